@@ -20,6 +20,9 @@
 #define ID_FIELD "id"      // required
 #define TYPE_FIELD "type"  // required
 #define STREAM_LINK_PATH_FIELD "stream_link_path"
+#define STREAM_LINK_RESOLVED_FIELD "stream_link_resolved"  // serialized ResolvedLinkInfo array
+#define DVB_TUNER_FEEDS_FIELD "dvb_tuner_feeds"  // serialized ResolvedLinkInfo array, set by daemon
+#define PIPE_COMPACT_FRAMING_FIELD "pipe_compact_framing"  // set by daemon, pipes use compact frames
 #define AUTO_EXIT_TIME_FIELD "auto_exit_time"
 
 #define INPUT_FIELD "input"  // required
@@ -36,6 +39,7 @@
 #define VIDEO_CODEC_FIELD "video_codec"
 #define AUDIO_CODEC_FIELD "audio_codec"
 #define AUDIO_SELECT_FIELD "audio_select"
+#define INPUT_FAILOVER_FIELD "input_failover"
 #define TIMESHIFT_DIR_FIELD "timeshift_dir"  // requeired in timeshift mode
 #define TIMESHIFT_CHUNK_LIFE_TIME_FIELD "timeshift_chunk_life_time"
 #define TIMESHIFT_DELAY_FIELD "timeshift_delay"
@@ -54,6 +58,9 @@
 #define ASPECT_RATIO_FIELD "aspect_ratio"
 #define RELAY_AUDIO_FIELD "relay_audio"
 #define RELAY_VIDEO_FIELD "relay_video"
+#define ABR_LADDER_FIELD "abr_ladder"
+#define TS_PASSTHROUGH_FIELD "ts_passthrough"
+#define TS_PIDS_FIELD "ts_pids"
 
 #define DECKLINK_VIDEO_MODE_FIELD "decklink_video_mode"
 
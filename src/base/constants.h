@@ -22,6 +22,8 @@
 
 #define DEFAULT_LOOP false
 
+#define STREAM_LINK_DEFAULT_TTL_SEC 600  // resolved url life time if it not signed
+
 #define TEST_URL "test"
 #define DISPLAY_URL "display"
 #define FAKE_URL "fake"
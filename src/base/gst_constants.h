@@ -34,6 +34,7 @@
 #define MPEG_AUDIO_PARSE "mpegaudioparse"
 #define RAW_AUDIO_PARSE "rawaudioparse"
 #define TEE "tee"
+#define INPUT_SELECTOR "input-selector"
 #define MP4_MUX "mp4mux"
 #define QT_MUX "qtmux"
 #define FLV_MUX "flvmux"
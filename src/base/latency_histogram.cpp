@@ -0,0 +1,51 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/latency_histogram.h"
+
+namespace fastocloud {
+
+LatencyHistogram::LatencyHistogram() : buckets_(), sum_usec_(0), max_usec_(0) {
+  for (size_t i = 0; i < LatencyStats::BUCKETS_COUNT; ++i) {
+    buckets_[i] = 0;
+  }
+}
+
+void LatencyHistogram::Observe(uint64_t usec) {
+  buckets_[LatencyStats::GetBucketIndex(usec)].fetch_add(1, std::memory_order_relaxed);
+  sum_usec_.fetch_add(usec, std::memory_order_relaxed);
+  uint64_t max = max_usec_.load(std::memory_order_relaxed);
+  while (usec > max && !max_usec_.compare_exchange_weak(max, usec, std::memory_order_relaxed)) {
+  }
+}
+
+void LatencyHistogram::Snapshot(LatencyStats* stats) const {
+  if (!stats) {
+    return;
+  }
+
+  for (size_t i = 0; i < LatencyStats::BUCKETS_COUNT; ++i) {
+    stats->SetBucket(i, buckets_[i].load(std::memory_order_relaxed));
+  }
+  stats->SetSumUsec(sum_usec_.load(std::memory_order_relaxed));
+  stats->SetMaxUsec(max_usec_.load(std::memory_order_relaxed));
+}
+
+void LatencyHistogram::Render(const std::string& name, const std::string& labels, std::string* out) const {
+  LatencyStats stats;
+  Snapshot(&stats);
+  stats.Render(name, labels, out);
+}
+
+}  // namespace fastocloud
@@ -0,0 +1,47 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+#include <common/macros.h>
+
+#include "base/latency_stats.h"
+
+namespace fastocloud {
+
+// Lock free accumulator of LatencyStats, safe to observe from any thread.
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  void Observe(uint64_t usec);
+
+  void Snapshot(LatencyStats* stats) const;
+  // renders snapshot, see LatencyStats::Render
+  void Render(const std::string& name, const std::string& labels, std::string* out) const;
+
+ private:
+  std::atomic<uint64_t> buckets_[LatencyStats::BUCKETS_COUNT];  // not cumulative
+  std::atomic<uint64_t> sum_usec_;
+  std::atomic<uint64_t> max_usec_;
+
+  DISALLOW_COPY_AND_ASSIGN(LatencyHistogram);
+};
+
+}  // namespace fastocloud
@@ -0,0 +1,109 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/latency_stats.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <limits>
+
+namespace fastocloud {
+
+const uint64_t LatencyStats::kBucketsUsec[BUCKETS_COUNT] = {
+    500,     1000,    2500,    5000,    10000,    25000, 50000, 100000, 250000, 500000,
+    1000000, 2500000, 5000000, 10000000, std::numeric_limits<uint64_t>::max()};
+
+LatencyStats::LatencyStats() : buckets_(), sum_usec_(0), max_usec_(0) {}
+
+size_t LatencyStats::GetBucketIndex(uint64_t usec) {
+  size_t i = 0;
+  while (usec > kBucketsUsec[i]) {
+    ++i;
+  }
+  return i;
+}
+
+uint64_t LatencyStats::GetBucket(size_t index) const {
+  if (index >= BUCKETS_COUNT) {
+    return 0;
+  }
+  return buckets_[index];
+}
+
+void LatencyStats::SetBucket(size_t index, uint64_t count) {
+  if (index >= BUCKETS_COUNT) {
+    return;
+  }
+  buckets_[index] = count;
+}
+
+uint64_t LatencyStats::GetCount() const {
+  uint64_t count = 0;
+  for (size_t i = 0; i < BUCKETS_COUNT; ++i) {
+    count += buckets_[i];
+  }
+  return count;
+}
+
+uint64_t LatencyStats::GetSumUsec() const {
+  return sum_usec_;
+}
+
+void LatencyStats::SetSumUsec(uint64_t sum) {
+  sum_usec_ = sum;
+}
+
+uint64_t LatencyStats::GetMaxUsec() const {
+  return max_usec_;
+}
+
+void LatencyStats::SetMaxUsec(uint64_t max) {
+  max_usec_ = max;
+}
+
+void LatencyStats::Render(const std::string& name, const std::string& labels, std::string* out) const {
+  if (!out) {
+    return;
+  }
+
+  const std::string prefix = labels.empty() ? std::string() : labels + ",";
+  char line[256];
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < BUCKETS_COUNT; ++i) {
+    cumulative += buckets_[i];
+    if (i == BUCKETS_COUNT - 1) {
+      snprintf(line, sizeof(line), "%s_bucket{%sle=\"+Inf\"} %" PRIu64 "\n", name.c_str(), prefix.c_str(), cumulative);
+    } else {
+      snprintf(line, sizeof(line), "%s_bucket{%sle=\"%g\"} %" PRIu64 "\n", name.c_str(), prefix.c_str(),
+               kBucketsUsec[i] / 1000000.0, cumulative);
+    }
+    *out += line;
+  }
+
+  const std::string braces = labels.empty() ? std::string() : "{" + labels + "}";
+  snprintf(line, sizeof(line), "%s_sum%s %g\n%s_count%s %" PRIu64 "\n", name.c_str(), braces.c_str(),
+           sum_usec_ / 1000000.0, name.c_str(), braces.c_str(), cumulative);
+  *out += line;
+}
+
+const char* LatencyStats::GetStageName(LatencyStage stage) {
+  static const char* kStages[] = {"input", "decode", "encode", "output"};
+  if (stage >= LATENCY_STAGES_COUNT) {
+    return "unknown";
+  }
+  return kStages[stage];
+}
+
+}  // namespace fastocloud
@@ -0,0 +1,68 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <string>
+
+namespace fastocloud {
+
+// points of pipeline where buffers age is traced, for relay streams decode/encode points are demux/parse
+enum LatencyStage {
+  LATENCY_STAGE_INPUT = 0,   // source src pad
+  LATENCY_STAGE_DECODE = 1,  // after decoder (udb connection)
+  LATENCY_STAGE_ENCODE = 2,  // after encoder (converter)
+  LATENCY_STAGE_OUTPUT = 3,  // sink pad
+  LATENCY_STAGES_COUNT
+};
+
+// Histogram of durations with fixed buckets, value of LatencyHistogram.
+// Per stage it holds buffers age (pipeline running time minus buffer running time),
+// age at output is end to end latency, difference between stages is time spent by stage.
+class LatencyStats {  // only compile time size fields
+ public:
+  enum { BUCKETS_COUNT = 15 };
+  static const uint64_t kBucketsUsec[BUCKETS_COUNT];  // upper bounds, last one is +Inf
+
+  LatencyStats();
+
+  static size_t GetBucketIndex(uint64_t usec);
+
+  uint64_t GetBucket(size_t index) const;  // not cumulative
+  void SetBucket(size_t index, uint64_t count);
+
+  uint64_t GetCount() const;
+  uint64_t GetSumUsec() const;
+  void SetSumUsec(uint64_t sum);
+  uint64_t GetMaxUsec() const;
+  void SetMaxUsec(uint64_t max);
+
+  // prometheus text exposition: <name>_bucket{<labels>,le=".."}, <name>_sum, <name>_count
+  void Render(const std::string& name, const std::string& labels, std::string* out) const;
+
+  static const char* GetStageName(LatencyStage stage);
+
+ private:
+  uint64_t buckets_[BUCKETS_COUNT];
+  uint64_t sum_usec_;
+  uint64_t max_usec_;
+};
+
+typedef std::array<LatencyStats, LATENCY_STAGES_COUNT> latency_stats_t;
+
+}  // namespace fastocloud
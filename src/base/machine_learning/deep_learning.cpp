@@ -23,14 +23,15 @@
 #define DEEP_LEARNING_BACKEND_FIELD "backend"
 #define DEEP_LEARNING_MODEL_PATH_FIELD "model_path"
 #define DEEP_LEARNING_PROPERTIES_FIELD "properties"
+#define DEEP_LEARNING_DETECTION_FPS_FIELD "detection_fps"
 
 namespace fastocloud {
 namespace machine_learning {
 
-DeepLearning::DeepLearning() : backend_(fastoml::TENSORFLOW), model_path_(), properties_() {}
+DeepLearning::DeepLearning() : backend_(fastoml::TENSORFLOW), model_path_(), properties_(), detection_fps_(0) {}
 
 DeepLearning::DeepLearning(fastoml::SupportedBackends backend, const file_path_t& model_path, const properties_t& prop)
-    : backend_(backend), model_path_(model_path), properties_(prop) {}
+    : backend_(backend), model_path_(model_path), properties_(prop), detection_fps_(0) {}
 
 DeepLearning::file_path_t DeepLearning::GetModelPath() const {
   return model_path_;
@@ -48,6 +49,14 @@ void DeepLearning::SetProperties(const properties_t& prop) {
   properties_ = prop;
 }
 
+int DeepLearning::GetDetectionFps() const {
+  return detection_fps_;
+}
+
+void DeepLearning::SetDetectionFps(int fps) {
+  detection_fps_ = fps;
+}
+
 fastoml::SupportedBackends DeepLearning::GetBackend() const {
   return backend_;
 }
@@ -57,7 +66,7 @@ void DeepLearning::SetBackend(fastoml::SupportedBackends backend) {
 }
 
 bool DeepLearning::Equals(const DeepLearning& learn) const {
-  return learn.backend_ == backend_ && learn.model_path_ == model_path_;
+  return learn.backend_ == backend_ && learn.model_path_ == model_path_ && learn.detection_fps_ == detection_fps_;
 }
 
 common::Optional<DeepLearning> DeepLearning::MakeDeepLearning(common::HashValue* hash) {
@@ -102,6 +111,12 @@ common::Optional<DeepLearning> DeepLearning::MakeDeepLearning(common::HashValue*
     res.SetProperties(properties);
   }
 
+  common::Value* detection_fps_field = hash->Find(DEEP_LEARNING_DETECTION_FPS_FIELD);
+  int detection_fps;
+  if (detection_fps_field && detection_fps_field->GetAsInteger(&detection_fps) && detection_fps > 0) {
+    res.SetDetectionFps(detection_fps);
+  }
+
   return res;
 }
 
@@ -134,6 +149,16 @@ common::Error DeepLearning::DoDeSerialize(json_object* serialized) {
     res.SetProperties(properties);
   }
 
+  json_object* jdetection_fps = nullptr;
+  json_bool jdetection_fps_exists =
+      json_object_object_get_ex(serialized, DEEP_LEARNING_DETECTION_FPS_FIELD, &jdetection_fps);
+  if (jdetection_fps_exists) {
+    const int detection_fps = json_object_get_int(jdetection_fps);
+    if (detection_fps > 0) {  // same as MakeDeepLearning, not positive means every frame
+      res.SetDetectionFps(detection_fps);
+    }
+  }
+
   *this = res;
   return common::Error();
 }
@@ -151,6 +176,9 @@ common::Error DeepLearning::SerializeFields(json_object* out) const {
     json_object_array_add(jproperties, jproperty);
   }
   json_object_object_add(out, DEEP_LEARNING_PROPERTIES_FIELD, jproperties);
+  if (detection_fps_ > 0) {
+    json_object_object_add(out, DEEP_LEARNING_DETECTION_FPS_FIELD, json_object_new_int(detection_fps_));
+  }
   return common::Error();
 }
 
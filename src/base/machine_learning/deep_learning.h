@@ -52,6 +52,10 @@ class DeepLearning : public common::serializer::JsonSerializer<DeepLearning> {
   file_path_t GetModelPath() const;
   void SetModelPath(const file_path_t& path);
 
+  // 0 - inference inline on every frame, otherwise detections per second in side branch
+  int GetDetectionFps() const;
+  void SetDetectionFps(int fps);
+
   static common::Optional<DeepLearning> MakeDeepLearning(common::HashValue* hash);
 
  protected:
@@ -62,6 +66,7 @@ class DeepLearning : public common::serializer::JsonSerializer<DeepLearning> {
   fastoml::SupportedBackends backend_;
   file_path_t model_path_;
   properties_t properties_;
+  int detection_fps_;
 };
 
 }  // namespace machine_learning
@@ -0,0 +1,144 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/rendition.h"
+
+#include <string>
+
+#include <json-c/json_object.h>
+
+#define RENDITION_NAME_FIELD "name"
+#define RENDITION_SIZE_FIELD "size"
+#define RENDITION_VIDEO_BIT_RATE_FIELD "video_bitrate"
+
+namespace fastocloud {
+
+Rendition::Rendition() : Rendition(std::string(), common::draw::Size(), bit_rate_t()) {}
+
+Rendition::Rendition(const std::string& name, const common::draw::Size& size, bit_rate_t video_bitrate)
+    : name_(name), size_(size), video_bitrate_(video_bitrate) {}
+
+bool Rendition::IsValid() const {
+  return !name_.empty() && !size_.IsEmpty();
+}
+
+bool Rendition::Equals(const Rendition& rend) const {
+  return name_ == rend.name_ && size_ == rend.size_ && video_bitrate_ == rend.video_bitrate_;
+}
+
+std::string Rendition::GetName() const {
+  return name_;
+}
+
+void Rendition::SetName(const std::string& name) {
+  name_ = name;
+}
+
+common::draw::Size Rendition::GetSize() const {
+  return size_;
+}
+
+void Rendition::SetSize(const common::draw::Size& size) {
+  size_ = size;
+}
+
+bit_rate_t Rendition::GetVideoBitrate() const {
+  return video_bitrate_;
+}
+
+void Rendition::SetVideoBitrate(bit_rate_t bitrate) {
+  video_bitrate_ = bitrate;
+}
+
+common::Optional<Rendition> Rendition::MakeRendition(common::HashValue* hash) {
+  if (!hash) {
+    return common::Optional<Rendition>();
+  }
+
+  Rendition res;
+  common::Value* name_field = hash->Find(RENDITION_NAME_FIELD);
+  std::string name;
+  if (name_field && name_field->GetAsBasicString(&name)) {
+    res.SetName(name);
+  }
+
+  common::Value* size_field = hash->Find(RENDITION_SIZE_FIELD);
+  std::string size_str;
+  common::draw::Size size;
+  if (size_field && size_field->GetAsBasicString(&size_str) && common::ConvertFromString(size_str, &size)) {
+    res.SetSize(size);
+  }
+
+  common::Value* bitrate_field = hash->Find(RENDITION_VIDEO_BIT_RATE_FIELD);
+  int bitrate;
+  if (bitrate_field && bitrate_field->GetAsInteger(&bitrate)) {
+    res.SetVideoBitrate(bitrate);
+  }
+
+  if (!res.IsValid()) {
+    return common::Optional<Rendition>();
+  }
+  return res;
+}
+
+common::Error Rendition::DoDeSerialize(json_object* serialized) {
+  Rendition res;
+  json_object* jname = nullptr;
+  json_bool jname_exists = json_object_object_get_ex(serialized, RENDITION_NAME_FIELD, &jname);
+  if (jname_exists) {
+    res.SetName(json_object_get_string(jname));
+  }
+
+  json_object* jsize = nullptr;
+  json_bool jsize_exists = json_object_object_get_ex(serialized, RENDITION_SIZE_FIELD, &jsize);
+  if (jsize_exists) {
+    common::draw::Size sz;
+    if (common::ConvertFromString(json_object_get_string(jsize), &sz)) {
+      res.SetSize(sz);
+    }
+  }
+
+  json_object* jbitrate = nullptr;
+  json_bool jbitrate_exists = json_object_object_get_ex(serialized, RENDITION_VIDEO_BIT_RATE_FIELD, &jbitrate);
+  if (jbitrate_exists) {
+    res.SetVideoBitrate(json_object_get_int(jbitrate));
+  }
+
+  *this = res;
+  return common::Error();
+}
+
+common::Error Rendition::SerializeFields(json_object* out) const {
+  ignore_result(SetStringField(out, RENDITION_NAME_FIELD, name_));
+  const std::string size_str = common::ConvertToString(size_);
+  ignore_result(SetStringField(out, RENDITION_SIZE_FIELD, size_str));
+  if (video_bitrate_) {
+    ignore_result(SetIntField(out, RENDITION_VIDEO_BIT_RATE_FIELD, *video_bitrate_));
+  }
+
+  return common::Error();
+}
+
+uint64_t GetRenditionBandwidth(bit_rate_t video_bitrate, bit_rate_t audio_bitrate) {
+  uint64_t bandwidth = 0;
+  if (video_bitrate) {
+    bandwidth += static_cast<uint64_t>(*video_bitrate) * 1000;
+  }
+  if (audio_bitrate) {
+    bandwidth += static_cast<uint64_t>(*audio_bitrate) * 1000;
+  }
+  return bandwidth;
+}
+
+}  // namespace fastocloud
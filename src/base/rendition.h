@@ -0,0 +1,65 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <common/draw/size.h>
+#include <common/serializer/json_serializer.h>
+#include <common/value.h>
+
+#include "base/types.h"
+
+namespace fastocloud {
+
+// one variant of adaptive bitrate ladder, encoded from the shared decode
+class Rendition : public common::serializer::JsonSerializer<Rendition> {
+ public:
+  Rendition();
+  Rendition(const std::string& name, const common::draw::Size& size, bit_rate_t video_bitrate);
+
+  bool IsValid() const;
+  bool Equals(const Rendition& rend) const;
+
+  std::string GetName() const;
+  void SetName(const std::string& name);
+
+  common::draw::Size GetSize() const;
+  void SetSize(const common::draw::Size& size);
+
+  bit_rate_t GetVideoBitrate() const;
+  void SetVideoBitrate(bit_rate_t bitrate);
+
+  static common::Optional<Rendition> MakeRendition(common::HashValue* value);
+
+ protected:
+  common::Error DoDeSerialize(json_object* serialized) override;
+  common::Error SerializeFields(json_object* out) const override;
+
+ private:
+  std::string name_;
+  common::draw::Size size_;
+  bit_rate_t video_bitrate_;
+};
+
+typedef std::vector<Rendition> abr_ladder_t;
+
+// BANDWIDTH of master playlist in bits per second, encoder bitrates are in kbps
+uint64_t GetRenditionBandwidth(bit_rate_t video_bitrate, bit_rate_t audio_bitrate);
+
+}  // namespace fastocloud
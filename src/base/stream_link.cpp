@@ -0,0 +1,204 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/stream_link.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if !defined(OS_WIN)
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+
+#include "base/constants.h"
+
+#if !defined(OS_WIN)
+extern char** environ;
+#endif
+
+namespace {
+const char* const kExpireMarkers[] = {"expire=", "/expire/", "expires%22%3A", "expires\":"};
+
+#if defined(OS_WIN)
+bool RunScript(const std::vector<std::string>& args, char* line, size_t size) {
+  std::string cmd_line;
+  for (const std::string& arg : args) {
+    cmd_line += cmd_line.empty() ? arg : " " + arg;
+  }
+
+  FILE* fp = popen(cmd_line.c_str(), "r");
+  if (!fp) {
+    return false;
+  }
+
+  char* res = fgets(line, size - 1, fp);
+  pclose(fp);
+  return res != nullptr;
+}
+#else
+// script gets only stdin, stderr and pipe as stdout, it doesn't inherit daemon sockets and pipes,
+// even ones opened by other threads without CLOEXEC
+bool SetupScriptFds(posix_spawn_file_actions_t* actions, int out_fd) {
+  if (posix_spawn_file_actions_adddup2(actions, out_fd, STDOUT_FILENO) != 0) {
+    return false;
+  }
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 34)
+#define HAVE_SPAWN_CLOSEFROM
+#endif
+#endif
+#if defined(HAVE_SPAWN_CLOSEFROM)
+  return posix_spawn_file_actions_addclosefrom_np(actions, STDERR_FILENO + 1) == 0;
+#else
+  const long max_fd = sysconf(_SC_OPEN_MAX);
+  for (long fd = STDERR_FILENO + 1; fd < max_fd; ++fd) {
+    if (fcntl(fd, F_GETFD) == -1) {
+      continue;
+    }
+    if (posix_spawn_file_actions_addclose(actions, fd) != 0) {
+      return false;
+    }
+  }
+  return true;
+#endif
+}
+
+bool ReadLine(int fd, char* line, size_t size) {
+  size_t len = 0;
+  while (len < size - 1) {
+    const ssize_t nread = read(fd, line + len, size - 1 - len);
+    if (nread < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nread <= 0) {
+      break;
+    }
+    len += nread;
+    if (memchr(line + len - nread, '\n', nread)) {
+      break;
+    }
+  }
+  line[len] = 0;
+  char* end = strchr(line, '\n');
+  if (end) {  // only first line, like fgets
+    end[1] = 0;
+  }
+  return len != 0;
+}
+
+// posix_spawn instead of popen: arguments are passed without shell, descriptors are closed explicitly
+bool RunScript(const std::vector<std::string>& args, char* line, size_t size) {
+  std::vector<char*> argv;
+  for (const std::string& arg : args) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return false;
+  }
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+  posix_spawn_file_actions_t actions;
+  if (posix_spawn_file_actions_init(&actions) != 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+
+  pid_t pid = 0;
+  const bool spawned =
+      SetupScriptFds(&actions, fds[1]) && posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ) == 0;
+  posix_spawn_file_actions_destroy(&actions);
+  close(fds[1]);
+  if (!spawned) {
+    close(fds[0]);
+    return false;
+  }
+
+  const bool res = ReadLine(fds[0], line, size);
+  close(fds[0]);
+  while (waitpid(pid, nullptr, 0) == -1 && errno == EINTR) {  // ECHILD if already reaped by loop child watcher
+  }
+  return res;
+}
+#endif
+}  // namespace
+
+namespace fastocloud {
+
+bool ResolveStreamLink(const std::string& script_path,
+                       const common::uri::GURL& url,
+                       const fastotv::StreamLink& link,
+                       common::uri::GURL* resolved) {
+  if (!resolved) {
+    return false;
+  }
+
+  std::vector<std::string> args = {script_path, "--stream-url"};
+  const auto http = link.GetHttp();
+  if (http) {
+    args.push_back("--http-proxy=" + http->spec());
+  }
+
+  const auto https = link.GetHttps();
+  if (https) {
+    args.push_back("--https-proxy=" + https->spec());
+  }
+
+  args.push_back(url.spec());
+  args.push_back("best");
+  char true_url[1024] = {0};
+  if (!RunScript(args, true_url, sizeof(true_url))) {
+    return false;
+  }
+
+  size_t ln = strlen(true_url) - 1;
+  if (true_url[ln] == '\n') {
+    true_url[ln] = 0;
+  }
+
+  *resolved = common::uri::GURL(true_url);
+  return resolved->is_valid();
+}
+
+fastotv::timestamp_t GetStreamLinkExpireTime(const common::uri::GURL& resolved,
+                                             fastotv::timestamp_t resolved_utc_msec) {
+  const std::string spec = resolved.spec();
+  for (const char* marker : kExpireMarkers) {
+    const size_t pos = spec.find(marker);
+    if (pos == std::string::npos) {
+      continue;
+    }
+
+    const char* start = spec.c_str() + pos + strlen(marker);
+    char* end = nullptr;
+    const long long expire_sec = strtoll(start, &end, 10);
+    if (end != start && expire_sec > 0) {
+      return static_cast<fastotv::timestamp_t>(expire_sec) * 1000;
+    }
+  }
+
+  return resolved_utc_msec + STREAM_LINK_DEFAULT_TTL_SEC * 1000;
+}
+
+}  // namespace fastocloud
@@ -0,0 +1,35 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+
+#include "base/input_uri.h"
+#include "base/types.h"
+
+namespace fastocloud {
+
+// runs streamlink script for url, blocks till script exit
+bool ResolveStreamLink(const std::string& script_path,
+                       const common::uri::GURL& url,
+                       const fastotv::StreamLink& link,
+                       common::uri::GURL* resolved) WARN_UNUSED_RESULT;
+
+// expire time of signed resolved url (youtube/twitch tokens),
+// if url not signed: resolved_utc_msec + STREAM_LINK_DEFAULT_TTL_SEC
+fastotv::timestamp_t GetStreamLinkExpireTime(const common::uri::GURL& resolved,
+                                             fastotv::timestamp_t resolved_utc_msec);
+
+}  // namespace fastocloud
@@ -0,0 +1,205 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/stream_stats_block.h"
+
+#if defined(OS_POSIX)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <new>
+
+namespace fastocloud {
+
+namespace {
+enum { kReadAttempts = 4 };
+}
+
+StreamStatsBlock::StreamStatsBlock(uint32_t max_inputs, uint32_t max_outputs)
+    : sequence_(0), max_inputs_(max_inputs), max_outputs_(max_outputs), truncated_(false), payload_() {
+  ChannelStats* channels = GetChannels();
+  for (uint32_t i = 0; i < max_inputs + max_outputs; ++i) {
+    new (channels + i) ChannelStats;
+  }
+}
+
+size_t StreamStatsBlock::GetMappingSize(size_t inputs, size_t outputs) {
+  static_assert(sizeof(StreamStatsBlock) % alignof(ChannelStats) == 0, "channels must be aligned after block");
+  return sizeof(StreamStatsBlock) + (inputs + outputs) * sizeof(ChannelStats);
+}
+
+ChannelStats* StreamStatsBlock::GetChannels() {
+  return reinterpret_cast<ChannelStats*>(this + 1);
+}
+
+const ChannelStats* StreamStatsBlock::GetChannels() const {
+  return reinterpret_cast<const ChannelStats*>(this + 1);
+}
+
+StreamStatsBlock* StreamStatsBlock::Create(size_t inputs, size_t outputs) {
+#if defined(OS_POSIX)
+  void* mem =
+      mmap(nullptr, GetMappingSize(inputs, outputs), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) {
+    return nullptr;
+  }
+  return new (mem) StreamStatsBlock(inputs, outputs);
+#else
+  return nullptr;
+#endif
+}
+
+#if defined(OS_LINUX)
+StreamStatsBlock* StreamStatsBlock::CreateShareable(size_t inputs, size_t outputs, int* fd) {
+  int mfd = memfd_create("stream_stats", MFD_CLOEXEC);
+  if (mfd == -1) {
+    return nullptr;
+  }
+
+  const size_t size = GetMappingSize(inputs, outputs);
+  if (ftruncate(mfd, size) == -1) {
+    close(mfd);
+    return nullptr;
+  }
+
+  void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mfd, 0);
+  if (mem == MAP_FAILED) {
+    close(mfd);
+    return nullptr;
+  }
+
+  *fd = mfd;
+  return new (mem) StreamStatsBlock(inputs, outputs);
+}
+
+StreamStatsBlock* StreamStatsBlock::Attach(int fd) {
+  struct stat sb;
+  if (fstat(fd, &sb) == -1 || static_cast<size_t>(sb.st_size) < sizeof(StreamStatsBlock)) {
+    return nullptr;
+  }
+
+  void* mem = mmap(nullptr, sb.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mem == MAP_FAILED) {
+    return nullptr;
+  }
+
+  StreamStatsBlock* block = static_cast<StreamStatsBlock*>(mem);
+  if (GetMappingSize(block->max_inputs_, block->max_outputs_) != static_cast<size_t>(sb.st_size)) {
+    munmap(mem, sb.st_size);
+    return nullptr;
+  }
+  return block;
+}
+#endif
+
+void StreamStatsBlock::Destroy(StreamStatsBlock* block) {
+  if (!block) {
+    return;
+  }
+
+#if defined(OS_POSIX)
+  const size_t size = GetMappingSize(block->max_inputs_, block->max_outputs_);
+  block->~StreamStatsBlock();
+  munmap(block, size);
+#endif
+}
+
+void StreamStatsBlock::Write(const StreamStruct& stats,
+                             double cpu_load,
+                             size_t rss_bytes,
+                             fastotv::timestamp_t utc_time) {
+  if (stats.input.size() > max_inputs_ || stats.output.size() > max_outputs_) {
+    if (!truncated_.exchange(true, std::memory_order_relaxed)) {
+      WARNING_LOG() << "Stream " << stats.id << " has " << stats.input.size() << " inputs and "
+                    << stats.output.size() << " outputs, statistic block only for " << max_inputs_ << " and "
+                    << max_outputs_;
+    }
+  }
+
+  const uint64_t seq = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  payload_.type = stats.type;
+  payload_.status = stats.status;
+  payload_.start_time = stats.start_time;
+  payload_.loop_start_time = stats.loop_start_time;
+  payload_.idle_time = stats.idle_time;
+  payload_.restarts = stats.restarts;
+  payload_.cpu_load = cpu_load;
+  payload_.rss_bytes = rss_bytes;
+  payload_.utc_time = utc_time;
+  ChannelStats* channels = GetChannels();
+  payload_.input_count = std::min<size_t>(stats.input.size(), max_inputs_);
+  for (uint32_t i = 0; i < payload_.input_count; ++i) {
+    channels[i] = stats.input[i];
+  }
+  payload_.output_count = std::min<size_t>(stats.output.size(), max_outputs_);
+  for (uint32_t i = 0; i < payload_.output_count; ++i) {
+    channels[max_inputs_ + i] = stats.output[i];
+  }
+  payload_.latency = stats.latency;
+
+  sequence_.store(seq + 2, std::memory_order_release);
+}
+
+bool StreamStatsBlock::Read(const fastotv::stream_id_t& sid,
+                            uint64_t* sequence,
+                            StreamStruct* stats,
+                            double* cpu_load,
+                            size_t* rss_bytes,
+                            fastotv::timestamp_t* utc_time) const {
+  for (int i = 0; i < kReadAttempts; ++i) {
+    const uint64_t begin = sequence_.load(std::memory_order_acquire);
+    if (begin == *sequence) {
+      return false;
+    }
+    if (begin & 1) {
+      continue;
+    }
+
+    const Payload copy = payload_;
+    if (copy.input_count > max_inputs_ || copy.output_count > max_outputs_) {  // torn read
+      continue;
+    }
+    const ChannelStats* channels = GetChannels();
+    input_channels_info_t input(channels, channels + copy.input_count);
+    output_channels_info_t output(channels + max_inputs_, channels + max_inputs_ + copy.output_count);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) != begin) {
+      continue;
+    }
+
+    *stats = StreamStruct(sid, copy.type, copy.status, input, output, copy.start_time, copy.loop_start_time,
+                          copy.restarts);
+    stats->idle_time = copy.idle_time;
+    stats->latency = copy.latency;
+    *cpu_load = copy.cpu_load;
+    *rss_bytes = copy.rss_bytes;
+    *utc_time = copy.utc_time;
+    *sequence = begin;
+    return true;
+  }
+
+  return false;
+}
+
+bool StreamStatsBlock::IsTruncated() const {
+  return truncated_.load(std::memory_order_relaxed);
+}
+
+}  // namespace fastocloud
@@ -0,0 +1,81 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "base/stream_struct.h"
+
+namespace fastocloud {
+
+// Fixed layout statistics of one stream, lives in memory shared between daemon and stream process.
+// Input and output channel arrays follow the block, sized from stream config when block is created.
+// Single writer (stream process) publishes under seqlock, daemon reads without locks or serialization.
+class StreamStatsBlock {
+ public:
+  // anonymous shared mapping inherited by forked stream process, nullptr if not supported
+  static StreamStatsBlock* Create(size_t inputs, size_t outputs);
+#if defined(OS_LINUX)
+  // memfd backed block which can be passed to not related process, caller owns fd
+  static StreamStatsBlock* CreateShareable(size_t inputs, size_t outputs, int* fd);
+  static StreamStatsBlock* Attach(int fd);  // channels count taken from block
+#endif
+  static void Destroy(StreamStatsBlock* block);
+
+  // channels above block capacity are dropped and block marked as truncated
+  void Write(const StreamStruct& stats, double cpu_load, size_t rss_bytes, fastotv::timestamp_t utc_time);
+  // false if nothing new since *sequence or writer is busy, on success *sequence updated
+  bool Read(const fastotv::stream_id_t& sid,
+            uint64_t* sequence,
+            StreamStruct* stats,
+            double* cpu_load,
+            size_t* rss_bytes,
+            fastotv::timestamp_t* utc_time) const;
+
+  // stream reported more channels than config had
+  bool IsTruncated() const;
+
+ private:
+  StreamStatsBlock(uint32_t max_inputs, uint32_t max_outputs);
+
+  static size_t GetMappingSize(size_t inputs, size_t outputs);
+  ChannelStats* GetChannels();  // inputs, then outputs
+  const ChannelStats* GetChannels() const;
+
+  struct Payload {
+    fastotv::StreamType type;
+    StreamStatus status;
+    fastotv::timestamp_t start_time;
+    fastotv::timestamp_t loop_start_time;
+    fastotv::timestamp_t idle_time;
+    uint64_t restarts;
+    double cpu_load;
+    uint64_t rss_bytes;
+    fastotv::timestamp_t utc_time;
+    uint32_t input_count;
+    uint32_t output_count;
+    latency_stats_t latency;
+  };
+
+  std::atomic<uint64_t> sequence_;  // odd while writer updates payload
+  const uint32_t max_inputs_;
+  const uint32_t max_outputs_;
+  std::atomic<bool> truncated_;
+  Payload payload_;
+};
+
+}  // namespace fastocloud
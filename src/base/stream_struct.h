@@ -17,6 +17,7 @@
 #include <string>
 #include <vector>
 
+#include "base/latency_stats.h"
 #include "base/stream_info.h"
 
 namespace fastocloud {
@@ -53,6 +54,7 @@ struct StreamStruct {
 
   input_channels_info_t input;
   output_channels_info_t output;
+  latency_stats_t latency;
 };
 
 }  // namespace fastocloud
@@ -0,0 +1,214 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/async_http_client.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#if defined(OS_LINUX)
+#include <sys/sendfile.h>
+#endif
+
+#include <string>
+
+#include <common/string_util.h>
+#include <common/time.h>
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+namespace {
+const char kHeadersEnd[] = "\r\n\r\n";
+const char kContentLengthField[] = "\r\ncontent-length:";
+
+size_t GetContentLength(const std::string& headers) {
+  const std::string lower = common::StringToLowerASCII(headers);
+  size_t pos = lower.find(kContentLengthField);
+  if (pos == std::string::npos) {
+    return 0;
+  }
+
+  return strtoull(lower.c_str() + pos + sizeof(kContentLengthField) - 1, nullptr, 10);
+}
+
+bool IsWouldBlock(const common::ErrnoError& err) {
+  const int code = err->GetErrorCode();
+  return code == EAGAIN || code == EWOULDBLOCK;
+}
+}  // namespace
+
+AsyncHttpClient::AsyncHttpClient(common::libev::IoLoop* server, const common::net::socket_info& info)
+    : base_class(server, info),
+      received_(),
+      file_(INVALID_DESCRIPTOR),
+      data_(),
+      offset_(0),
+      remaining_(0),
+      last_activity_msec_(common::time::current_utc_mstime()),
+      close_after_send_(false) {}
+
+AsyncHttpClient::~AsyncHttpClient() {
+  ResetSend();
+}
+
+common::ErrnoError AsyncHttpClient::StartSendFile(int file, off_t offset, off_t size) {
+  ResetSend();
+  file_ = file;
+  offset_ = offset;
+  remaining_ = size;
+  last_activity_msec_ = common::time::current_utc_mstime();
+  bool done = false;
+  return ContinueSend(&done);
+}
+
+common::ErrnoError AsyncHttpClient::StartSendData(data_t data, off_t offset, off_t size) {
+  ResetSend();
+  data_ = data;
+  offset_ = offset;
+  remaining_ = size;
+  last_activity_msec_ = common::time::current_utc_mstime();
+  bool done = false;
+  return ContinueSend(&done);
+}
+
+common::ErrnoError AsyncHttpClient::ContinueSend(bool* done) {
+  while (remaining_ > 0) {
+    size_t nwrite = 0;
+    common::ErrnoError err;
+    if (data_) {
+      const size_t to_write = remaining_ > SEND_CHUNK_SIZE ? SEND_CHUNK_SIZE : static_cast<size_t>(remaining_);
+      err = SingleWrite(data_->data() + offset_, to_write, &nwrite);
+    } else {
+      err = WriteFileChunk(&nwrite);
+    }
+
+    if (err && !IsWouldBlock(err)) {
+      ResetSend();
+      WaitWritable(false);
+      return err;
+    }
+
+    if (err || nwrite == 0) {  // socket buffer is full, wait for write readiness
+      WaitWritable(true);
+      *done = false;
+      return common::ErrnoError();
+    }
+
+    offset_ += nwrite;
+    remaining_ -= nwrite;
+    last_activity_msec_ = common::time::current_utc_mstime();
+  }
+
+  ResetSend();
+  WaitWritable(false);
+  *done = true;
+  return common::ErrnoError();
+}
+
+bool AsyncHttpClient::AppendReceived(const char* data, size_t size) {
+  if (received_.size() + size > MAX_REQUEST_SIZE) {
+    return false;
+  }
+
+  received_.append(data, size);
+  last_activity_msec_ = common::time::current_utc_mstime();
+  return true;
+}
+
+bool AsyncHttpClient::PopRequest(std::string* request) {
+  const size_t headers_end = received_.find(kHeadersEnd);
+  if (headers_end == std::string::npos) {
+    return false;
+  }
+
+  const size_t headers_size = headers_end + sizeof(kHeadersEnd) - 1;
+  const size_t request_size = headers_size + GetContentLength(received_.substr(0, headers_end));
+  if (request_size > received_.size()) {  // body not fully received
+    return false;
+  }
+
+  *request = received_.substr(0, request_size);
+  received_.erase(0, request_size);
+  return true;
+}
+
+bool AsyncHttpClient::IsSending() const {
+  return remaining_ > 0;
+}
+
+bool AsyncHttpClient::IsSendStalled(common::time64_t now_msec, common::time64_t timeout_msec) const {
+  return IsSending() && now_msec - last_activity_msec_ > timeout_msec;
+}
+
+bool AsyncHttpClient::IsIdle(common::time64_t now_msec, common::time64_t timeout_msec) const {
+  return !IsSending() && now_msec - last_activity_msec_ > timeout_msec;
+}
+
+void AsyncHttpClient::SetCloseAfterSend(bool close) {
+  close_after_send_ = close;
+}
+
+bool AsyncHttpClient::IsCloseAfterSend() const {
+  return close_after_send_;
+}
+
+common::ErrnoError AsyncHttpClient::WriteFileChunk(size_t* nwrite) {
+  const size_t to_write = remaining_ > SEND_CHUNK_SIZE ? SEND_CHUNK_SIZE : static_cast<size_t>(remaining_);
+#if defined(OS_LINUX)
+  off_t offset = offset_;
+  ssize_t res = sendfile(GetFd(), file_, &offset, to_write);
+  if (res < 0) {
+    return common::make_errno_error(errno);
+  }
+  if (res == 0) {  // file truncated
+    return common::make_errno_error(EIO);
+  }
+  *nwrite = res;
+  return common::ErrnoError();
+#else
+  char buff[SEND_CHUNK_SIZE];
+  ssize_t nread = pread(file_, buff, to_write, offset_);
+  if (nread < 0) {
+    return common::make_errno_error(errno);
+  }
+  if (nread == 0) {  // file truncated
+    return common::make_errno_error(EIO);
+  }
+  return SingleWrite(buff, nread, nwrite);
+#endif
+}
+
+void AsyncHttpClient::WaitWritable(bool writable) {
+  const common::libev::flags_t flags = writable ? EV_WRITE : EV_READ;
+  if (!GetServer() || GetFlags() == flags) {  // not attached to loop or nothing to switch
+    return;
+  }
+  SetFlags(flags);
+}
+
+void AsyncHttpClient::ResetSend() {
+  if (file_ != INVALID_DESCRIPTOR) {
+    ::close(file_);
+    file_ = INVALID_DESCRIPTOR;
+  }
+  data_.reset();
+  offset_ = 0;
+  remaining_ = 0;
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,77 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <common/libev/http/http_client.h>
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+// Http client which sends response bodies without blocking the loop:
+// bodies are written in partial chunks, when socket buffer is full client waits for write readiness
+// (reads are paused meanwhile) and continues from DataReadyToWrite of its handler.
+// Received bytes are accumulated per connection, so requests split across reads and pipelined requests
+// are extracted one by one.
+class AsyncHttpClient : public common::libev::http::HttpClient {
+ public:
+  typedef common::libev::http::HttpClient base_class;
+  typedef std::shared_ptr<const std::string> data_t;
+  enum { SEND_CHUNK_SIZE = 64 * 1024, MAX_REQUEST_SIZE = 16 * 1024 };
+
+  AsyncHttpClient(common::libev::IoLoop* server, const common::net::socket_info& info);
+  ~AsyncHttpClient() override;
+
+  // takes ownership of file
+  common::ErrnoError StartSendFile(int file, off_t offset, off_t size) WARN_UNUSED_RESULT;
+  common::ErrnoError StartSendData(data_t data, off_t offset, off_t size) WARN_UNUSED_RESULT;
+  // sends as much as socket accepts, done is true when whole body sent
+  common::ErrnoError ContinueSend(bool* done) WARN_UNUSED_RESULT;
+
+  // false if buffered unprocessed data exceeds MAX_REQUEST_SIZE
+  bool AppendReceived(const char* data, size_t size) WARN_UNUSED_RESULT;
+  // extracts next complete request (headers and Content-Length body) from received data
+  bool PopRequest(std::string* request);
+
+  bool IsSending() const;
+  bool IsSendStalled(common::time64_t now_msec, common::time64_t timeout_msec) const;
+  // nothing received or sent for timeout, used to release keep-alive connections
+  bool IsIdle(common::time64_t now_msec, common::time64_t timeout_msec) const;
+
+  void SetCloseAfterSend(bool close);
+  bool IsCloseAfterSend() const;
+
+ private:
+  common::ErrnoError WriteFileChunk(size_t* nwrite) WARN_UNUSED_RESULT;
+  // switches loop watcher between write readiness (body pending) and reads
+  void WaitWritable(bool writable);
+  void ResetSend();
+
+  std::string received_;
+
+  int file_;
+  data_t data_;
+  off_t offset_;
+  off_t remaining_;
+  common::time64_t last_activity_msec_;
+  bool close_after_send_;
+};
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
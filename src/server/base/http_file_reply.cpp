@@ -0,0 +1,251 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/http_file_reply.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include <common/string_split.h>
+#include <common/string_util.h>
+
+#include "base/types.h"
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+const common::http::http_status HS_PARTIAL_CONTENT = static_cast<common::http::http_status>(206);
+const common::http::http_status HS_NOT_MODIFIED = static_cast<common::http::http_status>(304);
+const common::http::http_status HS_RANGE_NOT_SATISFIABLE = static_cast<common::http::http_status>(416);
+
+namespace {
+
+bool ParseHttpDate(const std::string& value, time_t* out) {
+  struct tm tm;
+  memset(&tm, 0, sizeof(tm));
+  const char* end = strptime(value.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  if (!end) {
+    return false;
+  }
+
+  *out = timegm(&tm);
+  return true;
+}
+
+bool IsETagMatch(const std::string& header_value, const std::string& etag) {
+  const auto tags = common::SplitString(header_value, ",", common::TRIM_WHITESPACE, common::SPLIT_WANT_NONEMPTY);
+  for (std::string tag : tags) {
+    if (tag == "*") {
+      return true;
+    }
+    if (common::StartsWithASCII(tag, "W/", true)) {  // weak comparison for GET
+      tag = tag.substr(2);
+    }
+    if (tag == etag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsNotModified(const common::http::HttpRequest& request, const std::string& etag, time_t mtime) {
+  common::http::header_t field;
+  if (request.FindHeaderByKey("If-None-Match", false, &field)) {
+    return IsETagMatch(field.value, etag);
+  }
+
+  time_t since = 0;
+  if (request.FindHeaderByKey("If-Modified-Since", false, &field) && ParseHttpDate(field.value, &since)) {
+    return mtime <= since;
+  }
+  return false;
+}
+
+// If-Range with a stale validator means the whole representation must be sent
+bool IsRangeApplicable(const common::http::HttpRequest& request, const std::string& etag, time_t mtime) {
+  common::http::header_t field;
+  if (!request.FindHeaderByKey("If-Range", false, &field)) {
+    return true;
+  }
+
+  time_t date = 0;
+  if (ParseHttpDate(field.value, &date)) {
+    return date == mtime;
+  }
+  return field.value == etag;
+}
+
+enum RangeResult { RANGE_IGNORE, RANGE_OK, RANGE_NOT_SATISFIABLE };
+
+// only single range requests are served, multi range falls back to the full body
+RangeResult ParseRange(const std::string& value, off_t size, off_t* first, off_t* last) {
+  static const char kBytesUnit[] = "bytes=";
+  if (!common::StartsWithASCII(value, kBytesUnit, false)) {
+    return RANGE_IGNORE;
+  }
+
+  const std::string spec = value.substr(sizeof(kBytesUnit) - 1);
+  if (spec.find(',') != std::string::npos) {
+    return RANGE_IGNORE;
+  }
+
+  const size_t dash = spec.find('-');
+  if (dash == std::string::npos) {
+    return RANGE_IGNORE;
+  }
+
+  const std::string start_str = spec.substr(0, dash);
+  const std::string end_str = spec.substr(dash + 1);
+  char* endptr = nullptr;
+  if (start_str.empty()) {  // suffix: last N bytes
+    if (end_str.empty()) {
+      return RANGE_IGNORE;
+    }
+    long long suffix = strtoll(end_str.c_str(), &endptr, 10);
+    if (*endptr != '\0' || suffix < 0) {
+      return RANGE_IGNORE;
+    }
+    if (suffix == 0 || size == 0) {
+      return RANGE_NOT_SATISFIABLE;
+    }
+    *first = suffix >= size ? 0 : size - suffix;
+    *last = size - 1;
+    return RANGE_OK;
+  }
+
+  long long start = strtoll(start_str.c_str(), &endptr, 10);
+  if (*endptr != '\0' || start < 0) {
+    return RANGE_IGNORE;
+  }
+
+  long long end = size - 1;
+  if (!end_str.empty()) {
+    end = strtoll(end_str.c_str(), &endptr, 10);
+    if (*endptr != '\0' || end < start) {
+      return RANGE_IGNORE;
+    }
+  }
+
+  if (start >= size) {
+    return RANGE_NOT_SATISFIABLE;
+  }
+
+  *first = start;
+  *last = end >= size ? size - 1 : end;
+  return RANGE_OK;
+}
+
+}  // namespace
+
+FileVersion MakeFileVersion(const struct stat& sb) {
+  FileVersion version;
+  version.size = sb.st_size;
+  version.mtime = sb.st_mtime;
+#if defined(OS_MACOSX)
+  version.mtime_nsec = sb.st_mtimespec.tv_nsec;
+#elif defined(OS_WIN)
+  version.mtime_nsec = 0;
+#else
+  version.mtime_nsec = sb.st_mtim.tv_nsec;
+#endif
+  version.inode = sb.st_ino;
+  return version;
+}
+
+bool operator==(const FileVersion& left, const FileVersion& right) {
+  return left.inode == right.inode && left.size == right.size && left.mtime == right.mtime &&
+         left.mtime_nsec == right.mtime_nsec;
+}
+
+std::string MakeETag(const FileVersion& version) {
+  char buff[96] = {0};
+  snprintf(buff, sizeof(buff), "\"%" PRIx64 "-%" PRIx64 ".%lx-%" PRIx64 "\"", static_cast<uint64_t>(version.inode),
+           static_cast<uint64_t>(version.mtime), version.mtime_nsec, static_cast<uint64_t>(version.size));
+  return buff;
+}
+
+const char* GetCacheControl(const std::string& extension, bool write_once) {
+  if (common::EqualsASCII(extension, M3U8_EXTENSION, false) || common::EqualsASCII(extension, DASH_EXTENSION, false)) {
+    return "no-cache";
+  }
+  if (common::EqualsASCII(extension, TS_EXTENSION, false)) {
+    return write_once ? "public, max-age=31536000, immutable" : "public, max-age=10";
+  }
+  return nullptr;
+}
+
+HttpFileReply MakeFileReply(const common::http::HttpRequest& request,
+                            const std::string& extension,
+                            const FileVersion& version,
+                            bool write_once) {
+  const off_t size = version.size;
+  const time_t mtime = version.mtime;
+  HttpFileReply reply;
+  reply.status = common::http::HS_OK;
+  reply.offset = 0;
+  reply.length = size;
+
+  const std::string etag = MakeETag(version);
+  reply.headers.push_back({"ETag", etag});
+  reply.headers.push_back({"Accept-Ranges", "bytes"});
+  const char* cache_control = GetCacheControl(extension, write_once);
+  if (cache_control) {
+    reply.headers.push_back({"Cache-Control", cache_control});
+  }
+
+  if (IsNotModified(request, etag, mtime)) {
+    reply.status = HS_NOT_MODIFIED;
+    reply.length = 0;
+    return reply;
+  }
+
+  common::http::header_t range;
+  if (!request.FindHeaderByKey("Range", false, &range) || !IsRangeApplicable(request, etag, mtime)) {
+    return reply;
+  }
+
+  off_t first = 0, last = 0;
+  const RangeResult res = ParseRange(range.value, size, &first, &last);
+  if (res == RANGE_IGNORE) {
+    return reply;
+  }
+
+  char content_range[128] = {0};
+  if (res == RANGE_NOT_SATISFIABLE) {
+    snprintf(content_range, sizeof(content_range), "bytes */%" PRId64, static_cast<int64_t>(size));
+    reply.headers.push_back({"Content-Range", content_range});
+    reply.status = HS_RANGE_NOT_SATISFIABLE;
+    reply.length = 0;
+    return reply;
+  }
+
+  snprintf(content_range, sizeof(content_range), "bytes %" PRId64 "-%" PRId64 "/%" PRId64, static_cast<int64_t>(first),
+           static_cast<int64_t>(last), static_cast<int64_t>(size));
+  reply.headers.push_back({"Content-Range", content_range});
+  reply.status = HS_PARTIAL_CONTENT;
+  reply.offset = first;
+  reply.length = last - first + 1;
+  return reply;
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,66 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <string>
+
+#include <common/http/http.h>
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+// not enumerated by common::http
+extern const common::http::http_status HS_PARTIAL_CONTENT;
+extern const common::http::http_status HS_NOT_MODIFIED;
+extern const common::http::http_status HS_RANGE_NOT_SATISFIABLE;
+
+// How a GET/HEAD request for a static file should be answered, taking into account
+// Range/If-Range and If-None-Match/If-Modified-Since request headers.
+struct HttpFileReply {
+  common::http::http_status status;
+  off_t offset;
+  off_t length;
+  common::http::headers_t headers;  // ETag, Cache-Control, Accept-Ranges, Content-Range
+};
+
+// Validator of file content, mtime nanoseconds and inode catch rewrite within the same second
+// and replacement by rename with the same size.
+struct FileVersion {
+  off_t size;
+  time_t mtime;
+  long mtime_nsec;
+  ino_t inode;
+};
+
+FileVersion MakeFileVersion(const struct stat& sb);
+bool operator==(const FileVersion& left, const FileVersion& right);
+std::string MakeETag(const FileVersion& version);
+
+// extension without dot: live playlists must be revalidated,
+// chunks are immutable only if written once (vods), live chunk names are reused after stream restart
+const char* GetCacheControl(const std::string& extension, bool write_once);
+
+HttpFileReply MakeFileReply(const common::http::HttpRequest& request,
+                            const std::string& extension,
+                            const FileVersion& version,
+                            bool write_once);
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,153 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/http_server_handler.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <common/time.h>
+
+#include "server/base/async_http_client.h"
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+HttpServerHandler::HttpServerHandler() : base_class() {}
+
+void HttpServerHandler::PreLooped(common::libev::IoLoop* server) {
+  server->CreateTimer(TIMEOUT_CHECK_SECONDS, true);
+}
+
+void HttpServerHandler::TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) {
+  UNUSED(id);  // only timeouts timer
+  const common::time64_t now = common::time::current_utc_mstime();
+  std::vector<common::libev::IoClient*> online_clients = server->GetClients();
+  for (size_t i = 0; i < online_clients.size(); ++i) {
+    AsyncHttpClient* hclient = ToHttpClient(online_clients[i]);
+    if (!hclient) {
+      continue;
+    }
+
+    if (hclient->IsSendStalled(now, SEND_TIMEOUT_MSEC)) {
+      WARNING_LOG() << "Send timeout, closing client: " << hclient->GetFormatedName();
+      CloseClient(hclient);
+    } else if (hclient->IsIdle(now, KEEP_ALIVE_TIMEOUT_MSEC)) {
+      CloseClient(hclient);
+    }
+  }
+}
+
+void HttpServerHandler::Accepted(common::libev::IoChild* child) {
+  UNUSED(child);
+}
+
+void HttpServerHandler::Moved(common::libev::IoLoop* server, common::libev::IoChild* child) {
+  UNUSED(server);
+  UNUSED(child);
+}
+
+void HttpServerHandler::ChildStatusChanged(common::libev::IoChild* child, int status, int signal) {
+  UNUSED(child);
+  UNUSED(status);
+  UNUSED(signal);
+}
+
+void HttpServerHandler::DataReceived(common::libev::IoClient* client) {
+  AsyncHttpClient* hclient = ToHttpClient(client);
+  if (!hclient) {
+    CloseClient(client);
+    return;
+  }
+
+  char buff[BUF_SIZE];
+  size_t nread = 0;
+  common::ErrnoError errn = hclient->SingleRead(buff, BUF_SIZE, &nread);
+  if (errn || nread == 0) {
+    CloseClient(hclient);
+    return;
+  }
+
+  if (!hclient->AppendReceived(buff, nread)) {
+    static const common::libev::http::HttpServerInfo hinf(PROJECT_NAME_TITLE, PROJECT_DOMAIN);
+    common::ErrnoError err = hclient->SendError(common::http::HP_1_1, common::http::HS_BAD_REQUEST, {},
+                                                "Request too large.", false, hinf);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    }
+    CloseClient(hclient);
+    return;
+  }
+
+  ProcessPendingRequests(hclient);
+}
+
+void HttpServerHandler::DataReadyToWrite(common::libev::IoClient* client) {
+  AsyncHttpClient* hclient = ToHttpClient(client);
+  if (!hclient) {
+    CloseClient(client);
+    return;
+  }
+
+  bool done = false;
+  common::ErrnoError err = hclient->ContinueSend(&done);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    CloseClient(hclient);
+    return;
+  }
+
+  if (!done) {
+    return;
+  }
+
+  if (hclient->IsCloseAfterSend()) {
+    CloseClient(hclient);
+    return;
+  }
+
+  ProcessPendingRequests(hclient);  // pipelined requests received while sending
+}
+
+void HttpServerHandler::PostLooped(common::libev::IoLoop* server) {
+  UNUSED(server);
+}
+
+AsyncHttpClient* HttpServerHandler::ToHttpClient(common::libev::IoClient* client) {
+  return dynamic_cast<AsyncHttpClient*>(client);
+}
+
+void HttpServerHandler::CloseClient(common::libev::IoClient* client) {
+  ignore_result(client->Close());
+  delete client;
+}
+
+void HttpServerHandler::ProcessPendingRequests(AsyncHttpClient* hclient) {
+  std::string request;
+  while (!hclient->IsSending() && hclient->PopRequest(&request)) {
+    const auto start = std::chrono::steady_clock::now();
+    bool alive = ProcessReceived(hclient, request.data(), request.size());
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    ObserveRequestLatency(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    if (!alive) {
+      return;
+    }
+  }
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
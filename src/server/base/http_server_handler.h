@@ -0,0 +1,59 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "server/base/iserver_handler.h"
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+class AsyncHttpClient;
+
+// Connection handling shared by http-like endpoints served with AsyncHttpClient:
+// buffered reads, pipelined requests, non blocking sends, send stall and keep-alive timeouts.
+// Subclasses only answer single requests.
+class HttpServerHandler : public IServerHandler {
+ public:
+  enum { BUF_SIZE = 4096, SEND_TIMEOUT_MSEC = 30000, KEEP_ALIVE_TIMEOUT_MSEC = 60000, TIMEOUT_CHECK_SECONDS = 5 };
+  typedef IServerHandler base_class;
+  HttpServerHandler();
+
+  void PreLooped(common::libev::IoLoop* server) override;
+
+  void TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) override;
+  void Accepted(common::libev::IoChild* child) override;
+  void Moved(common::libev::IoLoop* server, common::libev::IoChild* child) override;
+  void ChildStatusChanged(common::libev::IoChild* child, int status, int signal) override;
+
+  void DataReceived(common::libev::IoClient* client) override;
+  void DataReadyToWrite(common::libev::IoClient* client) override;
+
+  void PostLooped(common::libev::IoLoop* server) override;
+
+ protected:
+  // false if client closed
+  virtual bool ProcessReceived(AsyncHttpClient* hclient, const char* request, size_t req_len) = 0;
+
+ private:
+  // nullptr if client not created by http server, such clients are closed
+  static AsyncHttpClient* ToHttpClient(common::libev::IoClient* client);
+  static void CloseClient(common::libev::IoClient* client);
+  void ProcessPendingRequests(AsyncHttpClient* hclient);
+};
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
@@ -18,12 +18,20 @@ namespace fastocloud {
 namespace server {
 namespace base {
 
-IServerHandler::IServerHandler() : online_clients_(0) {}
+IServerHandler::IServerHandler() : online_clients_(0), request_latency_() {}
 
 size_t IServerHandler::GetOnlineClients() const {
   return online_clients_;
 }
 
+const LatencyHistogram& IServerHandler::GetRequestLatency() const {
+  return request_latency_;
+}
+
+void IServerHandler::ObserveRequestLatency(uint64_t usec) {
+  request_latency_.Observe(usec);
+}
+
 void IServerHandler::Accepted(common::libev::IoClient* client) {
   UNUSED(client);
   online_clients_++;
@@ -16,6 +16,8 @@
 
 #include <common/libev/io_loop_observer.h>
 
+#include "base/latency_histogram.h"
+
 namespace fastocloud {
 namespace server {
 namespace base {
@@ -26,6 +28,7 @@ class IServerHandler : public common::libev::IoLoopObserver {
   IServerHandler();
 
   size_t GetOnlineClients() const;
+  const LatencyHistogram& GetRequestLatency() const;
 
   void PreLooped(common::libev::IoLoop* server) override = 0;
 
@@ -42,8 +45,12 @@ class IServerHandler : public common::libev::IoLoopObserver {
 
   void PostLooped(common::libev::IoLoop* server) override = 0;
 
+ protected:
+  void ObserveRequestLatency(uint64_t usec);
+
  private:
   online_clients_t online_clients_;
+  LatencyHistogram request_latency_;
 };
 
 }  // namespace base
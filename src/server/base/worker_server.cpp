@@ -0,0 +1,190 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/worker_server.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <common/libev/event_io.h>
+
+namespace fastocloud {
+namespace server {
+namespace base {
+namespace {
+
+common::ErrnoError BindSocket(const common::net::HostAndPort& host, bool reuse_port, int* out) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  const std::string host_name = host.GetHost();
+  const std::string port = std::to_string(host.GetPort());
+  struct addrinfo* result = nullptr;
+  int res = getaddrinfo(host_name.empty() ? nullptr : host_name.c_str(), port.c_str(), &hints, &result);
+  if (res != 0) {
+    return common::make_errno_error(gai_strerror(res), EINVAL);
+  }
+
+  common::ErrnoError err = common::make_errno_error("Can't resolve host", EINVAL);
+  for (struct addrinfo* rp = result; rp; rp = rp->ai_next) {
+    int fd = socket(rp->ai_family, rp->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, rp->ai_protocol);
+    if (fd == INVALID_DESCRIPTOR) {
+      err = common::make_errno_error(errno);
+      continue;
+    }
+
+    const int on = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) == -1) {
+      err = common::make_errno_error(errno);
+      ::close(fd);
+      continue;
+    }
+#if defined(SO_REUSEPORT)
+    if (reuse_port && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == -1) {
+      err = common::make_errno_error(errno);
+      ::close(fd);
+      continue;
+    }
+#endif
+
+    if (bind(fd, rp->ai_addr, rp->ai_addrlen) == -1) {
+      err = common::make_errno_error(errno);
+      ::close(fd);
+      continue;
+    }
+
+    *out = fd;
+    err = common::ErrnoError();
+    break;
+  }
+  freeaddrinfo(result);
+  return err;
+}
+
+}  // namespace
+
+WorkerServer::WorkerServer(const common::net::HostAndPort& host, common::libev::IoLoopObserver* observer)
+    : base_class(new common::libev::LibEvLoop, observer),
+      host_(host),
+      listen_fd_(INVALID_DESCRIPTOR),
+      listen_io_(new common::libev::LibevIO) {
+  listen_io_->SetUserData(this);
+}
+
+WorkerServer::~WorkerServer() {
+  delete listen_io_;
+  if (listen_fd_ != INVALID_DESCRIPTOR) {
+    ::close(listen_fd_);
+  }
+}
+
+common::ErrnoError WorkerServer::CheckPortFree(const common::net::HostAndPort& host) {
+  // SO_REUSEPORT lets another instance bind the same port silently, plain bind fails if anyone holds it
+  int fd = INVALID_DESCRIPTOR;
+  common::ErrnoError err = BindSocket(host, false, &fd);
+  if (err) {
+    return err;
+  }
+
+  ::close(fd);
+  return common::ErrnoError();
+}
+
+common::ErrnoError WorkerServer::Bind() {
+  if (listen_fd_ != INVALID_DESCRIPTOR) {
+    return common::make_errno_error("Already bound", EINVAL);
+  }
+
+  return BindSocket(host_, true, &listen_fd_);
+}
+
+common::ErrnoError WorkerServer::Listen(int backlog) {
+  if (listen_fd_ == INVALID_DESCRIPTOR) {
+    return common::make_errno_error("Not bound", EINVAL);
+  }
+
+  if (listen(listen_fd_, backlog) == -1) {
+    return common::make_errno_error(errno);
+  }
+
+  return common::ErrnoError();
+}
+
+common::net::HostAndPort WorkerServer::GetHost() const {
+  return host_;
+}
+
+const char* WorkerServer::ClassName() const {
+  return "WorkerServer";
+}
+
+common::libev::IoChild* WorkerServer::CreateChild() {
+  NOTREACHED();
+  return nullptr;
+}
+
+void WorkerServer::Started(common::libev::LibEvLoop* loop) {
+  CHECK(listen_fd_ != INVALID_DESCRIPTOR) << "Must be bound before exec!";
+  // plain io watcher, listening socket never shows up in clients of handler
+  CHECK(listen_io_->Init(loop, listen_cb, listen_fd_, EV_READ)) << "Must be for accepting!";
+  CHECK(listen_io_->Start()) << "Must be for accepting!";
+  base_class::Started(loop);
+}
+
+void WorkerServer::Stopped(common::libev::LibEvLoop* loop) {
+  ignore_result(listen_io_->Stop());
+  base_class::Stopped(loop);
+}
+
+void WorkerServer::listen_cb(common::libev::LibEvLoop* loop,
+                             common::libev::LibevIO* io,
+                             common::libev::flags_t revents) {
+  UNUSED(loop);
+  UNUSED(revents);
+  WorkerServer* pthis = static_cast<WorkerServer*>(io->GetUserData());
+  pthis->AcceptClients();
+}
+
+void WorkerServer::AcceptClients() {
+  while (true) {
+    // clients must not block the loop, partial sends wait for write readiness
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd == INVALID_DESCRIPTOR) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        WARNING_LOG() << GetFormatedName() << " accept error: " << common::make_errno_error(errno)->GetDescription();
+      }
+      return;
+    }
+
+    common::libev::tcp::TcpClient* client = CreateClient(common::net::socket_info(fd));
+    if (!RegisterClient(client)) {
+      ignore_result(client->Close());
+      delete client;
+    }
+  }
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,63 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <common/libev/event_io.h>
+#include <common/libev/io_loop.h>
+#include <common/libev/tcp/tcp_client.h>
+#include <common/net/types.h>
+
+namespace fastocloud {
+namespace server {
+namespace base {
+
+// Io loop serving one endpoint together with other loops of the same endpoint.
+// Every loop owns listening socket bound with SO_REUSEPORT, kernel balances new connections between them.
+// Listening socket is watched by own io watcher, handlers see only accepted clients.
+class WorkerServer : public common::libev::IoLoop {
+ public:
+  typedef common::libev::IoLoop base_class;
+  WorkerServer(const common::net::HostAndPort& host, common::libev::IoLoopObserver* observer);
+  ~WorkerServer() override;
+
+  // fails if port already held by someone, even by socket with SO_REUSEPORT
+  static common::ErrnoError CheckPortFree(const common::net::HostAndPort& host) WARN_UNUSED_RESULT;
+
+  common::ErrnoError Bind() WARN_UNUSED_RESULT;
+  common::ErrnoError Listen(int backlog) WARN_UNUSED_RESULT;
+  common::net::HostAndPort GetHost() const;
+
+  const char* ClassName() const override;
+
+  common::libev::IoChild* CreateChild() override;
+  virtual common::libev::tcp::TcpClient* CreateClient(const common::net::socket_info& info) = 0;
+  void Started(common::libev::LibEvLoop* loop) override;
+  void Stopped(common::libev::LibEvLoop* loop) override;
+
+ private:
+  static void listen_cb(common::libev::LibEvLoop* loop, common::libev::LibevIO* io,
+                        common::libev::flags_t revents);
+  void AcceptClients();
+
+  const common::net::HostAndPort host_;
+  int listen_fd_;
+  common::libev::LibevIO* const listen_io_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkerServer);
+};
+
+}  // namespace base
+}  // namespace server
+}  // namespace fastocloud
@@ -14,6 +14,8 @@
 
 #include "server/child.h"
 
+#include <string>
+
 #include <common/time.h>
 
 #include "stream_commands/commands_factory.h"
@@ -22,10 +24,19 @@ namespace fastocloud {
 namespace server {
 
 Child::Child(common::libev::IoLoop* server)
-    : IoChild(server), client_(nullptr), request_id_(0), last_update_(common::time::current_utc_mstime()) {}
+    : IoChild(server),
+      client_(nullptr),
+      compact_framing_(false),
+      frame_reader_(),
+      request_id_(0),
+      start_time_(common::time::current_utc_mstime()) {}
 
 Child::~Child() {}
 
+fastotv::timestamp_t Child::GetStartTime() const {
+  return start_time_;
+}
+
 Child::client_t* Child::GetClient() const {
   return client_;
 }
@@ -34,12 +45,16 @@ void Child::SetClient(client_t* pipe) {
   client_ = pipe;
 }
 
-void Child::UpdateTimestamp() {
-  last_update_ = common::time::current_utc_mstime();
+bool Child::IsCompactFraming() const {
+  return compact_framing_;
 }
 
-fastotv::timestamp_t Child::GetLastUpdate() const {
-  return last_update_;
+void Child::SetCompactFraming(bool compact) {
+  compact_framing_ = compact;
+}
+
+CompactFrameReader* Child::GetFrameReader() {
+  return &frame_reader_;
 }
 
 common::ErrnoError Child::Stop() {
@@ -47,6 +62,10 @@ common::ErrnoError Child::Stop() {
     return common::make_errno_error_inval();
   }
 
+  if (compact_framing_) {
+    return WriteCompactFrame(client_, COMPACT_FRAME_STOP, std::string());
+  }
+
   fastotv::protocol::request_t req = StopStreamRequest(NextRequestID());
   return client_->WriteRequest(req);
 }
@@ -56,10 +75,40 @@ common::ErrnoError Child::Restart() {
     return common::make_errno_error_inval();
   }
 
+  if (compact_framing_) {
+    return WriteCompactFrame(client_, COMPACT_FRAME_RESTART, std::string());
+  }
+
   fastotv::protocol::request_t req = RestartStreamRequest(NextRequestID());
   return client_->WriteRequest(req);
 }
 
+common::ErrnoError Child::SendResolvedLink(const ResolvedLinkInfo& link) {
+  if (!client_) {
+    return common::make_errno_error_inval();
+  }
+
+  if (compact_framing_) {
+    std::string link_str;
+    common::Error err_ser = link.SerializeToString(&link_str);
+    if (err_ser) {
+      const std::string err_str = err_ser->GetDescription();
+      return common::make_errno_error(err_str, EAGAIN);
+    }
+
+    return WriteCompactFrame(client_, COMPACT_FRAME_RESOLVED_LINK, link_str);
+  }
+
+  fastotv::protocol::request_t req;
+  common::Error err_ser = ResolvedLinkStreamNotification(link, &req);
+  if (err_ser) {
+    const std::string err_str = err_ser->GetDescription();
+    return common::make_errno_error(err_str, EAGAIN);
+  }
+
+  return client_->WriteRequest(req);
+}
+
 fastotv::protocol::sequance_id_t Child::NextRequestID() {
   const fastotv::protocol::seq_id_t next_id = request_id_++;
   return common::protocols::json_rpc::MakeRequestID(next_id);
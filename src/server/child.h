@@ -21,6 +21,9 @@
 
 #include "base/types.h"
 
+#include "stream_commands/commands_info/resolved_link_info.h"
+#include "stream_commands/compact_frame.h"
+
 namespace fastocloud {
 namespace server {
 
@@ -32,13 +35,19 @@ class Child : public common::libev::IoChild {
 
   common::ErrnoError Stop() WARN_UNUSED_RESULT;
   common::ErrnoError Restart() WARN_UNUSED_RESULT;
+  common::ErrnoError SendResolvedLink(const ResolvedLinkInfo& link) WARN_UNUSED_RESULT;
 
   client_t* GetClient() const;
   void SetClient(client_t* pipe);
+
+  // compact frames instead of json rpc, agreed with stream at spawn
+  bool IsCompactFraming() const;
+  void SetCompactFraming(bool compact);
+  CompactFrameReader* GetFrameReader();
   virtual ~Child();
 
-  void UpdateTimestamp();
-  fastotv::timestamp_t GetLastUpdate() const;
+  // msec, cod ttl counts from here until first access
+  fastotv::timestamp_t GetStartTime() const;
 
  protected:
   explicit Child(common::libev::IoLoop* server);
@@ -47,9 +56,11 @@ class Child : public common::libev::IoChild {
 
  private:
   client_t* client_;
+  bool compact_framing_;
+  CompactFrameReader frame_reader_;
   std::atomic<fastotv::protocol::seq_id_t> request_id_;
 
-  fastotv::timestamp_t last_update_;
+  const fastotv::timestamp_t start_time_;
 };
 
 }  // namespace server
@@ -19,12 +19,43 @@
 namespace fastocloud {
 namespace server {
 
-ChildStream::ChildStream(common::libev::IoLoop* server, const StreamInfo& conf) : base_class(server), conf_(conf) {}
+ChildStream::ChildStream(common::libev::IoLoop* server, const StreamInfo& conf, StreamStatsBlock* stats_block)
+    : base_class(server),
+      conf_(conf),
+      stats_block_(stats_block, StreamStatsBlock::Destroy),
+      stats_sequence_(0) {}
+
+ChildStream::~ChildStream() {}
 
 fastotv::stream_id_t ChildStream::GetStreamID() const {
   return conf_.id;
 }
 
+const StreamInfo& ChildStream::GetStreamInfo() const {
+  return conf_;
+}
+
+bool ChildStream::ReadStatistic(StatisticInfo* statistic) {
+  if (!stats_block_ || !statistic) {
+    return false;
+  }
+
+  StreamStruct stats;
+  double cpu_load = 0;
+  size_t rss_bytes = 0;
+  fastotv::timestamp_t utc_time = 0;
+  if (!stats_block_->Read(conf_.id, &stats_sequence_, &stats, &cpu_load, &rss_bytes, &utc_time)) {
+    return false;
+  }
+
+  *statistic = StatisticInfo(stats, cpu_load, rss_bytes, utc_time);
+  return true;
+}
+
+ChildStream::stats_block_t ChildStream::GetStatsBlock() const {
+  return stats_block_;
+}
+
 void ChildStream::CleanUp() {
   if (conf_.type == fastotv::VOD_ENCODE || conf_.type == fastotv::VOD_RELAY || conf_.type == fastotv::CATCHUP ||
       conf_.type == fastotv::TIMESHIFT_RECORDER || conf_.type == fastotv::TEST_LIFE || conf_.type == fastotv::SCREEN) {
@@ -14,9 +14,14 @@
 
 #pragma once
 
+#include <memory>
+
 #include "server/child.h"
 
 #include "base/stream_info.h"
+#include "base/stream_stats_block.h"
+
+#include "stream_commands/commands_info/statistic_info.h"
 
 namespace fastocloud {
 namespace server {
@@ -24,13 +29,24 @@ namespace server {
 class ChildStream : public Child {
  public:
   typedef Child base_class;
-  ChildStream(common::libev::IoLoop* server, const StreamInfo& conf);
+  typedef std::shared_ptr<StreamStatsBlock> stats_block_t;
+  // takes ownership of stats_block (can be nullptr)
+  ChildStream(common::libev::IoLoop* server, const StreamInfo& conf, StreamStatsBlock* stats_block);
+  ~ChildStream() override;
 
   fastotv::stream_id_t GetStreamID() const override;
+  const StreamInfo& GetStreamInfo() const;
   void CleanUp();
 
+  // true if stream process published new statistic since last call
+  bool ReadStatistic(StatisticInfo* statistic);
+  // shared with readers outside of loop thread, block outlives the child while referenced
+  stats_block_t GetStatsBlock() const;
+
  private:
   const StreamInfo conf_;
+  const stats_block_t stats_block_;
+  uint64_t stats_sequence_;
   DISALLOW_COPY_AND_ASSIGN(ChildStream);
 };
 
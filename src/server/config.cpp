@@ -27,8 +27,12 @@
 #define SERVICE_HTTP_HOST_FIELD "http_host"
 #define SERVICE_VODS_HOST_FIELD "vods_host"
 #define SERVICE_CODS_HOST_FIELD "cods_host"
+#define SERVICE_METRICS_HOST_FIELD "metrics_host"
 #define SERVICE_CODS_TTL_FIELD "cods_ttl"
 #define SERVICE_FILES_TTL_FIELD "files_ttl"
+#define SERVICE_HTTP_WORKERS_FIELD "http_workers"
+#define SERVICE_VODS_WORKERS_FIELD "vods_workers"
+#define SERVICE_CODS_WORKERS_FIELD "cods_workers"
 #define SERVICE_STREAMLINK_PATH_FIELD "streamlink_path"
 #define SERVICE_LICENSE_KEY_FIELD "license_key"
 
@@ -76,6 +80,8 @@ common::ErrnoError ReadConfigFile(const std::string& path, common::HashValue** a
       options->Insert(pair.first, common::Value::CreateStringValueFromBasicString(pair.second));
     } else if (pair.first == SERVICE_CODS_HOST_FIELD) {
       options->Insert(pair.first, common::Value::CreateStringValueFromBasicString(pair.second));
+    } else if (pair.first == SERVICE_METRICS_HOST_FIELD) {
+      options->Insert(pair.first, common::Value::CreateStringValueFromBasicString(pair.second));
     } else if (pair.first == SERVICE_CODS_TTL_FIELD) {
       time_t ttl;
       if (common::ConvertFromString(pair.second, &ttl)) {
@@ -86,6 +92,12 @@ common::ErrnoError ReadConfigFile(const std::string& path, common::HashValue** a
       if (common::ConvertFromString(pair.second, &ttl)) {
         options->Insert(pair.first, common::Value::CreateTimeValue(ttl));
       }
+    } else if (pair.first == SERVICE_HTTP_WORKERS_FIELD || pair.first == SERVICE_VODS_WORKERS_FIELD ||
+               pair.first == SERVICE_CODS_WORKERS_FIELD) {
+      int workers;
+      if (common::ConvertFromString(pair.second, &workers)) {
+        options->Insert(pair.first, common::Value::CreateIntegerValue(workers));
+      }
     } else if (pair.first == SERVICE_STREAMLINK_PATH_FIELD) {
       options->Insert(pair.first, common::Value::CreateStringValueFromBasicString(pair.second));
     } else if (pair.first == SERVICE_LICENSE_KEY_FIELD) {
@@ -101,6 +113,16 @@ common::ErrnoError ReadConfigFile(const std::string& path, common::HashValue** a
 
 namespace fastocloud {
 namespace server {
+namespace {
+size_t ReadWorkersCount(common::HashValue* args, const char* field, size_t def) {
+  common::Value* workers_field = args->Find(field);
+  int workers;
+  if (!workers_field || !workers_field->GetAsInteger(&workers) || workers <= 0) {
+    return def;
+  }
+  return workers;
+}
+}  // namespace
 
 Config::Config()
     : host(GetDefaultHost()),
@@ -108,6 +130,9 @@ Config::Config()
       log_level(common::logging::LOG_LEVEL_INFO),
       cods_ttl(CODS_TTL),
       files_ttl(FILES_TTL),
+      http_workers(HTTP_WORKERS),
+      vods_workers(VODS_WORKERS),
+      cods_workers(CODS_WORKERS),
       streamlink_path(STREAMER_SERVICE_STREAMLINK_PATH),
       license_key() {}
 
@@ -184,6 +209,13 @@ common::ErrnoError load_config_from_file(const std::string& config_absolute_path
     lconfig.cods_host = common::net::HostAndPort::CreateLocalHostIPV4(CODS_PORT);
   }
 
+  common::Value* metrics_host_field = slave_config_args->Find(SERVICE_METRICS_HOST_FIELD);
+  std::string metrics_host_str;
+  if (!metrics_host_field || !metrics_host_field->GetAsBasicString(&metrics_host_str) ||
+      !common::ConvertFromString(metrics_host_str, &lconfig.metrics_host)) {
+    lconfig.metrics_host = common::net::HostAndPort::CreateLocalHostIPV4(METRICS_PORT);
+  }
+
   common::Value* cods_ttl_field = slave_config_args->Find(SERVICE_CODS_TTL_FIELD);
   if (!cods_ttl_field || !cods_ttl_field->GetAsTime(&lconfig.cods_ttl)) {
     lconfig.cods_ttl = CODS_TTL;
@@ -194,6 +226,10 @@ common::ErrnoError load_config_from_file(const std::string& config_absolute_path
     lconfig.files_ttl = FILES_TTL;
   }
 
+  lconfig.http_workers = ReadWorkersCount(slave_config_args, SERVICE_HTTP_WORKERS_FIELD, HTTP_WORKERS);
+  lconfig.vods_workers = ReadWorkersCount(slave_config_args, SERVICE_VODS_WORKERS_FIELD, VODS_WORKERS);
+  lconfig.cods_workers = ReadWorkersCount(slave_config_args, SERVICE_CODS_WORKERS_FIELD, CODS_WORKERS);
+
   common::Value* streamlink_field = slave_config_args->Find(SERVICE_STREAMLINK_PATH_FIELD);
   if (!streamlink_field || !streamlink_field->GetAsBasicString(&lconfig.streamlink_path)) {
     lconfig.streamlink_path = STREAMER_SERVICE_STREAMLINK_PATH;
@@ -39,8 +39,12 @@ struct Config {
   common::net::HostAndPort http_host;
   common::net::HostAndPort vods_host;
   common::net::HostAndPort cods_host;
+  common::net::HostAndPort metrics_host;  // prometheus scrape endpoint
   time_t cods_ttl;  // in seconds
   time_t files_ttl;
+  size_t http_workers;  // io loops per endpoint, each with own listening socket
+  size_t vods_workers;
+  size_t cods_workers;
   std::string streamlink_path;
   license_t license_key;
 };
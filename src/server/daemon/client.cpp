@@ -255,5 +255,15 @@ common::ErrnoError ProtocoledDaemonClient::SyncServiceSuccess(fastotv::protocol:
   return WriteResponse(resp);
 }
 
+common::ErrnoError ProtocoledDaemonClient::SubscribeStatisticServiceSuccess(fastotv::protocol::sequance_id_t id) {
+  fastotv::protocol::response_t resp;
+  common::Error err_ser = SubscribeStatisticServiceResponseSuccess(id, &resp);
+  if (err_ser) {
+    return common::make_errno_error(err_ser->GetDescription(), EAGAIN);
+  }
+
+  return WriteResponse(resp);
+}
+
 }  // namespace server
 }  // namespace fastocloud
@@ -69,6 +69,7 @@ class ProtocoledDaemonClient : public fastotv::protocol::ProtocolClient<common::
   common::ErrnoError StopStreamSuccess(fastotv::protocol::sequance_id_t id) WARN_UNUSED_RESULT;
 
   common::ErrnoError SyncServiceSuccess(fastotv::protocol::sequance_id_t id) WARN_UNUSED_RESULT;
+  common::ErrnoError SubscribeStatisticServiceSuccess(fastotv::protocol::sequance_id_t id) WARN_UNUSED_RESULT;
 };
 
 }  // namespace server
@@ -41,6 +41,7 @@
   "prepare_service"  // { "feedback_directory": "", "timeshifts_directory": "", "hls_directory": "",
                      // "playlists_directory": "", "dvb_directory": "", "capture_card_directory": "" }
 #define DAEMON_SYNC_SERVICE "sync_service"
+#define DAEMON_SUBSCRIBE_STATISTIC_SERVICE "subscribe_statistic_service"  // {"streams": [] } empty - all streams
 #define DAEMON_PING_SERVICE "ping_service"
 #define DAEMON_GET_LOG_SERVICE "get_log_service"  // {"path":"http://localhost/service/id"}
 
@@ -49,6 +50,7 @@
 // Broadcast
 #define STREAM_CHANGED_SOURCES_STREAM "changed_source_stream"
 #define STREAM_STATISTIC_STREAM "statistic_stream"
+#define STREAM_STATISTIC_STREAMS "statistic_streams"  // batch for subscribed clients [{...}, {...}]
 #define STREAM_QUIT_STATUS_STREAM "quit_status_stream"
 #if defined(MACHINE_LEARNING)
 #define STREAM_ML_NOTIFICATION_STREAM "ml_notification_stream"
@@ -61,6 +63,10 @@ namespace server {
 // Broadcast
 common::Error ChangedSourcesStreamBroadcast(const ChangedSouresInfo& params, fastotv::protocol::request_t* req);
 common::Error StatisitcStreamBroadcast(const StatisticInfo& params, fastotv::protocol::request_t* req);
+common::Error StatisitcStreamBroadcast(fastotv::protocol::serializet_params_t params,
+                                       fastotv::protocol::request_t* req);
+common::Error StatisitcStreamsBroadcast(fastotv::protocol::serializet_params_t params,
+                                        fastotv::protocol::request_t* req);
 #if defined(MACHINE_LEARNING)
 common::Error MlNotificationStreamBroadcast(const fastotv::commands_info::ml::NotificationInfo& params,
                                             fastotv::protocol::request_t* req);
@@ -151,6 +151,17 @@ common::Error SyncServiceResponseSuccess(fastotv::protocol::sequance_id_t id, fa
   return common::Error();
 }
 
+common::Error SubscribeStatisticServiceResponseSuccess(fastotv::protocol::sequance_id_t id,
+                                                       fastotv::protocol::response_t* resp) {
+  if (!resp) {
+    return common::make_error_inval();
+  }
+
+  *resp =
+      fastotv::protocol::response_t::MakeMessage(id, common::protocols::json_rpc::JsonRPCMessage::MakeSuccessMessage());
+  return common::Error();
+}
+
 common::Error StartStreamResponseSuccess(fastotv::protocol::sequance_id_t id, fastotv::protocol::response_t* resp) {
   if (!resp) {
     return common::make_error_inval();
@@ -58,6 +58,8 @@ common::Error PrepareServiceResponse(fastotv::protocol::sequance_id_t id,
                                      fastotv::protocol::response_t* resp);  // Directories
 
 common::Error SyncServiceResponseSuccess(fastotv::protocol::sequance_id_t id, fastotv::protocol::response_t* resp);
+common::Error SubscribeStatisticServiceResponseSuccess(fastotv::protocol::sequance_id_t id,
+                                                       fastotv::protocol::response_t* resp);
 
 common::Error PingServiceResponse(fastotv::protocol::sequance_id_t id,
                                   const common::daemon::commands::ServerPingInfo& ping,
@@ -0,0 +1,61 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/daemon/commands_info/service/statistic_subscribe_info.h"
+
+#define STATISTIC_SUBSCRIBE_INFO_STREAMS_FIELD "streams"
+
+namespace fastocloud {
+namespace server {
+namespace service {
+
+StatisticSubscribeInfo::StatisticSubscribeInfo() : base_class(), streams_() {}
+
+StatisticSubscribeInfo::StatisticSubscribeInfo(const streams_t& streams) : base_class(), streams_(streams) {}
+
+StatisticSubscribeInfo::streams_t StatisticSubscribeInfo::GetStreams() const {
+  return streams_;
+}
+
+common::Error StatisticSubscribeInfo::SerializeFields(json_object* out) const {
+  json_object* jstreams = json_object_new_array();
+  for (const fastotv::stream_id_t& sid : streams_) {
+    json_object_array_add(jstreams, json_object_new_string(sid.c_str()));
+  }
+  ignore_result(SetArrayField(out, STATISTIC_SUBSCRIBE_INFO_STREAMS_FIELD, jstreams));
+  return common::Error();
+}
+
+common::Error StatisticSubscribeInfo::DoDeSerialize(json_object* serialized) {
+  json_object* jstreams;
+  size_t len;
+  common::Error err = GetArrayField(serialized, STATISTIC_SUBSCRIBE_INFO_STREAMS_FIELD, &jstreams, &len);
+  streams_t streams;
+  if (!err) {
+    for (size_t i = 0; i < len; ++i) {
+      json_object* jsid = json_object_array_get_idx(jstreams, i);
+      const char* sid = json_object_get_string(jsid);
+      if (sid) {
+        streams.push_back(sid);
+      }
+    }
+  }
+
+  *this = StatisticSubscribeInfo(streams);
+  return common::Error();
+}
+
+}  // namespace service
+}  // namespace server
+}  // namespace fastocloud
@@ -61,6 +61,17 @@ const size_t kMaxSizeLogFile = 10 * 1024 * 1024;  // 10 MB
 }  // namespace
 
 int main(int argc, char** argv, char** envp) {
+#if defined(OS_LINUX)
+  if (argc == 4 && strcmp(argv[1], DVB_TUNER_ARG) == 0) {  // executed by daemon, not for users
+    fastocloud::server::Config config;
+    common::ErrnoError err = fastocloud::server::load_config_from_file(CONFIG_PATH, &config);
+    if (!err) {
+      common::logging::INIT_LOGGER(STREAMER_SERVICE_NAME, config.log_path, config.log_level, kMaxSizeLogFile);
+    }
+    return fastocloud::server::ProcessSlaveWrapper::ExecDvbTuner(argv[2], argv[3]);
+  }
+#endif
+
   bool run_as_daemon = false;
   for (int i = 1; i < argc; ++i) {
     if (strcmp(argv[i], "--version") == 0) {
@@ -0,0 +1,159 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/dvb_tuner_manager.h"
+
+#include <algorithm>
+
+#include <common/sprintf.h>
+#include <common/string_split.h>
+
+#define DVB_SCHEME "dvb"
+#define FEED_URL_2U "udp://239.255.250.%lu:%lu"
+
+namespace fastocloud {
+namespace server {
+
+DvbTunerManager::DvbTunerManager(start_tuner_t start, stop_tuner_t stop)
+    : start_(start), stop_(stop), tuners_(), used_slots_(max_tuners, false) {}
+
+DvbTunerManager::~DvbTunerManager() {
+  StopAll();
+}
+
+bool DvbTunerManager::IsTunerSource(const common::uri::GURL& source) {
+  return source.is_valid() && source.SchemeIs(DVB_SCHEME);
+}
+
+std::string DvbTunerManager::MakeTunerKey(const common::uri::GURL& source) {
+  std::vector<std::string> params =
+      common::SplitString(source.query(), "&", common::TRIM_WHITESPACE, common::SPLIT_WANT_NONEMPTY);
+  std::sort(params.begin(), params.end());
+  std::string key = source.host();
+  for (const std::string& param : params) {
+    key += "&" + param;
+  }
+  return key;
+}
+
+common::uri::GURL DvbTunerManager::MakeFeedUrl(size_t slot) {
+  const size_t port = feed_base_port + slot;
+  return common::uri::GURL(common::MemSPrintf(FEED_URL_2U, slot + 1, port));
+}
+
+common::ErrnoError DvbTunerManager::Acquire(fastotv::stream_id_t sid,
+                                            const common::uri::GURL& source,
+                                            common::uri::GURL* feed) {
+  if (!IsTunerSource(source) || !feed) {
+    return common::make_errno_error_inval();
+  }
+
+  const std::string key = MakeTunerKey(source);
+  auto it = tuners_.find(key);
+  if (it != tuners_.end()) {
+    it->second.users.insert(sid);
+    *feed = MakeFeedUrl(it->second.slot);
+    return common::ErrnoError();
+  }
+
+  size_t slot;
+  if (!AllocateSlot(&slot)) {
+    return common::make_errno_error("No free dvb feeds", EBUSY);
+  }
+
+  const common::uri::GURL feed_url = MakeFeedUrl(slot);
+  pid_t pid = -1;
+  common::ErrnoError err = start_(source, feed_url, &pid);
+  if (err) {
+    used_slots_[slot] = false;
+    return err;
+  }
+
+  Tuner tuner = {source, slot, pid, {sid}};
+  tuners_[key] = tuner;
+  *feed = feed_url;
+  return common::ErrnoError();
+}
+
+void DvbTunerManager::Release(fastotv::stream_id_t sid) {
+  for (auto it = tuners_.begin(); it != tuners_.end();) {
+    Tuner& tuner = it->second;
+    tuner.users.erase(sid);
+    if (!tuner.users.empty()) {
+      ++it;
+      continue;
+    }
+
+    if (tuner.pid > 0) {
+      stop_(tuner.pid);
+    }
+    used_slots_[tuner.slot] = false;
+    it = tuners_.erase(it);
+  }
+}
+
+void DvbTunerManager::TunerExited(pid_t pid) {
+  for (auto& it : tuners_) {
+    if (it.second.pid == pid) {
+      it.second.pid = -1;
+      return;
+    }
+  }
+}
+
+void DvbTunerManager::CheckTuners() {
+  for (auto& it : tuners_) {
+    Tuner& tuner = it.second;
+    if (tuner.pid > 0) {
+      continue;
+    }
+
+    pid_t pid = -1;
+    common::ErrnoError err = start_(tuner.source, MakeFeedUrl(tuner.slot), &pid);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+      tuner.pid = -1;
+      continue;
+    }
+    tuner.pid = pid;
+  }
+}
+
+void DvbTunerManager::StopAll() {
+  for (const auto& it : tuners_) {
+    if (it.second.pid > 0) {
+      stop_(it.second.pid);
+    }
+  }
+  tuners_.clear();
+  std::fill(used_slots_.begin(), used_slots_.end(), false);
+}
+
+size_t DvbTunerManager::GetTunersCount() const {
+  return tuners_.size();
+}
+
+bool DvbTunerManager::AllocateSlot(size_t* slot) {
+  for (size_t i = 0; i < used_slots_.size(); ++i) {
+    if (!used_slots_[i]) {
+      used_slots_[i] = true;
+      *slot = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace server
+}  // namespace fastocloud
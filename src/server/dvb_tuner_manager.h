@@ -0,0 +1,82 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <functional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <common/error.h>
+#include <common/uri/gurl.h>
+
+#include <fastotv/types.h>
+
+namespace fastocloud {
+namespace server {
+
+// One tuner process per dvb frequency on node, streams with same tuning parameters share it.
+// Tuner sends whole multiplex to host local multicast group (feed), each stream reads feed instead of dvb source
+// and picks own program by program number, tuner stopped when last stream released it.
+// Owner reports reaped tuner processes, so pid of exited tuner is never signaled again (may be reused).
+// Loop thread only.
+class DvbTunerManager {
+ public:
+  enum { feed_base_port = 28000, max_tuners = 254 };
+  typedef std::function<common::ErrnoError(const common::uri::GURL& source, const common::uri::GURL& feed, pid_t* pid)>
+      start_tuner_t;
+  typedef std::function<void(pid_t pid)> stop_tuner_t;
+
+  DvbTunerManager(start_tuner_t start, stop_tuner_t stop);
+  ~DvbTunerManager();
+
+  static bool IsTunerSource(const common::uri::GURL& source);
+  // same frequency and modulation parameters in any order give same key
+  static std::string MakeTunerKey(const common::uri::GURL& source);
+  static common::uri::GURL MakeFeedUrl(size_t slot);
+
+  common::ErrnoError Acquire(fastotv::stream_id_t sid, const common::uri::GURL& source, common::uri::GURL* feed)
+      WARN_UNUSED_RESULT;
+  void Release(fastotv::stream_id_t sid);  // all tuners of stream
+
+  void TunerExited(pid_t pid);  // tuner process reaped
+  void CheckTuners();           // start again exited tuners which still have users
+  void StopAll();
+
+  size_t GetTunersCount() const;
+
+ private:
+  struct Tuner {
+    common::uri::GURL source;
+    size_t slot;
+    pid_t pid;  // -1 if not running
+    std::set<fastotv::stream_id_t> users;
+  };
+
+  bool AllocateSlot(size_t* slot);
+
+  const start_tuner_t start_;
+  const stop_tuner_t stop_;
+  std::unordered_map<std::string, Tuner> tuners_;
+  std::vector<bool> used_slots_;
+
+  DISALLOW_COPY_AND_ASSIGN(DvbTunerManager);
+};
+
+}  // namespace server
+}  // namespace fastocloud
@@ -14,14 +14,14 @@
 
 #pragma once
 
-#include <common/libev/http/http_client.h>
+#include "server/base/async_http_client.h"
 
 namespace fastocloud {
 namespace server {
 
-class HttpClient : public common::libev::http::HttpClient {
+class HttpClient : public base::AsyncHttpClient {
  public:
-  typedef common::libev::http::HttpClient base_class;
+  typedef base::AsyncHttpClient base_class;
 
   HttpClient(common::libev::IoLoop* server, const common::net::socket_info& info);
 
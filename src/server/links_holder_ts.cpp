@@ -12,36 +12,77 @@
     along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <map>
-
 #include "server/links_holder_ts.h"
 
+#include <string>
+#include <utility>
+
+#include <common/time.h>
+
 namespace fastocloud {
 namespace server {
 
-StreamConfig LinksHolderTS::Find(const common::file_system::ascii_directory_string_path& path) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  auto it = links_.find(path);
-  if (it == links_.end()) {
+namespace {
+void InsertLink(LinksHolderTS::links_t* links, const std::string& path, StreamConfig config) {
+  auto it = links->find(path);
+  if (it != links->end()) {
+    it->second.config = config;
+    return;
+  }
+
+  LinksHolderTS::Link link = {config,
+                              std::make_shared<LinksHolderTS::access_time_t>(common::time::current_utc_mstime())};
+  links->insert(std::make_pair(path, link));
+}
+}  // namespace
+
+LinksHolderTS::LinksHolderTS() : write_mutex_(), links_(std::make_shared<links_t>()) {}
+
+StreamConfig LinksHolderTS::Find(const path_t& path) const {
+  const snapshot_t links = GetSnapshot();
+  auto it = links->find(path.GetPath());
+  if (it == links->end()) {
+    return StreamConfig();
+  }
+
+  return it->second.config;
+}
+
+StreamConfig LinksHolderTS::FindAndTouch(const path_t& path) const {
+  const snapshot_t links = GetSnapshot();
+  auto it = links->find(path.GetPath());
+  if (it == links->end()) {
     return StreamConfig();
   }
 
-  return it->second;
+  it->second.last_access->store(common::time::current_utc_mstime(), std::memory_order_relaxed);
+  return it->second.config;
 }
 
-void LinksHolderTS::Insert(const common::file_system::ascii_directory_string_path& path, StreamConfig config) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  links_[path] = config;
+LinksHolderTS::snapshot_t LinksHolderTS::GetSnapshot() const {
+  return std::atomic_load(&links_);
+}
+
+void LinksHolderTS::Insert(const configs_t& configs) {
+  if (configs.empty()) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(write_mutex_);
+  std::shared_ptr<links_t> copy = std::make_shared<links_t>(*GetSnapshot());
+  for (auto it = configs.begin(); it != configs.end(); ++it) {
+    InsertLink(copy.get(), it->first, it->second);
+  }
+  Publish(copy);
 }
 
 void LinksHolderTS::Clear() {
-  std::unique_lock<std::mutex> lock(mutex_);
-  links_.clear();
+  std::unique_lock<std::mutex> lock(write_mutex_);
+  Publish(std::make_shared<links_t>());
 }
 
-std::map<common::file_system::ascii_directory_string_path, StreamConfig> LinksHolderTS::Copy() {
-  std::unique_lock<std::mutex> lock(mutex_);
-  return links_;
+void LinksHolderTS::Publish(snapshot_t links) {
+  std::atomic_store(&links_, links);
 }
 
 }  // namespace server
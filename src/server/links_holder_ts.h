@@ -14,25 +14,50 @@
 
 #pragma once
 
-#include <map>
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include "base/stream_config.h"
 
 namespace fastocloud {
 namespace server {
 
+// Read mostly holder: lookups take a snapshot of immutable map and search it without holding any lock,
+// so http workers don't wait for writers or each other while searching.
+// Snapshot itself is taken with std::atomic_load on shared_ptr, which is not lock-free (libstdc++ uses a pool of
+// internal mutexes), they are held only for pointer copy and reference count update.
+// Writers copy the whole map, so links are published in batches (service sync), never per link.
 class LinksHolderTS {
  public:
-  StreamConfig Find(const common::file_system::ascii_directory_string_path& path);
-  void Insert(const common::file_system::ascii_directory_string_path& path, StreamConfig config);
-  void Clear();
+  typedef common::file_system::ascii_directory_string_path path_t;
+  typedef std::atomic<fastotv::timestamp_t> access_time_t;
+  struct Link {
+    StreamConfig config;
+    std::shared_ptr<access_time_t> last_access;  // msec, preserved across snapshots
+  };
+  typedef std::unordered_map<std::string, StreamConfig> configs_t;  // keyed by directory path
+  typedef std::unordered_map<std::string, Link> links_t;            // keyed by directory path
+  typedef std::shared_ptr<const links_t> snapshot_t;
+
+  LinksHolderTS();
 
-  std::map<common::file_system::ascii_directory_string_path, StreamConfig> Copy();
+  StreamConfig Find(const path_t& path) const;
+  // find and store access time of link
+  StreamConfig FindAndTouch(const path_t& path) const;
+  snapshot_t GetSnapshot() const;
+
+  // publishes all links at once
+  void Insert(const configs_t& configs);
+  void Clear();
 
  private:
-  std::mutex mutex_;
-  std::map<common::file_system::ascii_directory_string_path, StreamConfig> links_;
+  void Publish(snapshot_t links);
+
+  std::mutex write_mutex_;
+  snapshot_t links_;  // accessed only via std::atomic_load/std::atomic_store
 };
 
 }  // namespace server
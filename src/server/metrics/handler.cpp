@@ -0,0 +1,95 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/metrics/handler.h"
+
+#include <memory>
+#include <string>
+
+#include "server/base/async_http_client.h"
+#include "server/metrics/registry.h"
+
+#define METRICS_PATH "/metrics"
+#define METRICS_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+namespace fastocloud {
+namespace server {
+
+MetricsHandler::MetricsHandler(const MetricsRegistry* registry) : base_class(), registry_(registry) {}
+
+bool MetricsHandler::ProcessReceived(base::AsyncHttpClient* hclient, const char* request, size_t req_len) {
+  static const common::libev::http::HttpServerInfo hinf(PROJECT_NAME_TITLE, PROJECT_DOMAIN);
+  common::http::HttpRequest hrequest;
+  std::pair<common::http::http_status, common::Error> result =
+      common::http::parse_http_request(std::string(request, req_len), &hrequest);
+  if (result.second) {
+    DEBUG_MSG_ERROR(result.second, common::logging::LOG_LEVEL_ERR);
+    ignore_result(hclient->Close());
+    delete hclient;
+    return false;
+  }
+
+  const common::http::http_protocol protocol = hrequest.GetProtocol();
+  common::http::header_t connection_field;
+  bool IsKeepAlive = protocol == common::http::HP_1_1;
+  if (hrequest.FindHeaderByKey("Connection", false, &connection_field)) {
+    IsKeepAlive = protocol == common::http::HP_1_1 ? !common::EqualsASCII(connection_field.value, "close", false)
+                                                   : common::EqualsASCII(connection_field.value, "Keep-Alive", false);
+  }
+
+  const auto url = hrequest.GetURL();
+  const bool is_get = hrequest.GetMethod() == common::http::http_method::HM_GET;
+  if (!is_get && hrequest.GetMethod() != common::http::http_method::HM_HEAD) {
+    common::ErrnoError err =
+        hclient->SendError(protocol, common::http::HS_NOT_ALLOWED, {}, "Method not allowed.", IsKeepAlive, hinf);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    }
+  } else if (!url.is_valid() || url.PathForRequest() != METRICS_PATH) {
+    common::ErrnoError err =
+        hclient->SendError(protocol, common::http::HS_NOT_FOUND, {}, "Not found.", IsKeepAlive, hinf);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    }
+  } else {
+    std::shared_ptr<std::string> body = std::make_shared<std::string>();
+    registry_->Render(body.get());
+    off_t content_length = body->size();
+    common::ErrnoError err = hclient->SendHeaders(protocol, common::http::HS_OK, {}, METRICS_CONTENT_TYPE,
+                                                  &content_length, nullptr, IsKeepAlive, hinf);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    } else if (is_get) {
+      err = hclient->StartSendData(body, 0, content_length);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      }
+    }
+  }
+
+  if (hclient->IsSending()) {  // released from DataReadyToWrite
+    hclient->SetCloseAfterSend(!IsKeepAlive);
+    return true;
+  }
+
+  if (!IsKeepAlive) {
+    ignore_result(hclient->Close());
+    delete hclient;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace server
+}  // namespace fastocloud
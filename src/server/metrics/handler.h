@@ -0,0 +1,38 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "server/base/http_server_handler.h"
+
+namespace fastocloud {
+namespace server {
+
+class MetricsRegistry;
+
+// Serves GET /metrics for prometheus scrapers on its own listener, runs with HttpServer workers.
+class MetricsHandler : public base::HttpServerHandler {
+ public:
+  typedef base::HttpServerHandler base_class;
+  explicit MetricsHandler(const MetricsRegistry* registry);
+
+ protected:
+  bool ProcessReceived(base::AsyncHttpClient* hclient, const char* request, size_t req_len) override;
+
+ private:
+  const MetricsRegistry* const registry_;
+};
+
+}  // namespace server
+}  // namespace fastocloud
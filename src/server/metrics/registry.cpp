@@ -0,0 +1,261 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/metrics/registry.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <utility>
+
+#include "server/base/iserver_handler.h"
+#include "server/retention_worker.h"
+
+namespace fastocloud {
+namespace server {
+
+namespace {
+void AppendHeader(const char* name, const char* type, const char* help, std::string* out) {
+  *out += "# HELP ";
+  *out += name;
+  *out += " ";
+  *out += help;
+  *out += "\n# TYPE ";
+  *out += name;
+  *out += " ";
+  *out += type;
+  *out += "\n";
+}
+
+void AppendSample(const char* name, const std::string& labels, uint64_t value, std::string* out) {
+  char buff[32];
+  snprintf(buff, sizeof(buff), " %" PRIu64 "\n", value);
+  *out += name;
+  if (!labels.empty()) {
+    *out += "{" + labels + "}";
+  }
+  *out += buff;
+}
+
+void AppendSample(const char* name, const std::string& labels, double value, std::string* out) {
+  char buff[32];
+  snprintf(buff, sizeof(buff), " %g\n", value);
+  *out += name;
+  if (!labels.empty()) {
+    *out += "{" + labels + "}";
+  }
+  *out += buff;
+}
+
+struct StreamSample {
+  std::string labels;
+  StreamStruct stats;
+  double cpu_load;
+  size_t rss_bytes;
+  bool truncated;
+};
+}  // namespace
+
+MetricsRegistry::MetricsRegistry()
+    : servers_(),
+      retention_(nullptr),
+      zygote_spawn_latency_(),
+      write_mutex_(),
+      streams_(std::make_shared<streams_t>()) {}
+
+void MetricsRegistry::AddServer(const std::string& endpoint, const base::IServerHandler* handler) {
+  servers_.push_back(std::make_pair(endpoint, handler));
+}
+
+void MetricsRegistry::SetRetention(const RetentionWorker* retention) {
+  retention_ = retention;
+}
+
+void MetricsRegistry::AddStream(const fastotv::stream_id_t& sid, stats_block_t block) {
+  if (!block) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  std::shared_ptr<streams_t> copy = std::make_shared<streams_t>(*std::atomic_load(&streams_));
+  (*copy)[sid] = block;
+  std::atomic_store(&streams_, snapshot_t(copy));
+}
+
+void MetricsRegistry::RemoveStream(const fastotv::stream_id_t& sid) {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  const snapshot_t current = std::atomic_load(&streams_);
+  if (current->find(sid) == current->end()) {
+    return;
+  }
+
+  std::shared_ptr<streams_t> copy = std::make_shared<streams_t>(*current);
+  copy->erase(sid);
+  std::atomic_store(&streams_, snapshot_t(copy));
+}
+
+void MetricsRegistry::ObserveZygoteSpawn(fastotv::timestamp_t msec) {
+  zygote_spawn_latency_.Observe(msec * 1000);
+}
+
+void MetricsRegistry::Render(std::string* out) const {
+  if (!out) {
+    return;
+  }
+
+  RenderServers(out);
+  RenderRetention(out);
+  RenderZygote(out);
+  RenderStreams(out);
+}
+
+std::string MetricsRegistry::EscapeLabel(const std::string& value) {
+  std::string result;
+  result.reserve(value.size());
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      result += '\\';
+      result += c;
+    } else if (c == '\n') {
+      result += "\\n";
+    } else {
+      result += c;
+    }
+  }
+  return result;
+}
+
+void MetricsRegistry::RenderServers(std::string* out) const {
+  AppendHeader("fastocloud_http_online_clients", "gauge", "Connected clients per http endpoint.", out);
+  for (const auto& server : servers_) {
+    AppendSample("fastocloud_http_online_clients", "endpoint=\"" + server.first + "\"",
+                 static_cast<uint64_t>(server.second->GetOnlineClients()), out);
+  }
+
+  AppendHeader("fastocloud_http_request_duration_seconds", "histogram",
+               "Time spent to process http request on worker loop.", out);
+  for (const auto& server : servers_) {
+    server.second->GetRequestLatency().Render("fastocloud_http_request_duration_seconds",
+                                              "endpoint=\"" + server.first + "\"", out);
+  }
+}
+
+void MetricsRegistry::RenderRetention(std::string* out) const {
+  if (!retention_) {
+    return;
+  }
+
+  const RetentionWorker::Stats stats = retention_->GetStats();
+  AppendHeader("fastocloud_retention_removed_files_total", "counter", "Expired chunks removed.", out);
+  AppendSample("fastocloud_retention_removed_files_total", std::string(), stats.files_removed, out);
+  AppendHeader("fastocloud_retention_removed_bytes_total", "counter", "Bytes of expired chunks removed.", out);
+  AppendSample("fastocloud_retention_removed_bytes_total", std::string(), stats.bytes_removed, out);
+  AppendHeader("fastocloud_retention_queued_files", "gauge", "Chunks waiting for expiration.", out);
+  AppendSample("fastocloud_retention_queued_files", std::string(), stats.files_queued, out);
+  AppendHeader("fastocloud_retention_last_scan_timestamp_seconds", "gauge", "Time of last folders scan.", out);
+  AppendSample("fastocloud_retention_last_scan_timestamp_seconds", std::string(), stats.last_scan_msec / 1000.0, out);
+}
+
+void MetricsRegistry::RenderZygote(std::string* out) const {
+  AppendHeader("fastocloud_zygote_spawn_duration_seconds", "histogram",
+               "Time from stream spawn request to zygote reply.", out);
+  zygote_spawn_latency_.Render("fastocloud_zygote_spawn_duration_seconds", std::string(), out);
+}
+
+void MetricsRegistry::RenderStreams(std::string* out) const {
+  const snapshot_t streams = std::atomic_load(&streams_);
+  std::vector<StreamSample> samples;
+  samples.reserve(streams->size());
+  for (const auto& stream : *streams) {
+    StreamSample sample;
+    uint64_t sequence = 0;  // any published state
+    fastotv::timestamp_t utc_time = 0;
+    if (!stream.second->Read(stream.first, &sequence, &sample.stats, &sample.cpu_load, &sample.rss_bytes, &utc_time)) {
+      continue;
+    }
+    sample.labels = "id=\"" + EscapeLabel(stream.first) + "\"";
+    sample.truncated = stream.second->IsTruncated();
+    samples.push_back(sample);
+  }
+
+  // samples of one metric should be grouped together
+  AppendHeader("fastocloud_stream_status", "gauge", "Stream status code.", out);
+  for (const auto& sample : samples) {
+    AppendSample("fastocloud_stream_status", sample.labels, static_cast<uint64_t>(sample.stats.status), out);
+  }
+  AppendHeader("fastocloud_stream_restarts_total", "counter", "Stream pipeline restarts.", out);
+  for (const auto& sample : samples) {
+    AppendSample("fastocloud_stream_restarts_total", sample.labels, static_cast<uint64_t>(sample.stats.restarts), out);
+  }
+  AppendHeader("fastocloud_stream_idle_seconds", "gauge", "Time since stream received data.", out);
+  for (const auto& sample : samples) {
+    AppendSample("fastocloud_stream_idle_seconds", sample.labels, sample.stats.idle_time / 1000.0, out);
+  }
+  AppendHeader("fastocloud_stream_cpu_load", "gauge", "Stream process cpu load.", out);
+  for (const auto& sample : samples) {
+    AppendSample("fastocloud_stream_cpu_load", sample.labels, sample.cpu_load, out);
+  }
+  AppendHeader("fastocloud_stream_rss_bytes", "gauge", "Stream process resident memory.", out);
+  for (const auto& sample : samples) {
+    AppendSample("fastocloud_stream_rss_bytes", sample.labels, static_cast<uint64_t>(sample.rss_bytes), out);
+  }
+
+  AppendHeader("fastocloud_stream_channels_truncated", "gauge",
+               "1 if stream has more channels than its statistic block, extra channels are not reported.", out);
+  for (const auto& sample : samples) {
+    AppendSample("fastocloud_stream_channels_truncated", sample.labels, static_cast<uint64_t>(sample.truncated), out);
+  }
+
+  AppendHeader("fastocloud_stream_latency_seconds", "histogram",
+               "Age of buffers per pipeline stage, output stage is end to end latency.", out);
+  for (const auto& sample : samples) {
+    for (size_t i = 0; i < sample.stats.latency.size(); ++i) {
+      const std::string labels =
+          sample.labels + ",stage=\"" + LatencyStats::GetStageName(static_cast<LatencyStage>(i)) + "\"";
+      sample.stats.latency[i].Render("fastocloud_stream_latency_seconds", labels, out);
+    }
+  }
+
+  AppendHeader("fastocloud_stream_input_bytes_total", "counter", "Bytes received per input channel.", out);
+  for (const auto& sample : samples) {
+    for (const ChannelStats& input : sample.stats.input) {
+      const std::string labels = sample.labels + ",channel=\"" + std::to_string(input.GetID()) + "\"";
+      AppendSample("fastocloud_stream_input_bytes_total", labels, static_cast<uint64_t>(input.GetTotalBytes()), out);
+    }
+  }
+  AppendHeader("fastocloud_stream_input_bytes_per_second", "gauge", "Bitrate per input channel.", out);
+  for (const auto& sample : samples) {
+    for (const ChannelStats& input : sample.stats.input) {
+      const std::string labels = sample.labels + ",channel=\"" + std::to_string(input.GetID()) + "\"";
+      AppendSample("fastocloud_stream_input_bytes_per_second", labels, static_cast<uint64_t>(input.GetBps()), out);
+    }
+  }
+  AppendHeader("fastocloud_stream_output_bytes_total", "counter", "Bytes sent per output channel.", out);
+  for (const auto& sample : samples) {
+    for (const ChannelStats& output : sample.stats.output) {
+      const std::string labels = sample.labels + ",channel=\"" + std::to_string(output.GetID()) + "\"";
+      AppendSample("fastocloud_stream_output_bytes_total", labels, static_cast<uint64_t>(output.GetTotalBytes()), out);
+    }
+  }
+  AppendHeader("fastocloud_stream_output_bytes_per_second", "gauge", "Bitrate per output channel.", out);
+  for (const auto& sample : samples) {
+    for (const ChannelStats& output : sample.stats.output) {
+      const std::string labels = sample.labels + ",channel=\"" + std::to_string(output.GetID()) + "\"";
+      AppendSample("fastocloud_stream_output_bytes_per_second", labels, static_cast<uint64_t>(output.GetBps()), out);
+    }
+  }
+}
+
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,80 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <common/macros.h>
+
+#include "base/stream_stats_block.h"
+
+#include "base/latency_histogram.h"
+
+namespace fastocloud {
+namespace server {
+
+class RetentionWorker;
+namespace base {
+class IServerHandler;
+}
+
+// Source of prometheus text exposition (format 0.0.4) for scrapes served off the daemon loop.
+// Streams are kept as immutable snapshot of shared statistic blocks: loop thread publishes changes,
+// scrape reads blocks lock free under their seqlock, so scrapes never touch child processes or json.
+class MetricsRegistry {
+ public:
+  typedef std::shared_ptr<StreamStatsBlock> stats_block_t;
+  typedef std::unordered_map<fastotv::stream_id_t, stats_block_t> streams_t;
+  typedef std::shared_ptr<const streams_t> snapshot_t;
+
+  MetricsRegistry();
+
+  // endpoint label, handler not owned and should outlive registry
+  void AddServer(const std::string& endpoint, const base::IServerHandler* handler);
+  void SetRetention(const RetentionWorker* retention);
+
+  void AddStream(const fastotv::stream_id_t& sid, stats_block_t block);
+  void RemoveStream(const fastotv::stream_id_t& sid);
+
+  // time from zygote spawn request to reply with pid
+  void ObserveZygoteSpawn(fastotv::timestamp_t msec);
+
+  // thread safe
+  void Render(std::string* out) const;
+
+  static std::string EscapeLabel(const std::string& value);
+
+ private:
+  void RenderServers(std::string* out) const;
+  void RenderRetention(std::string* out) const;
+  void RenderZygote(std::string* out) const;
+  void RenderStreams(std::string* out) const;
+
+  std::vector<std::pair<std::string, const base::IServerHandler*>> servers_;  // set before workers started
+  const RetentionWorker* retention_;
+  LatencyHistogram zygote_spawn_latency_;
+
+  std::mutex write_mutex_;
+  snapshot_t streams_;  // accessed only via std::atomic_load/std::atomic_store
+
+  DISALLOW_COPY_AND_ASSIGN(MetricsRegistry);
+};
+
+}  // namespace server
+}  // namespace fastocloud
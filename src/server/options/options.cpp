@@ -276,6 +276,10 @@ Validity validate_audio_select(const common::Value* value) {
   return Validity::VALID;
 }
 
+Validity validate_input_failover(const common::Value* value) {
+  return validate_range(value, 100, 10000, false);
+}
+
 Validity validate_mfxh264_preset(const common::Value* value) {
   return validate_range(value, 0, 7, false);
 }
@@ -448,6 +452,9 @@ bool FindOption(const std::string& key, option_t* opt) {
     {DATA_DIR_FIELD, validate_data_dir},
     {LOG_LEVEL_FIELD, validate_log_level},
     {STREAM_LINK_PATH_FIELD, dont_validate},
+    {STREAM_LINK_RESOLVED_FIELD, dont_validate},
+    {DVB_TUNER_FEEDS_FIELD, dont_validate},
+    {PIPE_COMPACT_FRAMING_FIELD, dont_validate},
     {INPUT_FIELD, validate_input},
     {OUTPUT_FIELD, validate_output},
     {RESTART_ATTEMPTS_FIELD, validate_restart_attempts},
@@ -475,12 +482,16 @@ bool FindOption(const std::string& key, option_t* opt) {
     {CLEANUP_TS_FIELD, validate_cleanupts},
     {LOGO_FIELD, dont_validate},
     {RSVG_LOGO_FIELD, dont_validate},
+    {ABR_LADDER_FIELD, dont_validate},
+    {TS_PASSTHROUGH_FIELD, dont_validate},
+    {TS_PIDS_FIELD, dont_validate},
     {FRAME_RATE_FIELD, validate_framerate},
     {ASPECT_RATIO_FIELD, validate_aspect_ratio},
     {VIDEO_BIT_RATE_FIELD, validate_video_bitrate},
     {AUDIO_BIT_RATE_FIELD, validate_audio_bitrate},
     {AUDIO_CHANNELS_FIELD, validate_audio_channels},
     {AUDIO_SELECT_FIELD, validate_audio_select},
+    {INPUT_FAILOVER_FIELD, validate_input_failover},
     {DECKLINK_VIDEO_MODE_FIELD, validate_decklink_video_mode},
 #if defined(MACHINE_LEARNING)
     {DEEP_LEARNING_FIELD, dont_validate},
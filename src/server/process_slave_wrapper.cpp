@@ -14,6 +14,13 @@
 
 #include "server/process_slave_wrapper.h"
 
+#if defined(OS_LINUX)
+#include <signal.h>
+#include <sys/ioctl.h>
+#endif
+
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <thread>
 #include <utility>
@@ -24,6 +31,7 @@
 #include <common/daemon/commands/get_log_info.h>
 #include <common/daemon/commands/stop_info.h>
 #include <common/file_system/string_path_utils.h>
+#include <common/libev/pipe_client.h>
 #include <common/license/expire_license.h>
 #include <common/net/http_client.h>
 #include <common/net/net.h>
@@ -35,25 +43,35 @@
 
 #include "gpu_stats/perf_monitor.h"
 
+#include "server/base/worker_server.h"
 #include "server/child_stream.h"
 #include "server/daemon/client.h"
 #include "server/daemon/commands.h"
 #include "server/daemon/commands_info/service/details/shots.h"
 #include "server/daemon/commands_info/service/prepare_info.h"
 #include "server/daemon/commands_info/service/server_info.h"
+#include "server/daemon/commands_info/service/statistic_subscribe_info.h"
 #include "server/daemon/commands_info/service/sync_info.h"
 #include "server/daemon/commands_info/stream/get_log_info.h"
 #include "server/daemon/commands_info/stream/restart_info.h"
 #include "server/daemon/commands_info/stream/start_info.h"
 #include "server/daemon/commands_info/stream/stop_info.h"
 #include "server/daemon/server.h"
+#if defined(OS_LINUX)
+#include "server/dvb_tuner_manager.h"
+#endif
 #include "server/http/handler.h"
 #include "server/http/server.h"
+#include "server/metrics/handler.h"
+#include "server/metrics/registry.h"
 #include "server/options/options.h"
+#include "server/retention_worker.h"
+#include "server/statistic_aggregator.h"
 #include "server/vods/handler.h"
 #include "server/vods/server.h"
 
 #include "stream_commands/commands.h"
+#include "stream_commands/compact_frame.h"
 
 #include "utils/m3u8_reader.h"
 
@@ -102,6 +120,59 @@ bool CheckIsFullVod(const common::file_system::ascii_file_string_path& file) {
 
   return true;
 }
+
+bool IsWorkerOf(const std::vector<common::libev::IoLoop*>& workers, common::libev::IoLoop* server) {
+  return std::find(workers.begin(), workers.end(), server) != workers.end();
+}
+
+// all workers of endpoint bind the same host, SO_REUSEPORT lets kernel balance accepts between them
+common::ErrnoError BindWorkers(const std::vector<common::libev::IoLoop*>& workers, int backlog) {
+  if (!workers.empty()) {
+    base::WorkerServer* first = static_cast<base::WorkerServer*>(workers.front());
+    const common::net::HostAndPort host = first->GetHost();
+    common::ErrnoError err = base::WorkerServer::CheckPortFree(host);
+    if (err) {
+      return common::make_errno_error(common::ConvertToString(host) + " already in use: " + err->GetDescription(),
+                                      EADDRINUSE);
+    }
+  }
+
+  for (common::libev::IoLoop* worker : workers) {
+    base::WorkerServer* server = static_cast<base::WorkerServer*>(worker);
+    common::ErrnoError err = server->Bind();
+    if (err) {
+      return common::make_errno_error(server->GetFormatedName() + " bind error: " + err->GetDescription(),
+                                      EADDRINUSE);
+    }
+
+    err = server->Listen(backlog);
+    if (err) {
+      return common::make_errno_error(server->GetFormatedName() + " listen error: " + err->GetDescription(),
+                                      EADDRINUSE);
+    }
+  }
+  return common::ErrnoError();
+}
+
+std::thread RunWorker(common::libev::IoLoop* worker) {
+  return std::thread([worker] {
+    int res = worker->Exec();
+    UNUSED(res);
+  });
+}
+
+void StopWorkers(const std::vector<common::libev::IoLoop*>& workers) {
+  for (common::libev::IoLoop* worker : workers) {
+    worker->Stop();
+  }
+}
+
+void DestroyWorkers(std::vector<common::libev::IoLoop*>* workers) {
+  for (common::libev::IoLoop* worker : *workers) {
+    delete worker;
+  }
+  workers->clear();
+}
 }  // namespace
 
 struct ProcessSlaveWrapper::NodeStats {
@@ -118,36 +189,83 @@ ProcessSlaveWrapper::ProcessSlaveWrapper(const Config& config)
       process_argc_(0),
       process_argv_(nullptr),
       loop_(nullptr),
-      http_server_(nullptr),
+      http_servers_(),
       http_handler_(nullptr),
-      vods_server_(nullptr),
+      vods_servers_(),
       vods_handler_(nullptr),
-      cods_server_(nullptr),
+      cods_servers_(),
       cods_handler_(nullptr),
+      metrics_servers_(),
+      metrics_handler_(nullptr),
       ping_client_timer_(INVALID_TIMER_ID),
       check_cods_vods_timer_(INVALID_TIMER_ID),
-      check_old_files_timer_(INVALID_TIMER_ID),
       node_stats_timer_(INVALID_TIMER_ID),
       quit_cleanup_timer_(INVALID_TIMER_ID),
       check_license_timer_(INVALID_TIMER_ID),
+      stream_stats_timer_(INVALID_TIMER_ID),
+#if defined(OS_LINUX)
+      check_dvb_tuners_timer_(INVALID_TIMER_ID),
+#endif
       node_stats_(new NodeStats),
       vods_links_(),
       cods_links_(),
-      folders_for_monitor_() {
+      childs_by_id_(),
+      pending_starts_(),
+#if defined(OS_LINUX)
+      zygote_(nullptr),
+      zygote_client_(nullptr),
+      zygote_spawns_(),
+      dvb_tuners_(nullptr),
+      dvb_tuner_childs_(),
+#endif
+      retention_(nullptr),
+      streamlink_resolver_(nullptr),
+      stats_aggregator_(new StatisticAggregator),
+      metrics_(new MetricsRegistry) {
   loop_ = new DaemonServer(config.host, this);
   loop_->SetName("client_server");
+  retention_ = new RetentionWorker(config.files_ttl, "*" CHUNK_EXT, retention_removes_per_second);
+  streamlink_resolver_ = new StreamLinkResolver(config.streamlink_path, streamlink_resolve_workers,
+                                                [this](const StreamLinkResolver::Link& link) {
+                                                  loop_->ExecInLoopThread([this, link]() { SendResolvedLink(link); });
+                                                });
+#if defined(OS_LINUX)
+  dvb_tuners_ = new DvbTunerManager(
+      [this](const common::uri::GURL& source, const common::uri::GURL& feed, pid_t* pid) {
+        return StartDvbTuner(source, feed, pid);
+      },
+      [](pid_t pid) { kill(pid, SIGTERM); });
+#endif
 
   http_handler_ = new HttpHandler(this);
-  http_server_ = new HttpServer(config.http_host, http_handler_);
-  http_server_->SetName("http_server");
-
-  vods_handler_ = new VodsHandler(this);
-  vods_server_ = new VodsServer(config.vods_host, vods_handler_);
-  vods_server_->SetName("vods_server");
-
-  cods_handler_ = new CodsHandler(this);
-  cods_server_ = new CodsServer(config.cods_host, cods_handler_);
-  cods_server_->SetName("cods_server");
+  for (size_t i = 0; i < config.http_workers; ++i) {
+    common::libev::IoLoop* http_server = new HttpServer(config.http_host, http_handler_);
+    http_server->SetName(common::MemSPrintf("http_server_%lu", i));
+    http_servers_.push_back(http_server);
+  }
+
+  vods_handler_ = new VodsHandler(this, true);
+  for (size_t i = 0; i < config.vods_workers; ++i) {
+    common::libev::IoLoop* vods_server = new VodsServer(config.vods_host, vods_handler_);
+    vods_server->SetName(common::MemSPrintf("vods_server_%lu", i));
+    vods_servers_.push_back(vods_server);
+  }
+
+  cods_handler_ = new CodsHandler(this, false);
+  for (size_t i = 0; i < config.cods_workers; ++i) {
+    common::libev::IoLoop* cods_server = new CodsServer(config.cods_host, cods_handler_);
+    cods_server->SetName(common::MemSPrintf("cods_server_%lu", i));
+    cods_servers_.push_back(cods_server);
+  }
+
+  metrics_->AddServer("http", static_cast<HttpHandler*>(http_handler_));
+  metrics_->AddServer("vods", static_cast<VodsHandler*>(vods_handler_));
+  metrics_->AddServer("cods", static_cast<CodsHandler*>(cods_handler_));
+  metrics_->SetRetention(retention_);
+  metrics_handler_ = new MetricsHandler(metrics_);
+  common::libev::IoLoop* metrics_server = new HttpServer(config.metrics_host, metrics_handler_);
+  metrics_server->SetName("metrics_server");
+  metrics_servers_.push_back(metrics_server);
 }
 
 common::ErrnoError ProcessSlaveWrapper::SendStopDaemonRequest(const Config& config) {
@@ -173,13 +291,22 @@ common::ErrnoError ProcessSlaveWrapper::SendStopDaemonRequest(const Config& conf
 }
 
 ProcessSlaveWrapper::~ProcessSlaveWrapper() {
-  destroy(&cods_server_);
+  DestroyWorkers(&metrics_servers_);
+  destroy(&metrics_handler_);
+  DestroyWorkers(&cods_servers_);
   destroy(&cods_handler_);
-  destroy(&vods_server_);
+  DestroyWorkers(&vods_servers_);
   destroy(&vods_handler_);
-  destroy(&http_server_);
+  DestroyWorkers(&http_servers_);
   destroy(&http_handler_);
   destroy(&loop_);
+  destroy(&streamlink_resolver_);
+#if defined(OS_LINUX)
+  destroy(&dvb_tuners_);
+#endif
+  destroy(&stats_aggregator_);
+  destroy(&metrics_);
+  destroy(&retention_);
   destroy(&node_stats_);
 }
 
@@ -187,6 +314,17 @@ int ProcessSlaveWrapper::Exec(int argc, char** argv) {
   process_argc_ = argc;
   process_argv_ = argv;
 
+#if defined(OS_LINUX) && !defined(TEST)
+  // fork zygote while daemon is still single threaded
+  common::ErrnoError zerr = StartZygote();
+  if (zerr) {
+    WARNING_LOG() << "Zygote not started, streams will be forked from daemon: " << zerr->GetDescription();
+  }
+#endif
+
+  retention_->Start();
+  streamlink_resolver_->Start();
+
   // gpu statistic monitor
   std::thread perf_thread;
   gpu_stats::IPerfMonitor* perf_monitor = gpu_stats::CreatePerfMonitor(&node_stats_->gpu_load);
@@ -194,61 +332,8 @@ int ProcessSlaveWrapper::Exec(int argc, char** argv) {
     perf_thread = std::thread([perf_monitor] { perf_monitor->Exec(); });
   }
 
-  HttpServer* http_server = static_cast<HttpServer*>(http_server_);
-  std::thread http_thread = std::thread([http_server] {
-    common::ErrnoError err = http_server->Bind(true);
-    if (err) {
-      ERROR_LOG() << "HttpServer error: " << err->GetDescription();
-      return;
-    }
-
-    err = http_server->Listen(5);
-    if (err) {
-      ERROR_LOG() << "HttpServer error: " << err->GetDescription();
-      return;
-    }
-
-    int res = http_server->Exec();
-    UNUSED(res);
-  });
-
-  VodsServer* vods_server = static_cast<VodsServer*>(vods_server_);
-  std::thread vods_thread = std::thread([vods_server] {
-    common::ErrnoError err = vods_server->Bind(true);
-    if (err) {
-      ERROR_LOG() << "VodsServer error: " << err->GetDescription();
-      return;
-    }
-
-    err = vods_server->Listen(5);
-    if (err) {
-      ERROR_LOG() << "VodsServer error: " << err->GetDescription();
-      return;
-    }
-
-    int res = vods_server->Exec();
-    UNUSED(res);
-  });
-
-  CodsServer* cods_server = static_cast<CodsServer*>(cods_server_);
-  std::thread cods_thread = std::thread([cods_server] {
-    common::ErrnoError err = cods_server->Bind(true);
-    if (err) {
-      ERROR_LOG() << "CodsServer error: " << err->GetDescription();
-      return;
-    }
-
-    err = cods_server->Listen(5);
-    if (err) {
-      ERROR_LOG() << "CodsServer error: " << err->GetDescription();
-      return;
-    }
-
-    int res = cods_server->Exec();
-    UNUSED(res);
-  });
-
   int res = EXIT_FAILURE;
+  std::vector<std::thread> workers_threads;
   DaemonServer* server = static_cast<DaemonServer*>(loop_);
   common::ErrnoError err = server->Bind(true);
   if (err) {
@@ -262,6 +347,20 @@ int ProcessSlaveWrapper::Exec(int argc, char** argv) {
     goto finished;
   }
 
+  // endpoint without all its workers is startup failure, so bind everything before any loop started
+  for (const workers_t* workers : {&http_servers_, &vods_servers_, &cods_servers_, &metrics_servers_}) {
+    err = BindWorkers(*workers, http_listen_backlog);
+    if (err) {
+      ERROR_LOG() << err->GetDescription();
+      goto finished;
+    }
+  }
+  for (const workers_t* workers : {&http_servers_, &vods_servers_, &cods_servers_, &metrics_servers_}) {
+    for (common::libev::IoLoop* worker : *workers) {
+      workers_threads.push_back(RunWorker(worker));
+    }
+  }
+
   node_stats_->prev = service::GetMachineCpuShot();
   node_stats_->prev_nshot = service::GetMachineNetShot();
   node_stats_->timestamp = common::time::current_utc_mstime();
@@ -269,9 +368,10 @@ int ProcessSlaveWrapper::Exec(int argc, char** argv) {
   res = server->Exec();
 
 finished:
-  vods_thread.join();
-  cods_thread.join();
-  http_thread.join();
+  streamlink_resolver_->Stop();
+  for (std::thread& worker_thread : workers_threads) {
+    worker_thread.join();
+  }
   if (perf_monitor) {
     perf_monitor->Stop();
   }
@@ -279,15 +379,34 @@ finished:
     perf_thread.join();
   }
   delete perf_monitor;
+  retention_->Stop();
+#if defined(OS_LINUX) && !defined(TEST)
+  StopZygote();
+#endif
+#if defined(OS_LINUX)
+  dvb_tuners_->StopAll();
+#endif
   return res;
 }
 
 void ProcessSlaveWrapper::PreLooped(common::libev::IoLoop* server) {
   ping_client_timer_ = server->CreateTimer(ping_timeout_clients_seconds, true);
   check_cods_vods_timer_ = server->CreateTimer(config_.cods_ttl / 2, true);
-  check_old_files_timer_ = server->CreateTimer(config_.files_ttl / 10, true);
   node_stats_timer_ = server->CreateTimer(node_stats_send_seconds, true);
   check_license_timer_ = server->CreateTimer(check_license_timeout_seconds, true);
+  stream_stats_timer_ = server->CreateTimer(stream_stats_poll_seconds, true);
+#if defined(OS_LINUX)
+  check_dvb_tuners_timer_ = server->CreateTimer(dvb_tuners_check_seconds, true);
+  if (zygote_ && zygote_->IsRunning()) {
+    common::libev::IoClient* zygote_client = new common::libev::PipeReadClient(server, zygote_->GetControlFd());
+    if (server->RegisterClient(zygote_client)) {
+      zygote_client_ = zygote_client;
+    } else {
+      WARNING_LOG() << "Can't watch zygote, streams will be forked from daemon";
+      delete zygote_client;
+    }
+  }
+#endif
 }
 
 void ProcessSlaveWrapper::Accepted(common::libev::IoClient* client) {
@@ -300,7 +419,7 @@ void ProcessSlaveWrapper::Moved(common::libev::IoLoop* server, common::libev::Io
 }
 
 void ProcessSlaveWrapper::Closed(common::libev::IoClient* client) {
-  UNUSED(client);
+  stats_aggregator_->Forget(client);
 }
 
 void ProcessSlaveWrapper::TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) {
@@ -323,24 +442,24 @@ void ProcessSlaveWrapper::TimerEmited(common::libev::IoLoop* server, common::lib
     }
   } else if (check_cods_vods_timer_ == id) {
     fastotv::timestamp_t current_time = common::time::current_utc_mstime();
-    const auto copy_cods = cods_links_.Copy();
-    for (auto it = copy_cods.begin(); it != copy_cods.end(); ++it) {
-      serialized_stream_t conf = it->second;
-      fastotv::stream_id_t sid = GetSid(conf);
-      Child* cod = FindChildByID(sid);
-      if (cod) {
-        fastotv::timestamp_t cod_last_update = cod->GetLastUpdate();
-        fastotv::timestamp_t ts_diff = current_time - cod_last_update;
-        if (ts_diff > config_.cods_ttl * 1000) {
-          ignore_result(cod->Stop());
-        }
+    const LinksHolderTS::snapshot_t cods = cods_links_.GetSnapshot();
+    for (auto it = cods->begin(); it != cods->end(); ++it) {
+      fastotv::timestamp_t ts_diff = current_time - it->second.last_access->load(std::memory_order_relaxed);
+      if (ts_diff <= config_.cods_ttl * 1000) {
+        continue;
       }
-    }
-  } else if (check_old_files_timer_ == id) {
-    for (auto it = folders_for_monitor_.begin(); it != folders_for_monitor_.end(); ++it) {
-      const common::file_system::ascii_directory_string_path folder = *it;
-      const time_t max_life_time = common::time::current_utc_mstime() / 1000 - config_.files_ttl;
-      RemoveOldFilesByTime(folder, max_life_time, "*" CHUNK_EXT, true);
+
+      Child* cod = FindChildByID(GetSid(it->second.config));
+      if (!cod) {
+        continue;
+      }
+
+      // cod started by daemon command or after slow link resolve may still wait for first request
+      if (current_time - cod->GetStartTime() <= config_.cods_ttl * 1000) {
+        continue;
+      }
+
+      ignore_result(cod->Stop());
     }
   } else if (node_stats_timer_ == id) {
     const std::string node_stats = MakeServiceStats(0);
@@ -352,12 +471,19 @@ void ProcessSlaveWrapper::TimerEmited(common::libev::IoLoop* server, common::lib
 
     BroadcastClients(req);
   } else if (quit_cleanup_timer_ == id) {
-    vods_server_->Stop();
-    cods_server_->Stop();
-    http_server_->Stop();
+    StopWorkers(vods_servers_);
+    StopWorkers(cods_servers_);
+    StopWorkers(http_servers_);
+    StopWorkers(metrics_servers_);
     loop_->Stop();
   } else if (check_license_timer_ == id) {
     CheckLicenseExpired();
+  } else if (stream_stats_timer_ == id) {
+    BroadcastStreamsStatistic();
+#if defined(OS_LINUX)
+  } else if (check_dvb_tuners_timer_ == id) {
+    dvb_tuners_->CheckTuners();
+#endif
   }
 }
 
@@ -371,14 +497,38 @@ void ProcessSlaveWrapper::Moved(common::libev::IoLoop* server, common::libev::Io
 }
 
 void ProcessSlaveWrapper::ChildStatusChanged(common::libev::IoChild* child, int status, int signal) {
-  ChildStream* channel = static_cast<ChildStream*>(child);
+#if defined(OS_LINUX)
+  if (DvbTunerExited(child, status, signal)) {
+    return;
+  }
+#endif
+  StreamFinished(static_cast<ChildStream*>(child), status, signal, true);
+}
+
+void ProcessSlaveWrapper::StreamFinished(ChildStream* channel, int status, int signal, bool registered) {
   channel->CleanUp();
   const auto sid = channel->GetStreamID();
+  for (const InputUri& input : channel->GetStreamInfo().input) {
+    if (input.GetStreamLink()) {
+      streamlink_resolver_->Release(input);
+    }
+  }
+#if defined(OS_LINUX)
+  dvb_tuners_->Release(sid);
+#endif
+  auto indexed = childs_by_id_.find(sid);
+  if (indexed != childs_by_id_.end() && indexed->second == channel) {
+    childs_by_id_.erase(indexed);
+    stats_aggregator_->Remove(sid);
+    metrics_->RemoveStream(sid);
+  }
 
   INFO_LOG() << "Successful finished children id: " << sid << "\nStream id: " << sid
              << ", exit with status: " << (status ? "FAILURE" : "SUCCESS") << ", signal: " << signal;
 
-  loop_->UnRegisterChild(child);
+  if (registered) {
+    loop_->UnRegisterChild(channel);
+  }
 
   delete channel;
 
@@ -393,11 +543,8 @@ void ProcessSlaveWrapper::ChildStatusChanged(common::libev::IoChild* child, int
 }
 
 void ProcessSlaveWrapper::StopImpl() {
-  DaemonServer* server = static_cast<DaemonServer*>(loop_);
-  auto childs = server->GetChilds();
-  for (auto* child : childs) {
-    ChildStream* channel = static_cast<ChildStream*>(child);
-    ignore_result(channel->Stop());
+  for (auto& child : childs_by_id_) {  // also streams waiting pid from zygote, they read stop when started
+    ignore_result(child.second->Stop());
   }
 
   quit_cleanup_timer_ = loop_->CreateTimer(cleanup_seconds, false);
@@ -405,16 +552,12 @@ void ProcessSlaveWrapper::StopImpl() {
 
 Child* ProcessSlaveWrapper::FindChildByID(fastotv::stream_id_t cid) const {
   CHECK(loop_->IsLoopThread());
-  DaemonServer* server = static_cast<DaemonServer*>(loop_);
-  auto childs = server->GetChilds();
-  for (auto* child : childs) {
-    Child* channel = static_cast<Child*>(child);
-    if (channel->GetStreamID() == cid) {
-      return channel;
-    }
+  auto it = childs_by_id_.find(cid);
+  if (it == childs_by_id_.end()) {
+    return nullptr;
   }
 
-  return nullptr;
+  return it->second;
 }
 
 void ProcessSlaveWrapper::BroadcastClients(const fastotv::protocol::request_t& req) {
@@ -430,6 +573,94 @@ void ProcessSlaveWrapper::BroadcastClients(const fastotv::protocol::request_t& r
   }
 }
 
+bool ProcessSlaveWrapper::HaveVerifiedClients() const {
+  std::vector<common::libev::IoClient*> clients = loop_->GetClients();
+  for (size_t i = 0; i < clients.size(); ++i) {
+    ProtocoledDaemonClient* dclient = dynamic_cast<ProtocoledDaemonClient*>(clients[i]);
+    if (dclient && dclient->IsVerified()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ProcessSlaveWrapper::BroadcastStreamsStatistic() {
+  CHECK(loop_->IsLoopThread());
+  if (!HaveVerifiedClients()) {  // serialize only if somebody listens
+    return;
+  }
+
+  for (auto it = childs_by_id_.begin(); it != childs_by_id_.end(); ++it) {
+    ChildStream* channel = static_cast<ChildStream*>(it->second);
+    StatisticInfo stat;
+    if (!channel->ReadStatistic(&stat)) {
+      continue;
+    }
+
+    std::string stat_json;
+    common::Error err_ser = stat.SerializeToString(&stat_json);
+    if (err_ser) {
+      continue;
+    }
+
+    stats_aggregator_->Update(it->first, stat_json);
+  }
+
+  FlushStreamsStatistic();
+}
+
+void ProcessSlaveWrapper::FlushStreamsStatistic() {
+  std::vector<common::libev::IoClient*> clients = loop_->GetClients();
+  for (size_t i = 0; i < clients.size(); ++i) {
+    ProtocoledDaemonClient* dclient = dynamic_cast<ProtocoledDaemonClient*>(clients[i]);
+    if (!dclient || !dclient->IsVerified()) {
+      continue;
+    }
+
+#if defined(OS_LINUX)
+    int pending_bytes = 0;
+    if (ioctl(dclient->GetFd(), TIOCOUTQ, &pending_bytes) == 0 && pending_bytes > client_stats_max_pending_bytes) {
+      // don't queue more, client gets only latest values when it drains
+      stats_aggregator_->MarkSkipped(dclient);
+      continue;
+    }
+#endif
+
+    if (stats_aggregator_->IsBatched(dclient)) {
+      std::string batch_json;
+      if (!stats_aggregator_->TakeBatch(dclient, &batch_json)) {
+        continue;
+      }
+
+      fastotv::protocol::request_t req;
+      common::Error err_ser = StatisitcStreamsBroadcast(batch_json, &req);
+      if (err_ser) {
+        continue;
+      }
+
+      common::ErrnoError err = dclient->WriteRequest(req);
+      if (err) {
+        WARNING_LOG() << "FlushStreamsStatistic error: " << err->GetDescription();
+      }
+      continue;
+    }
+
+    for (const std::string& stat_json : stats_aggregator_->TakeChanges(dclient)) {
+      fastotv::protocol::request_t req;
+      common::Error err_ser = StatisitcStreamBroadcast(stat_json, &req);
+      if (err_ser) {
+        continue;
+      }
+
+      common::ErrnoError err = dclient->WriteRequest(req);
+      if (err) {
+        WARNING_LOG() << "FlushStreamsStatistic error: " << err->GetDescription();
+        break;
+      }
+    }
+  }
+}
+
 common::ErrnoError ProcessSlaveWrapper::DaemonDataReceived(ProtocoledDaemonClient* dclient) {
   CHECK(loop_->IsLoopThread());
   std::string input_command;
@@ -471,6 +702,33 @@ common::ErrnoError ProcessSlaveWrapper::DaemonDataReceived(ProtocoledDaemonClien
 
 common::ErrnoError ProcessSlaveWrapper::StreamDataReceived(stream_client_t* pipe_client) {
   CHECK(loop_->IsLoopThread());
+  Child* child = FindChildByID(pipe_client->GetName());
+  if (child && child->IsCompactFraming()) {
+    CompactFrameReader* reader = child->GetFrameReader();
+    common::ErrnoError err = reader->ReadFrom(pipe_client);
+    if (err) {
+      return err;
+    }
+
+    while (true) {
+      CompactFrame frame;
+      bool ready = false;
+      err = reader->PopFrame(&frame, &ready);
+      if (err) {
+        return err;
+      }
+      if (!ready) {
+        break;
+      }
+
+      err = HandleCompactFrameStreams(pipe_client, frame);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      }
+    }
+    return common::ErrnoError();
+  }
+
   std::string input_command;
   common::ErrnoError err = pipe_client->ReadCommand(&input_command);
   if (err) {
@@ -507,6 +765,13 @@ common::ErrnoError ProcessSlaveWrapper::StreamDataReceived(stream_client_t* pipe
 }
 
 void ProcessSlaveWrapper::DataReceived(common::libev::IoClient* client) {
+#if defined(OS_LINUX)
+  if (client == zygote_client_) {
+    ZygoteDataReceived();
+    return;
+  }
+#endif
+
   if (ProtocoledDaemonClient* dclient = dynamic_cast<ProtocoledDaemonClient*>(client)) {
     common::ErrnoError err = DaemonDataReceived(dclient);
     if (err) {
@@ -518,12 +783,9 @@ void ProcessSlaveWrapper::DataReceived(common::libev::IoClient* client) {
     common::ErrnoError err = StreamDataReceived(pipe_client);
     if (err) {
       DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      DaemonServer* server = static_cast<DaemonServer*>(loop_);
-      auto childs = server->GetChilds();
-      for (auto* child : childs) {
-        ChildStream* channel = static_cast<ChildStream*>(child);
-        if (pipe_client == channel->GetClient()) {
-          channel->SetClient(nullptr);
+      for (auto& child : childs_by_id_) {  // also streams waiting pid from zygote
+        if (pipe_client == child.second->GetClient()) {
+          child.second->SetClient(nullptr);
           break;
         }
       }
@@ -546,11 +808,6 @@ void ProcessSlaveWrapper::PostLooped(common::libev::IoLoop* server) {
     check_cods_vods_timer_ = INVALID_TIMER_ID;
   }
 
-  if (check_old_files_timer_ != INVALID_TIMER_ID) {
-    server->RemoveTimer(check_old_files_timer_);
-    check_old_files_timer_ = INVALID_TIMER_ID;
-  }
-
   if (ping_client_timer_ != INVALID_TIMER_ID) {
     server->RemoveTimer(ping_client_timer_);
     ping_client_timer_ = INVALID_TIMER_ID;
@@ -570,12 +827,31 @@ void ProcessSlaveWrapper::PostLooped(common::libev::IoLoop* server) {
     server->RemoveTimer(check_license_timer_);
     check_license_timer_ = INVALID_TIMER_ID;
   }
+
+  if (stream_stats_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(stream_stats_timer_);
+    stream_stats_timer_ = INVALID_TIMER_ID;
+  }
+
+#if defined(OS_LINUX)
+  if (zygote_client_) {
+    server->UnRegisterClient(zygote_client_);
+    delete zygote_client_;  // descriptor owned by zygote
+    zygote_client_ = nullptr;
+  }
+
+  for (const auto& tuner : dvb_tuner_childs_) {  // not reaped anymore, still stopped by pid after loop
+    server->UnRegisterChild(tuner.first);
+    delete tuner.first;
+  }
+  dvb_tuner_childs_.clear();
+#endif
 }
 
 void ProcessSlaveWrapper::OnHttpRequest(common::libev::http::HttpClient* client,
                                         const file_path_t& file,
                                         common::http::http_status* recommend_status) {
-  if (client->GetServer() == vods_server_) {
+  if (IsWorkerOf(vods_servers_, client->GetServer())) {
     std::string ext = file.GetExtension();
     bool is_m3u8 = common::EqualsASCII(ext, M3U8_EXTENSION, false);
     if (is_m3u8) {
@@ -607,13 +883,13 @@ void ProcessSlaveWrapper::OnHttpRequest(common::libev::http::HttpClient* client,
       }
       return;
     }
-  } else if (client->GetServer() == cods_server_) {
+  } else if (IsWorkerOf(cods_servers_, client->GetServer())) {
     std::string ext = file.GetExtension();
     bool is_m3u8 = common::EqualsASCII(ext, M3U8_EXTENSION, false);
     bool is_ts = common::EqualsASCII(ext, TS_EXTENSION, false);
     if (is_m3u8 || is_ts) {
       const common::file_system::ascii_directory_string_path http_root(file.GetDirectory());
-      auto config = cods_links_.Find(http_root);
+      auto config = cods_links_.FindAndTouch(http_root);  // keeps cod alive
       if (!config) {
         if (recommend_status) {
           *recommend_status = common::http::HS_FORBIDDEN;
@@ -621,20 +897,14 @@ void ProcessSlaveWrapper::OnHttpRequest(common::libev::http::HttpClient* client,
         return;
       }
 
-      loop_->ExecInLoopThread([this, is_m3u8, config]() {
-        if (is_m3u8) {
+      if (is_m3u8) {
+        loop_->ExecInLoopThread([this, config]() {
           common::ErrnoError errn = CreateChildStream(config);
           if (errn) {
             DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
           }
-        }
-
-        fastotv::stream_id_t sid = GetSid(config);
-        Child* cod = FindChildByID(sid);
-        if (cod) {
-          cod->UpdateTimestamp();
-        }
-      });
+        });
+      }
       if (is_m3u8) {
         if (recommend_status) {
           *recommend_status = common::http::HS_ACCEPTED;
@@ -732,8 +1002,138 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStream(const serialized_strea
     return common::make_errno_error(common::MemSPrintf("Stream with id: %s exist, skip request.", sha.id), EEXIST);
   }
 
-  config_args->Insert(STREAM_LINK_PATH_FIELD, common::Value::CreateStringValueFromBasicString(config_.streamlink_path));
-  return CreateChildStreamImpl(config_args, sha);
+  // config may come from vods/cods snapshot read by http workers, per start fields go only to own copy
+  const serialized_stream_t child_config(config_args->DeepCopy());
+  if (!InsertResolvedStreamLinks(child_config, sha)) {
+    return common::ErrnoError();
+  }
+
+#if defined(OS_LINUX)
+  InsertDvbTunerFeeds(child_config, sha);
+#endif
+  child_config->Insert(STREAM_LINK_PATH_FIELD,
+                       common::Value::CreateStringValueFromBasicString(config_.streamlink_path));
+  err = CreateChildStreamImpl(child_config, sha);
+  if (err) {
+#if defined(OS_LINUX)
+    dvb_tuners_->Release(sha.id);
+#endif
+    return err;
+  }
+
+  Child* created = FindChildByID(sha.id);
+  if (created) {
+    metrics_->AddStream(sha.id, static_cast<ChildStream*>(created)->GetStatsBlock());
+    for (const InputUri& input : sha.input) {
+      if (input.GetStreamLink()) {
+        streamlink_resolver_->Acquire(input);
+      }
+    }
+  }
+  return common::ErrnoError();
+}
+
+bool ProcessSlaveWrapper::InsertResolvedStreamLinks(const serialized_stream_t& config_args, const StreamInfo& sha) {
+  common::ArrayValue* resolved_links = common::Value::CreateArrayValue();
+  bool waiting = false;
+  for (const InputUri& input : sha.input) {
+    if (!input.GetStreamLink()) {
+      continue;
+    }
+
+    StreamLinkResolver::Link link;
+    if (streamlink_resolver_->Find(input, &link)) {
+      if (!link.url.is_valid()) {  // failed recently, stream will try by itself
+        continue;
+      }
+
+      std::string link_json;
+      const ResolvedLinkInfo info(link.source.spec(), link.url.spec(), link.expire_utc_msec);
+      common::Error err_ser = info.SerializeToString(&link_json);
+      if (!err_ser) {
+        resolved_links->Append(common::Value::CreateStringValueFromBasicString(link_json));
+      }
+      continue;
+    }
+
+    if (waiting) {  // only first pending link creates stream again, others just resolving
+      streamlink_resolver_->Resolve(input, nullptr);
+      continue;
+    }
+
+    waiting = true;
+    pending_starts_.insert(sha.id);
+    INFO_LOG() << "Stream id: " << sha.id << " waiting stream link: " << input.GetUrl().spec();
+    const fastotv::stream_id_t sid = sha.id;
+    streamlink_resolver_->Resolve(input, [this, config_args, sid](const StreamLinkResolver::Link& link) {
+      UNUSED(link);
+      loop_->ExecInLoopThread([this, config_args, sid]() {
+        if (pending_starts_.erase(sid) == 0) {  // stopped while resolving, or already started
+          return;
+        }
+
+        common::ErrnoError errn = CreateChildStream(config_args);
+        if (errn) {
+          DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
+        }
+      });
+    });
+  }
+
+  if (waiting) {
+    delete resolved_links;
+    return false;
+  }
+
+  config_args->Insert(STREAM_LINK_RESOLVED_FIELD, resolved_links);
+  return true;
+}
+
+#if defined(OS_LINUX)
+void ProcessSlaveWrapper::InsertDvbTunerFeeds(const serialized_stream_t& config_args, const StreamInfo& sha) {
+  common::ArrayValue* feeds = common::Value::CreateArrayValue();
+  for (const InputUri& input : sha.input) {
+    const common::uri::GURL source = input.GetUrl();
+    if (!DvbTunerManager::IsTunerSource(source)) {
+      continue;
+    }
+
+    common::uri::GURL feed;
+    common::ErrnoError err = dvb_tuners_->Acquire(sha.id, source, &feed);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+      continue;
+    }
+
+    // feed never expires, stream just reads it instead of source
+    std::string link_json;
+    const ResolvedLinkInfo info(source.spec(), feed.spec(), std::numeric_limits<fastotv::timestamp_t>::max());
+    common::Error err_ser = info.SerializeToString(&link_json);
+    if (!err_ser) {
+      INFO_LOG() << "Stream id: " << sha.id << " reads dvb feed: " << feed.spec();
+      feeds->Append(common::Value::CreateStringValueFromBasicString(link_json));
+    }
+  }
+
+  config_args->Insert(DVB_TUNER_FEEDS_FIELD, feeds);
+}
+#endif
+
+void ProcessSlaveWrapper::SendResolvedLink(const StreamLinkResolver::Link& link) {
+  CHECK(loop_->IsLoopThread());
+  const ResolvedLinkInfo info(link.source.spec(), link.url.spec(), link.expire_utc_msec);
+  for (const auto& child : childs_by_id_) {
+    const ChildStream* channel = static_cast<const ChildStream*>(child.second);
+    for (const InputUri& input : channel->GetStreamInfo().input) {
+      if (input.GetStreamLink() && input.GetUrl() == link.source) {
+        common::ErrnoError errn = child.second->SendResolvedLink(info);
+        if (errn) {
+          DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
+        }
+        break;
+      }
+    }
+  }
 }
 
 common::ErrnoError ProcessSlaveWrapper::StopChildStream(const serialized_stream_t& config_args) {
@@ -743,8 +1143,13 @@ common::ErrnoError ProcessSlaveWrapper::StopChildStream(const serialized_stream_
 
 common::ErrnoError ProcessSlaveWrapper::StopChildStreamImpl(fastotv::stream_id_t sid) {
   CHECK(loop_->IsLoopThread());
+  const bool pending = pending_starts_.erase(sid) != 0;
   Child* stream = FindChildByID(sid);
   if (!stream) {
+    if (pending) {  // cancels start waiting for stream link
+      INFO_LOG() << "Stream id: " << sid << " stopped while waiting stream link";
+      return common::ErrnoError();
+    }
     return common::make_errno_error(common::MemSPrintf("Stream with id: %s not exist, skip request.", sid), EINVAL);
   }
 
@@ -756,32 +1161,35 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestChangedSourcesStream(stream
   UNUSED(pclient);
   CHECK(loop_->IsLoopThread());
   if (req->params) {
-    const char* params_ptr = req->params->c_str();
-    json_object* jrequest_changed_sources = json_tokener_parse(params_ptr);
-    if (!jrequest_changed_sources) {
-      return common::make_errno_error_inval();
-    }
+    return BroadcastChangedSources(*req->params);
+  }
 
-    ChangedSouresInfo ch_sources_info;
-    common::Error err_des = ch_sources_info.DeSerialize(jrequest_changed_sources);
-    json_object_put(jrequest_changed_sources);
-    if (err_des) {
-      const std::string err_str = err_des->GetDescription();
-      return common::make_errno_error(err_str, EAGAIN);
-    }
+  return common::make_errno_error_inval();
+}
 
-    fastotv::protocol::request_t req;
-    common::Error err_ser = ChangedSourcesStreamBroadcast(ch_sources_info, &req);
-    if (err_ser) {
-      const std::string err_str = err_ser->GetDescription();
-      return common::make_errno_error(err_str, EAGAIN);
-    }
+common::ErrnoError ProcessSlaveWrapper::BroadcastChangedSources(const std::string& changed_sources_json) {
+  json_object* jrequest_changed_sources = json_tokener_parse(changed_sources_json.c_str());
+  if (!jrequest_changed_sources) {
+    return common::make_errno_error_inval();
+  }
 
-    BroadcastClients(req);
-    return common::ErrnoError();
+  ChangedSouresInfo ch_sources_info;
+  common::Error err_des = ch_sources_info.DeSerialize(jrequest_changed_sources);
+  json_object_put(jrequest_changed_sources);
+  if (err_des) {
+    const std::string err_str = err_des->GetDescription();
+    return common::make_errno_error(err_str, EAGAIN);
   }
 
-  return common::make_errno_error_inval();
+  fastotv::protocol::request_t req;
+  common::Error err_ser = ChangedSourcesStreamBroadcast(ch_sources_info, &req);
+  if (err_ser) {
+    const std::string err_str = err_ser->GetDescription();
+    return common::make_errno_error(err_str, EAGAIN);
+  }
+
+  BroadcastClients(req);
+  return common::ErrnoError();
 }
 
 common::ErrnoError ProcessSlaveWrapper::HandleRequestStatisticStream(stream_client_t* pclient,
@@ -803,14 +1211,8 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestStatisticStream(stream_clie
       return common::make_errno_error(err_str, EAGAIN);
     }
 
-    fastotv::protocol::request_t req;
-    common::Error err_ser = StatisitcStreamBroadcast(stat, &req);
-    if (err_ser) {
-      const std::string err_str = err_ser->GetDescription();
-      return common::make_errno_error(err_str, EAGAIN);
-    }
-
-    BroadcastClients(req);
+    // coalesced, delivered on next statistic flush
+    stats_aggregator_->Update(stat.GetStreamStruct().id, *req->params);
     return common::ErrnoError();
   }
 
@@ -823,32 +1225,35 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestMlNotificationStream(stream
   UNUSED(pclient);
   CHECK(loop_->IsLoopThread());
   if (req->params) {
-    const char* params_ptr = req->params->c_str();
-    json_object* jrequest_notif = json_tokener_parse(params_ptr);
-    if (!jrequest_notif) {
-      return common::make_errno_error_inval();
-    }
+    return BroadcastMlNotification(*req->params);
+  }
 
-    fastotv::commands_info::ml::NotificationInfo notif;
-    common::Error err_des = notif.DeSerialize(jrequest_notif);
-    json_object_put(jrequest_notif);
-    if (err_des) {
-      const std::string err_str = err_des->GetDescription();
-      return common::make_errno_error(err_str, EAGAIN);
-    }
+  return common::make_errno_error_inval();
+}
 
-    fastotv::protocol::request_t req;
-    common::Error err_ser = MlNotificationStreamBroadcast(notif, &req);
-    if (err_ser) {
-      const std::string err_str = err_ser->GetDescription();
-      return common::make_errno_error(err_str, EAGAIN);
-    }
+common::ErrnoError ProcessSlaveWrapper::BroadcastMlNotification(const std::string& notification_json) {
+  json_object* jrequest_notif = json_tokener_parse(notification_json.c_str());
+  if (!jrequest_notif) {
+    return common::make_errno_error_inval();
+  }
 
-    BroadcastClients(req);
-    return common::ErrnoError();
+  fastotv::commands_info::ml::NotificationInfo notif;
+  common::Error err_des = notif.DeSerialize(jrequest_notif);
+  json_object_put(jrequest_notif);
+  if (err_des) {
+    const std::string err_str = err_des->GetDescription();
+    return common::make_errno_error(err_str, EAGAIN);
   }
 
-  return common::make_errno_error_inval();
+  fastotv::protocol::request_t req;
+  common::Error err_ser = MlNotificationStreamBroadcast(notif, &req);
+  if (err_ser) {
+    const std::string err_str = err_ser->GetDescription();
+    return common::make_errno_error(err_str, EAGAIN);
+  }
+
+  BroadcastClients(req);
+  return common::ErrnoError();
 }
 #endif
 
@@ -1074,22 +1479,23 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientPrepareService(Protoc
       return common::make_errno_error(err_str, EAGAIN);
     }
 
-    folders_for_monitor_.clear();
+    std::vector<RetentionWorker::folder_t> folders_for_monitor;
 
     const auto http_root = HttpHandler::http_directory_path_t(state_info.GetHlsDirectory());
     static_cast<HttpHandler*>(http_handler_)->SetHttpRoot(http_root);
-    folders_for_monitor_.push_back(http_root);
+    folders_for_monitor.push_back(http_root);
 
     const auto vods_root = VodsHandler::http_directory_path_t(state_info.GetVodsDirectory());
     static_cast<VodsHandler*>(vods_handler_)->SetHttpRoot(vods_root);
-    folders_for_monitor_.push_back(vods_root);
+    folders_for_monitor.push_back(vods_root);
 
     const auto cods_root = CodsHandler::http_directory_path_t(state_info.GetCodsDirectory());
     static_cast<CodsHandler*>(cods_handler_)->SetHttpRoot(cods_root);
-    folders_for_monitor_.push_back(cods_root);
+    folders_for_monitor.push_back(cods_root);
 
     const auto timeshift_root = CodsHandler::http_directory_path_t(state_info.GetTimeshiftsDirectory());
-    folders_for_monitor_.push_back(timeshift_root);
+    folders_for_monitor.push_back(timeshift_root);
+    retention_->SetFolders(folders_for_monitor);
 
     service::Directories dirs(state_info);
     std::string resp_str = service::MakeDirectoryResponce(dirs);
@@ -1124,9 +1530,12 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientSyncService(Protocole
     // refresh vods
     // vods_links_.Clear();
     // cods_links_.Clear();
+    LinksHolderTS::configs_t vods, cods;
     for (StreamConfig config : sync_info.GetStreams()) {
-      AddStreamLine(config);
+      AddStreamLine(config, &vods, &cods);
     }
+    vods_links_.Insert(vods);
+    cods_links_.Insert(cods);
 
     return dclient->SyncServiceSuccess(req->id);
   }
@@ -1134,7 +1543,37 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientSyncService(Protocole
   return common::make_errno_error_inval();
 }
 
-void ProcessSlaveWrapper::AddStreamLine(const serialized_stream_t& config_args) {
+common::ErrnoError ProcessSlaveWrapper::HandleRequestClientSubscribeStatisticService(
+    ProtocoledDaemonClient* dclient,
+    const fastotv::protocol::request_t* req) {
+  CHECK(loop_->IsLoopThread());
+  if (!dclient->IsVerified()) {
+    return common::make_errno_error_inval();
+  }
+
+  service::StatisticSubscribeInfo subscribe_info;
+  if (req->params) {
+    const char* params_ptr = req->params->c_str();
+    json_object* jsubscribe = json_tokener_parse(params_ptr);
+    if (!jsubscribe) {
+      return common::make_errno_error_inval();
+    }
+
+    common::Error err_des = subscribe_info.DeSerialize(jsubscribe);
+    json_object_put(jsubscribe);
+    if (err_des) {
+      const std::string err_str = err_des->GetDescription();
+      return common::make_errno_error(err_str, EAGAIN);
+    }
+  }
+
+  stats_aggregator_->Subscribe(dclient, subscribe_info.GetStreams());
+  return dclient->SubscribeStatisticServiceSuccess(req->id);
+}
+
+void ProcessSlaveWrapper::AddStreamLine(const serialized_stream_t& config_args,
+                                        LinksHolderTS::configs_t* vods,
+                                        LinksHolderTS::configs_t* cods) {
   CHECK(loop_->IsLoopThread());
   common::ErrnoError err = options::ValidateConfig(config_args);
   if (err) {
@@ -1159,7 +1598,7 @@ void ProcessSlaveWrapper::AddStreamLine(const serialized_stream_t& config_args)
           const auto http_root = out_uri.GetHttpRoot();
           if (http_root) {
             config_args->Insert(CLEANUP_TS_FIELD, common::Value::CreateBooleanValue(false));
-            vods_links_.Insert(*http_root, config_args);
+            (*vods)[http_root->GetPath()] = config_args;
           }
         }
       }
@@ -1172,7 +1611,7 @@ void ProcessSlaveWrapper::AddStreamLine(const serialized_stream_t& config_args)
         if (ouri.SchemeIsHTTPOrHTTPS()) {
           const auto http_root = out_uri.GetHttpRoot();
           if (http_root) {
-            cods_links_.Insert(*http_root, config_args);
+            (*cods)[http_root->GetPath()] = config_args;
           }
         }
       }
@@ -1313,6 +1752,8 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestServiceCommand(ProtocoledDa
     return HandleRequestClientPrepareService(dclient, req);
   } else if (req->method == DAEMON_SYNC_SERVICE) {
     return HandleRequestClientSyncService(dclient, req);
+  } else if (req->method == DAEMON_SUBSCRIBE_STATISTIC_SERVICE) {
+    return HandleRequestClientSubscribeStatisticService(dclient, req);
   } else if (req->method == DAEMON_STOP_SERVICE) {
     return HandleRequestClientStopService(dclient, req);
   } else if (req->method == DAEMON_ACTIVATE) {
@@ -1366,6 +1807,41 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestStreamsCommand(stream_clien
   return common::ErrnoError();
 }
 
+common::ErrnoError ProcessSlaveWrapper::HandleCompactFrameStreams(stream_client_t* pclient,
+                                                                  const CompactFrame& frame) {
+  UNUSED(pclient);
+  CHECK(loop_->IsLoopThread());
+  if (frame.type == COMPACT_FRAME_STATISTIC) {
+    StatisticInfo stat;
+    common::Error err = DecodeStatisticFrame(frame.payload, &stat);
+    if (err) {
+      const std::string err_str = err->GetDescription();
+      return common::make_errno_error(err_str, EAGAIN);
+    }
+
+    // clients still receive json, built once here instead of json + gzip in stream and parse in daemon
+    std::string stat_json;
+    err = stat.SerializeToString(&stat_json);
+    if (err) {
+      const std::string err_str = err->GetDescription();
+      return common::make_errno_error(err_str, EAGAIN);
+    }
+
+    stats_aggregator_->Update(stat.GetStreamStruct().id, stat_json);
+    return common::ErrnoError();
+  } else if (frame.type == COMPACT_FRAME_CHANGED_SOURCES) {
+    return BroadcastChangedSources(frame.payload);
+  }
+#if defined(MACHINE_LEARNING)
+  else if (frame.type == COMPACT_FRAME_ML_NOTIFICATION) {
+    return BroadcastMlNotification(frame.payload);
+  }
+#endif
+
+  WARNING_LOG() << "Received unknown frame type: " << static_cast<int>(frame.type);
+  return common::ErrnoError();
+}
+
 common::ErrnoError ProcessSlaveWrapper::HandleResponceStreamsCommand(stream_client_t* pclient,
                                                                      const fastotv::protocol::response_t* resp) {
   fastotv::protocol::request_t req;
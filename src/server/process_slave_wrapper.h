@@ -14,8 +14,11 @@
 
 #pragma once
 
+#include <deque>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <common/libev/io_loop_observer.h>
@@ -31,12 +34,28 @@
 #include "server/base/ihttp_requests_observer.h"
 #include "server/config.h"
 #include "server/links_holder_ts.h"
+#include "server/streamlink_resolver.h"
+
+#if defined(OS_LINUX)
+#define DVB_TUNER_ARG "--dvb-tuner"
+#endif
 
 namespace fastocloud {
+struct CompactFrame;
 namespace server {
 
 class Child;
+class ChildStream;
+#if defined(OS_LINUX)
+class DvbTunerManager;
+#endif
+class MetricsRegistry;
 class ProtocoledDaemonClient;
+class RetentionWorker;
+class StatisticAggregator;
+#if defined(OS_LINUX)
+class Zygote;
+#endif
 
 class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server::base::IHttpRequestsObserver {
  public:
@@ -44,7 +63,13 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
     node_stats_send_seconds = 10,
     ping_timeout_clients_seconds = 60,
     cleanup_seconds = 3,
-    check_license_timeout_seconds = 300
+    check_license_timeout_seconds = 300,
+    stream_stats_poll_seconds = 1,
+    client_stats_max_pending_bytes = 256 * 1024,  // slow client skips statistic flush
+    retention_removes_per_second = 2000,
+    streamlink_resolve_workers = 2,
+    dvb_tuners_check_seconds = 5,
+    http_listen_backlog = 1024
   };
   typedef StreamConfig serialized_stream_t;
   typedef fastotv::protocol::protocol_client_t stream_client_t;
@@ -53,6 +78,10 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
   ~ProcessSlaveWrapper() override;
 
   static common::ErrnoError SendStopDaemonRequest(const Config& config);
+#if defined(OS_LINUX)
+  // main of tuner process, daemon executes itself with DVB_TUNER_ARG source feed
+  static int ExecDvbTuner(const char* source_url, const char* feed_url);
+#endif
   common::net::HostAndPort GetServerHostAndPort();
 
   int Exec(int argc, char** argv) WARN_UNUSED_RESULT;
@@ -91,7 +120,12 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
   void StopImpl();
 
   Child* FindChildByID(fastotv::stream_id_t cid) const;
+  // registered is false for stream which process wasn't registered in loop yet
+  void StreamFinished(ChildStream* channel, int status, int signal, bool registered);
   void BroadcastClients(const fastotv::protocol::request_t& req);
+  bool HaveVerifiedClients() const;
+  void BroadcastStreamsStatistic();
+  void FlushStreamsStatistic();
 
   common::ErrnoError DaemonDataReceived(ProtocoledDaemonClient* dclient) WARN_UNUSED_RESULT;
   common::ErrnoError StreamDataReceived(stream_client_t* pclient) WARN_UNUSED_RESULT;
@@ -100,7 +134,25 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
   common::ErrnoError CreateChildStreamImpl(const serialized_stream_t& config_args,
                                            const StreamInfo& sha) WARN_UNUSED_RESULT;
   common::ErrnoError StopChildStream(const serialized_stream_t& config_args);
+  // false if some stream links not resolved yet, stream created again when they are ready
+  bool InsertResolvedStreamLinks(const serialized_stream_t& config_args, const StreamInfo& sha);
+  void SendResolvedLink(const StreamLinkResolver::Link& link);
   common::ErrnoError StopChildStreamImpl(fastotv::stream_id_t sid);
+#if defined(OS_LINUX)
+  common::ErrnoError StartZygote() WARN_UNUSED_RESULT;
+  void StopZygote();
+  // spawn results come asynchronously, streams get their pid registered in loop here
+  void ZygoteDataReceived();
+
+  // dvb sources of stream read feeds of shared tuners, source kept as is if tuner can't be started
+  // feeds go to DVB_TUNER_FEEDS_FIELD of per start config copy
+  void InsertDvbTunerFeeds(const serialized_stream_t& config_args, const StreamInfo& sha);
+  // fork and exec, forked daemon (has threads) only calls async signal safe functions before exec
+  common::ErrnoError StartDvbTuner(const common::uri::GURL& source, const common::uri::GURL& feed, pid_t* pid)
+      WARN_UNUSED_RESULT;
+  // false if child is not a tuner
+  bool DvbTunerExited(common::libev::IoChild* child, int status, int signal);
+#endif
 
   // stream
   common::ErrnoError HandleRequestChangedSourcesStream(stream_client_t* pclient,
@@ -111,7 +163,11 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
 #if defined(MACHINE_LEARNING)
   common::ErrnoError HandleRequestMlNotificationStream(stream_client_t* pclient,
                                                        const fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
+  common::ErrnoError BroadcastMlNotification(const std::string& notification_json) WARN_UNUSED_RESULT;
 #endif
+  common::ErrnoError BroadcastChangedSources(const std::string& changed_sources_json) WARN_UNUSED_RESULT;
+  common::ErrnoError HandleCompactFrameStreams(stream_client_t* pclient,
+                                               const CompactFrame& frame) WARN_UNUSED_RESULT;
 
   common::ErrnoError HandleRequestClientStartStream(ProtocoledDaemonClient* dclient,
                                                     const fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
@@ -129,6 +185,9 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
                                                        const fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
   common::ErrnoError HandleRequestClientSyncService(ProtocoledDaemonClient* dclient,
                                                     const fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
+  common::ErrnoError HandleRequestClientSubscribeStatisticService(ProtocoledDaemonClient* dclient,
+                                                                 const fastotv::protocol::request_t* req)
+      WARN_UNUSED_RESULT;
   common::ErrnoError HandleRequestClientActivate(ProtocoledDaemonClient* dclient,
                                                  const fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
   common::ErrnoError HandleRequestClientPingService(ProtocoledDaemonClient* dclient,
@@ -144,7 +203,9 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
   void CheckLicenseExpired();
 
   std::string MakeServiceStats(common::time64_t expiration_time) const;
-  void AddStreamLine(const serialized_stream_t& config_args);
+  void AddStreamLine(const serialized_stream_t& config_args,
+                     LinksHolderTS::configs_t* vods,
+                     LinksHolderTS::configs_t* cods);
 
   struct NodeStats;
 
@@ -154,28 +215,48 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
   char** process_argv_;
 
   common::libev::IoLoop* loop_;
+  // workers of one endpoint share handler, so online clients counted once per endpoint
+  typedef std::vector<common::libev::IoLoop*> workers_t;
   // http
-  common::libev::IoLoop* http_server_;
+  workers_t http_servers_;
   common::libev::IoLoopObserver* http_handler_;
   // vods (video on demand)
-  common::libev::IoLoop* vods_server_;
+  workers_t vods_servers_;
   common::libev::IoLoopObserver* vods_handler_;
   // cods (channel on demand)
-  common::libev::IoLoop* cods_server_;
+  workers_t cods_servers_;
   common::libev::IoLoopObserver* cods_handler_;
+  // metrics (prometheus scrapes)
+  workers_t metrics_servers_;
+  common::libev::IoLoopObserver* metrics_handler_;
 
   common::libev::timer_id_t ping_client_timer_;
   common::libev::timer_id_t check_cods_vods_timer_;
-  common::libev::timer_id_t check_old_files_timer_;
   common::libev::timer_id_t node_stats_timer_;
   common::libev::timer_id_t quit_cleanup_timer_;
   common::libev::timer_id_t check_license_timer_;
+  common::libev::timer_id_t stream_stats_timer_;
+#if defined(OS_LINUX)
+  common::libev::timer_id_t check_dvb_tuners_timer_;
+#endif
   NodeStats* node_stats_;
 
   LinksHolderTS vods_links_;
   LinksHolderTS cods_links_;
+  std::unordered_map<fastotv::stream_id_t, Child*> childs_by_id_;  // loop thread only
+  std::unordered_set<fastotv::stream_id_t> pending_starts_;        // waiting stream links, loop thread only
+#if defined(OS_LINUX)
+  Zygote* zygote_;                          // nullptr if stream processes forked from daemon
+  common::libev::IoClient* zygote_client_;  // zygote control socket in loop
+  std::deque<ChildStream*> zygote_spawns_;  // waiting pid, in order of requests, nullptr if creation failed
+  DvbTunerManager* dvb_tuners_;
+  std::unordered_map<common::libev::IoChild*, pid_t> dvb_tuner_childs_;  // tuner processes watched by loop
+#endif
 
-  std::vector<common::file_system::ascii_directory_string_path> folders_for_monitor_;
+  RetentionWorker* retention_;
+  StreamLinkResolver* streamlink_resolver_;
+  StatisticAggregator* stats_aggregator_;
+  MetricsRegistry* metrics_;
 };
 
 }  // namespace server
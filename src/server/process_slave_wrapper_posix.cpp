@@ -14,22 +14,29 @@
 
 #include "server/process_slave_wrapper.h"
 
+#include <dlfcn.h>
+#include <signal.h>
 #if defined(OS_LINUX)
 #include <sys/prctl.h>
 #endif
-
-#include <dlfcn.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <string>
+#include <vector>
+
 #include <common/file_system/file_system.h>
 #include <common/file_system/string_path_utils.h>
 
+#include "base/config_fields.h"
 #include "base/stream_info.h"
 
 #include "server/child_stream.h"
 #include "server/daemon/server.h"
 #include "server/utils/utils.h"
+#if defined(OS_LINUX)
+#include "server/zygote.h"
+#endif
 
 #include "stream/stream_wrapper.h"
 
@@ -41,9 +48,198 @@
 #include "tcp/client.h"
 #endif
 
+namespace {
+
+#if defined(OS_LINUX)
+class DvbTunerChild : public common::libev::IoChild {
+ public:
+  explicit DvbTunerChild(common::libev::IoLoop* server) : IoChild(server) {}
+};
+#endif
+
+std::string GetCoreLibraryPath() {
+  const std::string absolute_source_dir = common::file_system::absolute_path_from_relative(RELATIVE_SOURCE_DIR);
+  return common::file_system::make_path(absolute_source_dir, CORE_LIBRARY);
+}
+
+// fds: read command, write responce descriptors for pipes or child socket
+int StreamMain(stream_exec_t exec,
+               int argc,
+               char** argv,
+               const fastocloud::StreamConfig& config,
+               const std::vector<int>& fds,
+               fastocloud::StreamStatsBlock* stats_block) {
+  const fastotv::stream_id_t sid = fastocloud::GetSid(config);
+  const std::string new_process_name = common::MemSPrintf(STREAMER_NAME "_%s", sid);
+  fastocloud::server::ChangeProcessName(argc, argv, new_process_name);
+
+#if PIPE
+  fastocloud::server::pipe::Client* client = new fastocloud::server::pipe::Client(nullptr, fds[0], fds[1]);
+#else
+  fastocloud::server::tcp::Client* client =
+      new fastocloud::server::tcp::Client(nullptr, common::net::socket_info(fds[0]));
+#endif
+  client->SetName(sid);
+  int res = exec(new_process_name.c_str(), config.get(), client, stats_block);
+  ignore_result(client->Close());
+  delete client;
+  return res;
+}
+
+}  // namespace
+
 namespace fastocloud {
 namespace server {
 
+#if defined(OS_LINUX)
+common::ErrnoError ProcessSlaveWrapper::StartZygote() {
+  Zygote* zygote = new Zygote(process_argc_, process_argv_, StreamMain);
+  common::ErrnoError err = zygote->Start(GetCoreLibraryPath());
+  if (err) {
+    delete zygote;
+    return err;
+  }
+
+  zygote_ = zygote;
+  return common::ErrnoError();
+}
+
+void ProcessSlaveWrapper::StopZygote() {
+  destroy(&zygote_);
+}
+
+void ProcessSlaveWrapper::ZygoteDataReceived() {
+  while (true) {
+    Zygote::SpawnResult result;
+    common::ErrnoError err = zygote_->ReadSpawnResult(&result);
+    if (err && err->GetErrorCode() == EAGAIN) {
+      return;
+    }
+
+    if (err) {  // zygote is gone, waiting streams will not be started
+      ERROR_LOG() << "Zygote error: " << err->GetDescription() << ", streams will be forked from daemon";
+      loop_->UnRegisterClient(zygote_client_);
+      delete zygote_client_;
+      zygote_client_ = nullptr;
+      StopZygote();
+      while (!zygote_spawns_.empty()) {
+        ChildStream* channel = zygote_spawns_.front();
+        zygote_spawns_.pop_front();
+        if (channel) {
+          StreamFinished(channel, EXIT_FAILURE, 0, false);
+        }
+      }
+      return;
+    }
+
+    if (zygote_spawns_.empty()) {
+      WARNING_LOG() << "Unexpected zygote spawn result, pid: " << result.pid;
+      continue;
+    }
+
+    ChildStream* channel = zygote_spawns_.front();
+    zygote_spawns_.pop_front();
+    metrics_->ObserveZygoteSpawn(result.spawn_msec);
+    if (!channel) {  // creation failed after request was sent
+      if (result.pid > 0) {
+        kill(result.pid, SIGKILL);
+      }
+      continue;
+    }
+
+    if (result.pid < 0) {
+      WARNING_LOG() << "Zygote failed to spawn stream id: " << channel->GetStreamID()
+                    << ", error: " << common::make_errno_error(result.error)->GetDescription();
+      StreamFinished(channel, EXIT_FAILURE, 0, false);
+      continue;
+    }
+
+    // status of process exited before watcher registered is already reaped
+    if (kill(result.pid, 0) == ERROR_RESULT_VALUE && errno == ESRCH) {
+      StreamFinished(channel, EXIT_FAILURE, 0, false);
+      continue;
+    }
+
+    loop_->RegisterChild(channel, result.pid);
+  }
+}
+
+common::ErrnoError ProcessSlaveWrapper::StartDvbTuner(const common::uri::GURL& source,
+                                                      const common::uri::GURL& feed,
+                                                      pid_t* pid) {
+  // everything for exec prepared before fork, other threads may hold allocator or logger locks
+  const std::string process_name = STREAMER_NAME "_tuner";
+  const std::string source_url = source.spec();
+  const std::string feed_url = feed.spec();
+  char* const args[] = {const_cast<char*>(process_name.c_str()), const_cast<char*>(DVB_TUNER_ARG),
+                        const_cast<char*>(source_url.c_str()), const_cast<char*>(feed_url.c_str()), nullptr};
+  const long max_fd = sysconf(_SC_OPEN_MAX);
+  const pid_t parent = getpid();
+  const pid_t tuner_pid = fork();
+  if (tuner_pid < 0) {
+    return common::make_errno_error(errno);
+  }
+
+  if (tuner_pid == 0) {  // child
+    prctl(PR_SET_PDEATHSIG, SIGKILL);  // tuner has no sense without daemon, kept after exec
+    if (getppid() != parent) {
+      _exit(EXIT_FAILURE);
+    }
+
+    for (long fd = STDERR_FILENO + 1; fd < max_fd; ++fd) {  // daemon sockets and pipes
+      close(fd);
+    }
+    execv("/proc/self/exe", args);
+    _exit(EXIT_FAILURE);
+  }
+
+  common::libev::IoChild* tuner = new DvbTunerChild(loop_);
+  loop_->RegisterChild(tuner, tuner_pid);
+  dvb_tuner_childs_[tuner] = tuner_pid;
+  INFO_LOG() << "Tuner started, pid: " << tuner_pid << ", source: " << source_url;
+  *pid = tuner_pid;
+  return common::ErrnoError();
+}
+
+bool ProcessSlaveWrapper::DvbTunerExited(common::libev::IoChild* child, int status, int signal) {
+  auto it = dvb_tuner_childs_.find(child);
+  if (it == dvb_tuner_childs_.end()) {
+    return false;
+  }
+
+  const pid_t tuner_pid = it->second;
+  INFO_LOG() << "Tuner finished, pid: " << tuner_pid << ", exit with status: " << (status ? "FAILURE" : "SUCCESS")
+             << ", signal: " << signal;
+  dvb_tuners_->TunerExited(tuner_pid);  // reaped, pid may be reused from now
+  dvb_tuner_childs_.erase(it);
+  loop_->UnRegisterChild(child);
+  delete child;
+  return true;
+}
+
+int ProcessSlaveWrapper::ExecDvbTuner(const char* source_url, const char* feed_url) {
+  const std::string process_name = STREAMER_NAME "_tuner";
+  const std::string lib_full_path = GetCoreLibraryPath();
+  void* handle = dlopen(lib_full_path.c_str(), RTLD_LAZY);
+  if (!handle) {
+    ERROR_LOG() << "Failed to load " CORE_LIBRARY " path: " << lib_full_path << ", error: " << dlerror();
+    return EXIT_FAILURE;
+  }
+
+  tuner_exec_t tuner_exec_func = reinterpret_cast<tuner_exec_t>(dlsym(handle, "tuner_exec"));
+  char* error = dlerror();
+  if (error) {
+    ERROR_LOG() << "Failed to load start tuner function error: " << error;
+    dlclose(handle);
+    return EXIT_FAILURE;
+  }
+
+  int res = tuner_exec_func(process_name.c_str(), source_url, feed_url);
+  dlclose(handle);
+  return res;
+}
+#endif
+
 common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_stream_t& config_args,
                                                               const StreamInfo& sha) {
   const fastotv::stream_id_t sid = GetSid(config_args);
@@ -69,6 +265,7 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_s
     }
     return err;
   }
+  const std::vector<int> child_fds = {read_command_client, write_responce_client};
 #else
   common::net::socket_descr_t parent_sock;
   common::net::socket_descr_t child_sock;
@@ -76,78 +273,87 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_s
   if (err) {
     return err;
   }
+  const std::vector<int> child_fds = {child_sock};
 #endif
 
-#if !defined(TEST)
-  pid_t pid = fork();
-#else
-  pid_t pid = 0;
+#if PIPE
+  // both ends are built from this tree, so daemon just tells stream to use compact frames
+  config_args->Insert(PIPE_COMPACT_FRAMING_FIELD, common::Value::CreateBooleanValue(true));
 #endif
-  if (pid == 0) {  // child
-    typedef int (*stream_exec_t)(const char* process_name, const void* args, void* command_client);
 
-    const std::string absolute_source_dir = common::file_system::absolute_path_from_relative(RELATIVE_SOURCE_DIR);
-    const std::string lib_full_path = common::file_system::make_path(absolute_source_dir, CORE_LIBRARY);
-    void* handle = dlopen(lib_full_path.c_str(), RTLD_LAZY);
-    if (!handle) {
-      ERROR_LOG() << "Failed to load " CORE_LIBRARY " path: " << lib_full_path << ", error: " << dlerror();
-      _exit(EXIT_FAILURE);
+  StreamStatsBlock* stats_block = nullptr;
+  pid_t pid = -1;
+  bool zygote_spawn = false;
+#if defined(OS_LINUX) && !defined(TEST)
+  if (zygote_client_) {
+    int stats_fd = -1;
+    stats_block = StreamStatsBlock::CreateShareable(sha.input.size(), sha.output.size(), &stats_fd);
+    common::ErrnoError errn = zygote_->Spawn(config_args, child_fds, stats_fd);
+    if (stats_fd != -1) {
+      close(stats_fd);
     }
-
-    stream_exec_t stream_exec_func = reinterpret_cast<stream_exec_t>(dlsym(handle, "stream_exec"));
-    char* error = dlerror();
-    if (error) {
-      ERROR_LOG() << "Failed to load start stream function error: " << error;
-      dlclose(handle);
-      _exit(EXIT_FAILURE);
+    if (errn) {
+      DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
+      StreamStatsBlock::Destroy(stats_block);
+      stats_block = nullptr;
+    } else {
+      zygote_spawn = true;  // pid comes later in ZygoteDataReceived
     }
+  }
+#endif
 
-    const std::string new_process_name = common::MemSPrintf(STREAMER_NAME "_%s", sid);
-    const char* new_name = new_process_name.c_str();
-#if defined(OS_LINUX)
-    for (int i = 0; i < process_argc_; ++i) {
-      memset(process_argv_[i], 0, strlen(process_argv_[i]));
-    }
-    char* app_name = process_argv_[0];
-    strncpy(app_name, new_name, new_process_name.length());
-    app_name[new_process_name.length()] = 0;
-    prctl(PR_SET_NAME, new_name);
-#elif defined(OS_FREEBSD)
-    setproctitle(new_name);
+  if (!zygote_spawn) {  // plain fork of daemon, also fallback if zygote not available
+    stats_block = StreamStatsBlock::Create(sha.input.size(), sha.output.size());
+#if !defined(TEST)
+    pid = fork();
 #else
-#pragma message "Please implement"
+    pid = 0;
 #endif
+    if (pid == 0) {  // child
+      const std::string lib_full_path = GetCoreLibraryPath();
+      void* handle = dlopen(lib_full_path.c_str(), RTLD_LAZY);
+      if (!handle) {
+        ERROR_LOG() << "Failed to load " CORE_LIBRARY " path: " << lib_full_path << ", error: " << dlerror();
+        _exit(EXIT_FAILURE);
+      }
+
+      stream_exec_t stream_exec_func = reinterpret_cast<stream_exec_t>(dlsym(handle, "stream_exec"));
+      char* error = dlerror();
+      if (error) {
+        ERROR_LOG() << "Failed to load start stream function error: " << error;
+        dlclose(handle);
+        _exit(EXIT_FAILURE);
+      }
 
-#if PIPE
 #if !defined(TEST)
-    // close not needed pipes
-    common::ErrnoError errn = common::file_system::close_descriptor(read_responce_client);
-    if (errn) {
-      DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
-    }
-    errn = common::file_system::close_descriptor(write_requests_client);
-    if (errn) {
-      DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
-    }
-#endif
-    pipe::Client* client = new pipe::Client(nullptr, read_command_client, write_responce_client);
+#if PIPE
+      // close not needed pipes
+      common::ErrnoError errn = common::file_system::close_descriptor(read_responce_client);
+      if (errn) {
+        DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
+      }
+      errn = common::file_system::close_descriptor(write_requests_client);
+      if (errn) {
+        DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
+      }
 #else
-    // close not needed sock
-    common::ErrnoError errn = common::file_system::close_descriptor(parent_sock);
-    if (errn) {
-      DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
-    }
-    tcp::Client* client = new tcp::Client(nullptr, common::net::socket_info(child_sock));
+      // close not needed sock
+      common::ErrnoError errn = common::file_system::close_descriptor(parent_sock);
+      if (errn) {
+        DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
+      }
+#endif
 #endif
 
-    client->SetName(sid);
-    int res = stream_exec_func(new_name, config_args.get(), client);
-    ignore_result(client->Close());
-    delete client;
-    dlclose(handle);
-    _exit(res);
-  } else if (pid < 0) {
+      int res = StreamMain(stream_exec_func, process_argc_, process_argv_, config_args, child_fds, stats_block);
+      dlclose(handle);
+      _exit(res);
+    }
+  }
+
+  if (!zygote_spawn && pid < 0) {
     ERROR_LOG() << "Failed to start children!";
+    StreamStatsBlock::Destroy(stats_block);
   } else {
 #if PIPE
     // close not needed pipes
@@ -171,11 +377,29 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_s
     client->SetName(sid);
     bool registered = loop_->RegisterClient(client);
     if (!registered) {
+#if defined(OS_LINUX)
+      if (zygote_spawn) {
+        zygote_spawns_.push_back(nullptr);  // process killed when its pid comes
+      }
+#endif
+      StreamStatsBlock::Destroy(stats_block);
       return common::make_errno_error("Can't register communication pipe", EAGAIN);
     }
-    ChildStream* new_channel = new ChildStream(loop_, sha);
+    ChildStream* new_channel = new ChildStream(loop_, sha, stats_block);
     new_channel->SetClient(client);
+#if PIPE
+    new_channel->SetCompactFraming(true);
+#endif
+#if defined(OS_LINUX)
+    if (zygote_spawn) {
+      zygote_spawns_.push_back(new_channel);
+    } else {
+      loop_->RegisterChild(new_channel, pid);
+    }
+#else
     loop_->RegisterChild(new_channel, pid);
+#endif
+    childs_by_id_[sid] = new_channel;
   }
 
   return common::ErrnoError();
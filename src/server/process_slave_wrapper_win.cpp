@@ -110,9 +110,10 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStreamImpl(const serialized_s
   if (!registered) {
     return common::make_errno_error("Can't register communication pipe", EAGAIN);
   }
-  ChildStream* child = new ChildStream(loop_, sha);
+  ChildStream* child = new ChildStream(loop_, sha, nullptr);  // statistic only via pipe
   child->SetClient(sock_client);
   loop_->RegisterChild(child, pi.hProcess);
+  childs_by_id_[sid] = child;
   CloseHandle(pi.hThread);
   return common::ErrnoError();
 }
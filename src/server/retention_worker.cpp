@@ -0,0 +1,357 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/retention_worker.h"
+
+#if defined(OS_LINUX)
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include <common/file_system/file_system.h>
+#include <common/file_system/string_path_utils.h>
+#include <common/sprintf.h>
+#include <common/time.h>
+
+#include "base/utils.h"
+
+namespace {
+const int kTickMsec = 200;
+#if defined(OS_LINUX)
+const uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+#endif
+}  // namespace
+
+namespace fastocloud {
+namespace server {
+
+RetentionWorker::RetentionWorker(time_t files_ttl, const std::string& pattern, size_t max_removes_per_second)
+    : files_ttl_(files_ttl),
+      pattern_(pattern),
+      max_removes_per_second_(max_removes_per_second),
+      thread_(),
+      stop_(false),
+      folders_mutex_(),
+      new_folders_(),
+      folders_changed_(false),
+      folders_(),
+      queue_(),
+      dirs_(),
+      dir_ids_(),
+      watches_(),
+      inotify_fd_(INVALID_DESCRIPTOR),
+      need_rescan_(false),
+      remove_tokens_(0),
+      last_refill_msec_(0),
+      next_sweep_msec_(0),
+      files_removed_(0),
+      bytes_removed_(0),
+      files_queued_(0),
+      last_scan_msec_(0) {}
+
+RetentionWorker::~RetentionWorker() {
+  Stop();
+}
+
+void RetentionWorker::Start() {
+  if (thread_.joinable()) {
+    return;
+  }
+
+  stop_ = false;
+  thread_ = std::thread([this] { Run(); });
+}
+
+void RetentionWorker::Stop() {
+  stop_ = true;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void RetentionWorker::SetFolders(const std::vector<folder_t>& folders) {
+  std::unique_lock<std::mutex> lock(folders_mutex_);
+  new_folders_ = folders;
+  folders_changed_ = true;
+}
+
+RetentionWorker::Stats RetentionWorker::GetStats() const {
+  return {files_removed_, bytes_removed_, files_queued_, last_scan_msec_};
+}
+
+bool RetentionWorker::TakeFolders(std::vector<folder_t>* folders) {
+  std::unique_lock<std::mutex> lock(folders_mutex_);
+  if (!folders_changed_) {
+    return false;
+  }
+
+  *folders = new_folders_;
+  folders_changed_ = false;
+  return true;
+}
+
+void RetentionWorker::Run() {
+#if defined(OS_LINUX)
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ == INVALID_DESCRIPTOR) {
+    WARNING_LOG() << "Retention can't init inotify, error: " << strerror(errno);
+  }
+#endif
+
+  while (!stop_) {
+    std::vector<folder_t> folders;
+    if (TakeFolders(&folders)) {
+      folders_ = folders;
+      need_rescan_ = true;
+    }
+
+#if defined(OS_LINUX)
+    if (inotify_fd_ == INVALID_DESCRIPTOR) {  // without events rescan every tick of ttl
+      const fastotv::timestamp_t now_msec = common::time::current_utc_mstime();
+      if (now_msec >= next_sweep_msec_) {
+        need_rescan_ = true;
+        next_sweep_msec_ = now_msec + files_ttl_ * 1000 / 10;
+      }
+    }
+    if (need_rescan_) {
+      Rescan();
+    }
+    WaitEvents(kTickMsec);
+    RemoveExpired(common::time::current_utc_mstime() / 1000);
+    files_queued_ = queue_.size();
+#else
+    const fastotv::timestamp_t now_msec = common::time::current_utc_mstime();
+    if (need_rescan_ || now_msec >= next_sweep_msec_) {
+      need_rescan_ = false;
+      next_sweep_msec_ = now_msec + files_ttl_ * 1000 / 10;
+      Sweep();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(kTickMsec));
+#endif
+  }
+
+#if defined(OS_LINUX)
+  if (inotify_fd_ != INVALID_DESCRIPTOR) {
+    close(inotify_fd_);
+    inotify_fd_ = INVALID_DESCRIPTOR;
+  }
+#endif
+}
+
+#if defined(OS_LINUX)
+void RetentionWorker::Rescan() {
+  need_rescan_ = false;
+  if (inotify_fd_ != INVALID_DESCRIPTOR) {
+    for (auto it = watches_.begin(); it != watches_.end(); ++it) {
+      inotify_rm_watch(inotify_fd_, it->first);
+    }
+  }
+  watches_.clear();
+  queue_ = expire_queue_t();
+  dirs_.clear();
+  dir_ids_.clear();
+
+  const fastotv::timestamp_t start_msec = common::time::current_utc_mstime();
+  for (const folder_t& folder : folders_) {
+    if (folder.IsValid()) {
+      ScanDir(folder.GetPath());
+    }
+  }
+  last_scan_msec_ = common::time::current_utc_mstime() - start_msec;
+  INFO_LOG() << "Retention scan finished in " << last_scan_msec_ << " msec, files queued: " << queue_.size();
+}
+
+uint32_t RetentionWorker::RegisterDir(const std::string& path) {
+  const auto it = dir_ids_.find(path);
+  if (it != dir_ids_.end()) {
+    return it->second;
+  }
+
+  const uint32_t dir_id = static_cast<uint32_t>(dirs_.size());
+  dirs_.push_back(path);
+  dir_ids_[path] = dir_id;
+  return dir_id;
+}
+
+void RetentionWorker::ScanDir(const std::string& path) {
+  // watch before listing, so files created meanwhile are not lost
+  const uint32_t dir_id = RegisterDir(path);
+  if (inotify_fd_ != INVALID_DESCRIPTOR) {
+    int wd = inotify_add_watch(inotify_fd_, path.c_str(), kWatchMask);
+    if (wd != INVALID_DESCRIPTOR) {
+      watches_[wd] = dir_id;
+    }
+  }
+
+  DIR* dirp = opendir(path.c_str());
+  if (!dirp) {
+    return;
+  }
+
+  const int dfd = dirfd(dirp);
+  struct dirent* dent;
+  while ((dent = readdir(dirp)) != nullptr) {
+    if (!strcmp(dent->d_name, ".") || !strcmp(dent->d_name, "..")) {
+      continue;
+    }
+
+    if (dent->d_type == DT_DIR) {
+      ScanDir(common::MemSPrintf("%s%s/", path, dent->d_name));
+      continue;
+    }
+
+    if (!common::MatchPattern(dent->d_name, pattern_)) {
+      continue;
+    }
+
+    struct stat st;
+    if (fstatat(dfd, dent->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISREG(st.st_mode)) {
+      queue_.push({st.st_mtime + files_ttl_, dir_id, dent->d_name});
+    }
+  }
+  closedir(dirp);
+}
+
+void RetentionWorker::WaitEvents(int timeout_msec) {
+  if (inotify_fd_ == INVALID_DESCRIPTOR) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout_msec));
+    return;
+  }
+
+  struct pollfd pfd = {inotify_fd_, POLLIN, 0};
+  if (poll(&pfd, 1, timeout_msec) <= 0) {
+    return;
+  }
+
+  alignas(struct inotify_event) char buffer[64 * 1024];
+  while (true) {
+    ssize_t nread = read(inotify_fd_, buffer, sizeof(buffer));
+    if (nread <= 0) {
+      break;
+    }
+
+    const time_t now = common::time::current_utc_mstime() / 1000;
+    for (char* ptr = buffer; ptr < buffer + nread;) {
+      const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+      ptr += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {  // lost events, only full scan can restore queue
+        need_rescan_ = true;
+        continue;
+      }
+
+      const auto it = watches_.find(event->wd);
+      if (it == watches_.end()) {
+        continue;
+      }
+
+      const uint32_t dir_id = it->second;
+      if (event->mask & IN_IGNORED) {  // folder removed
+        watches_.erase(it);
+        continue;
+      }
+
+      if (!event->len) {
+        continue;
+      }
+
+      if (event->mask & IN_ISDIR) {
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+          ScanDir(common::MemSPrintf("%s%s/", dirs_[dir_id], event->name));
+        }
+      } else if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) && common::MatchPattern(event->name, pattern_)) {
+        queue_.push({now + files_ttl_, dir_id, event->name});
+      }
+    }
+  }
+}
+
+void RetentionWorker::RemoveExpired(time_t now) {
+  const fastotv::timestamp_t now_msec = common::time::current_utc_mstime();
+  if (last_refill_msec_) {
+    remove_tokens_ += static_cast<double>(now_msec - last_refill_msec_) * max_removes_per_second_ / 1000;
+    remove_tokens_ = std::min(remove_tokens_, static_cast<double>(max_removes_per_second_));
+  }
+  last_refill_msec_ = now_msec;
+
+  std::vector<Entry> batch;
+  while (!queue_.empty() && queue_.top().expire_time <= now && batch.size() + 1 <= remove_tokens_) {
+    batch.push_back(queue_.top());
+    queue_.pop();
+  }
+  if (batch.empty()) {
+    return;
+  }
+
+  remove_tokens_ -= batch.size();
+  // one descriptor per folder, files removed relative to it
+  std::sort(batch.begin(), batch.end(), [](const Entry& left, const Entry& right) { return left.dir_id < right.dir_id; });
+  int dfd = INVALID_DESCRIPTOR;
+  uint32_t opened_dir = 0;
+  for (const Entry& entry : batch) {
+    if (dfd == INVALID_DESCRIPTOR || opened_dir != entry.dir_id) {
+      if (dfd != INVALID_DESCRIPTOR) {
+        close(dfd);
+      }
+      opened_dir = entry.dir_id;
+      dfd = open(dirs_[entry.dir_id].c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    }
+    if (dfd == INVALID_DESCRIPTOR) {
+      continue;
+    }
+
+    struct stat st;
+    if (fstatat(dfd, entry.name.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0) {
+      continue;
+    }
+
+    const time_t expire_time = st.st_mtime + files_ttl_;
+    if (expire_time > now) {  // rewritten after it was queued
+      queue_.push({expire_time, entry.dir_id, entry.name});
+      continue;
+    }
+
+    if (unlinkat(dfd, entry.name.c_str(), 0) == 0) {
+      files_removed_++;
+      bytes_removed_ += st.st_size;
+    } else {
+      WARNING_LOG() << "Can't remove file: " << dirs_[entry.dir_id] << entry.name << ", error: " << strerror(errno);
+    }
+  }
+  if (dfd != INVALID_DESCRIPTOR) {
+    close(dfd);
+  }
+}
+#else
+void RetentionWorker::Sweep() {
+  const fastotv::timestamp_t start_msec = common::time::current_utc_mstime();
+  const time_t max_life_time = start_msec / 1000 - files_ttl_;
+  for (const folder_t& folder : folders_) {
+    RemoveOldFilesByTime(folder, max_life_time, pattern_.c_str(), true);
+  }
+  last_scan_msec_ = common::time::current_utc_mstime() - start_msec;
+}
+#endif
+
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,114 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <common/file_system/path.h>
+
+#include <fastotv/types.h>
+
+namespace fastocloud {
+namespace server {
+
+// Removes expired chunks of monitored folders out of daemon loop.
+// On Linux folders scanned once, after that new files come from inotify into time ordered expiry queue,
+// expired files removed in batches with unlinkat and rate limited, so huge trees don't stall anything.
+// Other platforms sweep folders periodically, but also in own thread.
+class RetentionWorker {
+ public:
+  typedef common::file_system::ascii_directory_string_path folder_t;
+
+  struct Stats {
+    uint64_t files_removed;
+    uint64_t bytes_removed;
+    uint64_t files_queued;
+    fastotv::timestamp_t last_scan_msec;
+  };
+
+  RetentionWorker(time_t files_ttl, const std::string& pattern, size_t max_removes_per_second);
+  ~RetentionWorker();
+
+  void Start();
+  void Stop();
+
+  // replaces monitored folders, thread safe
+  void SetFolders(const std::vector<folder_t>& folders);
+
+  Stats GetStats() const;
+
+ private:
+  struct Entry {
+    time_t expire_time;
+    uint32_t dir_id;
+    std::string name;
+
+    bool operator>(const Entry& other) const { return expire_time > other.expire_time; }
+  };
+  typedef std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> expire_queue_t;
+
+  void Run();
+  bool TakeFolders(std::vector<folder_t>* folders);
+
+#if defined(OS_LINUX)
+  void Rescan();
+  void ScanDir(const std::string& path);
+  uint32_t RegisterDir(const std::string& path);
+  void WaitEvents(int timeout_msec);
+  void RemoveExpired(time_t now);
+#else
+  void Sweep();
+#endif
+
+  const time_t files_ttl_;
+  const std::string pattern_;
+  const size_t max_removes_per_second_;
+
+  std::thread thread_;
+  std::atomic<bool> stop_;
+
+  std::mutex folders_mutex_;
+  std::vector<folder_t> new_folders_;
+  bool folders_changed_;
+
+  // worker thread only
+  std::vector<folder_t> folders_;
+  expire_queue_t queue_;
+  std::vector<std::string> dirs_;
+  std::unordered_map<std::string, uint32_t> dir_ids_;
+  std::unordered_map<int, uint32_t> watches_;
+  int inotify_fd_;
+  bool need_rescan_;
+  double remove_tokens_;
+  fastotv::timestamp_t last_refill_msec_;
+  fastotv::timestamp_t next_sweep_msec_;
+
+  std::atomic<uint64_t> files_removed_;
+  std::atomic<uint64_t> bytes_removed_;
+  std::atomic<uint64_t> files_queued_;
+  std::atomic<fastotv::timestamp_t> last_scan_msec_;
+};
+
+}  // namespace server
+}  // namespace fastocloud
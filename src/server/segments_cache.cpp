@@ -0,0 +1,296 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/segments_cache.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(OS_LINUX)
+#include <sys/inotify.h>
+#endif
+
+#include <string>
+#include <utility>
+
+#include <common/string_util.h>
+#include <common/time.h>
+
+#include "base/types.h"
+
+namespace fastocloud {
+namespace server {
+
+namespace {
+std::string GetExtension(const std::string& path) {
+  const size_t slash = path.rfind('/');
+  const size_t dot = path.rfind('.');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+    return std::string();
+  }
+  return path.substr(dot + 1);
+}
+
+bool IsPlaylist(const std::string& path) {
+  return common::EqualsASCII(GetExtension(path), M3U8_EXTENSION, false);
+}
+
+std::string GetDirectory(const std::string& path) {
+  const size_t slash = path.rfind('/');
+  if (slash == std::string::npos) {
+    return ".";
+  }
+  return path.substr(0, slash);
+}
+}  // namespace
+
+SegmentsCache::SegmentsCache(size_t max_bytes, size_t max_segment_size, common::time64_t revalidate_msec)
+    : max_bytes_(max_bytes),
+      max_segment_size_(max_segment_size),
+      revalidate_msec_(revalidate_msec),
+      mutex_(),
+      entries_(),
+      lru_(),
+      total_bytes_(0),
+#if defined(OS_LINUX)
+      inotify_fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+#else
+      inotify_fd_(INVALID_DESCRIPTOR),
+#endif
+      watches_(),
+      watched_dirs_(),
+      invalidations_(0) {}
+
+SegmentsCache::~SegmentsCache() {
+  if (inotify_fd_ != INVALID_DESCRIPTOR) {
+    ::close(inotify_fd_);
+  }
+}
+
+bool SegmentsCache::IsCacheable(const std::string& path) {
+  const std::string ext = GetExtension(path);
+  return common::EqualsASCII(ext, M3U8_EXTENSION, false) || common::EqualsASCII(ext, TS_EXTENSION, false);
+}
+
+SegmentsCache::segment_t SegmentsCache::Get(const std::string& path, const char* mime) {
+  if (!IsCacheable(path)) {
+    return nullptr;
+  }
+
+  const common::time64_t now = common::time::current_utc_mstime();
+  segment_t cached = FindValid(path, now);
+  if (cached) {
+    return cached;
+  }
+
+  // watch before reading, so write after read is never missed
+  bool watched = false;
+  uint64_t invalidations = 0;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    watched = WatchDirectory(GetDirectory(path));
+    invalidations = invalidations_;
+  }
+
+  struct stat sb;
+  if (stat(path.c_str(), &sb) < 0 || !S_ISREG(sb.st_mode) || static_cast<size_t>(sb.st_size) > max_segment_size_) {
+    Remove(path);
+    return nullptr;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    DrainEvents();
+    auto it = entries_.find(path);
+    if (it != entries_.end() && it->second.segment->version == base::MakeFileVersion(sb)) {
+      it->second.validated_msec = now;
+      it->second.watched = watched && invalidations == invalidations_;
+      lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+      return it->second.segment;
+    }
+  }
+
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == INVALID_DESCRIPTOR) {
+    Remove(path);
+    return nullptr;
+  }
+
+  std::shared_ptr<Segment> segment = std::make_shared<Segment>();
+  segment->data.resize(sb.st_size);
+  segment->mime = mime ? mime : std::string();
+  segment->version = base::MakeFileVersion(sb);
+  size_t total = 0;
+  while (total < segment->data.size()) {
+    ssize_t nread = read(fd, &segment->data[total], segment->data.size() - total);
+    if (nread <= 0) {
+      break;
+    }
+    total += nread;
+  }
+  ::close(fd);
+
+  if (total != segment->data.size()) {  // file truncated while reading
+    Remove(path);
+    return nullptr;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  DrainEvents();
+  Store(path, segment, now, watched && invalidations == invalidations_);
+  return segment;
+}
+
+void SegmentsCache::Clear() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  entries_.clear();
+  lru_.clear();
+  total_bytes_ = 0;
+}
+
+size_t SegmentsCache::GetTotalBytes() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return total_bytes_;
+}
+
+SegmentsCache::segment_t SegmentsCache::FindValid(const std::string& path, common::time64_t now) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  DrainEvents();
+  auto it = entries_.find(path);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+
+  if (!it->second.watched) {
+    if (IsPlaylist(path) || now - it->second.validated_msec > revalidate_msec_) {
+      return nullptr;
+    }
+  }
+
+  lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+  return it->second.segment;
+}
+
+void SegmentsCache::Store(const std::string& path, segment_t segment, common::time64_t now, bool watched) {
+  RemoveLocked(path);
+  lru_.push_front(path);
+  total_bytes_ += segment->data.size();
+  entries_[path] = {segment, now, watched, lru_.begin()};
+  EvictIfNeeded();
+}
+
+void SegmentsCache::Remove(const std::string& path) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  RemoveLocked(path);
+}
+
+void SegmentsCache::RemoveLocked(const std::string& path) {
+  auto it = entries_.find(path);
+  if (it == entries_.end()) {
+    return;
+  }
+
+  total_bytes_ -= it->second.segment->data.size();
+  lru_.erase(it->second.lru_it);
+  entries_.erase(it);
+}
+
+void SegmentsCache::EvictIfNeeded() {
+  while (total_bytes_ > max_bytes_ && !lru_.empty()) {
+    const std::string& oldest = lru_.back();
+    auto it = entries_.find(oldest);
+    if (it != entries_.end()) {
+      total_bytes_ -= it->second.segment->data.size();
+      entries_.erase(it);
+    }
+    lru_.pop_back();
+  }
+}
+
+bool SegmentsCache::WatchDirectory(const std::string& dir) {
+#if defined(OS_LINUX)
+  if (inotify_fd_ == INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  if (watched_dirs_.find(dir) != watched_dirs_.end()) {
+    return true;
+  }
+
+  const int wd = inotify_add_watch(inotify_fd_, dir.c_str(),
+                                   IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_ONLYDIR);
+  if (wd < 0) {
+    return false;
+  }
+
+  watches_[wd] = dir;
+  watched_dirs_[dir] = wd;
+  return true;
+#else
+  UNUSED(dir);
+  return false;
+#endif
+}
+
+void SegmentsCache::DrainEvents() {
+#if defined(OS_LINUX)
+  if (inotify_fd_ == INVALID_DESCRIPTOR) {
+    return;
+  }
+
+  alignas(struct inotify_event) char buff[16 * 1024];
+  while (true) {
+    ssize_t len = read(inotify_fd_, buff, sizeof(buff));
+    if (len <= 0) {
+      return;
+    }
+
+    for (ssize_t pos = 0; pos < len;) {
+      const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buff + pos);
+      pos += sizeof(struct inotify_event) + event->len;
+      invalidations_++;
+      if (event->mask & IN_Q_OVERFLOW) {  // events lost, nothing cached can be trusted
+        entries_.clear();
+        lru_.clear();
+        total_bytes_ = 0;
+        continue;
+      }
+
+      auto it = watches_.find(event->wd);
+      if (it == watches_.end()) {
+        continue;
+      }
+
+      if (event->mask & IN_IGNORED) {  // directory removed, its entries are not watched anymore
+        const std::string prefix = it->second + "/";
+        for (auto& entry : entries_) {
+          if (entry.first.compare(0, prefix.size(), prefix) == 0) {
+            entry.second.watched = false;
+          }
+        }
+        watched_dirs_.erase(it->second);
+        watches_.erase(it);
+        continue;
+      }
+
+      if (event->len) {
+        RemoveLocked(it->second + "/" + event->name);
+      }
+    }
+  }
+#endif
+}
+
+}  // namespace server
+}  // namespace fastocloud
@@ -0,0 +1,91 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <common/types.h>
+
+#include "server/base/http_file_reply.h"
+
+namespace fastocloud {
+namespace server {
+
+// Size bounded LRU of playlists and chunks shared between http workers, other files are never cached.
+// On linux directories of cached files are watched with inotify, entry is dropped as soon as its file is
+// rewritten (IN_CLOSE_WRITE), replaced by rename (IN_MOVED_TO) or deleted; events are drained on every lookup.
+// Without watch (no inotify, watch limit reached) playlists are revalidated by file version on every lookup and
+// chunks at most once per revalidate period.
+class SegmentsCache {
+ public:
+  struct Segment {
+    std::string data;
+    std::string mime;
+    base::FileVersion version;
+  };
+  typedef std::shared_ptr<const Segment> segment_t;
+
+  SegmentsCache(size_t max_bytes, size_t max_segment_size, common::time64_t revalidate_msec);
+  ~SegmentsCache();
+
+  // nullptr if file not exists, is not playlist or chunk, or too big for caching
+  segment_t Get(const std::string& path, const char* mime);
+  void Clear();
+
+  size_t GetTotalBytes() const;
+
+  static bool IsCacheable(const std::string& path);
+
+ private:
+  struct Entry {
+    segment_t segment;
+    common::time64_t validated_msec;
+    bool watched;  // invalidated by inotify events, no revalidation needed
+    std::list<std::string>::iterator lru_it;
+  };
+
+  segment_t FindValid(const std::string& path, common::time64_t now);
+  void Store(const std::string& path, segment_t segment, common::time64_t now, bool watched);
+  void Remove(const std::string& path);
+  void RemoveLocked(const std::string& path);
+  void EvictIfNeeded();
+
+  // called with mutex held
+  bool WatchDirectory(const std::string& dir);
+  void DrainEvents();
+
+  const size_t max_bytes_;
+  const size_t max_segment_size_;
+  const common::time64_t revalidate_msec_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::list<std::string> lru_;  // front is most recently used
+  size_t total_bytes_;
+
+  int inotify_fd_;
+  std::unordered_map<int, std::string> watches_;  // watch descriptor -> directory
+  std::unordered_map<std::string, int> watched_dirs_;
+  uint64_t invalidations_;  // drained events, entry loaded meanwhile may be stale so is not trusted as watched
+};
+
+}  // namespace server
+}  // namespace fastocloud
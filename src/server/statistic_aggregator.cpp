@@ -0,0 +1,113 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/statistic_aggregator.h"
+
+namespace fastocloud {
+namespace server {
+
+StatisticAggregator::ClientState::ClientState() : batched(false), streams(), delivered(0) {}
+
+StatisticAggregator::StatisticAggregator() : version_(0), entries_(), clients_(), skipped_(0) {}
+
+void StatisticAggregator::Update(fastotv::stream_id_t sid, const std::string& stat_json) {
+  Entry& entry = entries_[sid];
+  entry.stat_json = stat_json;
+  entry.version = ++version_;
+}
+
+void StatisticAggregator::Remove(fastotv::stream_id_t sid) {
+  entries_.erase(sid);
+}
+
+void StatisticAggregator::Subscribe(client_t client, const streams_filter_t& streams) {
+  ClientState* state = GetState(client);
+  state->batched = true;
+  state->streams = std::unordered_set<fastotv::stream_id_t>(streams.begin(), streams.end());
+  state->delivered = 0;  // full snapshot on next flush
+}
+
+void StatisticAggregator::Forget(client_t client) {
+  clients_.erase(client);
+}
+
+bool StatisticAggregator::IsBatched(client_t client) const {
+  auto it = clients_.find(client);
+  if (it == clients_.end()) {
+    return false;
+  }
+
+  return it->second.batched;
+}
+
+std::vector<std::string> StatisticAggregator::TakeChanges(client_t client) {
+  ClientState* state = GetState(client);
+  std::vector<std::string> changes;
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->second.version <= state->delivered) {
+      continue;
+    }
+    if (!state->streams.empty() && state->streams.find(it->first) == state->streams.end()) {
+      continue;
+    }
+    changes.push_back(it->second.stat_json);
+  }
+  state->delivered = version_;
+  return changes;
+}
+
+bool StatisticAggregator::TakeBatch(client_t client, std::string* batch_json) {
+  if (!batch_json) {
+    return false;
+  }
+
+  const std::vector<std::string> changes = TakeChanges(client);
+  if (changes.empty()) {
+    return false;
+  }
+
+  size_t total = 2;
+  for (const std::string& stat : changes) {
+    total += stat.size() + 1;
+  }
+
+  std::string batch;
+  batch.reserve(total);
+  batch += '[';
+  for (size_t i = 0; i < changes.size(); ++i) {
+    if (i) {
+      batch += ',';
+    }
+    batch += changes[i];
+  }
+  batch += ']';
+  *batch_json = batch;
+  return true;
+}
+
+void StatisticAggregator::MarkSkipped(client_t client) {
+  GetState(client);
+  skipped_++;
+}
+
+size_t StatisticAggregator::GetSkippedCount() const {
+  return skipped_;
+}
+
+StatisticAggregator::ClientState* StatisticAggregator::GetState(client_t client) {
+  return &clients_[client];
+}
+
+}  // namespace server
+}  // namespace fastocloud
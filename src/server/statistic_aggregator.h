@@ -0,0 +1,90 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <common/macros.h>
+
+#include "base/types.h"
+
+namespace common {
+namespace libev {
+class IoClient;
+}
+}  // namespace common
+
+namespace fastocloud {
+namespace server {
+
+// Keeps latest serialized statistic per stream and hands every daemon client only streams changed since its last
+// delivery. Client which can't keep up simply skips flushes, older values are overwritten by newer (drop-oldest).
+// Loop thread only.
+class StatisticAggregator {
+ public:
+  typedef common::libev::IoClient* client_t;
+  typedef std::vector<fastotv::stream_id_t> streams_filter_t;  // empty - all streams
+
+  StatisticAggregator();
+
+  void Update(fastotv::stream_id_t sid, const std::string& stat_json);
+  void Remove(fastotv::stream_id_t sid);
+
+  // subscribed clients receive one batch per flush instead of message per stream
+  void Subscribe(client_t client, const streams_filter_t& streams);
+  void Forget(client_t client);
+  bool IsBatched(client_t client) const;
+
+  // serialized statistics changed since last take for this client, filtered by subscription
+  std::vector<std::string> TakeChanges(client_t client);
+  // json array of TakeChanges, false if nothing changed
+  bool TakeBatch(client_t client, std::string* batch_json);
+
+  void MarkSkipped(client_t client);
+  size_t GetSkippedCount() const;
+
+ private:
+  typedef uint64_t version_t;
+
+  struct Entry {
+    std::string stat_json;
+    version_t version;
+  };
+
+  struct ClientState {
+    ClientState();
+
+    bool batched;
+    std::unordered_set<fastotv::stream_id_t> streams;
+    version_t delivered;
+  };
+
+  ClientState* GetState(client_t client);
+
+  version_t version_;
+  std::unordered_map<fastotv::stream_id_t, Entry> entries_;
+  std::unordered_map<client_t, ClientState> clients_;
+  size_t skipped_;
+
+  DISALLOW_COPY_AND_ASSIGN(StatisticAggregator);
+};
+
+}  // namespace server
+}  // namespace fastocloud
@@ -54,7 +54,7 @@ int main(int argc, char** argv) {
     return EXIT_FAILURE;
   }
 
-  typedef int (*stream_exec_t)(const char* process_name, const void* args, void* command_client);
+  typedef int (*stream_exec_t)(const char* process_name, const void* args, void* command_client, void* stats_block);
   stream_exec_t stream_exec_func = reinterpret_cast<stream_exec_t>(GetProcAddress(dll, "stream_exec"));
   if (!stream_exec_func) {
     std::cerr << "Failed to load start stream function error: " << GetLastError();
@@ -103,7 +103,7 @@ int main(int argc, char** argv) {
   const std::string new_process_name = common::MemSPrintf(STREAMER_NAME "_%s", sid);
   const char* new_name = new_process_name.c_str();
   int res = stream_exec_func(new_name, params_config.get(),
-                             new fastocloud::server::tcp::Client(nullptr, common::net::socket_info(cfd)));
+                             new fastocloud::server::tcp::Client(nullptr, common::net::socket_info(cfd)), nullptr);
   FreeLibrary(dll);
   return res;
 }
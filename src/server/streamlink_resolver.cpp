@@ -0,0 +1,253 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/streamlink_resolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+
+#include <common/time.h>
+
+#include "base/stream_link.h"
+
+namespace fastocloud {
+namespace server {
+
+StreamLinkResolver::StreamLinkResolver(const std::string& script_path,
+                                       size_t workers_count,
+                                       link_callback_t refreshed_cb)
+    : script_path_(script_path),
+      workers_count_(std::max<size_t>(workers_count, 1)),
+      refreshed_cb_(refreshed_cb),
+      workers_(),
+      entries_mutex_(),
+      entries_cond_(),
+      stop_(false),
+      queue_(),
+      entries_() {}
+
+StreamLinkResolver::~StreamLinkResolver() {
+  Stop();
+}
+
+void StreamLinkResolver::Start() {
+  std::unique_lock<std::mutex> lock(entries_mutex_);
+  if (!workers_.empty()) {
+    return;
+  }
+
+  stop_ = false;
+  for (size_t i = 0; i < workers_count_; ++i) {
+    workers_.push_back(std::thread(&StreamLinkResolver::WorkerRoutine, this));
+  }
+}
+
+void StreamLinkResolver::Stop() {
+  {
+    std::unique_lock<std::mutex> lock(entries_mutex_);
+    stop_ = true;
+    entries_cond_.notify_all();
+  }
+
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+bool StreamLinkResolver::Find(const InputUri& src, Link* link) {
+  if (!link) {
+    return false;
+  }
+
+  const fastotv::timestamp_t now = common::time::current_utc_mstime();
+  std::unique_lock<std::mutex> lock(entries_mutex_);
+  Entry* entry = GetEntry(src, now);
+  if (!IsFresh(*entry, now)) {
+    return false;
+  }
+
+  *link = entry->link;
+  return true;
+}
+
+void StreamLinkResolver::Resolve(const InputUri& src, link_callback_t cb) {
+  const fastotv::timestamp_t now = common::time::current_utc_mstime();
+  std::unique_lock<std::mutex> lock(entries_mutex_);
+  Entry* entry = GetEntry(src, now);
+  if (!entry->in_flight && IsFresh(*entry, now)) {
+    const Link link = entry->link;
+    lock.unlock();
+    if (cb) {
+      cb(link);
+    }
+    return;
+  }
+
+  if (cb) {
+    entry->waiters.push_back(cb);
+  }
+  if (!entry->in_flight) {
+    entry->in_flight = true;
+    queue_.push_back(MakeKey(src));
+    entries_cond_.notify_one();
+  }
+}
+
+void StreamLinkResolver::Acquire(const InputUri& src) {
+  const fastotv::timestamp_t now = common::time::current_utc_mstime();
+  std::unique_lock<std::mutex> lock(entries_mutex_);
+  GetEntry(src, now)->users++;
+}
+
+void StreamLinkResolver::Release(const InputUri& src) {
+  const fastotv::timestamp_t now = common::time::current_utc_mstime();
+  std::unique_lock<std::mutex> lock(entries_mutex_);
+  Entry* entry = GetEntry(src, now);
+  if (entry->users) {
+    entry->users--;
+  }
+}
+
+std::string StreamLinkResolver::MakeKey(const InputUri& src) {
+  std::string key = src.GetUrl().spec();
+  const auto link = src.GetStreamLink();
+  if (link) {
+    const auto http = link->GetHttp();
+    const auto https = link->GetHttps();
+    key += "|" + (http ? http->spec() : std::string()) + "|" + (https ? https->spec() : std::string());
+  }
+  return key;
+}
+
+bool StreamLinkResolver::IsFresh(const Entry& entry, fastotv::timestamp_t now) {
+  if (!entry.resolved) {
+    return false;
+  }
+
+  if (!entry.link.url.is_valid()) {  // failed, don't retry too often
+    return entry.link.expire_utc_msec > now;
+  }
+  return entry.link.expire_utc_msec > now + refresh_ahead_sec * 1000;
+}
+
+StreamLinkResolver::Entry* StreamLinkResolver::GetEntry(const InputUri& src, fastotv::timestamp_t now) {
+  const std::string key = MakeKey(src);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    Entry entry;
+    entry.src = src;
+    entry.link = {src.GetUrl(), common::uri::GURL(), 0};
+    entry.resolved = false;
+    entry.in_flight = false;
+    entry.users = 0;
+    it = entries_.insert(std::make_pair(key, entry)).first;
+  }
+  it->second.last_used_msec = now;
+  return &it->second;
+}
+
+void StreamLinkResolver::ScheduleRefresh(fastotv::timestamp_t now, fastotv::timestamp_t* next_check) {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    Entry& entry = it->second;
+    if (entry.in_flight || !entry.resolved) {
+      ++it;
+      continue;
+    }
+
+    if (!entry.users) {
+      if (now - entry.last_used_msec > unused_life_time_sec * 1000) {
+        it = entries_.erase(it);
+        continue;
+      }
+      ++it;
+      continue;
+    }
+
+    const fastotv::timestamp_t refresh_time = entry.link.url.is_valid()
+                                                  ? entry.link.expire_utc_msec - refresh_ahead_sec * 1000
+                                                  : entry.link.expire_utc_msec;
+    if (refresh_time <= now) {
+      entry.in_flight = true;
+      queue_.push_back(it->first);
+    } else {
+      *next_check = std::min(*next_check, refresh_time);
+    }
+    ++it;
+  }
+}
+
+void StreamLinkResolver::WorkerRoutine() {
+  std::unique_lock<std::mutex> lock(entries_mutex_);
+  while (!stop_) {
+    if (queue_.empty()) {
+      const fastotv::timestamp_t now = common::time::current_utc_mstime();
+      fastotv::timestamp_t next_check = now + wait_refresh_sec * 1000;
+      ScheduleRefresh(now, &next_check);
+      if (queue_.empty()) {
+        entries_cond_.wait_for(lock, std::chrono::milliseconds(next_check - now));
+        continue;
+      }
+    }
+
+    const std::string key = queue_.front();
+    queue_.pop_front();
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      continue;
+    }
+
+    const InputUri src = it->second.src;
+    const bool is_refresh = it->second.resolved;
+    lock.unlock();
+
+    Link link = {src.GetUrl(), common::uri::GURL(), 0};
+    const auto stream_link = src.GetStreamLink();
+    const bool resolved = stream_link && ResolveStreamLink(script_path_, src.GetUrl(), *stream_link, &link.url);
+    const fastotv::timestamp_t resolved_time = common::time::current_utc_mstime();
+    if (resolved) {
+      link.expire_utc_msec = GetStreamLinkExpireTime(link.url, resolved_time);
+    } else {
+      link.url = common::uri::GURL();
+      link.expire_utc_msec = resolved_time + failed_retry_sec * 1000;
+      WARNING_LOG() << "Can't resolve stream link: " << src.GetUrl().spec();
+    }
+
+    std::vector<link_callback_t> waiters;
+    lock.lock();
+    it = entries_.find(key);
+    if (it == entries_.end()) {
+      continue;
+    }
+
+    it->second.link = link;
+    it->second.resolved = true;
+    it->second.in_flight = false;
+    waiters.swap(it->second.waiters);
+    lock.unlock();
+
+    for (const auto& cb : waiters) {
+      cb(link);
+    }
+    if (is_refresh && resolved && refreshed_cb_) {
+      refreshed_cb_(link);
+    }
+    lock.lock();
+  }
+}
+
+}  // namespace server
+}  // namespace fastocloud
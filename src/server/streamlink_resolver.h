@@ -0,0 +1,101 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "base/input_uri.h"
+#include "base/types.h"
+
+namespace fastocloud {
+namespace server {
+
+// Resolves streamlink sources (youtube, twitch, ...) out of daemon loop in small worker pool.
+// Resolved urls cached till signed url expire, concurrent requests of the same source share one streamlink run,
+// sources used by running streams refreshed ahead of expiration.
+class StreamLinkResolver {
+ public:
+  enum {
+    refresh_ahead_sec = 120,
+    failed_retry_sec = 30,
+    unused_life_time_sec = 3600,
+    wait_refresh_sec = 60
+  };
+
+  struct Link {
+    common::uri::GURL source;
+    common::uri::GURL url;  // not valid if resolve failed
+    fastotv::timestamp_t expire_utc_msec;
+  };
+  // called from worker thread
+  typedef std::function<void(const Link& link)> link_callback_t;
+
+  StreamLinkResolver(const std::string& script_path, size_t workers_count, link_callback_t refreshed_cb);
+  ~StreamLinkResolver();
+
+  void Start();
+  void Stop();
+
+  // link still valid or failed recently
+  bool Find(const InputUri& src, Link* link);
+  void Resolve(const InputUri& src, link_callback_t cb);
+
+  // source used by running stream, keep it fresh
+  void Acquire(const InputUri& src);
+  void Release(const InputUri& src);
+
+ private:
+  struct Entry {
+    InputUri src;
+    Link link;
+    bool resolved;
+    bool in_flight;
+    size_t users;
+    fastotv::timestamp_t last_used_msec;
+    std::vector<link_callback_t> waiters;
+  };
+
+  static std::string MakeKey(const InputUri& src);
+  static bool IsFresh(const Entry& entry, fastotv::timestamp_t now);
+
+  Entry* GetEntry(const InputUri& src, fastotv::timestamp_t now);
+  void ScheduleRefresh(fastotv::timestamp_t now, fastotv::timestamp_t* next_check);
+  void WorkerRoutine();
+
+  const std::string script_path_;
+  const size_t workers_count_;
+  const link_callback_t refreshed_cb_;
+
+  std::vector<std::thread> workers_;
+  std::mutex entries_mutex_;
+  std::condition_variable entries_cond_;
+  bool stop_;
+  std::deque<std::string> queue_;
+  std::unordered_map<std::string, Entry> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamLinkResolver);
+};
+
+}  // namespace server
+}  // namespace fastocloud
@@ -14,6 +14,11 @@
 
 #include "server/utils/utils.h"
 
+#if defined(OS_LINUX)
+#include <sys/prctl.h>
+#endif
+
+#include <string.h>
 #include <unistd.h>
 
 namespace {
@@ -119,5 +124,30 @@ common::ErrnoError CreateSocketPair(common::net::socket_descr_t* parent_sock, co
   return common::ErrnoError();
 }
 
+#if defined(OS_POSIX)
+void ChangeProcessName(int argc, char** argv, const std::string& name) {
+  const char* new_name = name.c_str();
+#if defined(OS_LINUX)
+  for (int i = 0; i < argc; ++i) {
+    memset(argv[i], 0, strlen(argv[i]));
+  }
+  if (argc > 0) {
+    char* app_name = argv[0];
+    strncpy(app_name, new_name, name.length());
+    app_name[name.length()] = 0;
+  }
+  prctl(PR_SET_NAME, new_name);
+#elif defined(OS_FREEBSD)
+  UNUSED(argc);
+  UNUSED(argv);
+  setproctitle(new_name);
+#else
+#pragma message "Please implement"
+  UNUSED(argc);
+  UNUSED(argv);
+#endif
+}
+#endif
+
 }  // namespace server
 }  // namespace fastocloud
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <string>
+
 #include <common/error.h>
 #include <common/net/socket_info.h>
 
@@ -26,5 +28,10 @@ common::ErrnoError CreatePipe(common::net::socket_descr_t* read_client_fd,
 #endif
 common::ErrnoError CreateSocketPair(common::net::socket_descr_t* parent_sock, common::net::socket_descr_t* child_sock);
 
+#if defined(OS_POSIX)
+// rewrites argv of current process, so ps/top show forked stream name
+void ChangeProcessName(int argc, char** argv, const std::string& name);
+#endif
+
 }  // namespace server
 }  // namespace fastocloud
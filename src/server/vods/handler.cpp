@@ -21,78 +21,26 @@
 #include <string>
 #include <utility>
 
+#include "server/base/async_http_client.h"
+#include "server/base/http_file_reply.h"
 #include "server/base/ihttp_requests_observer.h"
-#include "server/vods/client.h"
 
 namespace fastocloud {
 namespace server {
 
-VodsHandler::VodsHandler(base::IHttpRequestsObserver* observer)
-    : base_class(), http_root_(http_directory_path_t::MakeHomeDir()), observer_(observer) {}
+VodsHandler::VodsHandler(base::IHttpRequestsObserver* observer, bool write_once_chunks)
+    : base_class(),
+      http_root_(http_directory_path_t::MakeHomeDir()),
+      observer_(observer),
+      write_once_chunks_(write_once_chunks),
+      cache_(CACHE_MAX_BYTES, CACHE_MAX_SEGMENT_SIZE, CACHE_REVALIDATE_MSEC) {}
 
 void VodsHandler::SetHttpRoot(const http_directory_path_t& http_root) {
   http_root_ = http_root;
+  cache_.Clear();
 }
 
-void VodsHandler::PreLooped(common::libev::IoLoop* server) {
-  UNUSED(server);
-}
-
-void VodsHandler::Accepted(common::libev::IoClient* client) {
-  base_class::Accepted(client);
-}
-
-void VodsHandler::Moved(common::libev::IoLoop* server, common::libev::IoClient* client) {
-  base_class::Moved(server, client);
-}
-
-void VodsHandler::Closed(common::libev::IoClient* client) {
-  base_class::Closed(client);
-}
-
-void VodsHandler::TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) {
-  UNUSED(server);
-  UNUSED(id);
-}
-
-void VodsHandler::Accepted(common::libev::IoChild* child) {
-  UNUSED(child);
-}
-
-void VodsHandler::Moved(common::libev::IoLoop* server, common::libev::IoChild* child) {
-  UNUSED(server);
-  UNUSED(child);
-}
-
-void VodsHandler::ChildStatusChanged(common::libev::IoChild* child, int status, int signal) {
-  UNUSED(child);
-  UNUSED(status);
-  UNUSED(signal);
-}
-
-void VodsHandler::DataReceived(common::libev::IoClient* client) {
-  char buff[BUF_SIZE] = {0};
-  size_t nread = 0;
-  common::ErrnoError errn = client->SingleRead(buff, BUF_SIZE - 1, &nread);
-  if (errn || nread == 0) {
-    ignore_result(client->Close());
-    delete client;
-    return;
-  }
-
-  VodsClient* hclient = static_cast<server::VodsClient*>(client);
-  ProcessReceived(hclient, buff, nread);
-}
-
-void VodsHandler::DataReadyToWrite(common::libev::IoClient* client) {
-  UNUSED(client);
-}
-
-void VodsHandler::PostLooped(common::libev::IoLoop* server) {
-  UNUSED(server);
-}
-
-void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size_t req_len) {
+bool VodsHandler::ProcessReceived(base::AsyncHttpClient* hclient, const char* request, size_t req_len) {
   static const common::libev::http::HttpServerInfo hinf(PROJECT_NAME_TITLE, PROJECT_DOMAIN);
   common::http::HttpRequest hrequest;
   std::string request_str(request, req_len);
@@ -110,14 +58,18 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
     }
     ignore_result(hclient->Close());
     delete hclient;
-    return;
+    return false;
   }
 
-  // keep alive
+  // keep alive, persistent by default since HTTP/1.1
+  const common::http::http_protocol protocol = hrequest.GetProtocol();
   common::http::header_t connection_field;
   bool is_find_connection = hrequest.FindHeaderByKey("Connection", false, &connection_field);
-  bool IsKeepAlive = is_find_connection ? common::EqualsASCII(connection_field.value, "Keep-Alive", false) : false;
-  const common::http::http_protocol protocol = hrequest.GetProtocol();
+  bool IsKeepAlive = protocol == common::http::HP_1_1;
+  if (is_find_connection) {
+    IsKeepAlive = protocol == common::http::HP_1_1 ? !common::EqualsASCII(connection_field.value, "close", false)
+                                                   : common::EqualsASCII(connection_field.value, "Keep-Alive", false);
+  }
   if (hrequest.GetMethod() == common::http::http_method::HM_GET ||
       hrequest.GetMethod() == common::http::http_method::HM_HEAD) {
     auto url = hrequest.GetURL();
@@ -156,6 +108,43 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
     }
 
     const std::string file_path_str = file_path->GetPath();
+    const std::string fileName = url.ExtractFileName();
+    const char* mime = common::http::MimeTypes::GetType(fileName.c_str());
+    const std::string ext = file_path->GetExtension();
+    SegmentsCache::segment_t segment = cache_.Get(file_path_str, mime);
+    if (segment) {
+      time_t mtime = segment->version.mtime;
+      base::HttpFileReply reply = base::MakeFileReply(hrequest, ext, segment->version, write_once_chunks_);
+      extra_headers.insert(extra_headers.end(), reply.headers.begin(), reply.headers.end());
+      if (reply.status == base::HS_RANGE_NOT_SATISFIABLE) {
+        common::ErrnoError err = hclient->SendError(protocol, reply.status, extra_headers, "Range not satisfiable.",
+                                                    IsKeepAlive, hinf);
+        if (err) {
+          DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+        }
+        goto finish;
+      }
+
+      off_t* content_length = reply.status == base::HS_NOT_MODIFIED ? nullptr : &reply.length;
+      common::ErrnoError err = hclient->SendHeaders(protocol, reply.status, extra_headers, segment->mime.c_str(),
+                                                    content_length, &mtime, IsKeepAlive, hinf);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+        goto finish;
+      }
+
+      if (hrequest.GetMethod() == common::http::http_method::HM_GET && reply.status != base::HS_NOT_MODIFIED) {
+        err = hclient->StartSendData(base::AsyncHttpClient::data_t(segment, &segment->data), reply.offset,
+                                     reply.length);
+        if (err) {
+          DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+        } else {
+          DEBUG_LOG() << "Sending cached file path: " << file_path_str << ", size: " << reply.length;
+        }
+      }
+      goto finish;
+    }
+
     int open_flags = O_RDONLY;
     struct stat sb;
     if (stat(file_path_str.c_str(), &sb) < 0) {
@@ -186,6 +175,26 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
       goto finish;
     }
 
+    base::HttpFileReply reply = base::MakeFileReply(hrequest, ext, base::MakeFileVersion(sb), write_once_chunks_);
+    extra_headers.insert(extra_headers.end(), reply.headers.begin(), reply.headers.end());
+    if (reply.status == base::HS_NOT_MODIFIED) {
+      common::ErrnoError err =
+          hclient->SendHeaders(protocol, reply.status, extra_headers, mime, nullptr, &sb.st_mtime, IsKeepAlive, hinf);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      }
+      goto finish;
+    }
+
+    if (reply.status == base::HS_RANGE_NOT_SATISFIABLE) {
+      common::ErrnoError err =
+          hclient->SendError(protocol, reply.status, extra_headers, "Range not satisfiable.", IsKeepAlive, hinf);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      }
+      goto finish;
+    }
+
     int file = open(file_path_str.c_str(), open_flags);
     if (file == INVALID_DESCRIPTOR) { /* open the file for reading */
       common::ErrnoError err = hclient->SendError(protocol, common::http::HS_FORBIDDEN, extra_headers,
@@ -196,9 +205,7 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
       goto finish;
     }
 
-    const std::string fileName = url.ExtractFileName();
-    const char* mime = common::http::MimeTypes::GetType(fileName.c_str());
-    common::ErrnoError err = hclient->SendHeaders(protocol, common::http::HS_OK, extra_headers, mime, &sb.st_size,
+    common::ErrnoError err = hclient->SendHeaders(protocol, reply.status, extra_headers, mime, &reply.length,
                                                   &sb.st_mtime, IsKeepAlive, hinf);
     if (err) {
       DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
@@ -206,23 +213,31 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
       goto finish;
     }
 
-    if (hrequest.GetMethod() == common::http::http_method::HM_GET) {
-      common::ErrnoError err = hclient->SendFileByFd(protocol, file, sb.st_size);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      } else {
-        DEBUG_LOG() << "Sent file path: " << file_path_str << ", size: " << sb.st_size;
-      }
+    if (hrequest.GetMethod() != common::http::http_method::HM_GET) {
+      ::close(file);
+      goto finish;
     }
 
-    ::close(file);
+    err = hclient->StartSendFile(file, reply.offset, reply.length);  // file owned by client now
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    } else {
+      DEBUG_LOG() << "Sending file path: " << file_path_str << ", size: " << reply.length;
+    }
   }
 
 finish:
+  if (hclient->IsSending()) {  // released from DataReadyToWrite
+    hclient->SetCloseAfterSend(!IsKeepAlive);
+    return true;
+  }
+
   if (!IsKeepAlive) {
     ignore_result(hclient->Close());
     delete hclient;
+    return false;
   }
+  return true;
 }
 
 }  // namespace server
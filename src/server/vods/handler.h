@@ -16,45 +16,38 @@
 
 #include <common/file_system/path.h>
 
-#include "server/base/iserver_handler.h"
+#include "server/base/http_server_handler.h"
+#include "server/segments_cache.h"
 
 namespace fastocloud {
 namespace server {
 
-class VodsClient;
 namespace base {
 class IHttpRequestsObserver;
 }
 
-class VodsHandler : public base::IServerHandler {
+class VodsHandler : public base::HttpServerHandler {
  public:
-  enum { BUF_SIZE = 4096 };
-  typedef base::IServerHandler base_class;
+  enum {
+    CACHE_MAX_BYTES = 64 * 1024 * 1024,
+    CACHE_MAX_SEGMENT_SIZE = 8 * 1024 * 1024,
+    CACHE_REVALIDATE_MSEC = 500
+  };
+  typedef base::HttpServerHandler base_class;
   typedef common::file_system::ascii_directory_string_path http_directory_path_t;
-  explicit VodsHandler(base::IHttpRequestsObserver* observer);
+  // write_once_chunks - chunks are never rewritten (vods), not for cods which reuse names after restart
+  VodsHandler(base::IHttpRequestsObserver* observer, bool write_once_chunks);
 
   void SetHttpRoot(const http_directory_path_t& http_root);
 
-  void PreLooped(common::libev::IoLoop* server) override;
-
-  void Accepted(common::libev::IoClient* client) override;
-  void Moved(common::libev::IoLoop* server, common::libev::IoClient* client) override;
-  void Closed(common::libev::IoClient* client) override;
-  void TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) override;
-  void Accepted(common::libev::IoChild* child) override;
-  void Moved(common::libev::IoLoop* server, common::libev::IoChild* child) override;
-  void ChildStatusChanged(common::libev::IoChild* child, int status, int signal) override;
-
-  void DataReceived(common::libev::IoClient* client) override;
-  void DataReadyToWrite(common::libev::IoClient* client) override;
-
-  void PostLooped(common::libev::IoLoop* server) override;
+ protected:
+  bool ProcessReceived(base::AsyncHttpClient* hclient, const char* request, size_t req_len) override;
 
  private:
-  void ProcessReceived(VodsClient* hclient, const char* request, size_t req_len);
-
   http_directory_path_t http_root_;
   base::IHttpRequestsObserver* const observer_;
+  const bool write_once_chunks_;
+  SegmentsCache cache_;
 };
 
 }  // namespace server
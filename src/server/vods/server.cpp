@@ -20,7 +20,7 @@ namespace fastocloud {
 namespace server {
 
 VodsServer::VodsServer(const common::net::HostAndPort& host, common::libev::IoLoopObserver* observer)
-    : base_class(host, false, observer) {}
+    : base_class(host, observer) {}
 
 common::libev::tcp::TcpClient* VodsServer::CreateClient(const common::net::socket_info& info) {
   return new VodsClient(this, info);
@@ -14,14 +14,14 @@
 
 #pragma once
 
-#include <common/libev/http/http_server.h>
+#include "server/base/worker_server.h"
 
 namespace fastocloud {
 namespace server {
 
-class VodsServer : public common::libev::http::HttpServer {
+class VodsServer : public base::WorkerServer {
  public:
-  typedef common::libev::http::HttpServer base_class;
+  typedef base::WorkerServer base_class;
   explicit VodsServer(const common::net::HostAndPort& host, common::libev::IoLoopObserver* observer = nullptr);
 
  private:
@@ -0,0 +1,345 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/zygote.h"
+
+#include <dlfcn.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <common/time.h>
+
+#include "base/stream_config_parse.h"
+#include "base/stream_stats_block.h"
+
+#include "server/utils/utils.h"
+
+namespace {
+
+const size_t kMaxMessageSize = 64 * 1024;
+
+struct SpawnRequest {
+  uint32_t fds_count;
+  int32_t stats_fd;  // 0/1, stats descriptor goes last in SCM_RIGHTS
+};
+
+struct SpawnReply {
+  int32_t pid;
+  int32_t error;
+};
+
+void CloseDescriptors(const std::vector<int>& fds) {
+  for (int fd : fds) {
+    close(fd);
+  }
+}
+
+}  // namespace
+
+namespace fastocloud {
+namespace server {
+
+Zygote::Zygote(int argc, char** argv, stream_main_t main)
+    : argc_(argc),
+      argv_(argv),
+      main_(main),
+      pid_(-1),
+      control_(-1),
+      pending_() {}
+
+Zygote::~Zygote() {
+  Stop();
+}
+
+common::ErrnoError Zygote::Start(const std::string& lib_full_path) {
+  if (IsRunning()) {
+    return common::make_errno_error("Zygote already started", EINVAL);
+  }
+
+  int socks[2];
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, socks) == ERROR_RESULT_VALUE) {
+    return common::make_errno_error(errno);
+  }
+
+  // stream processes are grandchildren of zygote, they should be reparented to daemon
+  if (prctl(PR_SET_CHILD_SUBREAPER, 1) == ERROR_RESULT_VALUE) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(socks[0]);
+    close(socks[1]);
+    return err;
+  }
+
+  const pid_t parent = getpid();
+  const pid_t pid = fork();
+  if (pid == 0) {
+    close(socks[0]);
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    if (getppid() != parent) {
+      _exit(EXIT_FAILURE);
+    }
+    _exit(Run(lib_full_path, socks[1]));
+  } else if (pid < 0) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(socks[0]);
+    close(socks[1]);
+    return err;
+  }
+
+  close(socks[1]);
+  control_ = socks[0];
+  pid_ = pid;
+  INFO_LOG() << "Zygote started, pid: " << pid;
+  return common::ErrnoError();
+}
+
+bool Zygote::IsRunning() const {
+  return control_ != -1;
+}
+
+void Zygote::Stop() {
+  if (control_ != -1) {
+    close(control_);
+    control_ = -1;
+  }
+  if (pid_ > 0) {
+    kill(pid_, SIGKILL);
+    waitpid(pid_, nullptr, 0);  // can be already reaped by loop child watcher
+    pid_ = -1;
+  }
+  pending_.clear();
+}
+
+common::ErrnoError Zygote::Spawn(const StreamConfig& config, const std::vector<int>& fds, int stats_fd) {
+  if (!config || fds.size() > MAX_FDS) {
+    return common::make_errno_error_inval();
+  }
+
+  if (!IsRunning()) {
+    return common::make_errno_error("Zygote not running", EAGAIN);
+  }
+
+  std::string json;
+  if (!MakeJsonFromConfig(config, &json)) {
+    return common::make_errno_error("Can't serialize stream config", EINVAL);
+  }
+
+  if (sizeof(SpawnRequest) + json.size() > kMaxMessageSize) {
+    return common::make_errno_error("Stream config too big for zygote", E2BIG);
+  }
+
+  std::vector<int> passed = fds;
+  if (stats_fd != -1) {
+    passed.push_back(stats_fd);
+  }
+
+  const fastotv::timestamp_t start_msec = common::time::current_utc_mstime();
+  SpawnRequest request = {static_cast<uint32_t>(fds.size()), stats_fd != -1};
+  struct iovec iov[2];
+  iov[0].iov_base = &request;
+  iov[0].iov_len = sizeof(request);
+  iov[1].iov_base = const_cast<char*>(json.data());
+  iov[1].iov_len = json.size();
+
+  char control_buffer[CMSG_SPACE(sizeof(int) * (MAX_FDS + 1))];
+  memset(control_buffer, 0, sizeof(control_buffer));
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = 2;
+  if (!passed.empty()) {
+    msg.msg_control = control_buffer;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * passed.size());
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * passed.size());
+    memcpy(CMSG_DATA(cmsg), passed.data(), sizeof(int) * passed.size());
+  }
+
+  if (sendmsg(control_, &msg, MSG_NOSIGNAL | MSG_DONTWAIT) == ERROR_RESULT_VALUE) {
+    const int error = errno;
+    if (error != EAGAIN && error != EWOULDBLOCK) {
+      Stop();
+    }
+    return common::make_errno_error(error);  // busy zygote, caller forks by itself
+  }
+
+  pending_.push_back(start_msec);
+  return common::ErrnoError();
+}
+
+int Zygote::GetControlFd() const {
+  return control_;
+}
+
+common::ErrnoError Zygote::ReadSpawnResult(SpawnResult* result) {
+  if (!result) {
+    return common::make_errno_error_inval();
+  }
+
+  if (!IsRunning()) {
+    return common::make_errno_error("Zygote not running", EPIPE);
+  }
+
+  SpawnReply reply;
+  ssize_t nread;
+  do {
+    nread = recv(control_, &reply, sizeof(reply), MSG_DONTWAIT);
+  } while (nread == ERROR_RESULT_VALUE && errno == EINTR);
+  if (nread == ERROR_RESULT_VALUE && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+    return common::make_errno_error(EAGAIN);
+  }
+  if (nread != sizeof(reply) || pending_.empty()) {
+    Stop();
+    return common::make_errno_error("Zygote not responding", EPIPE);
+  }
+
+  const fastotv::timestamp_t start_msec = pending_.front();
+  pending_.pop_front();
+  result->pid = reply.error ? -1 : reply.pid;
+  result->error = reply.error;
+  result->spawn_msec = common::time::current_utc_mstime() - start_msec;
+  if (!reply.error) {
+    INFO_LOG() << "Zygote spawned stream process pid: " << reply.pid << ", in " << result->spawn_msec << " msec";
+  }
+  return common::ErrnoError();
+}
+
+int Zygote::Run(const std::string& lib_full_path, int control) {
+  ChangeProcessName(argc_, argv_, STREAMER_NAME "_zygote");
+
+  void* handle = dlopen(lib_full_path.c_str(), RTLD_LAZY);
+  if (!handle) {
+    ERROR_LOG() << "Zygote failed to load " CORE_LIBRARY " path: " << lib_full_path << ", error: " << dlerror();
+    return EXIT_FAILURE;
+  }
+
+  stream_preinit_t preinit_func = reinterpret_cast<stream_preinit_t>(dlsym(handle, "stream_preinit"));
+  stream_exec_t exec_func = reinterpret_cast<stream_exec_t>(dlsym(handle, "stream_exec"));
+  if (!preinit_func || !exec_func) {
+    ERROR_LOG() << "Zygote failed to load stream functions error: " << dlerror();
+    dlclose(handle);
+    return EXIT_FAILURE;
+  }
+
+  preinit_func();
+
+  char buffer[kMaxMessageSize];
+  char control_buffer[CMSG_SPACE(sizeof(int) * (MAX_FDS + 1))];
+  while (true) {
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = sizeof(buffer);
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control_buffer;
+    msg.msg_controllen = sizeof(control_buffer);
+
+    ssize_t nread = recvmsg(control, &msg, 0);
+    if (nread == 0) {  // daemon closed control socket
+      break;
+    }
+    if (nread == ERROR_RESULT_VALUE) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    std::vector<int> fds;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+        const size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const int* data = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+        fds.insert(fds.end(), data, data + count);
+      }
+    }
+
+    SpawnRequest request;
+    if (static_cast<size_t>(nread) < sizeof(request) || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+      CloseDescriptors(fds);
+      SpawnReply reply = {-1, EINVAL};
+      send(control, &reply, sizeof(reply), MSG_NOSIGNAL);
+      continue;
+    }
+    memcpy(&request, buffer, sizeof(request));
+    if (fds.size() != request.fds_count + (request.stats_fd ? 1 : 0)) {
+      CloseDescriptors(fds);
+      SpawnReply reply = {-1, EINVAL};
+      send(control, &reply, sizeof(reply), MSG_NOSIGNAL);
+      continue;
+    }
+
+    int stats_fd = -1;
+    if (request.stats_fd) {
+      stats_fd = fds.back();
+      fds.pop_back();
+    }
+    const std::string json(buffer + sizeof(request), nread - sizeof(request));
+    const pid_t intermediate = fork();
+    if (intermediate == 0) {
+      Spawned(exec_func, control, json, fds, stats_fd);
+    } else if (intermediate < 0) {
+      SpawnReply reply = {-1, errno};
+      send(control, &reply, sizeof(reply), MSG_NOSIGNAL);
+    } else {
+      waitpid(intermediate, nullptr, 0);
+    }
+
+    CloseDescriptors(fds);
+    if (stats_fd != -1) {
+      close(stats_fd);
+    }
+  }
+
+  dlclose(handle);
+  return EXIT_SUCCESS;
+}
+
+void Zygote::Spawned(stream_exec_t exec,
+                     int control,
+                     const std::string& json,
+                     const std::vector<int>& fds,
+                     int stats_fd) {
+  // intermediate process exits right after fork, so stream process is adopted by daemon
+  const pid_t pid = fork();
+  if (pid == 0) {
+    close(control);
+    StreamStatsBlock* stats_block = nullptr;
+    if (stats_fd != -1) {
+      stats_block = StreamStatsBlock::Attach(stats_fd);
+      close(stats_fd);
+    }
+
+    StreamConfig config(MakeConfigFromJson(json));
+    if (!config) {
+      ERROR_LOG() << "Zygote received invalid stream config";
+      _exit(EXIT_FAILURE);
+    }
+    _exit(main_(exec, argc_, argv_, config, fds, stats_block));
+  }
+
+  SpawnReply reply = {pid, pid < 0 ? errno : 0};
+  send(control, &reply, sizeof(reply), MSG_NOSIGNAL);
+  _exit(pid < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+}  // namespace server
+}  // namespace fastocloud
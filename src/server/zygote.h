@@ -0,0 +1,87 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+
+#include <fastotv/types.h>
+
+#include "base/stream_config.h"
+
+#include "stream/stream_wrapper.h"
+
+namespace fastocloud {
+
+class StreamStatsBlock;
+
+namespace server {
+
+// Process forked from daemon before any threads, keeps core library loaded and gstreamer registry initialized.
+// Daemon asks it over control socket for new stream processes, they are forked with everything already warm.
+// Stream processes are reparented to daemon (child subreaper), so libev child watchers work as with plain fork.
+class Zygote {
+ public:
+  enum { MAX_FDS = 4 };
+  // executed in new stream process, fds are descriptors passed to Spawn in same order
+  typedef int (*stream_main_t)(stream_exec_t exec,
+                               int argc,
+                               char** argv,
+                               const StreamConfig& config,
+                               const std::vector<int>& fds,
+                               StreamStatsBlock* stats_block);
+
+  Zygote(int argc, char** argv, stream_main_t main);
+  ~Zygote();
+
+  common::ErrnoError Start(const std::string& lib_full_path) WARN_UNUSED_RESULT;
+  bool IsRunning() const;
+  void Stop();
+
+  struct SpawnResult {
+    pid_t pid;                        // -1 if zygote failed to fork
+    int error;                        // errno of failed fork
+    fastotv::timestamp_t spawn_msec;  // from request to reply
+  };
+
+  // only sends request, descriptors and stats_fd (optional, -1) are already duplicated into zygote when it returns,
+  // caller still owns them; result comes later on control socket, requests are answered in order
+  common::ErrnoError Spawn(const StreamConfig& config, const std::vector<int>& fds, int stats_fd) WARN_UNUSED_RESULT;
+  // readable when spawn results are ready
+  int GetControlFd() const;
+  // EAGAIN if no results yet, other errors mean zygote is gone
+  common::ErrnoError ReadSpawnResult(SpawnResult* result) WARN_UNUSED_RESULT;
+
+ private:
+  int Run(const std::string& lib_full_path, int control);
+  void Spawned(stream_exec_t exec, int control, const std::string& json, const std::vector<int>& fds, int stats_fd);
+
+  const int argc_;
+  char** const argv_;
+  const stream_main_t main_;
+
+  pid_t pid_;
+  int control_;
+
+  std::deque<fastotv::timestamp_t> pending_;  // request times of unanswered spawns
+};
+
+}  // namespace server
+}  // namespace fastocloud
@@ -223,6 +223,12 @@ common::Error make_config(const StreamConfig& config_args, Config** config) {
     aconf.SetAudioSelect(audio_select);
   }
 
+  int input_failover;
+  common::Value* input_failover_field = config_args->Find(INPUT_FAILOVER_FIELD);
+  if (input_failover_field && input_failover_field->GetAsInteger(&input_failover)) {
+    aconf.SetInputFailover(input_failover);
+  }
+
   bool loop;
   common::Value* loop_field = config_args->Find(LOOP_FIELD);
   if (loop_field && loop_field->GetAsBoolean(&loop)) {
@@ -249,6 +255,26 @@ common::Error make_config(const StreamConfig& config_args, Config** config) {
       rconfig->SetAudioParser(audio_parser);
     }
 
+    bool ts_passthrough;
+    common::Value* ts_passthrough_field = config_args->Find(TS_PASSTHROUGH_FIELD);
+    if (ts_passthrough_field && ts_passthrough_field->GetAsBoolean(&ts_passthrough)) {
+      rconfig->SetTsPassthrough(ts_passthrough);
+    }
+
+    common::ArrayValue* ts_pids_array = nullptr;
+    common::Value* ts_pids_field = config_args->Find(TS_PIDS_FIELD);
+    if (ts_pids_field && ts_pids_field->GetAsList(&ts_pids_array)) {
+      streams::RelayConfig::ts_pids_t pids;
+      for (size_t i = 0; i < ts_pids_array->GetSize(); ++i) {
+        common::Value* pid_value = nullptr;
+        int pid;
+        if (ts_pids_array->Get(i, &pid_value) && pid_value->GetAsInteger(&pid) && pid >= 0 && pid < 0x2000) {
+          pids.push_back(static_cast<uint16_t>(pid));
+        }
+      }
+      rconfig->SetTsPids(pids);
+    }
+
     if (stream_type == fastotv::VOD_RELAY) {
       streams::VodRelayConfig* vconf = new streams::VodRelayConfig(*rconfig);
       delete rconfig;
@@ -371,6 +397,23 @@ common::Error make_config(const StreamConfig& config_args, Config** config) {
       }
     }
 
+    common::ArrayValue* abr_ladder_array = nullptr;
+    common::Value* abr_ladder_field = config_args->Find(ABR_LADDER_FIELD);
+    if (abr_ladder_field && abr_ladder_field->GetAsList(&abr_ladder_array)) {
+      abr_ladder_t ladder;
+      for (size_t i = 0; i < abr_ladder_array->GetSize(); ++i) {
+        common::Value* rendition_value = nullptr;
+        common::HashValue* rendition_hash = nullptr;
+        if (abr_ladder_array->Get(i, &rendition_value) && rendition_value->GetAsHash(&rendition_hash)) {
+          auto rendition = Rendition::MakeRendition(rendition_hash);
+          if (rendition) {
+            ladder.push_back(*rendition);
+          }
+        }
+      }
+      econfig->SetAbrLadder(ladder);
+    }
+
     common::media::Rational rat;
     common::Value* rat_field = config_args->Find(ASPECT_RATIO_FIELD);
     std::string rat_str;
@@ -0,0 +1,41 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/detection_limiter.h"
+
+namespace fastocloud {
+namespace stream {
+
+DetectionLimiter::DetectionLimiter(int64_t min_interval_msec)
+    : min_interval_msec_(min_interval_msec), last_classes_(), last_sent_msec_(0), sent_(false) {}
+
+bool DetectionLimiter::Accept(const classes_t& classes, int64_t now_msec) {
+  std::set<int> current(classes.begin(), classes.end());
+  if (current.empty() && last_classes_.empty()) {
+    return false;
+  }
+
+  const bool changed = current != last_classes_;
+  if (!changed && sent_ && now_msec - last_sent_msec_ < min_interval_msec_) {
+    return false;
+  }
+
+  last_classes_.swap(current);
+  last_sent_msec_ = now_msec;
+  sent_ = true;
+  return true;
+}
+
+}  // namespace stream
+}  // namespace fastocloud
@@ -0,0 +1,49 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <set>
+#include <vector>
+
+#include <common/macros.h>
+
+namespace fastocloud {
+namespace stream {
+
+// Decides which inference results are worth a notification, detector emits result per analyzed frame,
+// but consumers only care when set of detected classes changes or as periodic keepalive of same scene.
+class DetectionLimiter {
+ public:
+  typedef std::vector<int> classes_t;
+  enum { default_interval_msec = 1000 };
+
+  explicit DetectionLimiter(int64_t min_interval_msec = default_interval_msec);
+
+  // called from streaming thread of detector only
+  bool Accept(const classes_t& classes, int64_t now_msec);
+
+ private:
+  const int64_t min_interval_msec_;
+  std::set<int> last_classes_;
+  int64_t last_sent_msec_;
+  bool sent_;
+
+  DISALLOW_COPY_AND_ASSIGN(DetectionLimiter);
+};
+
+}  // namespace stream
+}  // namespace fastocloud
@@ -0,0 +1,151 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/dvb_tuner.h"
+
+#include <glib-unix.h>
+
+#include <algorithm>
+
+#include <common/sprintf.h>
+
+#include "base/input_uri.h"
+
+#include "stream/elements/element.h"
+#include "stream/elements/sink/udp.h"
+#include "stream/elements/sources/build_input.h"
+#include "stream/stypes.h"
+
+namespace fastocloud {
+namespace stream {
+
+DvbTuner::DvbTuner(const common::uri::GURL& source, const common::net::HostAndPort& feed)
+    : source_(source),
+      feed_(feed),
+      loop_(g_main_loop_new(nullptr, FALSE)),
+      pipeline_(gst_pipeline_new("tuner")),
+      elements_(),
+      exit_status_(EXIT_SUCCESS) {}
+
+DvbTuner::~DvbTuner() {
+  gst_element_set_state(pipeline_, GST_STATE_NULL);
+  gst_object_unref(pipeline_);
+  for (elements::Element* el : elements_) {
+    delete el;
+  }
+  elements_.clear();
+  g_main_loop_unref(loop_);
+}
+
+int DvbTuner::Exec() {
+  if (!BuildPipeline()) {
+    return EXIT_FAILURE;
+  }
+
+  GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline_));
+  guint bus_watch_id = gst_bus_add_watch(bus, bus_callback, this);
+  gst_object_unref(bus);
+  guint term_id = g_unix_signal_add(SIGTERM, quit_callback, this);
+  guint int_id = g_unix_signal_add(SIGINT, quit_callback, this);
+
+  INFO_LOG() << "Tuner " << source_.spec() << " feeds " << feed_.GetHost() << ":" << feed_.GetPort();
+  if (gst_element_set_state(pipeline_, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+    exit_status_ = EXIT_FAILURE;
+  } else {
+    g_main_loop_run(loop_);
+  }
+
+  g_source_remove(int_id);
+  g_source_remove(term_id);
+  g_source_remove(bus_watch_id);
+  return exit_status_;
+}
+
+bool DvbTuner::BuildPipeline() {
+  elements::Element* src = elements::sources::make_src(InputUri(0, source_), 0, 0);
+  if (!src) {
+    return false;
+  }
+  ElementAdd(src);
+
+  elements::ElementQueue* queue = new elements::ElementQueue(common::MemSPrintf(TUNER_QUEUE_NAME_1U, 0));
+  queue->SetLeaky(2);  // streams can't wait tuner, tuner can't wait network
+  ElementAdd(queue);
+  ElementLink(src, queue);
+
+  elements::sink::ElementUDPSink* sink = elements::sink::make_udp_sink(feed_, 0);
+  sink->SetProperty("ttl-mc", 0);  // multicast never leaves host
+  sink->SetProperty("auto-multicast", true);
+  sink->SetProperty("sync", false);
+  sink->SetProperty("async", false);
+  ElementAdd(sink);
+  ElementLink(queue, sink);
+  return true;
+}
+
+bool DvbTuner::ElementAdd(elements::Element* elem) {
+  bool res = gst_bin_add(GST_BIN(pipeline_), elem->GetGstElement());
+  CHECK(res) << "Can't added " << elem->GetPluginName();
+  elements_.push_back(elem);
+  return res;
+}
+
+bool DvbTuner::ElementLink(elements::Element* src, elements::Element* dest) {
+  bool res = gst_element_link(src->GetGstElement(), dest->GetGstElement());
+  CHECK(res) << "Can't linked " << src->GetPluginName() << " to " << dest->GetPluginName();
+  return res;
+}
+
+bool DvbTuner::ElementRemove(elements::Element* elem) {
+  bool res = gst_bin_remove(GST_BIN(pipeline_), elem->GetGstElement());
+  elements_.erase(std::remove(elements_.begin(), elements_.end(), elem), elements_.end());
+  delete elem;
+  return res;
+}
+
+bool DvbTuner::ElementLinkRemove(elements::Element* src, elements::Element* dest) {
+  gst_element_unlink(src->GetGstElement(), dest->GetGstElement());
+  return true;
+}
+
+gboolean DvbTuner::bus_callback(GstBus* bus, GstMessage* message, gpointer user_data) {
+  UNUSED(bus);
+  DvbTuner* tuner = reinterpret_cast<DvbTuner*>(user_data);
+  GstMessageType type = GST_MESSAGE_TYPE(message);
+  if (type == GST_MESSAGE_ERROR) {
+    GError* err = nullptr;
+    gchar* debug = nullptr;
+    gst_message_parse_error(message, &err, &debug);
+    ERROR_LOG() << "Tuner " << tuner->source_.spec() << " error: " << (err ? err->message : "unknown");
+    if (err) {
+      g_error_free(err);
+    }
+    g_free(debug);
+    tuner->exit_status_ = EXIT_FAILURE;
+    g_main_loop_quit(tuner->loop_);
+  } else if (type == GST_MESSAGE_EOS) {
+    tuner->exit_status_ = EXIT_FAILURE;  // live source, eos means frontend lost
+    g_main_loop_quit(tuner->loop_);
+  }
+  return TRUE;
+}
+
+gboolean DvbTuner::quit_callback(gpointer user_data) {
+  DvbTuner* tuner = reinterpret_cast<DvbTuner*>(user_data);
+  g_main_loop_quit(tuner->loop_);
+  return G_SOURCE_CONTINUE;
+}
+
+}  // namespace stream
+}  // namespace fastocloud
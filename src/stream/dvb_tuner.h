@@ -0,0 +1,59 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <gst/gst.h>
+
+#include <common/net/types.h>
+#include <common/uri/gurl.h>
+
+#include "stream/gst_types.h"
+#include "stream/ilinker.h"
+
+namespace fastocloud {
+namespace stream {
+
+// Process of one physical tuner: whole multiplex of dvb source goes as is to host local multicast group,
+// every stream of this frequency reads own program from there, so N programs need one tuner.
+class DvbTuner : public ILinker {
+ public:
+  DvbTuner(const common::uri::GURL& source, const common::net::HostAndPort& feed);
+  ~DvbTuner() override;
+
+  int Exec();  // till SIGTERM or pipeline error
+
+  bool ElementAdd(elements::Element* elem) override;
+  bool ElementLink(elements::Element* src, elements::Element* dest) override;
+  bool ElementRemove(elements::Element* elem) override;
+  bool ElementLinkRemove(elements::Element* src, elements::Element* dest) override;
+
+ private:
+  bool BuildPipeline() WARN_UNUSED_RESULT;
+
+  static gboolean bus_callback(GstBus* bus, GstMessage* message, gpointer user_data);
+  static gboolean quit_callback(gpointer user_data);
+
+  const common::uri::GURL source_;
+  const common::net::HostAndPort feed_;
+  GMainLoop* loop_;
+  GstElement* pipeline_;
+  elements_line_t elements_;
+  int exit_status_;
+
+  DISALLOW_COPY_AND_ASSIGN(DvbTuner);
+};
+
+}  // namespace stream
+}  // namespace fastocloud
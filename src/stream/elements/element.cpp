@@ -268,6 +268,10 @@ void ElementQueue::SetMaxSizeBytes(guint64 val) {
   SetProperty("max-size-bytes", val);
 }
 
+void ElementQueue::SetLeaky(gint val) {
+  SetProperty("leaky", val);
+}
+
 void ElementQueue::SetEmpty() {
   SetMaxSizeBuffers(0);
   SetMaxSizeTime(0);
@@ -278,6 +282,18 @@ void ElementCapsFilter::SetCaps(GstCaps* caps) {
   SetProperty("caps", caps);
 }
 
+void ElementInputSelector::SetSyncStreams(bool sync) {
+  SetProperty("sync-streams", sync);
+}
+
+void ElementInputSelector::SetCacheBuffers(bool cache) {
+  SetProperty("cache-buffers", cache);
+}
+
+void ElementInputSelector::SetActivePad(GstPad* pad) {
+  SetProperty("active-pad", static_cast<void*>(pad));
+}
+
 void ElementQueue2::SetMaxSizeBuffers(guint val) {
   SetProperty("max-size-buffers", val);
 }
@@ -392,6 +408,7 @@ DECLARE_ELEMENT_TRAITS_SPECIALIZATION(AC3_PARSE)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(MPEG_AUDIO_PARSE)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(RAW_AUDIO_PARSE)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(TEE)
+DECLARE_ELEMENT_TRAITS_SPECIALIZATION(INPUT_SELECTOR)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(FLV_MUX)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(MP4_MUX)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(QT_MUX)
@@ -50,6 +50,7 @@ enum SupportedElements {
   ELEMENT_MPEG_AUDIO_PARSE,
   ELEMENT_RAW_AUDIO_PARSE,
   ELEMENT_TEE,
+  ELEMENT_INPUT_SELECTOR,
   ELEMENT_FLV_MUX,
   ELEMENT_MP4_MUX,
   ELEMENT_QT_MUX,
@@ -392,6 +393,7 @@ class ElementQueue : public ElementEx<ELEMENT_QUEUE> {
   void SetMaxSizeBuffers(guint val = 200);         // 0 - 4294967295 Default: 200
   void SetMaxSizeTime(guint val = 10485760);       // 0 - 4294967295 Default: 10485760
   void SetMaxSizeBytes(guint64 val = 1000000000);  // 0 - 18446744073709551615 Default: 1000000000
+  void SetLeaky(gint val = 0);                     // (0): no, (1): upstream, (2): downstream Default: 0
 
   void SetEmpty();
 };
@@ -413,6 +415,16 @@ class ElementTee : public ElementEx<ELEMENT_TEE> {
   using base_class::base_class;
 };
 
+class ElementInputSelector : public ElementEx<ELEMENT_INPUT_SELECTOR> {
+ public:
+  typedef ElementEx<ELEMENT_INPUT_SELECTOR> base_class;
+  using base_class::base_class;
+
+  void SetSyncStreams(bool sync = true);     // true - false: true
+  void SetCacheBuffers(bool cache = false);  // true - false: false
+  void SetActivePad(GstPad* pad);
+};
+
 class ElementCapsFilter : public ElementEx<ELEMENT_CAPS_FILTER> {
  public:
   typedef ElementEx<ELEMENT_CAPS_FILTER> base_class;
@@ -33,21 +33,43 @@ ElementRTPMux* make_rtpmux(element_id_t muxer_id) {
   return make_muxer<ElementRTPMux>(muxer_id);
 }
 
-Element* make_muxer(const common::uri::GURL& url, element_id_t muxer_id) {
+bool GetMuxerType(const common::uri::GURL& url, MuxerType* type) {
+  if (!type) {
+    return false;
+  }
+
   if (url.SchemeIsRtmp()) {
-    return make_flvmux(true, muxer_id);
+    *type = FLV_MUXER;
+    return true;
   } else if (url.SchemeIsUdp()) {
+    *type = RTP_MUXER;
+    return true;
+  } else if (url.SchemeIsTcp() || url.SchemeIsHTTPOrHTTPS() || url.SchemeIsSrt()) {
+    *type = MPEGTS_MUXER;
+    return true;
+  }
+
+  return false;
+}
+
+Element* make_muxer(MuxerType type, element_id_t muxer_id) {
+  if (type == FLV_MUXER) {
+    return make_flvmux(true, muxer_id);
+  } else if (type == RTP_MUXER) {
     return make_rtpmux(muxer_id);
-  } else if (url.SchemeIsTcp()) {
-    return make_mpegtsmux(muxer_id);
-  } else if (url.SchemeIsHTTPOrHTTPS()) {
-    return make_mpegtsmux(muxer_id);
-  } else if (url.SchemeIsSrt()) {
-    return make_mpegtsmux(muxer_id);
   }
 
-  NOTREACHED() << "Unknown output url: " << url.spec();
-  return nullptr;
+  return make_mpegtsmux(muxer_id);
+}
+
+Element* make_muxer(const common::uri::GURL& url, element_id_t muxer_id) {
+  MuxerType type;
+  if (!GetMuxerType(url, &type)) {
+    NOTREACHED() << "Unknown output url: " << url.spec();
+    return nullptr;
+  }
+
+  return make_muxer(type, muxer_id);
 }
 
 void ElementFLVMux::SetStreamable(bool streamable) {
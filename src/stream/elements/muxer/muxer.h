@@ -49,6 +49,10 @@ ElementFLVMux* make_flvmux(bool streamable, element_id_t muxer_id);
 ElementRTPMux* make_rtpmux(element_id_t muxer_id);
 ElementMPEGTSMux* make_mpegtsmux(element_id_t muxer_id);
 
+enum MuxerType { MPEGTS_MUXER, FLV_MUXER, RTP_MUXER };
+
+bool GetMuxerType(const common::uri::GURL& url, MuxerType* type) WARN_UNUSED_RESULT;
+Element* make_muxer(MuxerType type, element_id_t muxer_id);
 Element* make_muxer(const common::uri::GURL& url, element_id_t muxer_id);
 
 }  // namespace muxer
@@ -81,7 +81,7 @@ GstInitializer::GstInitializer() {
 #endif
 }
 
-void GstInitializer::Init(int argc, char** argv, EncoderType enc) {
+void GstInitializer::InitCore(int argc, char** argv) {
   if (gst_is_initialized()) {
     return;
   }
@@ -91,6 +91,10 @@ void GstInitializer::Init(int argc, char** argv, EncoderType enc) {
   GstRegistry* registry = gst_registry_get();
   gst_registry_scan_path(registry, "/usr/local/lib/gstreamer-1.0/");
   gst_registry_scan_path(registry, "/usr/lib/gstreamer-1.0/");
+}
+
+void GstInitializer::Init(int argc, char** argv, EncoderType enc) {
+  InitCore(argc, argv);  // already done if process forked by zygote
 
   if (enc == GPU_MFX) {
     int res = setenv("LIBVA_DRIVER_NAME", MFX_ENV, 1);
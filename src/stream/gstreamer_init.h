@@ -24,6 +24,8 @@ namespace stream {
 class GstInitializer {
  public:
   GstInitializer();
+  // gst_init and plugins registry scan, safe to call before fork
+  static void InitCore(int argc, char** argv);
   void Init(int argc, char** argv, EncoderType enc);
   void Deinit();
 
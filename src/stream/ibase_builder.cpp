@@ -129,6 +129,12 @@ void IBaseBuilder::HandleOutputSinkPadCreated(pad::Pad* pad,
   }
 }
 
+void IBaseBuilder::HandleStageSinkPadCreated(pad::Pad* pad, LatencyStage stage) {
+  if (observer_) {
+    observer_->OnStageSinkPadCreated(pad, stage);
+  }
+}
+
 bool IBaseBuilder::CreatePipeLine(GstElement** pipeline, elements_line_t* elements) {
   if (!elements) {
     return false;
@@ -18,6 +18,8 @@
 
 #include <gst/gstelement.h>
 
+#include "base/latency_stats.h"
+
 #include "stream/config.h"
 #include "stream/gst_types.h"
 #include "stream/ilinker.h"
@@ -58,6 +60,7 @@ class IBaseBuilder : public ILinker {
 
   void HandleInputSrcPadCreated(pad::Pad* pad, element_id_t id, const common::uri::GURL& url);
   void HandleOutputSinkPadCreated(pad::Pad* pad, element_id_t id, const common::uri::GURL& url, bool need_push);
+  void HandleStageSinkPadCreated(pad::Pad* pad, LatencyStage stage);
 
  private:
   const Config* const config_;
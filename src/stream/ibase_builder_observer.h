@@ -16,6 +16,8 @@
 
 #include <common/uri/gurl.h>
 
+#include "base/latency_stats.h"
+
 #include "stream/stypes.h"
 
 namespace fastocloud {
@@ -30,6 +32,7 @@ class IBaseBuilderObserver {
   typedef common::uri::GURL url_t;
   virtual void OnInpudSrcPadCreated(pad::Pad* src_pad, element_id_t id, const url_t& url) = 0;
   virtual void OnOutputSinkPadCreated(pad::Pad* sink_pad, element_id_t id, const url_t& url, bool need_push) = 0;
+  virtual void OnStageSinkPadCreated(pad::Pad* sink_pad, LatencyStage stage) = 0;
 
   virtual ~IBaseBuilderObserver();
 };
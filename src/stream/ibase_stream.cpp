@@ -82,11 +82,15 @@ IBaseStream::IBaseStream(const Config* config, IStreamClient* client, StreamStru
       config_(config),
       probe_in_(),
       probe_out_(),
+      probe_stage_(),
+      latency_(),
       loop_(g_main_loop_new(ctx_holder::instance()->ctx, FALSE)),
       pipeline_(nullptr),
       status_tick_(0),
       no_data_panic_tick_(0),
       stats_(stats),
+      input_bytes_base_(),
+      output_bytes_base_(),
       last_exit_status_(EXIT_INNER),
       is_live_(false),
       flags_(INITED_NOTHING),
@@ -98,22 +102,39 @@ IBaseStream::IBaseStream(const Config* config, IStreamClient* client, StreamStru
   CHECK(config) << "Config must be!";
   CHECK(stats && stats->IsValid()) << "Stats must be!";
   CHECK_EQ(GetType(), config_->GetType());
+  for (const ChannelStats& input : stats_->input) {
+    input_bytes_base_.push_back(input.GetTotalBytes());
+  }
+  for (const ChannelStats& output : stats_->output) {
+    output_bytes_base_.push_back(output.GetTotalBytes());
+  }
 }
 
 void IBaseStream::LinkInputPad(GstPad* pad, element_id_t id, const common::uri::GURL& url) {
   DEBUG_LOG() << "InputPad created id: " << id << ", url: " << url.spec();
-  InputProbe* probe = new InputProbe(id, url, this);
+  InputProbe* probe = new InputProbe(id, url, NeedCheckInputData(), this);
   probe->Link(pad);
   probe_in_.push_back(probe);
 }
 
 void IBaseStream::LinkOutputPad(GstPad* pad, element_id_t id, const common::uri::GURL& url, bool need_push) {
   DEBUG_LOG() << "OutputPad created id: " << id << ", url: " << url.spec();
-  OutputProbe* probe = new OutputProbe(id, url, need_push, this);
+  OutputProbe* probe = new OutputProbe(id, url, need_push, NeedCheckOutputData(), this);
   probe->Link(pad);
   probe_out_.push_back(probe);
 }
 
+void IBaseStream::LinkStagePad(GstPad* pad, LatencyStage stage) {
+  DEBUG_LOG() << "StagePad created stage: " << LatencyStats::GetStageName(stage);
+  StageProbe* probe = new StageProbe(stage, this);
+  probe->Link(pad);
+  probe_stage_.push_back(probe);
+}
+
+void IBaseStream::OnStageSinkPadCreated(pad::Pad* sink_pad, LatencyStage stage) {
+  LinkStagePad(sink_pad->GetGstPad(), stage);
+}
+
 void IBaseStream::PreExecCleanup(time_t old_life_time) {
   const fastotv::timestamp_t cur_timestamp = common::time::current_utc_mstime();
   const fastotv::timestamp_t max_life_time = IsVod() ? cur_timestamp : cur_timestamp - old_life_time * 1000;
@@ -160,6 +181,13 @@ void IBaseStream::ClearInProbes() {
   probe_in_.clear();
 }
 
+void IBaseStream::ClearStageProbes() {
+  for (StageProbe* probe : probe_stage_) {
+    delete probe;
+  }
+  probe_stage_.clear();
+}
+
 size_t IBaseStream::CountInputEOS() const {
   size_t count_in_eos = 0;
   std::map<element_id_t, Consistency> probes_statuses;
@@ -214,6 +242,7 @@ IBaseStream::~IBaseStream() {
   g_main_loop_unref(loop_);
   ClearOutProbes();
   ClearInProbes();
+  ClearStageProbes();
   for (elements::Element* el : pipeline_elements_) {
     delete el;
   }
@@ -388,6 +417,7 @@ void IBaseStream::Play() {
 
 void IBaseStream::ResetDataWait() {
   no_data_panic_tick_ = GetElipsedTime() + no_data_panic_sec;  // update no_data_panic timestamp
+  CollectProbeStats();
   stats_->ResetDataWait();
 }
 
@@ -486,6 +516,7 @@ void IBaseStream::OnInputDataFailed() {
 void IBaseStream::OnInputDataOK() {}
 
 gboolean IBaseStream::HandleMainTimerTick() {
+  CollectProbeStats();
   const time_t up_time = GetElipsedTime();
   const size_t diff = (no_data_panic_sec - no_data_panic_tick_ + up_time) + 1;
 
@@ -536,6 +567,8 @@ gboolean IBaseStream::HandleMainTimerTick() {
     }
   }
 
+  latency_.Snapshot(&stats_->latency);
+
   /*
     Send the update
   */
@@ -690,6 +723,14 @@ void IBaseStream::HandleBufferingMessage(GstMessage* message) {
   UNUSED(message);
 }
 
+bool IBaseStream::NeedCheckInputData() const {
+  return false;
+}
+
+bool IBaseStream::NeedCheckOutputData() const {
+  return false;
+}
+
 GstPadProbeInfo* IBaseStream::CheckProbeData(InputProbe* probe, GstPadProbeInfo* buff) {
   if (client_) {
     return client_->OnCheckReveivedData(this, probe, buff);
@@ -733,18 +774,72 @@ gboolean IBaseStream::main_timer_callback(gpointer user_data) {
   return res;
 }
 
-void IBaseStream::UpdateInputProbeStats(const InputProbe* probe, gsize size) {
-  if (probe->GetID() < stats_->input.size()) {
-    const size_t prev_total = stats_->input[probe->GetID()].GetTotalBytes();
-    stats_->input[probe->GetID()].SetTotalBytes(prev_total + size);
+void IBaseStream::UpdateInputProbeStats(InputProbe* probe, gsize size) {
+  probe->AddBytes(size);
+}
+
+void IBaseStream::UpdateOutputProbeStats(OutputProbe* probe, gsize size) {
+  probe->AddBytes(size);
+}
+
+void IBaseStream::CollectProbeStats() {
+  std::vector<size_t> input_total = input_bytes_base_;
+  for (const InputProbe* probe : probe_in_) {
+    if (probe->GetID() < input_total.size()) {
+      input_total[probe->GetID()] += probe->GetTotalBytes();
+    }
+  }
+  for (size_t i = 0; i < input_total.size(); ++i) {
+    stats_->input[i].SetTotalBytes(input_total[i]);
+  }
+
+  std::vector<size_t> output_total = output_bytes_base_;
+  for (const OutputProbe* probe : probe_out_) {
+    if (probe->GetID() < output_total.size()) {
+      output_total[probe->GetID()] += probe->GetTotalBytes();
+    }
+  }
+  for (size_t i = 0; i < output_total.size(); ++i) {
+    stats_->output[i].SetTotalBytes(output_total[i]);
   }
 }
 
-void IBaseStream::UpdateOutputProbeStats(const OutputProbe* probe, gsize size) {
-  if (probe->GetID() < stats_->output.size()) {
-    const size_t prev_total = stats_->output[probe->GetID()].GetTotalBytes();
-    stats_->output[probe->GetID()].SetTotalBytes(prev_total + size);
+void IBaseStream::TraceBufferLatency(LatencyStage stage, const GstSegment* segment, GstBuffer* buffer) {
+  if (!latency_.NeedSample(stage, g_get_monotonic_time())) {
+    return;
   }
+
+  if (segment->format != GST_FORMAT_TIME) {  // byte streams of sources have no timing yet
+    return;
+  }
+
+  GstClockTime ts = GST_BUFFER_PTS(buffer);
+  if (!GST_CLOCK_TIME_IS_VALID(ts)) {
+    ts = GST_BUFFER_DTS(buffer);
+    if (!GST_CLOCK_TIME_IS_VALID(ts)) {
+      return;
+    }
+  }
+
+  const GstClockTime buffer_running_time = gst_segment_to_running_time(segment, GST_FORMAT_TIME, ts);
+  if (!GST_CLOCK_TIME_IS_VALID(buffer_running_time)) {
+    return;
+  }
+
+  GstClock* clock = gst_element_get_clock(pipeline_);
+  if (!clock) {  // not playing yet
+    return;
+  }
+  const GstClockTime now = gst_clock_get_time(clock);
+  gst_object_unref(clock);
+  const GstClockTime base_time = gst_element_get_base_time(pipeline_);
+  if (now < base_time) {
+    return;
+  }
+
+  const GstClockTime running_time = now - base_time;
+  const GstClockTime age = running_time > buffer_running_time ? running_time - buffer_running_time : 0;
+  latency_.Observe(stage, GST_TIME_AS_USECONDS(age));
 }
 
 const Config* IBaseStream::GetConfig() const {
@@ -31,6 +31,7 @@
 
 #include "stream/gst_types.h"
 #include "stream/ibase_builder_observer.h"
+#include "stream/latency_tracer.h"
 
 namespace fastocloud {
 namespace stream {
@@ -38,6 +39,7 @@ namespace stream {
 class IBaseBuilder;
 class InputProbe;
 class OutputProbe;
+class StageProbe;
 class Config;
 
 enum ExitStatus { EXIT_SELF, EXIT_INNER };
@@ -98,16 +100,21 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   virtual void HandleInputProbeEvent(InputProbe* probe, GstEvent* event);
   virtual void HandleOutputProbeEvent(OutputProbe* probe, GstEvent* event);
 
+  // buffers reach checks only if stream asked for it when probes linked, events always
   virtual GstPadProbeInfo* CheckProbeData(InputProbe* probe, GstPadProbeInfo* buff);
   virtual GstPadProbeInfo* CheckProbeDataOutput(OutputProbe* probe, GstPadProbeInfo* buff);
 
-  void UpdateInputProbeStats(const InputProbe* probe, gsize size);
-  void UpdateOutputProbeStats(const OutputProbe* probe, gsize size);
+  // any thread, counted per probe and aggregated into stats by main timer
+  void UpdateInputProbeStats(InputProbe* probe, gsize size);
+  void UpdateOutputProbeStats(OutputProbe* probe, gsize size);
+  // streaming threads, age of buffer is pipeline running time minus buffer running time in segment
+  void TraceBufferLatency(LatencyStage stage, const GstSegment* segment, GstBuffer* buffer);
 
   const Config* GetConfig() const;
 
   void LinkInputPad(GstPad* pad, element_id_t id, const common::uri::GURL& url);
   void LinkOutputPad(GstPad* pad, element_id_t id, const common::uri::GURL& url, bool need_push);
+  void LinkStagePad(GstPad* pad, LatencyStage stage);
 
   size_t CountInputEOS() const;
   size_t CountOutEOS() const;
@@ -131,6 +138,7 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
                               element_id_t id,
                               const common::uri::GURL& url,
                               bool need_push) override = 0;
+  void OnStageSinkPadCreated(pad::Pad* sink_pad, LatencyStage stage) override;
 
   virtual IBaseBuilder* CreateBuilder() = 0;
 
@@ -139,6 +147,10 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
 
   virtual void HandleBufferingMessage(GstMessage* message);
 
+  // true if every input/output buffer should pass CheckProbeData/CheckProbeDataOutput
+  virtual bool NeedCheckInputData() const;
+  virtual bool NeedCheckOutputData() const;
+
   void SetStatus(StreamStatus status);
 
   virtual gboolean HandleMainTimerTick();
@@ -168,10 +180,14 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
 
   std::vector<InputProbe*> probe_in_;
   std::vector<OutputProbe*> probe_out_;
+  std::vector<StageProbe*> probe_stage_;
+  LatencyTracer latency_;
 
   bool InitPipeLine();
   void ClearOutProbes();
   void ClearInProbes();
+  void ClearStageProbes();
+  void CollectProbeStats();
   void ResetDataWait();
 
   static GstBusSyncReply sync_bus_callback(GstBus* bus, GstMessage* message, gpointer user_data);
@@ -187,6 +203,9 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   time_t no_data_panic_tick_;
 
   StreamStruct* const stats_;
+  // totals of stats before this stream instance, probes count from zero
+  std::vector<size_t> input_bytes_base_;
+  std::vector<size_t> output_bytes_base_;
 
   ExitStatus last_exit_status_;
   bool is_live_;
@@ -0,0 +1,59 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/latency_tracer.h"
+
+namespace fastocloud {
+namespace stream {
+
+LatencyTracer::LatencyTracer() : stages_() {
+  for (size_t i = 0; i < LATENCY_STAGES_COUNT; ++i) {
+    stages_[i].last_sample_usec = 0;
+  }
+}
+
+bool LatencyTracer::NeedSample(LatencyStage stage, int64_t now_usec) {
+  if (stage >= LATENCY_STAGES_COUNT) {
+    return false;
+  }
+
+  std::atomic<int64_t>& last = stages_[stage].last_sample_usec;
+  int64_t prev = last.load(std::memory_order_relaxed);
+  if (now_usec - prev < sample_interval_usec) {
+    return false;
+  }
+  // several streaming threads can pass same stage (audio and video), only one takes the sample
+  return last.compare_exchange_strong(prev, now_usec, std::memory_order_relaxed);
+}
+
+void LatencyTracer::Observe(LatencyStage stage, uint64_t age_usec) {
+  if (stage >= LATENCY_STAGES_COUNT) {
+    return;
+  }
+
+  stages_[stage].histogram.Observe(age_usec);
+}
+
+void LatencyTracer::Snapshot(latency_stats_t* stats) const {
+  if (!stats) {
+    return;
+  }
+
+  for (size_t i = 0; i < LATENCY_STAGES_COUNT; ++i) {
+    stages_[i].histogram.Snapshot(&(*stats)[i]);
+  }
+}
+
+}  // namespace stream
+}  // namespace fastocloud
@@ -0,0 +1,54 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include <common/macros.h>
+
+#include "base/latency_histogram.h"
+
+namespace fastocloud {
+namespace stream {
+
+// Collects buffers age per stage from streaming threads, buffers are sampled not more often than
+// sample_interval_usec per stage, so tracing costs one relaxed load for most of buffers.
+class LatencyTracer {
+ public:
+  enum { sample_interval_usec = 100000 };
+
+  LatencyTracer();
+
+  // true if caller should measure buffer at stage now
+  bool NeedSample(LatencyStage stage, int64_t now_usec);
+  void Observe(LatencyStage stage, uint64_t age_usec);
+
+  void Snapshot(latency_stats_t* stats) const;
+
+ private:
+  struct Stage {
+    std::atomic<int64_t> last_sample_usec;
+    LatencyHistogram histogram;
+  };
+
+  Stage stages_[LATENCY_STAGES_COUNT];
+
+  DISALLOW_COPY_AND_ASSIGN(LatencyTracer);
+};
+
+}  // namespace stream
+}  // namespace fastocloud
@@ -0,0 +1,66 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/link_generator/cached_link_generator.h"
+
+#include <string>
+
+#include <common/time.h>
+
+#include "base/stream_link.h"
+
+namespace fastocloud {
+namespace stream {
+namespace link_generator {
+
+CachedLinkGenerator::CachedLinkGenerator(const ILinkGenerator* generator)
+    : generator_(generator), links_mutex_(), links_() {}
+
+bool CachedLinkGenerator::Generate(const InputUri& src, InputUri* out) const {
+  if (!out) {
+    return false;
+  }
+
+  const std::string key = src.GetUrl().spec();
+  const fastotv::timestamp_t now = common::time::current_utc_mstime();
+  {
+    std::unique_lock<std::mutex> lock(links_mutex_);
+    const auto it = links_.find(key);
+    if (it != links_.end() && it->second.expire_utc_msec > now + expire_margin_msec) {
+      *out = src;
+      out->SetUrl(it->second.url);
+      return true;
+    }
+  }
+
+  if (!generator_ || !generator_->Generate(src, out)) {
+    return false;
+  }
+
+  const common::uri::GURL resolved = out->GetUrl();
+  std::unique_lock<std::mutex> lock(links_mutex_);
+  links_[key] = {resolved, GetStreamLinkExpireTime(resolved, now)};
+  return true;
+}
+
+void CachedLinkGenerator::Update(const common::uri::GURL& source,
+                                 const common::uri::GURL& resolved,
+                                 fastotv::timestamp_t expire_utc_msec) {
+  std::unique_lock<std::mutex> lock(links_mutex_);
+  links_[source.spec()] = {resolved, expire_utc_msec};
+}
+
+}  // namespace link_generator
+}  // namespace stream
+}  // namespace fastocloud
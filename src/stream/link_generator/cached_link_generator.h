@@ -0,0 +1,54 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "base/types.h"
+
+#include "stream/link_generator/ilink_generator.h"
+
+namespace fastocloud {
+namespace stream {
+namespace link_generator {
+
+// Keeps resolved urls till they expire, so stream restarts not run streamlink again,
+// links can be updated by daemon at any time, generator used as fallback if link absent or expired.
+class CachedLinkGenerator : public ILinkGenerator {
+ public:
+  enum { expire_margin_msec = 30 * 1000 };
+
+  explicit CachedLinkGenerator(const ILinkGenerator* generator);
+
+  bool Generate(const InputUri& src, InputUri* out) const override WARN_UNUSED_RESULT;
+
+  void Update(const common::uri::GURL& source, const common::uri::GURL& resolved, fastotv::timestamp_t expire_utc_msec);
+
+ private:
+  struct ResolvedLink {
+    common::uri::GURL url;
+    fastotv::timestamp_t expire_utc_msec;
+  };
+
+  const ILinkGenerator* const generator_;
+  mutable std::mutex links_mutex_;
+  mutable std::unordered_map<std::string, ResolvedLink> links_;
+};
+
+}  // namespace link_generator
+}  // namespace stream
+}  // namespace fastocloud
@@ -16,51 +16,7 @@
 
 #include "stream/link_generator/streamlink.h"
 
-#include <common/sprintf.h>
-
-namespace {
-bool GetTrueUrl(const std::string& path,
-                const common::uri::GURL& url,
-                const fastotv::StreamLink& link,
-                common::uri::GURL* generated_url) {
-  if (!generated_url) {
-    return false;
-  }
-
-  std::string cmd_line = path + " --stream-url";
-  const auto http = link.GetHttp();
-  if (http) {
-    cmd_line += " --http-proxy=" + http->spec();
-  }
-
-  const auto https = link.GetHttps();
-  if (https) {
-    cmd_line += " --https-proxy=" + https->spec();
-  }
-
-  cmd_line += " " + url.spec() + " best";
-  FILE* fp = popen(cmd_line.c_str(), "r");
-  if (!fp) {
-    return false;
-  }
-
-  char true_url[1024] = {0};
-  char* res = fgets(true_url, sizeof(true_url) - 1, fp);
-  pclose(fp);
-
-  if (!res) {
-    return false;
-  }
-
-  size_t ln = strlen(true_url) - 1;
-  if (true_url[ln] == '\n') {
-    true_url[ln] = 0;
-  }
-
-  *generated_url = common::uri::GURL(true_url);
-  return true;
-}
-}  // namespace
+#include "base/stream_link.h"
 
 namespace fastocloud {
 namespace stream {
@@ -84,7 +40,7 @@ bool StreamLinkGenerator::Generate(const InputUri& src, InputUri* out) const {
   }
 
   common::uri::GURL gen;
-  if (!GetTrueUrl(script_path_.GetPath(), src.GetUrl(), *str, &gen)) {
+  if (!ResolveStreamLink(script_path_.GetPath(), src.GetUrl(), *str, &gen)) {
     return false;
   }
 
@@ -0,0 +1,252 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/playlist_reader.h"
+
+#if defined(OS_POSIX)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+
+namespace fastocloud {
+namespace stream {
+
+class PlaylistReader::BlockFile {
+ public:
+  explicit BlockFile(const InputUri& uri) : uri_(uri), size_(0), fd_(INVALID_DESCRIPTOR), file_(nullptr) {}
+
+  ~BlockFile() {
+#if defined(OS_POSIX)
+    if (fd_ != INVALID_DESCRIPTOR) {
+      close(fd_);
+    }
+#else
+    if (file_) {
+      fclose(file_);
+    }
+#endif
+  }
+
+  bool Open(const std::string& path) {
+#if defined(OS_POSIX)
+    fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ == INVALID_DESCRIPTOR) {
+      return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) == 0 && st.st_size > 0) {
+      size_ = static_cast<size_t>(st.st_size);
+      posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+      WillNeed(0);
+    }
+    return size_ != 0;
+#else
+    file_ = fopen(path.c_str(), "rb");
+    if (!file_) {
+      return false;
+    }
+
+    fseek(file_, 0, SEEK_END);
+    const long size = ftell(file_);
+    fseek(file_, 0, SEEK_SET);
+    size_ = size > 0 ? static_cast<size_t>(size) : 0;
+    return size_ != 0;
+#endif
+  }
+
+  const InputUri& GetUri() const { return uri_; }
+
+  // pages of next blocks are read by kernel while current block is muxed
+  void WillNeed(size_t offset) {
+#if defined(OS_POSIX)
+    if (offset >= size_) {
+      return;
+    }
+
+    const size_t length = std::min<size_t>(size_ - offset, block_size * readahead_blocks);
+    posix_fadvise(fd_, offset, length, POSIX_FADV_WILLNEED);
+#else
+    UNUSED(offset);
+#endif
+  }
+
+  // false if nothing can be read at offset (end of file, truncated file or read error)
+  bool ReadBlock(size_t offset, GstBuffer* buffer) {
+    gst_buffer_set_size(buffer, block_size);  // may be shrunk by previous read
+    if (offset >= size_) {
+      return false;
+    }
+
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+      return false;
+    }
+
+    const size_t size = std::min<size_t>(map.size, size_ - offset);
+    size_t total = 0;
+#if defined(OS_POSIX)
+    while (total < size) {
+      const ssize_t nread = pread(fd_, map.data + total, size - total, offset + total);
+      if (nread < 0 && errno == EINTR) {
+        continue;
+      }
+      if (nread <= 0) {
+        break;
+      }
+      total += nread;
+    }
+#else
+    total = fread(map.data, 1, size, file_);
+#endif
+    gst_buffer_unmap(buffer, &map);
+    gst_buffer_set_size(buffer, total);
+    if (total != size) {
+      WARNING_LOG() << "File " << uri_.GetUrl().path() << " shrunk while playing, size: " << offset + total
+                    << ", expected: " << size_;
+      size_ = offset + total;
+    }
+    return total != 0;
+  }
+
+ private:
+  const InputUri uri_;
+  size_t size_;
+  int fd_;
+  FILE* file_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockFile);
+};
+
+PlaylistReader::PlaylistReader(const input_t& playlist, bool loop, file_opened_callback_t opened_cb)
+    : playlist_(playlist),
+      loop_(loop),
+      opened_cb_(opened_cb),
+      pool_(gst_buffer_pool_new()),
+      pos_(0),
+      current_(),
+      offset_(0),
+      next_() {
+  GstStructure* config = gst_buffer_pool_get_config(pool_);
+  gst_buffer_pool_config_set_params(config, nullptr, block_size, 0, 0);
+  gst_buffer_pool_set_config(pool_, config);
+  gst_buffer_pool_set_active(pool_, TRUE);
+}
+
+PlaylistReader::~PlaylistReader() {
+  if (next_.valid()) {
+    next_.wait();
+  }
+  gst_buffer_pool_set_active(pool_, FALSE);  // buffers still in pipeline are freed when released
+  gst_object_unref(pool_);
+}
+
+GstBuffer* PlaylistReader::ReadBuffer() {
+  GstBuffer* buffer = nullptr;
+  if (gst_buffer_pool_acquire_buffer(pool_, &buffer, nullptr) != GST_FLOW_OK) {
+    return nullptr;
+  }
+
+  // next entry at the end of current file, also if it was truncated while playing
+  for (size_t attempts = 0; !current_ || !current_->ReadBlock(offset_, buffer); ++attempts) {
+    if (attempts > playlist_.size()) {  // every entry failed
+      gst_buffer_unref(buffer);
+      return nullptr;
+    }
+
+    current_ = TakeNextFile();
+    offset_ = 0;
+    if (!current_) {
+      if (!next_.valid()) {  // playlist finished
+        gst_buffer_unref(buffer);
+        return nullptr;
+      }
+      continue;
+    }
+
+    INFO_LOG() << "File " << current_->GetUri().GetUrl().path() << " open for playing";
+    if (opened_cb_) {
+      opened_cb_(current_->GetUri());
+    }
+  }
+
+  offset_ += gst_buffer_get_size(buffer);
+  current_->WillNeed(offset_ + block_size * (readahead_blocks - 1));
+  return buffer;
+}
+
+PlaylistReader::file_t PlaylistReader::OpenFile(const InputUri& uri) {
+  const std::string path = uri.GetUrl().path();
+  file_t file = std::make_shared<BlockFile>(uri);
+  if (!file->Open(path)) {
+    WARNING_LOG() << "File " << path << " can't open for playing";
+    return file_t();
+  }
+  return file;
+}
+
+bool PlaylistReader::NextEntry(InputUri* uri) {
+  if (playlist_.empty()) {
+    return false;
+  }
+
+  if (pos_ >= playlist_.size()) {
+    if (!loop_) {
+      return false;
+    }
+    pos_ = 0;
+  }
+
+  *uri = playlist_[pos_++];
+  return true;
+}
+
+void PlaylistReader::StartPrefetch() {
+  InputUri uri;
+  if (!NextEntry(&uri)) {
+    INFO_LOG() << "No more files for playing";
+    next_ = std::future<file_t>();
+    return;
+  }
+
+  next_ = std::async(std::launch::async, &PlaylistReader::OpenFile, uri);
+}
+
+PlaylistReader::file_t PlaylistReader::TakeNextFile() {
+  if (!next_.valid()) {
+    if (current_) {  // previous prefetch found playlist end
+      return file_t();
+    }
+
+    StartPrefetch();  // first file
+    if (!next_.valid()) {
+      return file_t();
+    }
+  }
+
+  file_t file = next_.get();
+  StartPrefetch();
+  return file;
+}
+
+}  // namespace stream
+}  // namespace fastocloud
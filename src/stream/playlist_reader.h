@@ -0,0 +1,68 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <gst/gst.h>
+
+#include <functional>
+#include <future>
+#include <memory>
+
+#include <common/macros.h>
+
+#include "base/inputs_outputs.h"
+
+namespace fastocloud {
+namespace stream {
+
+// Feeds appsrc of playlist streams: current file is read with pread into buffers of a pool with kernel readahead,
+// next entry is opened in background, so file boundaries don't stall streaming thread.
+// File truncated while playing is finished at its new size (no SIGBUS as with mapped file).
+class PlaylistReader {
+ public:
+  enum { block_size = 1024 * 1024, readahead_blocks = 4 };
+  typedef std::function<void(const InputUri& uri)> file_opened_callback_t;
+
+  PlaylistReader(const input_t& playlist, bool loop, file_opened_callback_t opened_cb);
+  ~PlaylistReader();
+
+  // streaming thread, nullptr if playlist finished or no file can be opened
+  GstBuffer* ReadBuffer();
+
+ private:
+  class BlockFile;
+  typedef std::shared_ptr<BlockFile> file_t;
+
+  static file_t OpenFile(const InputUri& uri);
+
+  bool NextEntry(InputUri* uri);
+  void StartPrefetch();
+  file_t TakeNextFile();
+
+  const input_t playlist_;
+  const bool loop_;
+  const file_opened_callback_t opened_cb_;
+  GstBufferPool* const pool_;
+
+  size_t pos_;
+  file_t current_;
+  size_t offset_;
+  std::future<file_t> next_;
+
+  DISALLOW_COPY_AND_ASSIGN(PlaylistReader);
+};
+
+}  // namespace stream
+}  // namespace fastocloud
@@ -16,9 +16,30 @@
 
 #include "stream/ibase_stream.h"
 
+namespace {
+gsize buffer_list_size(GstBufferList* buffer_list) {
+  gsize size = 0;
+  const guint len = gst_buffer_list_length(buffer_list);
+  for (guint i = 0; i < len; ++i) {
+    size += gst_buffer_get_size(gst_buffer_list_get(buffer_list, i));
+  }
+  return size;
+}
+}  // namespace
+
 namespace fastocloud {
 namespace stream {
 
+ProbeCounter::ProbeCounter() : head_pad_(), bytes_(0), tail_pad_() {}
+
+void ProbeCounter::Add(uint64_t bytes) {
+  bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+uint64_t ProbeCounter::Get() const {
+  return bytes_.load(std::memory_order_relaxed);
+}
+
 Consistency::Consistency()
     : segment(FALSE),
       eos(TRUE),
@@ -28,8 +49,9 @@ Consistency::Consistency()
       saw_serialized_event(FALSE) {}
 
 Probe::Probe(element_id_t id, const common::uri::GURL& url, IBaseStream* stream)
-    : stream_(stream), id_(id), id_buffer_(0), pad_(nullptr), consistency_(), url_(url) {
+    : stream_(stream), id_(id), id_buffer_(0), pad_(nullptr), consistency_(), segment_(), url_(url), counter_() {
   CHECK(stream);
+  gst_segment_init(&segment_, GST_FORMAT_UNDEFINED);
 }
 
 Probe::~Probe() {
@@ -48,6 +70,14 @@ void Probe::Clear() {
   gst_pad_remove_probe(pad_, id_buffer_);
 }
 
+void Probe::SetSegment(GstEvent* event) {
+  const GstSegment* segment = nullptr;
+  gst_event_parse_segment(event, &segment);
+  if (segment) {
+    gst_segment_copy_into(segment, &segment_);
+  }
+}
+
 void Probe::ClearInner() {
   pad_ = nullptr;
   id_buffer_ = 0;
@@ -65,27 +95,61 @@ Consistency Probe::GetConsistency() const {
   return consistency_;
 }
 
+void Probe::AddBytes(gsize size) {
+  counter_.Add(size);
+}
+
+uint64_t Probe::GetTotalBytes() const {
+  return counter_.Get();
+}
+
+bool Probe::CountData(GstPadProbeInfo* info, LatencyStage stage) {
+  void* data = GST_PAD_PROBE_INFO_DATA(info);
+  if (GST_IS_BUFFER(data)) {
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    AddBytes(gst_buffer_get_size(buffer));
+    stream_->TraceBufferLatency(stage, &segment_, buffer);
+    return true;
+  }
+
+  if (GST_IS_BUFFER_LIST(data)) {
+    GstBufferList* buffer_list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+    if (gst_buffer_list_length(buffer_list)) {
+      AddBytes(buffer_list_size(buffer_list));
+      stream_->TraceBufferLatency(stage, &segment_, gst_buffer_list_get(buffer_list, 0));
+    }
+    return true;
+  }
+
+  return false;
+}
+
 void Probe::destroy_callback_probe(gpointer user_data) {
   Probe* probe = reinterpret_cast<Probe*>(user_data);
   probe->ClearInner();
 }
 
-InputProbe::InputProbe(element_id_t id, const common::uri::GURL& url, IBaseStream* stream)
-    : base_class(id, url, stream) {}
+InputProbe::InputProbe(element_id_t id, const common::uri::GURL& url, bool check_data, IBaseStream* stream)
+    : base_class(id, url, stream), check_data_(check_data) {}
 
 GstPadProbeReturn InputProbe::source_callback_probe_buffer(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
   InputProbe* probe = reinterpret_cast<InputProbe*>(user_data);
+  if (!probe->check_data_ && probe->CountData(info, LATENCY_STAGE_INPUT)) {  // hot path, no virtual calls
+    return GST_PAD_PROBE_OK;
+  }
+
   IBaseStream* stream = probe->stream_;
   GstPadProbeInfo* checked_info = stream->CheckProbeData(probe, info);
   if (!checked_info) {
     return GST_PAD_PROBE_DROP;
   }
 
+  if (probe->CountData(checked_info, LATENCY_STAGE_INPUT)) {
+    return GST_PAD_PROBE_OK;
+  }
+
   void* data = GST_PAD_PROBE_INFO_DATA(checked_info);
-  if (GST_IS_BUFFER(data)) {
-    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(checked_info);
-    stream->UpdateInputProbeStats(probe, gst_buffer_get_size(buffer));
-  } else if (GST_IS_EVENT(data)) {
+  if (GST_IS_EVENT(data)) {
     GstEvent* event = GST_EVENT(data);
     const gchar* event_name = GST_EVENT_TYPE_NAME(event);
     GstEventType event_type = GST_EVENT_TYPE(event);
@@ -127,8 +191,7 @@ GstPadProbeReturn InputProbe::source_callback_probe_buffer(GstPad* pad, GstPadPr
       if (probe->consistency_.expect_flush && probe->consistency_.flushing) {
         INFO_LOG() << "Received SEGMENT while in a flushing seek on pad " << pad;
       }
-      const GstSegment* segment = nullptr;
-      gst_event_parse_segment(event, &segment);
+      probe->SetSegment(event);
       probe->consistency_.segment = TRUE;
       probe->consistency_.eos = FALSE;
     } else if (event_type == GST_EVENT_EOS) {
@@ -191,29 +254,31 @@ void InputProbe::Link(GstPad* pad) {
   DEBUG_LOG() << "Input probe added id: " << id_probe;
 }
 
-OutputProbe::OutputProbe(element_id_t id, const common::uri::GURL& url, bool need_push, IBaseStream* stream)
-    : base_class(id, url, stream), need_push_(need_push) {}
+OutputProbe::OutputProbe(element_id_t id,
+                         const common::uri::GURL& url,
+                         bool need_push,
+                         bool check_data,
+                         IBaseStream* stream)
+    : base_class(id, url, stream), need_push_(need_push), check_data_(check_data) {}
 
 GstPadProbeReturn OutputProbe::sink_callback_probe_buffer(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
   OutputProbe* probe = reinterpret_cast<OutputProbe*>(user_data);
+  if (!probe->check_data_ && probe->CountData(info, LATENCY_STAGE_OUTPUT)) {  // hot path, no virtual calls
+    return GST_PAD_PROBE_OK;
+  }
+
   IBaseStream* stream = probe->stream_;
   GstPadProbeInfo* checked_info = stream->CheckProbeDataOutput(probe, info);
   if (!checked_info) {
     return GST_PAD_PROBE_DROP;
   }
 
+  if (probe->CountData(checked_info, LATENCY_STAGE_OUTPUT)) {
+    return GST_PAD_PROBE_OK;
+  }
+
   void* data = GST_PAD_PROBE_INFO_DATA(checked_info);
-  if (GST_IS_BUFFER(data)) {
-    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(checked_info);
-    stream->UpdateOutputProbeStats(probe, gst_buffer_get_size(buffer));
-  } else if (GST_IS_BUFFER_LIST(data)) {
-    GstBufferList* buffer_list = GST_PAD_PROBE_INFO_BUFFER_LIST(checked_info);
-    guint len = gst_buffer_list_length(buffer_list);
-    for (guint i = 0; i < len; ++i) {
-      GstBuffer* buffer = gst_buffer_list_get(buffer_list, i);
-      stream->UpdateOutputProbeStats(probe, gst_buffer_get_size(buffer));
-    }
-  } else if (GST_IS_EVENT(data)) {
+  if (GST_IS_EVENT(data)) {
     GstEvent* event = GST_EVENT(data);
     const gchar* event_name = GST_EVENT_TYPE_NAME(event);
     GstEventType event_type = GST_EVENT_TYPE(event);
@@ -240,6 +305,7 @@ GstPadProbeReturn OutputProbe::sink_callback_probe_buffer(GstPad* pad, GstPadPro
       if (probe->consistency_.expect_flush && probe->consistency_.flushing) {
         INFO_LOG() << "Received SEGMENT while in a flushing seek on pad " << pad;
       }
+      probe->SetSegment(event);
       probe->consistency_.segment = TRUE;
       probe->consistency_.eos = FALSE;
     } else if (event_type == GST_EVENT_EOS) {
@@ -290,5 +356,49 @@ void OutputProbe::Link(GstPad* pad) {
   DEBUG_LOG() << "Output probe added id: " << id_probe;
 }
 
+StageProbe::StageProbe(LatencyStage stage, IBaseStream* stream)
+    : base_class(stage, common::uri::GURL(), stream), stage_(stage) {}
+
+LatencyStage StageProbe::GetStage() const {
+  return stage_;
+}
+
+GstPadProbeReturn StageProbe::stage_callback_probe_buffer(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+  UNUSED(pad);
+  StageProbe* probe = reinterpret_cast<StageProbe*>(user_data);
+  if (probe->CountData(info, probe->stage_)) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  void* data = GST_PAD_PROBE_INFO_DATA(info);
+  if (GST_IS_EVENT(data)) {
+    GstEvent* event = GST_EVENT(data);
+    if (GST_EVENT_TYPE(event) == GST_EVENT_SEGMENT) {
+      probe->SetSegment(event);
+    }
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+void StageProbe::Link(GstPad* pad) {
+  if (!pad) {
+    return;
+  }
+
+  Clear();
+
+  gulong id_probe = gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_DATA_DOWNSTREAM, stage_callback_probe_buffer, this,
+                                      &destroy_callback_probe);
+  if (!id_probe) {
+    CRITICAL_LOG() << "Cannot add stage probe";
+    return;
+  }
+
+  pad_ = pad;
+  id_buffer_ = id_probe;
+  DEBUG_LOG() << "Stage probe added id: " << id_probe << ", stage: " << LatencyStats::GetStageName(stage_);
+}
+
 }  // namespace stream
 }  // namespace fastocloud
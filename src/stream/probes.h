@@ -16,10 +16,13 @@
 
 #include <common/utils.h>
 
+#include <atomic>
 #include <string>  // for string
 
 #include <gst/gstpad.h>  // for GstPad, GstPadProbeInfo, GstPadProbeReturn
 
+#include "base/latency_stats.h"
+
 #include "stream/stypes.h"
 
 namespace fastocloud {
@@ -38,6 +41,24 @@ struct Consistency {
   gboolean saw_serialized_event;
 };
 
+// Bytes counter alone on its cache line: written by one streaming thread with relaxed atomics,
+// aggregated by main loop timer. Padded from both sides since heap objects are not cache line aligned.
+class ProbeCounter {
+ public:
+  enum { CACHE_LINE_SIZE = 64 };
+  ProbeCounter();
+
+  void Add(uint64_t bytes);
+  uint64_t Get() const;
+
+ private:
+  char head_pad_[CACHE_LINE_SIZE];
+  std::atomic<uint64_t> bytes_;
+  char tail_pad_[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+
+  DISALLOW_COPY_AND_ASSIGN(ProbeCounter);
+};
+
 class Probe {
  public:
   Probe(element_id_t id, const common::uri::GURL& url, IBaseStream* stream);
@@ -51,10 +72,16 @@ class Probe {
   GstPad* GetPad() const;
   Consistency GetConsistency() const;
 
+  void AddBytes(gsize size);
+  uint64_t GetTotalBytes() const;
+
  protected:
   static void destroy_callback_probe(gpointer user_data);
 
   void Clear();
+  void SetSegment(GstEvent* event);
+  // counts buffer or buffer list and traces its latency, false if info is not data
+  bool CountData(GstPadProbeInfo* info, LatencyStage stage);
 
  private:
   void ClearInner();
@@ -66,7 +93,9 @@ class Probe {
   gulong id_buffer_;
   GstPad* pad_;
   Consistency consistency_;
+  GstSegment segment_;  // last segment, buffers and serialized events of pad come from one thread
   const common::uri::GURL url_;
+  ProbeCounter counter_;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(Probe);
@@ -75,18 +104,22 @@ class Probe {
 class InputProbe : public Probe {
  public:
   typedef Probe base_class;
-  InputProbe(element_id_t id, const common::uri::GURL& url, IBaseStream* stream);
+  // check_data: buffers go through IBaseStream::CheckProbeData, otherwise only counted
+  InputProbe(element_id_t id, const common::uri::GURL& url, bool check_data, IBaseStream* stream);
 
   void Link(GstPad* pad) override;
 
  private:
   static GstPadProbeReturn source_callback_probe_buffer(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+
+  const bool check_data_;
 };
 
 class OutputProbe : public Probe {
  public:
   typedef Probe base_class;
-  OutputProbe(element_id_t id, const common::uri::GURL& url, bool need_push, IBaseStream* stream);
+  // check_data: buffers go through IBaseStream::CheckProbeDataOutput, otherwise only counted
+  OutputProbe(element_id_t id, const common::uri::GURL& url, bool need_push, bool check_data, IBaseStream* stream);
 
   bool GetNeedPush() const;
 
@@ -96,6 +129,23 @@ class OutputProbe : public Probe {
   static GstPadProbeReturn sink_callback_probe_buffer(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
 
   const bool need_push_;
+  const bool check_data_;
+};
+
+// traces buffers age between input and output, pad of any direction
+class StageProbe : public Probe {
+ public:
+  typedef Probe base_class;
+  StageProbe(LatencyStage stage, IBaseStream* stream);
+
+  LatencyStage GetStage() const;
+
+  void Link(GstPad* pad) override;
+
+ private:
+  static GstPadProbeReturn stage_callback_probe_buffer(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+
+  const LatencyStage stage_;
 };
 
 }  // namespace stream
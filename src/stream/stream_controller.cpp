@@ -29,7 +29,6 @@
 
 #include "stream/configs_factory.h"
 #include "stream/ibase_stream.h"
-#include "stream/link_generator/streamlink.h"
 #include "stream/probes.h"
 #include "stream/stream_server.h"
 #include "stream/streams/configs/relay_config.h"
@@ -67,15 +66,29 @@ TimeShiftInfo make_timeshift_info(const StreamConfig& config) {
   return tinfo;
 }
 
+bool MakeResolvedLinkInfo(const char* json, ResolvedLinkInfo* link) {
+  json_object* jlink = json_tokener_parse(json);
+  if (!jlink) {
+    return false;
+  }
+
+  common::Error err = link->DeSerialize(jlink);
+  json_object_put(jlink);
+  return !err;
+}
+
 }  // namespace
 
 StreamController::StreamController(const common::file_system::ascii_directory_string_path& feedback_dir,
                                    const common::file_system::ascii_file_string_path& streamlink_path,
                                    fastotv::protocol::protocol_client_t* command_client,
-                                   StreamStruct* mem)
+                                   StreamStruct* mem,
+                                   StreamStatsBlock* stats_block)
     : IBaseStream::IStreamClient(),
       feedback_dir_(feedback_dir),
       streamlink_path_(streamlink_path),
+      streamlink_(streamlink_path),
+      links_(&streamlink_),
       config_(nullptr),
       timeshift_info_(),
       restart_attempts_(0),
@@ -87,6 +100,7 @@ StreamController::StreamController(const common::file_system::ascii_directory_st
       ttl_master_timer_(0),
       libev_started_(2),
       mem_(mem),
+      stats_block_(stats_block),
       origin_(nullptr),
 #if defined(OS_WIN)
       process_metrics_(common::process::ProcessMetrics::CreateProcessMetrics(GetCurrentProcess()))
@@ -122,6 +136,31 @@ common::Error StreamController::Init(const StreamConfig& config_args) {
     }
   }
 
+  // streamlink urls and dvb tuner feeds both replace source urls of inputs
+  for (const char* links_field : {STREAM_LINK_RESOLVED_FIELD, DVB_TUNER_FEEDS_FIELD}) {
+    common::ArrayValue* resolved_links = nullptr;
+    common::Value* resolved_links_field = config_args->Find(links_field);
+    if (!resolved_links_field || !resolved_links_field->GetAsList(&resolved_links)) {
+      continue;
+    }
+
+    for (size_t i = 0; i < resolved_links->GetSize(); ++i) {
+      common::Value* link_value = nullptr;
+      std::string link_json;
+      ResolvedLinkInfo link;
+      if (resolved_links->Get(i, &link_value) && link_value->GetAsBasicString(&link_json) &&
+          MakeResolvedLinkInfo(link_json.c_str(), &link)) {
+        UpdateResolvedLink(link);
+      }
+    }
+  }
+
+  bool compact_framing = false;
+  common::Value* compact_framing_field = config_args->Find(PIPE_COMPACT_FRAMING_FIELD);
+  if (compact_framing_field && compact_framing_field->GetAsBoolean(&compact_framing)) {
+    static_cast<StreamServer*>(loop_)->SetCompactFraming(compact_framing);
+  }
+
   init_.Init(0, nullptr, enc);
   if (enc == GPU_NVIDIA) {
     /*if (!init_.SetPluginAsPrimary("nvdec", 10)) {
@@ -141,7 +180,6 @@ StreamController::~StreamController() {
 }
 
 int StreamController::Exec() {
-  const link_generator::StreamLinkGenerator gena(streamlink_path_);
   ev_thread_ = std::thread([this] {
     int res = loop_->Exec();
     UNUSED(res);
@@ -176,7 +214,7 @@ int StreamController::Exec() {
     int stabled_status = EXIT_SUCCESS;
     const int signal_number = 0;
     const fastotv::timestamp_t start_utc_now = common::time::current_utc_mstime();
-    const std::unique_ptr<Config> config_copy(make_config_copy(config_, &gena));
+    const std::unique_ptr<Config> config_copy(make_config_copy(config_, &links_));
     origin_ =
         StreamsFactory::GetInstance().CreateStream(config_copy.get(), this, mem_, timeshift_info_, start_chunk_index);
     if (!origin_) {
@@ -291,6 +329,29 @@ void StreamController::Closed(common::libev::IoClient* client) {
 }
 
 common::ErrnoError StreamController::StreamDataRecived(common::libev::IoClient* client) {
+  StreamServer* server = static_cast<StreamServer*>(loop_);
+  if (server->IsCompactFraming()) {
+    CompactFrameReader* reader = server->GetFrameReader();
+    common::ErrnoError err = reader->ReadFrom(client);
+    if (err) {
+      return err;
+    }
+
+    while (true) {
+      CompactFrame frame;
+      bool ready = false;
+      err = reader->PopFrame(&frame, &ready);
+      if (err || !ready) {
+        return err;
+      }
+
+      err = HandleCompactFrame(frame);
+      if (err) {
+        return err;
+      }
+    }
+  }
+
   std::string input_command;
   fastotv::protocol::protocol_client_t* pclient = static_cast<fastotv::protocol::protocol_client_t*>(client);
   common::ErrnoError err = pclient->ReadCommand(&input_command);
@@ -368,12 +429,36 @@ void StreamController::ChildStatusChanged(common::libev::IoChild* child, int sta
   UNUSED(signal);
 }
 
+common::ErrnoError StreamController::HandleCompactFrame(const CompactFrame& frame) {
+  CHECK(loop_->IsLoopThread());
+  if (frame.type == COMPACT_FRAME_STOP) {
+    Stop();
+    return common::ErrnoError();
+  } else if (frame.type == COMPACT_FRAME_RESTART) {
+    Restart();
+    return common::ErrnoError();
+  } else if (frame.type == COMPACT_FRAME_RESOLVED_LINK) {
+    ResolvedLinkInfo link;
+    if (!MakeResolvedLinkInfo(frame.payload.c_str(), &link)) {
+      return common::make_errno_error_inval();
+    }
+
+    UpdateResolvedLink(link);
+    return common::ErrnoError();
+  }
+
+  WARNING_LOG() << "Received unknown frame type: " << static_cast<int>(frame.type);
+  return common::ErrnoError();
+}
+
 common::ErrnoError StreamController::HandleRequestCommand(common::libev::IoClient* client,
                                                           const fastotv::protocol::request_t* req) {
   if (req->method == STOP_STREAM) {
     return HandleRequestStopStream(client, req);
   } else if (req->method == RESTART_STREAM) {
     return HandleRequestRestartStream(client, req);
+  } else if (req->method == RESOLVED_LINK_STREAM) {
+    return HandleRequestResolvedLinkStream(client, req);
   }
 
   WARNING_LOG() << "Received unknown command: " << req->method;
@@ -419,6 +504,34 @@ common::ErrnoError StreamController::HandleRequestRestartStream(common::libev::I
   return common::ErrnoError();
 }
 
+common::ErrnoError StreamController::HandleRequestResolvedLinkStream(common::libev::IoClient* client,
+                                                                     const fastotv::protocol::request_t* req) {
+  UNUSED(client);
+  CHECK(loop_->IsLoopThread());
+  if (!req->params) {
+    return common::make_errno_error_inval();
+  }
+
+  ResolvedLinkInfo link;
+  if (!MakeResolvedLinkInfo(req->params->c_str(), &link)) {
+    return common::make_errno_error_inval();
+  }
+
+  UpdateResolvedLink(link);
+  return common::ErrnoError();
+}
+
+void StreamController::UpdateResolvedLink(const ResolvedLinkInfo& link) {
+  const common::uri::GURL source(link.GetSource());
+  const common::uri::GURL url(link.GetUrl());
+  if (!source.is_valid() || !url.is_valid()) {
+    return;
+  }
+
+  DEBUG_LOG() << "Resolved link: " << source.spec() << " => " << url.spec();
+  links_.Update(source, url, link.GetExpireTime());
+}
+
 void StreamController::StopStream() {
   if (origin_) {
     origin_->Quit(EXIT_SELF);
@@ -471,7 +584,7 @@ void StreamController::OnPipelineEOS(IBaseStream* stream) {
 }
 
 void StreamController::OnTimeoutUpdated(IBaseStream* stream) {
-  DumpStreamStatus(stream->GetStats());
+  ReportStreamStatus(stream->GetStats());
 }
 
 void StreamController::OnASyncMessageReceived(IBaseStream* stream, GstMessage* message) {
@@ -511,6 +624,21 @@ void StreamController::OnPipelineCreated(IBaseStream* stream) {
 }
 
 void StreamController::DumpStreamStatus(StreamStruct* stat) {
+  const StatisticInfo statistic = MakeStatisticInfo(*stat);
+  static_cast<StreamServer*>(loop_)->SendStatisticBroadcast(statistic);
+}
+
+void StreamController::ReportStreamStatus(StreamStruct* stat) {
+  if (!stats_block_) {
+    DumpStreamStatus(stat);
+    return;
+  }
+
+  const StatisticInfo statistic = MakeStatisticInfo(*stat);
+  stats_block_->Write(*stat, statistic.GetCpuLoad(), statistic.GetRssBytes(), statistic.GetTimestamp());
+}
+
+StatisticInfo StreamController::MakeStatisticInfo(const StreamStruct& stat) const {
   const double cpu_load = process_metrics_->GetPlatformIndependentCPUUsage();
 #if defined(OS_LINUX) || defined(OS_ANDROID)
   const size_t rss = process_metrics_->GetResidentSetSize();
@@ -519,8 +647,7 @@ void StreamController::DumpStreamStatus(StreamStruct* stat) {
   const size_t rss = 0;
 #endif
   const fastotv::timestamp_t current_time = common::time::current_utc_mstime();
-  StatisticInfo statistic(*stat, cpu_load, rss, current_time);
-  static_cast<StreamServer*>(loop_)->SendStatisticBroadcast(statistic);
+  return StatisticInfo(stat, cpu_load, rss, current_time);
 }
 
 }  // namespace stream
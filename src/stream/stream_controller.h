@@ -27,9 +27,15 @@
 #include <fastotv/protocol/types.h>
 
 #include "base/stream_config.h"
+#include "base/stream_stats_block.h"
 #include "stream/gstreamer_init.h"
 #include "stream/ibase_stream.h"
+#include "stream/link_generator/cached_link_generator.h"
+#include "stream/link_generator/streamlink.h"
 #include "stream/timeshift.h"
+#include "stream_commands/commands_info/resolved_link_info.h"
+#include "stream_commands/commands_info/statistic_info.h"
+#include "stream_commands/compact_frame.h"
 
 namespace fastocloud {
 namespace stream {
@@ -41,7 +47,8 @@ class StreamController : public common::libev::IoLoopObserver, public IBaseStrea
   StreamController(const common::file_system::ascii_directory_string_path& feedback_dir,
                    const common::file_system::ascii_file_string_path& streamlink_path,
                    fastotv::protocol::protocol_client_t* command_client,
-                   StreamStruct* mem);
+                   StreamStruct* mem,
+                   StreamStatsBlock* stats_block);
 
   common::Error Init(const StreamConfig& config_args);
 
@@ -56,10 +63,15 @@ class StreamController : public common::libev::IoLoopObserver, public IBaseStrea
                                                    const fastotv::protocol::response_t* resp) WARN_UNUSED_RESULT;
 
  private:
+  common::ErrnoError HandleCompactFrame(const CompactFrame& frame) WARN_UNUSED_RESULT;
   common::ErrnoError HandleRequestStopStream(common::libev::IoClient* client,
                                              const fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
   common::ErrnoError HandleRequestRestartStream(common::libev::IoClient* client,
                                                 const fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
+  common::ErrnoError HandleRequestResolvedLinkStream(common::libev::IoClient* client,
+                                                     const fastotv::protocol::request_t* req) WARN_UNUSED_RESULT;
+
+  void UpdateResolvedLink(const ResolvedLinkInfo& link);
 
   void Stop();
   void Restart();
@@ -102,9 +114,14 @@ class StreamController : public common::libev::IoLoopObserver, public IBaseStrea
   common::ErrnoError SendResponceToParent(const std::string& cmd) WARN_UNUSED_RESULT;
 
   void DumpStreamStatus(StreamStruct* stat);
+  // periodic stats go to shared block if daemon provided it, otherwise same as DumpStreamStatus
+  void ReportStreamStatus(StreamStruct* stat);
+  StatisticInfo MakeStatisticInfo(const StreamStruct& stat) const;
 
   const common::file_system::ascii_directory_string_path feedback_dir_;
   const common::file_system::ascii_file_string_path streamlink_path_;
+  const link_generator::StreamLinkGenerator streamlink_;
+  link_generator::CachedLinkGenerator links_;  // links resolved by daemon or streamlink_
   const Config* config_;
   TimeShiftInfo timeshift_info_;
   size_t restart_attempts_;
@@ -119,6 +136,7 @@ class StreamController : public common::libev::IoLoopObserver, public IBaseStrea
   common::threads::barrier libev_started_;
 
   StreamStruct* mem_;
+  StreamStatsBlock* const stats_block_;
 
   //
   IBaseStream* origin_;
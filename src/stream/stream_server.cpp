@@ -22,7 +22,10 @@ namespace stream {
 
 StreamServer::StreamServer(fastotv::protocol::protocol_client_t* command_client,
                            common::libev::IoLoopObserver* observer)
-    : base_class(new common::libev::LibEvLoop, observer), command_client_(command_client) {
+    : base_class(new common::libev::LibEvLoop, observer),
+      command_client_(command_client),
+      compact_framing_(false),
+      frame_reader_() {
   CHECK(command_client);
 }
 
@@ -31,11 +34,39 @@ void StreamServer::WriteRequest(const fastotv::protocol::request_t& request) {
   ExecInLoopThread(cb);
 }
 
+void StreamServer::WriteFrame(CompactFrameType type, const std::string& payload) {
+  auto cb = [this, type, payload] { ignore_result(WriteCompactFrame(command_client_, type, payload)); };
+  ExecInLoopThread(cb);
+}
+
+void StreamServer::SetCompactFraming(bool compact) {
+  compact_framing_ = compact;
+}
+
+bool StreamServer::IsCompactFraming() const {
+  return compact_framing_;
+}
+
+CompactFrameReader* StreamServer::GetFrameReader() {
+  return &frame_reader_;
+}
+
 const char* StreamServer::ClassName() const {
   return "StreamServer";
 }
 
 void StreamServer::SendChangeSourcesBroadcast(const ChangedSouresInfo& change) {
+  if (compact_framing_) {
+    std::string change_str;
+    common::Error err = change.SerializeToString(&change_str);
+    if (err) {
+      return;
+    }
+
+    WriteFrame(COMPACT_FRAME_CHANGED_SOURCES, change_str);
+    return;
+  }
+
   fastotv::protocol::request_t req;
   common::Error err = ChangedSourcesStreamBroadcast(change, &req);
   if (err) {
@@ -46,6 +77,17 @@ void StreamServer::SendChangeSourcesBroadcast(const ChangedSouresInfo& change) {
 }
 
 void StreamServer::SendStatisticBroadcast(const StatisticInfo& statistic) {
+  if (compact_framing_) {
+    std::string payload;
+    common::Error err = EncodeStatisticFrame(statistic, &payload);
+    if (err) {
+      return;
+    }
+
+    WriteFrame(COMPACT_FRAME_STATISTIC, payload);
+    return;
+  }
+
   fastotv::protocol::request_t req;
   common::Error err = StatisticStreamBroadcast(statistic, &req);
   if (err) {
@@ -61,6 +103,17 @@ bool StreamServer::IsCanBeRegistered(common::libev::IoClient* client) const {
 
 #if defined(MACHINE_LEARNING)
 void StreamServer::SendMlNotificationBroadcast(const fastotv::commands_info::ml::NotificationInfo& notification) {
+  if (compact_framing_) {
+    std::string notification_str;
+    common::Error err = notification.SerializeToString(&notification_str);
+    if (err) {
+      return;
+    }
+
+    WriteFrame(COMPACT_FRAME_ML_NOTIFICATION, notification_str);
+    return;
+  }
+
   fastotv::protocol::request_t req;
   common::Error err = NotificationMlStreamBroadcast(notification, &req);
   if (err) {
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <string>
+
 #include <common/libev/io_loop.h>
 #include <common/net/socket_info.h>
 
@@ -26,6 +28,7 @@
 
 #include "stream_commands/commands_info/changed_sources_info.h"
 #include "stream_commands/commands_info/statistic_info.h"
+#include "stream_commands/compact_frame.h"
 
 namespace fastocloud {
 namespace stream {
@@ -37,6 +40,12 @@ class StreamServer : public common::libev::IoLoop {
                         common::libev::IoLoopObserver* observer = nullptr);
 
   void WriteRequest(const fastotv::protocol::request_t& request) WARN_UNUSED_RESULT;
+  void WriteFrame(CompactFrameType type, const std::string& payload) WARN_UNUSED_RESULT;
+
+  // set before loop started, daemon negotiates it through config
+  void SetCompactFraming(bool compact);
+  bool IsCompactFraming() const;
+  CompactFrameReader* GetFrameReader();
 
   const char* ClassName() const override;
 
@@ -56,6 +65,8 @@ class StreamServer : public common::libev::IoLoop {
 
  private:
   fastotv::protocol::protocol_client_t* const command_client_;
+  bool compact_framing_;
+  CompactFrameReader frame_reader_;
 };
 
 }  // namespace stream
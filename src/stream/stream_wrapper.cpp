@@ -20,7 +20,10 @@
 
 #include "base/config_fields.h"
 #include "base/constants.h"
+#include "base/stream_stats_block.h"
 
+#include "stream/dvb_tuner.h"
+#include "stream/gstreamer_init.h"
 #include "stream/stream_controller.h"
 
 namespace {
@@ -33,6 +36,7 @@ int start_stream(const std::string& process_name,
                  common::logging::LOG_LEVEL logs_level,
                  const fastocloud::StreamConfig& config_args,
                  fastotv::protocol::protocol_client_t* command_client,
+                 fastocloud::StreamStatsBlock* stats_block,
                  const fastocloud::StreamInfo& sha) {
   auto log_file = feedback_dir.MakeFileStringPath(LOGS_FILE_NAME);
   if (log_file) {
@@ -47,7 +51,7 @@ int start_stream(const std::string& process_name,
   }
 
   const std::unique_ptr<fastocloud::StreamStruct> mem(new fastocloud::StreamStruct(sha));
-  fastocloud::stream::StreamController proc(feedback_dir, streamlink_path, command_client, mem.get());
+  fastocloud::stream::StreamController proc(feedback_dir, streamlink_path, command_client, mem.get(), stats_block);
   common::Error err = proc.Init(config_args);
   if (err) {
     WARNING_LOG() << err->GetDescription();
@@ -62,7 +66,12 @@ int start_stream(const std::string& process_name,
 
 }  // namespace
 
-int stream_exec(const char* process_name, const void* args, void* command_client) {
+int stream_preinit() {
+  fastocloud::stream::GstInitializer::InitCore(0, nullptr);
+  return EXIT_SUCCESS;
+}
+
+int stream_exec(const char* process_name, const void* args, void* command_client, void* stats_block) {
   if (!process_name || !args || !command_client) {
     CRITICAL_LOG() << "Invalid arguments.";
     return EXIT_FAILURE;
@@ -94,5 +103,25 @@ int stream_exec(const char* process_name, const void* args, void* command_client
 
   fastotv::protocol::protocol_client_t* client = static_cast<fastotv::protocol::protocol_client_t*>(command_client);
   return start_stream(process_name, common::file_system::ascii_directory_string_path(feedback_dir),
-                      common::file_system::ascii_file_string_path(streamlink_path), logs_level, sargs, client, sha);
+                      common::file_system::ascii_file_string_path(streamlink_path), logs_level, sargs, client,
+                      static_cast<fastocloud::StreamStatsBlock*>(stats_block), sha);
+}
+
+int tuner_exec(const char* process_name, const char* source_url, const char* feed_url) {
+  if (!process_name || !source_url || !feed_url) {
+    CRITICAL_LOG() << "Invalid arguments.";
+    return EXIT_FAILURE;
+  }
+
+  const common::uri::GURL source(source_url);
+  const common::uri::GURL feed(feed_url);
+  if (!source.is_valid() || !feed.is_valid()) {
+    CRITICAL_LOG() << "Invalid tuner urls: " << source_url << " => " << feed_url;
+    return EXIT_FAILURE;
+  }
+
+  NOTICE_LOG() << "Running " << process_name << " " PROJECT_VERSION_HUMAN;
+  fastocloud::stream::GstInitializer::InitCore(0, nullptr);
+  fastocloud::stream::DvbTuner tuner(source, common::net::HostAndPort(feed.host(), feed.EffectiveIntPort()));
+  return tuner.Exec();
 }
@@ -14,4 +14,15 @@
 
 #pragma once
 
-extern "C" int stream_exec(const char* process_name, const void* args, void* command_client);
+// loads heavy dependencies (gstreamer registry) once, so forked processes start faster
+extern "C" int stream_preinit();
+
+// stats_block is optional StreamStatsBlock shared with daemon
+extern "C" int stream_exec(const char* process_name, const void* args, void* command_client, void* stats_block);
+
+// dvb tuner process, whole multiplex of source url (dvb://) goes to feed url (udp://group:port)
+extern "C" int tuner_exec(const char* process_name, const char* source_url, const char* feed_url);
+
+typedef int (*stream_preinit_t)();
+typedef int (*stream_exec_t)(const char* process_name, const void* args, void* command_client, void* stats_block);
+typedef int (*tuner_exec_t)(const char* process_name, const char* source_url, const char* feed_url);
@@ -20,6 +20,7 @@
 #include <common/sprintf.h>
 
 #include "base/constants.h"
+#include "base/utils.h"
 
 #include "stream/elements/audio/audio.h"
 #if defined(MACHINE_LEARNING)
@@ -32,20 +33,24 @@
 #endif
 #include "stream/elements/encoders/audio.h"
 #include "stream/elements/encoders/video.h"
+#include "stream/elements/muxer/muxer.h"
 #include "stream/elements/parser/audio.h"
 #include "stream/elements/parser/video.h"
+#include "stream/elements/sink/fake.h"
 #include "stream/elements/sink/screen.h"
 #include "stream/elements/video/video.h"
 
 #include "stream/pad/pad.h"
 
+#include "utils/m3u8_writer.h"
+
 namespace fastocloud {
 namespace stream {
 namespace streams {
 namespace builders {
 
 EncodingStreamBuilder::EncodingStreamBuilder(const EncodeConfig* api, SrcDecodeBinStream* observer)
-    : SrcDecodeStreamBuilder(api, observer) {}
+    : SrcDecodeStreamBuilder(api, observer), rendition_tees_() {}
 
 Connector EncodingStreamBuilder::BuildPostProc(Connector conn) {
   const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
@@ -99,7 +104,9 @@ SupportedAudioCodec EncodingStreamBuilder::GetAudioCodecType() const {
 
 Connector EncodingStreamBuilder::BuildConverter(Connector conn) {
   const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
-  if (config->HaveVideo()) {
+  if (config->HaveVideo() && config->IsAbrLadder()) {
+    conn = BuildAbrVideoConverter(conn);
+  } else if (config->HaveVideo()) {
     elements_line_t video_encoder = BuildVideoConverter(0);
     if (!video_encoder.empty()) {
       ElementLink(conn.video, video_encoder.front());
@@ -188,7 +195,7 @@ elements_line_t EncodingStreamBuilder::BuildVideoPostProc(element_id_t video_id)
     first = first_last.front();
     last = first_last.back();
 
-    if (!size.IsEmpty()) {
+    if (!size.IsEmpty() && !conf->IsAbrLadder()) {  // renditions scale by itself
       last = elements::encoders::build_video_scale(size.width(), size.height(), this, last, video_id);
     }
 
@@ -228,8 +235,41 @@ elements_line_t EncodingStreamBuilder::BuildVideoPostProc(element_id_t video_id)
     tiny->SetBackend(backend);
 
     ElementAdd(tiny);
-    ElementLink(last, tiny);
-    last = tiny;
+    const auto deep_learning_overlay = conf->GetDeepLearningOverlay();
+    const int detection_fps = deep_learning->GetDetectionFps();
+    if (detection_fps > 0 && !deep_learning_overlay) {
+      // nobody draws boxes on this video, so inference can lag behind on own branch and only see latest frames
+      elements::ElementTee* tee = new elements::ElementTee(common::MemSPrintf(ML_TEE_NAME_1U, video_id));
+      ElementAdd(tee);
+      ElementLink(last, tee);
+
+      elements::ElementQueue* queue = new elements::ElementQueue(common::MemSPrintf(ML_QUEUE_NAME_1U, video_id));
+      queue->SetMaxSizeBuffers(1);
+      queue->SetMaxSizeTime(0);
+      queue->SetMaxSizeBytes(0);
+      queue->SetLeaky(2);  // drop old frames, never block tee
+      ElementAdd(queue);
+      ElementLink(tee, queue);
+
+      elements::video::ElementVideoRate* videorate =
+          new elements::video::ElementVideoRate(common::MemSPrintf(ML_VIDEO_RATE_NAME_1U, video_id));
+      videorate->SetProperty("drop-only", true);
+      videorate->SetProperty("max-rate", detection_fps);
+      ElementAdd(videorate);
+      ElementLink(queue, videorate);
+      ElementLink(videorate, tiny);
+
+      elements::sink::ElementFakeSink* ml_sink =
+          new elements::sink::ElementFakeSink(common::MemSPrintf(ML_SINK_NAME_1U, video_id));
+      ml_sink->SetSync(false);
+      ml_sink->SetProperty("async", false);
+      ElementAdd(ml_sink);
+      ElementLink(tiny, ml_sink);
+      last = tee;
+    } else {
+      ElementLink(last, tiny);
+      last = tiny;
+    }
   }
 
   const auto deep_learning_overlay = conf->GetDeepLearningOverlay();
@@ -353,6 +393,178 @@ elements_line_t EncodingStreamBuilder::BuildAudioConverter(element_id_t audio_id
   return {first, last};
 }
 
+elements_line_t EncodingStreamBuilder::BuildVideoRendition(const Rendition& rendition, element_id_t rendition_id) {
+  const EncodeConfig* conf = static_cast<const EncodeConfig*>(GetConfig());
+
+  elements::ElementQueue* queue =
+      new elements::ElementQueue(common::MemSPrintf(VIDEO_RENDITION_QUEUE_NAME_1U, rendition_id));
+  ElementAdd(queue);
+
+  const common::draw::Size size = rendition.GetSize();
+  elements::Element* last =
+      elements::encoders::build_video_scale(size.width(), size.height(), this, queue, rendition_id);
+
+  bit_rate_t video_bitrate = rendition.GetVideoBitrate();
+  if (!video_bitrate) {
+    video_bitrate = conf->GetVideoBitrate();
+  }
+  elements_line_t video_encoder =
+      elements::encoders::build_video_encoder(conf->GetVideoEncoder(), video_bitrate, conf->GetVideoEncoderArgs(),
+                                              conf->GetVideoEncoderStrArgs(), this, rendition_id);
+  ElementLink(last, video_encoder.front());
+  return {queue, video_encoder.back()};
+}
+
+Connector EncodingStreamBuilder::BuildAbrVideoConverter(Connector conn) {
+  const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
+  const abr_ladder_t ladder = config->GetAbrLadder();
+
+  elements::ElementTee* raw_tee = new elements::ElementTee(common::MemSPrintf(VIDEO_RAW_TEE_NAME_1U, 0));
+  ElementAdd(raw_tee);
+  ElementLink(conn.video, raw_tee);
+
+  for (size_t i = 0; i < ladder.size(); ++i) {
+    elements_line_t rendition_line = BuildVideoRendition(ladder[i], i);
+    ElementLink(raw_tee, rendition_line.front());
+
+    elements::ElementTee* tee = new elements::ElementTee(common::MemSPrintf(VIDEO_TEE_NAME_1U, i));
+    ElementAdd(tee);
+    ElementLink(rendition_line.back(), tee);
+    rendition_tees_.push_back(tee);
+  }
+
+  conn.video = rendition_tees_.front();
+  return conn;
+}
+
+Connector EncodingStreamBuilder::BuildOutput(Connector conn) {
+  const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
+  if (config->HaveVideo() && config->IsAbrLadder()) {
+    return BuildAbrOutput(conn);
+  }
+
+  return SrcDecodeStreamBuilder::BuildOutput(conn);
+}
+
+Connector EncodingStreamBuilder::BuildAbrOutput(Connector conn) {
+  const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
+  const abr_ladder_t ladder = config->GetAbrLadder();
+  const size_t renditions_count = ladder.size();
+  output_t out = config->GetOutput();
+  for (size_t i = 0; i < out.size(); ++i) {
+    const OutputUri output = out[i];
+    const common::uri::GURL uri = output.GetUrl();
+    const auto http_root = output.GetHttpRoot();
+    if (!uri.SchemeIsHTTPOrHTTPS() || !http_root) {
+      CRITICAL_LOG() << "Abr ladder supported only for http outputs, skipped: " << uri.spec();
+      continue;
+    }
+
+    bool output_probed = false;
+    for (size_t j = 0; j < renditions_count; ++j) {
+      const element_id_t rendition_output_id = i * renditions_count + j;
+      const auto rendition_root = http_root->MakeDirectoryStringPath(ladder[j].GetName());
+      if (!rendition_root) {
+        WARNING_LOG() << "Invalid rendition name: " << ladder[j].GetName();
+        continue;
+      }
+
+      common::ErrnoError errn = CreateAndCheckDir(rendition_root->GetPath());
+      if (errn) {
+        WARNING_LOG() << "Failed to create rendition directory " << rendition_root->GetPath() << ": "
+                      << errn->GetDescription();
+        continue;
+      }
+
+      OutputUri rendition_output = output;
+      rendition_output.SetHttpRoot(*rendition_root);
+
+      elements::Element* mux = elements::muxer::make_muxer(uri, rendition_output_id);
+      ElementAdd(mux);
+
+      elements::ElementQueue* video_tee_queue =
+          new elements::ElementQueue(common::MemSPrintf(VIDEO_TEE_QUEUE_NAME_1U, rendition_output_id));
+      ElementAdd(video_tee_queue);
+      ElementLink(rendition_tees_[j], video_tee_queue);
+      ElementLink(video_tee_queue, mux);
+
+      if (config->HaveAudio()) {
+        elements::ElementQueue* audio_tee_queue =
+            new elements::ElementQueue(common::MemSPrintf(AUDIO_TEE_QUEUE_NAME_1U, rendition_output_id));
+        ElementAdd(audio_tee_queue);
+        ElementLink(conn.audio, audio_tee_queue);
+        ElementLink(audio_tee_queue, mux);
+      }
+
+      // one probe per output, stats of output follow its first rendition
+      elements::Element* sink = CreateSink(rendition_output, rendition_output_id);
+      if (!output_probed) {
+        pad::Pad* sink_pad = sink->StaticPad("sink");
+        if (sink_pad->IsValid()) {
+          HandleOutputSinkPadCreated(sink_pad, i, uri, false);
+          output_probed = true;
+        }
+        delete sink_pad;
+      }
+      ElementAdd(sink);
+      ElementLink(mux, sink);
+    }
+
+    common::ErrnoError errn = WriteMasterPlaylist(output);
+    if (errn) {
+      WARNING_LOG() << "Failed to write master playlist for " << uri.spec() << ": " << errn->GetDescription();
+    }
+  }
+  return conn;
+}
+
+common::ErrnoError EncodingStreamBuilder::WriteMasterPlaylist(const OutputUri& output) const {
+  const EncodeConfig* config = static_cast<const EncodeConfig*>(GetConfig());
+  const auto http_root = output.GetHttpRoot();
+  if (!http_root) {
+    return common::make_errno_error_inval();
+  }
+
+  const std::string playlist_name = output.GetUrl().ExtractFileName();
+  const auto master_path = http_root->MakeFileStringPath(playlist_name);
+  if (!master_path) {
+    return common::make_errno_error_inval();
+  }
+
+  utils::M3u8Writer fl;
+  common::ErrnoError err =
+      fl.Open(*master_path, common::file_system::File::FLAG_CREATE | common::file_system::File::FLAG_WRITE);
+  if (err) {
+    return err;
+  }
+
+  err = fl.WriteMasterHeader();
+  if (err) {
+    ignore_result(fl.Close());
+    return err;
+  }
+
+  const auto audio_bitrate = config->GetAudioBitrate();
+  for (const Rendition& rendition : config->GetAbrLadder()) {
+    bit_rate_t video_bitrate = rendition.GetVideoBitrate();
+    if (!video_bitrate) {
+      video_bitrate = config->GetVideoBitrate();
+    }
+
+    const bit_rate_t rendition_audio_bitrate = config->HaveAudio() ? audio_bitrate : bit_rate_t();
+    const uint64_t bandwidth = GetRenditionBandwidth(video_bitrate, rendition_audio_bitrate);
+
+    const std::string uri = common::MemSPrintf("%s/%s", rendition.GetName(), playlist_name);
+    err = fl.WriteStreamInf(bandwidth, rendition.GetSize(), uri);
+    if (err) {
+      ignore_result(fl.Close());
+      return err;
+    }
+  }
+
+  return fl.Close();
+}
+
 #if defined(MACHINE_LEARNING)
 void EncodingStreamBuilder::HandleMLElementCreated(elements::machine_learning::ElementVideoMLFilter* machine) {
   EncodingStream* stream = static_cast<EncodingStream*>(GetObserver());
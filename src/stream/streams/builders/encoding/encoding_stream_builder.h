@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "stream/streams/builders/src_decodebin_stream_builder.h"
 
 #include "stream/streams/configs/encode_config.h"
@@ -37,6 +39,7 @@ class EncodingStreamBuilder : public SrcDecodeStreamBuilder {
   EncodingStreamBuilder(const EncodeConfig* api, SrcDecodeBinStream* observer);
   Connector BuildPostProc(Connector conn) override;
   Connector BuildConverter(Connector conn) override;
+  Connector BuildOutput(Connector conn) override;
 
   SupportedVideoCodec GetVideoCodecType() const override;
   SupportedAudioCodec GetAudioCodecType() const override;
@@ -48,9 +51,19 @@ class EncodingStreamBuilder : public SrcDecodeStreamBuilder {
   virtual elements_line_t BuildVideoConverter(element_id_t video_id);
   virtual elements_line_t BuildAudioConverter(element_id_t audio_id);
 
+  // abr ladder: raw video tee -> queue -> scale -> encoder per rendition
+  virtual elements_line_t BuildVideoRendition(const Rendition& rendition, element_id_t rendition_id);
+
 #if defined(MACHINE_LEARNING)
   void HandleMLElementCreated(fastocloud::stream::elements::machine_learning::ElementVideoMLFilter* machine);
 #endif
+
+ private:
+  Connector BuildAbrVideoConverter(Connector conn);
+  Connector BuildAbrOutput(Connector conn);
+  common::ErrnoError WriteMasterPlaylist(const OutputUri& output) const WARN_UNUSED_RESULT;
+
+  std::vector<elements::Element*> rendition_tees_;
 };
 
 }  // namespace builders
@@ -14,6 +14,9 @@
 
 #include "stream/streams/builders/gst_base_builder.h"
 
+#include "stream/elements/element.h"
+#include "stream/pad/pad.h"
+
 namespace fastocloud {
 namespace stream {
 namespace streams {
@@ -24,12 +27,27 @@ GstBaseBuilder::GstBaseBuilder(const Config* api, IBaseBuilderObserver* observer
 bool GstBaseBuilder::InitPipeline() {
   Connector conn = BuildInput();
   conn = BuildUdbConnections(conn);
+  TraceConnector(conn, LATENCY_STAGE_DECODE);
   conn = BuildPostProc(conn);
   conn = BuildConverter(conn);
+  TraceConnector(conn, LATENCY_STAGE_ENCODE);
   BuildOutput(conn);
   return true;
 }
 
+void GstBaseBuilder::TraceConnector(const Connector& conn, LatencyStage stage) {
+  elements::Element* element = conn.video ? conn.video : conn.audio;
+  if (!element) {
+    return;
+  }
+
+  pad::Pad* sink_pad = element->StaticPad("sink");
+  if (sink_pad->IsValid()) {
+    HandleStageSinkPadCreated(sink_pad, stage);
+  }
+  delete sink_pad;
+}
+
 }  // namespace builders
 }  // namespace streams
 }  // namespace stream
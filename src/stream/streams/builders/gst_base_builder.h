@@ -38,6 +38,10 @@ class GstBaseBuilder : public IBaseBuilder {
 
  protected:
   bool InitPipeline() override final;
+
+ private:
+  // traces buffers entering first element of connector (video if any)
+  void TraceConnector(const Connector& conn, LatencyStage stage);
 };
 
 }  // namespace builders
@@ -0,0 +1,93 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/streams/builders/relay/ts_passthrough_stream_builder.h"
+
+#include <common/sprintf.h>
+
+#include "stream/elements/parser/video.h"
+#include "stream/elements/sources/build_input.h"
+#include "stream/ibase_stream.h"
+#include "stream/pad/pad.h"
+#include "stream/streams/relay/ts_passthrough_stream.h"
+
+namespace fastocloud {
+namespace stream {
+namespace streams {
+namespace builders {
+
+TsPassthroughStreamBuilder::TsPassthroughStreamBuilder(const RelayConfig* config, TsPassthroughStream* observer)
+    : GstBaseBuilder(config, observer) {}
+
+Connector TsPassthroughStreamBuilder::BuildInput() {
+  const Config* config = GetConfig();
+  input_t prepared = config->GetUrl();
+  InputUri uri = prepared[0];
+  const common::uri::GURL url = uri.GetUrl();
+  elements::Element* src = elements::sources::make_src(uri, 0, IBaseStream::src_timeout_sec);
+  pad::Pad* src_pad = src->StaticPad("src");
+  if (src_pad->IsValid()) {
+    HandleInputSrcPadCreated(src_pad, 0, url);
+  }
+  delete src_pad;
+  ElementAdd(src);
+
+  elements::Element* ts = src;
+  if (url.SchemeIsFile() || url.SchemeIsHTTPOrHTTPS()) {
+    // not live sources pushes as fast as read, timestamps from pcr let sinks pace output
+    elements::parser::ElementTsParse* parser = elements::parser::make_ts_parser(0);
+    parser->SetProperty("set-timestamps", true);
+    ElementAdd(parser);
+    ElementLink(ts, parser);
+    ts = parser;
+  }
+  return {ts, nullptr, nullptr};
+}
+
+Connector TsPassthroughStreamBuilder::BuildUdbConnections(Connector conn) {
+  return conn;
+}
+
+Connector TsPassthroughStreamBuilder::BuildPostProc(Connector conn) {
+  return conn;
+}
+
+Connector TsPassthroughStreamBuilder::BuildConverter(Connector conn) {
+  elements::ElementTee* tee = new elements::ElementTee(common::MemSPrintf(TS_TEE_NAME_1U, 0));
+  ElementAdd(tee);
+  ElementLink(conn.video, tee);
+  conn.video = tee;
+  return conn;
+}
+
+Connector TsPassthroughStreamBuilder::BuildOutput(Connector conn) {
+  const Config* config = GetConfig();
+  output_t out = config->GetOutput();
+  for (size_t i = 0; i < out.size(); ++i) {
+    const OutputUri output = out[i];
+    elements::ElementQueue* ts_tee_queue = new elements::ElementQueue(common::MemSPrintf(TS_TEE_QUEUE_NAME_1U, i));
+    ElementAdd(ts_tee_queue);
+    ElementLink(conn.video, ts_tee_queue);
+
+    elements::Element* sink = BuildGenericOutput(output, i);
+    ElementAdd(sink);
+    ElementLink(ts_tee_queue, sink);
+  }
+  return conn;
+}
+
+}  // namespace builders
+}  // namespace streams
+}  // namespace stream
+}  // namespace fastocloud
@@ -0,0 +1,42 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "stream/streams/builders/gst_base_builder.h"
+
+#include "stream/streams/configs/relay_config.h"
+
+namespace fastocloud {
+namespace stream {
+namespace streams {
+class TsPassthroughStream;
+namespace builders {
+
+// src => [tsparse for non live sources] => tee => queue => sink, conn.video carries transport stream
+class TsPassthroughStreamBuilder : public GstBaseBuilder {
+ public:
+  TsPassthroughStreamBuilder(const RelayConfig* config, TsPassthroughStream* observer);
+
+  Connector BuildInput() override;
+  Connector BuildUdbConnections(Connector conn) override;
+  Connector BuildPostProc(Connector conn) override;
+  Connector BuildConverter(Connector conn) override;
+  Connector BuildOutput(Connector conn) override;
+};
+
+}  // namespace builders
+}  // namespace streams
+}  // namespace stream
+}  // namespace fastocloud
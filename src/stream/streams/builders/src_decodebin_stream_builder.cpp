@@ -14,7 +14,10 @@
 
 #include "stream/streams/builders/src_decodebin_stream_builder.h"
 
+#include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <common/sprintf.h>
 
@@ -68,6 +71,11 @@ SrcDecodeStreamBuilder::SrcDecodeStreamBuilder(const AudioVideoConfig* config, S
     : GstBaseBuilder(config, observer) {}
 
 Connector SrcDecodeStreamBuilder::BuildInput() {
+  SrcDecodeBinStream* stream = static_cast<SrcDecodeBinStream*>(GetObserver());
+  if (stream && stream->IsInputFailover()) {
+    return BuildFailoverInput();
+  }
+
   elements::Element* src = BuildInputSrc();
   elements::ElementDecodebin* decodebin = new elements::ElementDecodebin(common::MemSPrintf(DECODEBIN_NAME_1U, 0));
   ElementAdd(decodebin);
@@ -77,6 +85,42 @@ Connector SrcDecodeStreamBuilder::BuildInput() {
   return {nullptr, nullptr, nullptr};
 }
 
+Connector SrcDecodeStreamBuilder::BuildFailoverInput() {
+  const AudioVideoConfig* config = static_cast<const AudioVideoConfig*>(GetConfig());
+  input_t prepared = config->GetUrl();
+  for (size_t i = 0; i < prepared.size(); ++i) {
+    InputUri uri = prepared[i];
+    const common::uri::GURL url = uri.GetUrl();
+    elements::Element* src = elements::sources::make_src(uri, i, IBaseStream::src_timeout_sec);
+    pad::Pad* src_pad = src->StaticPad("src");
+    if (src_pad->IsValid()) {
+      HandleInputSrcPadCreated(src_pad, i, url);
+    }
+    delete src_pad;
+    ElementAdd(src);
+
+    elements::ElementDecodebin* decodebin = new elements::ElementDecodebin(common::MemSPrintf(DECODEBIN_NAME_1U, i));
+    ElementAdd(decodebin);
+    ElementLink(src, decodebin);
+    HandleDecodebinCreated(decodebin);
+  }
+
+  // standby inputs keep running, selector drops their buffers until switched in
+  if (config->HaveVideo()) {
+    elements::ElementInputSelector* video_selector =
+        new elements::ElementInputSelector(common::MemSPrintf(VIDEO_INPUT_SELECTOR_NAME_1U, 0));
+    video_selector->SetSyncStreams(false);
+    ElementAdd(video_selector);
+  }
+  if (config->HaveAudio()) {
+    elements::ElementInputSelector* audio_selector =
+        new elements::ElementInputSelector(common::MemSPrintf(AUDIO_INPUT_SELECTOR_NAME_1U, 0));
+    audio_selector->SetSyncStreams(false);
+    ElementAdd(audio_selector);
+  }
+  return {nullptr, nullptr, nullptr};
+}
+
 void SrcDecodeStreamBuilder::HandleDecodebinCreated(elements::ElementDecodebin* decodebin) {
   SrcDecodeBinStream* stream = static_cast<SrcDecodeBinStream*>(GetObserver());
   if (stream) {
@@ -131,60 +175,106 @@ Connector SrcDecodeStreamBuilder::BuildUdbConnections(Connector conn) {
 Connector SrcDecodeStreamBuilder::BuildOutput(Connector conn) {
   const AudioVideoConfig* config = static_cast<const AudioVideoConfig*>(GetConfig());
   output_t out = config->GetOutput();
+
+  // outputs with same container share one muxer, muxed stream is teed into their sinks
+  std::vector<std::pair<elements::muxer::MuxerType, std::vector<size_t>>> groups;
   for (size_t i = 0; i < out.size(); ++i) {
-    const OutputUri output = out[i];
+    const common::uri::GURL uri = out[i].GetUrl();
     SinkDeviceType dt;
-    if (IsDeviceOutUrl(output.GetUrl(), &dt)) {  // monitor
+    if (IsDeviceOutUrl(uri, &dt)) {  // monitor
       CRITICAL_LOG() << "Decklink not supported for encoding based streams!";
       continue;
     }
 
-    common::uri::GURL uri = output.GetUrl();
-    bool is_rtp_out = uri.SchemeIsUdp();
-    elements::Element* mux = elements::muxer::make_muxer(uri, i);
-    ElementAdd(mux);
-
-    if (config->HaveVideo()) {
-      elements::ElementQueue* video_tee_queue =
-          new elements::ElementQueue(common::MemSPrintf(VIDEO_TEE_QUEUE_NAME_1U, i));
-      ElementAdd(video_tee_queue);
-      elements::Element* next = video_tee_queue;
-      ElementLink(conn.video, next);
-
-      if (is_rtp_out) {
-        elements::Element* rtp_pay = make_video_pay(GetVideoCodecType(), i);
-        ElementAdd(rtp_pay);
-        ElementLink(next, rtp_pay);
-        next = rtp_pay;
-      }
-
-      ElementLink(next, mux);
+    elements::muxer::MuxerType type;
+    if (!elements::muxer::GetMuxerType(uri, &type)) {
+      CRITICAL_LOG() << "Unknown output url: " << uri.spec();
+      continue;
     }
 
-    if (config->HaveAudio()) {
-      elements::ElementQueue* audio_tee_queue =
-          new elements::ElementQueue(common::MemSPrintf(AUDIO_TEE_QUEUE_NAME_1U, i));
-      ElementAdd(audio_tee_queue);
-      elements::Element* next = audio_tee_queue;
-      ElementLink(conn.audio, next);
-
-      if (is_rtp_out) {
-        elements::Element* rtp_pay = make_audio_pay(GetAudioCodecType(), i);
-        ElementAdd(rtp_pay);
-        ElementLink(next, rtp_pay);
-        next = rtp_pay;
-      }
-
-      ElementLink(next, mux);
+    auto it = std::find_if(groups.begin(), groups.end(),
+                           [type](const std::pair<elements::muxer::MuxerType, std::vector<size_t>>& group) {
+                             return group.first == type;
+                           });
+    if (it == groups.end()) {
+      groups.push_back(std::make_pair(type, std::vector<size_t>(1, i)));
+    } else {
+      it->second.push_back(i);
     }
+  }
 
-    elements::Element* sink = BuildGenericOutput(output, i);
-    ElementAdd(sink);
-    ElementLink(mux, sink);
+  for (const auto& group : groups) {
+    const std::vector<size_t>& outputs = group.second;
+    const element_id_t muxer_id = outputs.front();
+    elements::Element* mux = BuildMuxer(conn, group.first, muxer_id);
+    if (outputs.size() == 1) {
+      elements::Element* sink = BuildGenericOutput(out[muxer_id], muxer_id);
+      ElementAdd(sink);
+      ElementLink(mux, sink);
+      continue;
+    }
+
+    elements::ElementTee* tee = new elements::ElementTee(common::MemSPrintf(MUXER_TEE_NAME_1U, muxer_id));
+    ElementAdd(tee);
+    ElementLink(mux, tee);
+    for (size_t i : outputs) {
+      elements::ElementQueue* mux_tee_queue =
+          new elements::ElementQueue(common::MemSPrintf(MUXER_TEE_QUEUE_NAME_1U, i));
+      ElementAdd(mux_tee_queue);
+      ElementLink(tee, mux_tee_queue);
+
+      elements::Element* sink = BuildGenericOutput(out[i], i);
+      ElementAdd(sink);
+      ElementLink(mux_tee_queue, sink);
+    }
   }
   return conn;
 }
 
+elements::Element* SrcDecodeStreamBuilder::BuildMuxer(Connector conn,
+                                                      elements::muxer::MuxerType type,
+                                                      element_id_t muxer_id) {
+  const AudioVideoConfig* config = static_cast<const AudioVideoConfig*>(GetConfig());
+  const bool is_rtp_out = type == elements::muxer::RTP_MUXER;
+  elements::Element* mux = elements::muxer::make_muxer(type, muxer_id);
+  ElementAdd(mux);
+
+  if (config->HaveVideo()) {
+    elements::ElementQueue* video_tee_queue =
+        new elements::ElementQueue(common::MemSPrintf(VIDEO_TEE_QUEUE_NAME_1U, muxer_id));
+    ElementAdd(video_tee_queue);
+    elements::Element* next = video_tee_queue;
+    ElementLink(conn.video, next);
+
+    if (is_rtp_out) {
+      elements::Element* rtp_pay = make_video_pay(GetVideoCodecType(), muxer_id);
+      ElementAdd(rtp_pay);
+      ElementLink(next, rtp_pay);
+      next = rtp_pay;
+    }
+
+    ElementLink(next, mux);
+  }
+
+  if (config->HaveAudio()) {
+    elements::ElementQueue* audio_tee_queue =
+        new elements::ElementQueue(common::MemSPrintf(AUDIO_TEE_QUEUE_NAME_1U, muxer_id));
+    ElementAdd(audio_tee_queue);
+    elements::Element* next = audio_tee_queue;
+    ElementLink(conn.audio, next);
+
+    if (is_rtp_out) {
+      elements::Element* rtp_pay = make_audio_pay(GetAudioCodecType(), muxer_id);
+      ElementAdd(rtp_pay);
+      ElementLink(next, rtp_pay);
+      next = rtp_pay;
+    }
+
+    ElementLink(next, mux);
+  }
+  return mux;
+}
+
 }  // namespace builders
 }  // namespace streams
 }  // namespace stream
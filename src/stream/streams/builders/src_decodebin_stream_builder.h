@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "stream/elements/muxer/muxer.h"
 #include "stream/streams/builders/gst_base_builder.h"
 
 namespace fastocloud {
@@ -46,6 +47,10 @@ class SrcDecodeStreamBuilder : public GstBaseBuilder {
 
  protected:
   void HandleDecodebinCreated(elements::ElementDecodebin* decodebin);
+
+ private:
+  Connector BuildFailoverInput();  // src + decodebin per input, joined by input-selectors
+  elements::Element* BuildMuxer(Connector conn, elements::muxer::MuxerType type, element_id_t muxer_id);
 };
 
 }  // namespace builders
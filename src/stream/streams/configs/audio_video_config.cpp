@@ -26,7 +26,8 @@ AudioVideoConfig::AudioVideoConfig(const base_class& config)
       have_audio_(true),
       have_subtitle_(false),
       audio_select_(),
-      loop_(DEFAULT_LOOP) {}
+      loop_(DEFAULT_LOOP),
+      input_failover_() {}
 
 AudioVideoConfig::have_stream_t AudioVideoConfig::HaveVideo() const {
   return have_video_;
@@ -68,6 +69,14 @@ void AudioVideoConfig::SetLoop(loop_t loop) {
   loop_ = loop;
 }
 
+AudioVideoConfig::input_failover_t AudioVideoConfig::GetInputFailover() const {
+  return input_failover_;
+}
+
+void AudioVideoConfig::SetInputFailover(input_failover_t window) {
+  input_failover_ = window;
+}
+
 AudioVideoConfig* AudioVideoConfig::Clone() const {
   return new AudioVideoConfig(*this);
 }
@@ -26,6 +26,7 @@ class AudioVideoConfig : public Config {
  public:
   typedef Config base_class;
   typedef common::Optional<int> audio_select_t;
+  typedef common::Optional<int> input_failover_t;  // detection window msec
   typedef bool loop_t;
   typedef bool have_stream_t;
   explicit AudioVideoConfig(const base_class& config);
@@ -45,6 +46,9 @@ class AudioVideoConfig : public Config {
   loop_t GetLoop() const;
   void SetLoop(loop_t loop);
 
+  input_failover_t GetInputFailover() const;  // switch to backup input if active stalled longer than window
+  void SetInputFailover(input_failover_t window);
+
   AudioVideoConfig* Clone() const override;
 
  private:
@@ -53,6 +57,7 @@ class AudioVideoConfig : public Config {
   have_stream_t have_subtitle_;
   audio_select_t audio_select_;
   loop_t loop_;
+  input_failover_t input_failover_;
 };
 
 }  // namespace streams
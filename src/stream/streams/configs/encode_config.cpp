@@ -43,6 +43,7 @@ EncodeConfig::EncodeConfig(const base_class& config)
       audio_bit_rate_(),
       logo_(),
       rsvg_logo_(),
+      abr_ladder_(),
 #if defined(MACHINE_LEARNING)
       learning_(),
       learning_overlay_(),
@@ -193,6 +194,18 @@ void EncodeConfig::SetRSVGLogo(const rsvg_logo_t& logo) {
   rsvg_logo_ = logo;
 }
 
+abr_ladder_t EncodeConfig::GetAbrLadder() const {
+  return abr_ladder_;
+}
+
+void EncodeConfig::SetAbrLadder(const abr_ladder_t& ladder) {
+  abr_ladder_ = ladder;
+}
+
+bool EncodeConfig::IsAbrLadder() const {
+  return !abr_ladder_.empty();
+}
+
 #if defined(MACHINE_LEARNING)
 EncodeConfig::deep_learning_t EncodeConfig::GetDeepLearning() const {
   return learning_;
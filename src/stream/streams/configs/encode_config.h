@@ -21,6 +21,7 @@
 #include "base/machine_learning/deep_learning_overlay.h"
 #endif
 #include "base/logo.h"
+#include "base/rendition.h"
 #include "base/rsvg_logo.h"
 
 #include "stream/streams/configs/audio_video_config.h"
@@ -89,6 +90,10 @@ class EncodeConfig : public AudioVideoConfig {
   rsvg_logo_t GetRSVGLogo() const;  // encoding
   void SetRSVGLogo(const rsvg_logo_t& logo);
 
+  abr_ladder_t GetAbrLadder() const;  // encoding, if not empty size and video bitrate taken from renditions
+  void SetAbrLadder(const abr_ladder_t& ladder);
+  bool IsAbrLadder() const;
+
 #if defined(MACHINE_LEARNING)
   deep_learning_t GetDeepLearning() const;  // encoding
   void SetDeepLearning(const deep_learning_t& learning);
@@ -125,6 +130,7 @@ class EncodeConfig : public AudioVideoConfig {
 
   logo_t logo_;
   rsvg_logo_t rsvg_logo_;
+  abr_ladder_t abr_ladder_;
 #if defined(MACHINE_LEARNING)
   deep_learning_t learning_;
   deep_learning_overlay_t learning_overlay_;
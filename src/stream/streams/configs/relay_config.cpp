@@ -27,7 +27,11 @@ namespace stream {
 namespace streams {
 
 RelayConfig::RelayConfig(const base_class& config)
-    : base_class(config), video_parser_(DEFAULT_VIDEO_PARSER), audio_parser_(DEFAULT_AUDIO_PARSER) {}
+    : base_class(config),
+      video_parser_(DEFAULT_VIDEO_PARSER),
+      audio_parser_(DEFAULT_AUDIO_PARSER),
+      ts_passthrough_(false),
+      ts_pids_() {}
 
 std::string RelayConfig::GetVideoParser() const {
   return video_parser_;
@@ -45,6 +49,22 @@ void RelayConfig::SetAudioParser(const std::string& parser) {
   audio_parser_ = parser;
 }
 
+bool RelayConfig::GetTsPassthrough() const {
+  return ts_passthrough_;
+}
+
+void RelayConfig::SetTsPassthrough(bool passthrough) {
+  ts_passthrough_ = passthrough;
+}
+
+RelayConfig::ts_pids_t RelayConfig::GetTsPids() const {
+  return ts_pids_;
+}
+
+void RelayConfig::SetTsPids(const ts_pids_t& pids) {
+  ts_pids_ = pids;
+}
+
 RelayConfig* RelayConfig::Clone() const {
   return new RelayConfig(*this);
 }
@@ -14,7 +14,10 @@
 
 #pragma once
 
+#include <stdint.h>
+
 #include <string>
+#include <vector>
 
 #include "stream/streams/configs/audio_video_config.h"
 
@@ -25,6 +28,7 @@ namespace streams {
 class RelayConfig : public AudioVideoConfig {
  public:
   typedef AudioVideoConfig base_class;
+  typedef std::vector<uint16_t> ts_pids_t;
   explicit RelayConfig(const base_class& config);
 
   std::string GetVideoParser() const;  // relay
@@ -33,11 +37,19 @@ class RelayConfig : public AudioVideoConfig {
   std::string GetAudioParser() const;  // relay
   void SetAudioParser(const std::string& parser);
 
+  bool GetTsPassthrough() const;  // relay mpeg-ts without demux
+  void SetTsPassthrough(bool passthrough);
+
+  ts_pids_t GetTsPids() const;  // passthrough pid filter, empty - all pids, programs of listed pids pass whole
+  void SetTsPids(const ts_pids_t& pids);
+
   RelayConfig* Clone() const override;
 
  private:
   std::string video_parser_;
   std::string audio_parser_;
+  bool ts_passthrough_;
+  ts_pids_t ts_pids_;
 };
 
 class VodRelayConfig : public RelayConfig {
@@ -17,6 +17,7 @@
 #include <string>
 
 #include <common/sprintf.h>
+#include <common/time.h>
 
 #include "base/constants.h"
 #include "base/gst_constants.h"
@@ -244,10 +245,20 @@ void EncodingStream::HandleMlNotification(const std::vector<fastotv::commands_in
 
 void EncodingStream::new_prediction_callback(GstElement* elem, gpointer meta, gpointer user_data) {
   UNUSED(elem);
-  UNUSED(user_data);
 
-  std::vector<fastotv::commands_info::ml::ImageBox> images;
+  EncodingStream* stream = reinterpret_cast<EncodingStream*>(user_data);
   GstDetectionMeta* detection_meta = static_cast<GstDetectionMeta*>(meta);
+  DetectionLimiter::classes_t classes;
+  classes.reserve(detection_meta->num_boxes);
+  for (int i = 0; i < detection_meta->num_boxes; ++i) {
+    classes.push_back(detection_meta->boxes[i].label);
+  }
+  if (!stream->detection_limiter_.Accept(classes, common::time::current_utc_mstime())) {
+    return;
+  }
+
+  std::vector<fastotv::commands_info::ml::ImageBox> images;
+  images.reserve(detection_meta->num_boxes);
   for (int i = 0; i < detection_meta->num_boxes; ++i) {
     BBox* box = (detection_meta->boxes) + i;
     fastotv::commands_info::ml::ImageBox image;
@@ -259,7 +270,6 @@ void EncodingStream::new_prediction_callback(GstElement* elem, gpointer meta, gp
     image.rect.set_height(box->height);
     images.push_back(image);
   }
-  EncodingStream* stream = reinterpret_cast<EncodingStream*>(user_data);
   stream->HandleMlNotification(images);
 }
 #endif
@@ -16,6 +16,10 @@
 
 #include "stream/streams/src_decodebin_stream.h"
 
+#if defined(MACHINE_LEARNING)
+#include "stream/detection_limiter.h"
+#endif
+
 #include "stream/streams/configs/encode_config.h"
 
 namespace fastocloud {
@@ -64,6 +68,8 @@ class EncodingStream : public SrcDecodeBinStream {
   void HandleMlNotification(const std::vector<fastotv::commands_info::ml::ImageBox>& images);
 
   static void new_prediction_callback(GstElement* elem, gpointer meta, gpointer user_data);
+
+  DetectionLimiter detection_limiter_;
 #endif
 };
 
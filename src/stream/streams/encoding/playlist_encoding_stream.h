@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "stream/playlist_reader.h"
 #include "stream/streams/encoding/encoding_stream.h"
 
 namespace fastocloud {
@@ -51,11 +52,8 @@ class PlaylistEncodingStream : public EncodingStream {
  private:
   static void need_data_callback(GstElement* pipeline, guint size, gpointer user_data);
 
-  FILE* OpenNextFile();
-
   elements::sources::ElementAppSrc* app_src_;
-  FILE* current_file_;
-  size_t curent_pos_;
+  PlaylistReader reader_;
 };
 
 }  // namespace streams
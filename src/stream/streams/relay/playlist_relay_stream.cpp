@@ -14,8 +14,6 @@
 
 #include "stream/streams/relay/playlist_relay_stream.h"
 
-#include <string>
-
 #include <gst/app/gstappsrc.h>  // for GST_APP_SRC
 
 #include "stream/elements/sources/appsrc.h"
@@ -23,21 +21,20 @@
 
 #include "stream/streams/builders/relay/playlist_relay_stream_builder.h"
 
-#define BUFFER_SIZE 4096
-
 namespace fastocloud {
 namespace stream {
 namespace streams {
 
 PlaylistRelayStream::PlaylistRelayStream(const PlaylistRelayConfig* config, IStreamClient* client, StreamStruct* stats)
-    : RelayStream(config, client, stats), app_src_(nullptr), current_file_(nullptr), curent_pos_(0) {}
+    : RelayStream(config, client, stats),
+      app_src_(nullptr),
+      reader_(config->GetUrl(), config->GetLoop(), [this](const InputUri& uri) {
+        if (client_) {
+          client_->OnInputChanged(this, uri);
+        }
+      }) {}
 
-PlaylistRelayStream::~PlaylistRelayStream() {
-  if (current_file_) {
-    fclose(current_file_);
-    current_file_ = nullptr;
-  }
-}
+PlaylistRelayStream::~PlaylistRelayStream() {}
 
 const char* PlaylistRelayStream::ClassName() const {
   return "PlaylistRelayStream";
@@ -64,32 +61,12 @@ void PlaylistRelayStream::HandleNeedData(GstElement* pipeline, guint rsize) {
   UNUSED(pipeline);
   UNUSED(rsize);
 
-  char* ptr = static_cast<char*>(calloc(BUFFER_SIZE, sizeof(char)));
-  if (!ptr) {
-    app_src_->SendEOS();  // send  eos
+  GstBuffer* buffer = reader_.ReadBuffer();
+  if (!buffer) {
+    app_src_->SendEOS();
     return;
   }
 
-  size_t size = 0;
-  while (size == 0) {
-    if (!current_file_) {
-      current_file_ = OpenNextFile();
-    }
-
-    if (!current_file_) {
-      app_src_->SendEOS();  // send  eos
-      free(ptr);
-      return;
-    }
-
-    size = fread(ptr, sizeof(char), BUFFER_SIZE, current_file_);
-    if (size == 0) {
-      fclose(current_file_);
-      current_file_ = nullptr;
-    }
-  }
-
-  GstBuffer* buffer = gst_buffer_new_wrapped(ptr, size);
   GstFlowReturn ret = app_src_->PushBuffer(buffer);
   if (ret != GST_FLOW_OK) {
     WARNING_LOG() << "gst_app_src_push_buffer failed: " << gst_flow_get_name(ret);
@@ -102,38 +79,6 @@ void PlaylistRelayStream::need_data_callback(GstElement* pipeline, guint size, g
   return stream->HandleNeedData(pipeline, size);
 }
 
-FILE* PlaylistRelayStream::OpenNextFile() {
-  const PlaylistRelayConfig* rconf = static_cast<const PlaylistRelayConfig*>(GetConfig());
-  const bool loop = rconf->GetLoop();
-
-  if (!loop) {
-    input_t input = rconf->GetUrl();
-    if (curent_pos_ >= input.size()) {
-      INFO_LOG() << "No more files for playing";
-      return nullptr;  // EOS
-    }
-  }
-
-  input_t input = rconf->GetUrl();
-  if (curent_pos_ >= input.size()) {
-    curent_pos_ = 0;
-  }
-
-  InputUri iuri = input[curent_pos_++];
-  common::uri::GURL uri = iuri.GetUrl();
-  std::string cur_path = uri.path();
-  FILE* file = fopen(cur_path.c_str(), "rb");
-  if (file) {
-    INFO_LOG() << "File " << cur_path << " open for playing";
-    if (client_) {
-      client_->OnInputChanged(this, iuri);
-    }
-  } else {
-    WARNING_LOG() << "File " << cur_path << "can't open for playing";
-  }
-  return file;
-}
-
 }  // namespace streams
 }  // namespace stream
 }  // namespace fastocloud
@@ -0,0 +1,161 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/streams/relay/ts_passthrough_stream.h"
+
+#include <string.h>
+
+#include <common/time.h>
+
+#include "stream/pad/pad.h"
+#include "stream/streams/builders/relay/ts_passthrough_stream_builder.h"
+
+namespace fastocloud {
+namespace stream {
+namespace streams {
+
+TsPassthroughStream::TsPassthroughStream(const RelayConfig* config, IStreamClient* client, StreamStruct* stats)
+    : IBaseStream(config, client, stats),
+      filter_(config->GetTsPids()),
+      filtered_(),
+      reported_cc_errors_(0),
+      reported_sync_losses_(0),
+      last_report_msec_(0) {}
+
+const char* TsPassthroughStream::ClassName() const {
+  return "TsPassthroughStream";
+}
+
+bool TsPassthroughStream::IsPassthroughOutput(const common::uri::GURL& url) {
+  return url.SchemeIsUdp() || url.SchemeIsTcp() || url.SchemeIsSrt() || url.SchemeIsFile();
+}
+
+bool TsPassthroughStream::NeedCheckInputData() const {
+  return true;
+}
+
+GstPadProbeInfo* TsPassthroughStream::CheckProbeData(InputProbe* probe, GstPadProbeInfo* info) {
+  const GstPadProbeType type = GST_PAD_PROBE_INFO_TYPE(info);
+  if (type & GST_PAD_PROBE_TYPE_BUFFER) {
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    GstBuffer* out = FilterBuffer(buffer);
+    ReportErrors();
+    if (!out) {  // only not complete packet or filtered pids
+      return nullptr;
+    }
+
+    gst_buffer_unref(buffer);
+    GST_PAD_PROBE_INFO_DATA(info) = out;
+    return IBaseStream::CheckProbeData(probe, info);
+  }
+
+  if (type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    GstBufferList* list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+    const guint length = gst_buffer_list_length(list);
+    GstBufferList* out = gst_buffer_list_new_sized(length);
+    for (guint i = 0; i < length; ++i) {
+      GstBuffer* filtered = FilterBuffer(gst_buffer_list_get(list, i));
+      if (filtered) {
+        gst_buffer_list_add(out, filtered);
+      }
+    }
+    ReportErrors();
+    if (gst_buffer_list_length(out) == 0) {
+      gst_buffer_list_unref(out);
+      return nullptr;
+    }
+
+    gst_buffer_list_unref(list);
+    GST_PAD_PROBE_INFO_DATA(info) = out;
+    return IBaseStream::CheckProbeData(probe, info);
+  }
+
+  return IBaseStream::CheckProbeData(probe, info);
+}
+
+GstBuffer* TsPassthroughStream::FilterBuffer(GstBuffer* buffer) {
+  GstMapInfo map;
+  if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    return gst_buffer_ref(buffer);
+  }
+
+  filtered_.clear();
+  const bool as_is = filter_.Process(map.data, map.size, &filtered_);
+  gst_buffer_unmap(buffer, &map);
+  if (as_is) {
+    return gst_buffer_ref(buffer);
+  }
+
+  if (filtered_.empty()) {
+    return nullptr;
+  }
+
+  GstBuffer* out = gst_buffer_new_allocate(nullptr, filtered_.size(), nullptr);
+  gst_buffer_fill(out, 0, filtered_.data(), filtered_.size());
+  gst_buffer_copy_into(out, buffer, static_cast<GstBufferCopyFlags>(GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS),
+                       0, -1);
+  return out;
+}
+
+void TsPassthroughStream::ReportErrors() {
+  const fastotv::timestamp_t now = common::time::current_utc_mstime();
+  if (now - last_report_msec_ < 1000) {
+    return;
+  }
+
+  last_report_msec_ = now;
+  const TsPacketFilter::Stats stats = filter_.GetStats();
+  if (stats.cc_errors != reported_cc_errors_) {
+    WARNING_LOG() << "Continuity errors: " << stats.cc_errors - reported_cc_errors_ << " (total " << stats.cc_errors
+                  << ")";
+    reported_cc_errors_ = stats.cc_errors;
+  }
+  if (stats.sync_losses != reported_sync_losses_) {
+    WARNING_LOG() << "Sync lost: " << stats.sync_losses - reported_sync_losses_ << " (total " << stats.sync_losses
+                  << ")";
+    reported_sync_losses_ = stats.sync_losses;
+  }
+}
+
+void TsPassthroughStream::OnInpudSrcPadCreated(pad::Pad* src_pad, element_id_t id, const common::uri::GURL& url) {
+  LinkInputPad(src_pad->GetGstPad(), id, url);
+}
+
+void TsPassthroughStream::OnOutputSinkPadCreated(pad::Pad* sink_pad,
+                                                 element_id_t id,
+                                                 const common::uri::GURL& url,
+                                                 bool need_push) {
+  LinkOutputPad(sink_pad->GetGstPad(), id, url, need_push);
+}
+
+IBaseBuilder* TsPassthroughStream::CreateBuilder() {
+  const RelayConfig* rconf = static_cast<const RelayConfig*>(GetConfig());
+  return new builders::TsPassthroughStreamBuilder(rconf, this);
+}
+
+void TsPassthroughStream::PreLoop() {
+  const Config* conf = GetConfig();
+  const auto input = conf->GetUrl();
+  if (client_) {
+    client_->OnInputChanged(this, input[0]);
+  }
+}
+
+void TsPassthroughStream::PostLoop(ExitStatus status) {
+  UNUSED(status);
+}
+
+}  // namespace streams
+}  // namespace stream
+}  // namespace fastocloud
@@ -0,0 +1,66 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "stream/ibase_stream.h"
+
+#include "stream/streams/configs/relay_config.h"
+#include "stream/ts_packet_filter.h"
+
+namespace fastocloud {
+namespace stream {
+namespace streams {
+
+// Relays MPEG-TS input packets into outputs without demux/parse/mux,
+// only resync, optional pid filter and continuity monitoring on the input pad (single buffers and buffer lists).
+class TsPassthroughStream : public IBaseStream {
+ public:
+  TsPassthroughStream(const RelayConfig* config, IStreamClient* client, StreamStruct* stats);
+
+  const char* ClassName() const override;
+
+  // outputs which can carry raw transport stream
+  static bool IsPassthroughOutput(const common::uri::GURL& url);
+
+  GstPadProbeInfo* CheckProbeData(InputProbe* probe, GstPadProbeInfo* info) override;
+
+ protected:
+  bool NeedCheckInputData() const override;  // every buffer passes pid filter
+  void OnInpudSrcPadCreated(pad::Pad* src_pad, element_id_t id, const common::uri::GURL& url) override;
+  void OnOutputSinkPadCreated(pad::Pad* sink_pad,
+                              element_id_t id,
+                              const common::uri::GURL& url,
+                              bool need_push) override;
+
+  IBaseBuilder* CreateBuilder() override;
+
+  void PreLoop() override;
+  void PostLoop(ExitStatus status) override;
+
+ private:
+  // new reference to buffer to pass (input itself if nothing filtered), nullptr if nothing left
+  GstBuffer* FilterBuffer(GstBuffer* buffer);
+  void ReportErrors();
+
+  TsPacketFilter filter_;
+  std::vector<uint8_t> filtered_;
+  uint64_t reported_cc_errors_;
+  uint64_t reported_sync_losses_;
+  fastotv::timestamp_t last_report_msec_;
+};
+
+}  // namespace streams
+}  // namespace stream
+}  // namespace fastocloud
@@ -14,15 +14,37 @@
 
 #include "stream/streams/src_decodebin_stream.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <string>
 
+#include <common/sprintf.h>
+#include <common/time.h>
+
 #include "stream/config.h"
+#include "stream/gstreamer_utils.h"
 #include "stream/pad/pad.h"
+#include "stream/probes.h"
+#include "stream/streams/configs/audio_video_config.h"
 
 namespace fastocloud {
 namespace stream {
 namespace streams {
 
+namespace {
+const size_t kNoInput = static_cast<size_t>(-1);
+
+fastotv::timestamp_t GetFailoverWindow(const Config* config) {
+  const AudioVideoConfig* aconfig = static_cast<const AudioVideoConfig*>(config);
+  const auto window = aconfig->GetInputFailover();
+  if (!window || *window <= 0 || aconfig->GetUrl().size() < 2) {
+    return 0;
+  }
+  return *window;
+}
+}  // namespace
+
 void SrcDecodeBinStream::ConnectDecodebinSignals(elements::ElementDecodebin* decodebin) {
   gboolean pad_added = decodebin->RegisterPadAddedCallback(decodebin_pad_added_callback, this);
   DCHECK(pad_added);
@@ -44,26 +66,266 @@ void SrcDecodeBinStream::ConnectDecodebinSignals(elements::ElementDecodebin* dec
 }
 
 SrcDecodeBinStream::SrcDecodeBinStream(const Config* config, IStreamClient* client, StreamStruct* stats)
-    : IBaseStream(config, client, stats) {}
+    : IBaseStream(config, client, stats),
+      failover_window_msec_(GetFailoverWindow(config)),
+      input_last_data_(config->GetUrl().size()),
+      active_input_(0),
+      pending_input_(kNoInput),
+      pending_since_(0),
+      reported_input_(0),
+      failover_timer_id_(0) {
+  for (auto& last : input_last_data_) {
+    last = 0;
+  }
+}
 
 const char* SrcDecodeBinStream::ClassName() const {
   return "SrcDecodeBinStream";
 }
 
+bool SrcDecodeBinStream::IsInputFailover() const {
+  return failover_window_msec_ != 0;
+}
+
+bool SrcDecodeBinStream::NeedCheckInputData() const {
+  return IsInputFailover();
+}
+
+GstPadProbeInfo* SrcDecodeBinStream::CheckProbeData(InputProbe* probe, GstPadProbeInfo* buff) {
+  if (IsInputFailover() && probe->GetID() < input_last_data_.size()) {
+    input_last_data_[probe->GetID()] = common::time::current_utc_mstime();
+  }
+  return IBaseStream::CheckProbeData(probe, buff);
+}
+
 void SrcDecodeBinStream::PreLoop() {
   const Config* conf = GetConfig();
   const auto input = conf->GetUrl();
+  reported_input_ = active_input_;
   if (client_) {
-    client_->OnInputChanged(this, input[0]);
+    client_->OnInputChanged(this, input[reported_input_]);
+  }
+
+  if (IsInputFailover()) {
+    // inputs which never delivered data are measured from loop start
+    const fastotv::timestamp_t now = common::time::current_utc_mstime();
+    for (auto& last : input_last_data_) {
+      fastotv::timestamp_t expected = 0;
+      last.compare_exchange_strong(expected, now);
+    }
+    guint interval = std::max<guint>(failover_window_msec_ / 2, 50);
+    failover_timer_id_ = g_timeout_add(interval, failover_timer_callback, this);
   }
 }
 
 void SrcDecodeBinStream::PostLoop(ExitStatus status) {
   UNUSED(status);
+  if (failover_timer_id_) {
+    bool res = g_source_remove(failover_timer_id_);
+    DCHECK(res);
+    failover_timer_id_ = 0;
+  }
+
+  // next pipeline starts from the primary input again
+  for (auto& last : input_last_data_) {
+    last = 0;
+  }
+  active_input_ = 0;
+  pending_input_ = kNoInput;
+  pending_since_ = 0;
+}
+
+gboolean SrcDecodeBinStream::HandleFailoverTimerTick() {
+  const Config* conf = GetConfig();
+  const auto input = conf->GetUrl();
+  const fastotv::timestamp_t now = common::time::current_utc_mstime();
+  const size_t active = active_input_;
+  const size_t pending = pending_input_;
+
+  if (pending != kNoInput) {
+    const AudioVideoConfig* aconfig = static_cast<const AudioVideoConfig*>(conf);
+    if (now - input_last_data_[pending] > failover_window_msec_) {
+      WARNING_LOG() << "Backup input " << pending << " stalled before switch, cancel it";
+      pending_input_ = kNoInput;
+    } else if (!aconfig->HaveVideo() || now - pending_since_ > failover_window_msec_ * 2) {
+      // nothing to wait keyframe on, or keyframe not coming in time
+      SwitchInput(pending);
+    }
+  } else if (now - input_last_data_[active] > failover_window_msec_) {
+    for (size_t i = 1; i < input.size(); ++i) {
+      const size_t candidate = (active + i) % input.size();
+      if (now - input_last_data_[candidate] <= failover_window_msec_) {
+        WARNING_LOG() << "Input " << active << " stalled for " << now - input_last_data_[active]
+                      << " msec, switching to input " << candidate << " at next keyframe";
+        pending_since_ = now;
+        pending_input_ = candidate;
+        break;
+      }
+    }
+  }
+
+  const size_t current = active_input_;
+  if (current != reported_input_) {
+    reported_input_ = current;
+    if (client_) {
+      client_->OnInputChanged(this, input[current]);
+    }
+  }
+  return TRUE;
+}
+
+void SrcDecodeBinStream::SwitchInput(size_t input) {
+  size_t expected = input;
+  if (!pending_input_.compare_exchange_strong(expected, kNoInput)) {
+    return;  // already switched by other thread
+  }
+
+  const AudioVideoConfig* config = static_cast<const AudioVideoConfig*>(GetConfig());
+  const std::string sink_name = common::MemSPrintf("sink_%lu", input);
+  if (config->HaveVideo()) {
+    elements::ElementInputSelector* selector = static_cast<elements::ElementInputSelector*>(
+        GetElementByName(common::MemSPrintf(VIDEO_INPUT_SELECTOR_NAME_1U, 0)));
+    GstPad* pad = gst_element_get_static_pad(selector->GetGstElement(), sink_name.c_str());
+    if (pad) {
+      selector->SetActivePad(pad);
+      gst_object_unref(pad);
+    }
+  }
+  if (config->HaveAudio()) {
+    elements::ElementInputSelector* selector = static_cast<elements::ElementInputSelector*>(
+        GetElementByName(common::MemSPrintf(AUDIO_INPUT_SELECTOR_NAME_1U, 0)));
+    GstPad* pad = gst_element_get_static_pad(selector->GetGstElement(), sink_name.c_str());
+    if (pad) {
+      selector->SetActivePad(pad);
+      gst_object_unref(pad);
+    }
+  }
+  active_input_ = input;
+  INFO_LOG() << "Switched to input " << input;
+}
+
+void SrcDecodeBinStream::HandleFailoverPadAdded(GstElement* src, GstPad* new_pad) {
+  const gchar* new_pad_type = pad_get_type(new_pad);
+  if (!new_pad_type) {
+    DNOTREACHED();
+    return;
+  }
+
+  element_id_t input_id;
+  const char* gst_element_name = GST_ELEMENT_NAME(src);
+  if (!GetElementId(gst_element_name, &input_id)) {
+    DNOTREACHED();
+    return;
+  }
+
+  const AudioVideoConfig* config = static_cast<const AudioVideoConfig*>(GetConfig());
+  bool is_video = strncmp(new_pad_type, "video", 5) == 0;
+  bool is_audio = strncmp(new_pad_type, "audio", 5) == 0;
+  elements::ElementInputSelector* selector = nullptr;
+  elements::Element* udb = nullptr;
+  if (is_video) {
+    if (config->HaveVideo()) {
+      selector = static_cast<elements::ElementInputSelector*>(
+          GetElementByName(common::MemSPrintf(VIDEO_INPUT_SELECTOR_NAME_1U, 0)));
+      udb = GetElementByName(common::MemSPrintf(UDB_VIDEO_NAME_1U, 0));
+    }
+  } else if (is_audio) {
+    if (config->HaveAudio()) {
+      const char* gst_pad_name = GST_PAD_NAME(new_pad);
+      const auto audio_select = config->GetAudioSelect();
+      int current_audio_track = 0;
+      if (!audio_select || (GetPadId(gst_pad_name, &current_audio_track) && *audio_select == current_audio_track)) {
+        selector = static_cast<elements::ElementInputSelector*>(
+            GetElementByName(common::MemSPrintf(AUDIO_INPUT_SELECTOR_NAME_1U, 0)));
+        udb = GetElementByName(common::MemSPrintf(UDB_AUDIO_NAME_1U, 0));
+      }
+    }
+  }
+
+  if (!selector || !udb) {
+    return;
+  }
+
+  const std::string sink_name = common::MemSPrintf("sink_%lu", input_id);
+  GstPad* existing = gst_element_get_static_pad(selector->GetGstElement(), sink_name.c_str());
+  if (existing) {  // one track per input
+    gst_object_unref(existing);
+    return;
+  }
+
+  pad::Pad* sink_pad = selector->RequestPad(sink_name.c_str());
+  if (!sink_pad->IsValid()) {
+    delete sink_pad;
+    return;
+  }
+
+  GstPadLinkReturn ret = gst_pad_link(new_pad, sink_pad->GetGstPad());
+  if (GST_PAD_LINK_FAILED(ret)) {
+    WARNING_LOG() << "Failed to link: " << gst_element_name << " " << GST_PAD_NAME(new_pad) << " " << new_pad_type;
+    delete sink_pad;
+    return;
+  }
+
+  DEBUG_LOG() << "Pad emitted: " << gst_element_name << " " << GST_PAD_NAME(new_pad) << " " << new_pad_type;
+  if (input_id == active_input_) {
+    selector->SetActivePad(sink_pad->GetGstPad());
+  }
+  if (is_video) {
+    gst_pad_add_probe(sink_pad->GetGstPad(), GST_PAD_PROBE_TYPE_BUFFER, failover_keyframe_probe_callback, this,
+                      nullptr);
+  }
+  delete sink_pad;
+
+  pad::Pad* selector_src = selector->StaticPad("src");
+  pad::Pad* udb_sink = udb->StaticPad("sink");
+  if (selector_src->IsValid() && udb_sink->IsValid() && !gst_pad_is_linked(udb_sink->GetGstPad())) {
+    ret = gst_pad_link(selector_src->GetGstPad(), udb_sink->GetGstPad());
+    if (GST_PAD_LINK_FAILED(ret)) {
+      WARNING_LOG() << "Failed to link: " << selector->GetName() << " with " << udb->GetName();
+    }
+  }
+  delete udb_sink;
+  delete selector_src;
+
+  if (is_video) {
+    SetVideoInited(true);
+  } else if (is_audio) {
+    SetAudioInited(true);
+  }
+}
+
+gboolean SrcDecodeBinStream::failover_timer_callback(gpointer user_data) {
+  SrcDecodeBinStream* stream = reinterpret_cast<SrcDecodeBinStream*>(user_data);
+  return stream->HandleFailoverTimerTick();
+}
+
+GstPadProbeReturn SrcDecodeBinStream::failover_keyframe_probe_callback(GstPad* pad,
+                                                                       GstPadProbeInfo* info,
+                                                                       gpointer user_data) {
+  SrcDecodeBinStream* stream = reinterpret_cast<SrcDecodeBinStream*>(user_data);
+  const size_t pending = stream->pending_input_;
+  if (pending == kNoInput) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  int pad_id = 0;
+  if (!GetPadId(GST_PAD_NAME(pad), &pad_id) || static_cast<size_t>(pad_id) != pending) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+  if (!GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    stream->SwitchInput(pending);
+  }
+  return GST_PAD_PROBE_OK;
 }
 
 void SrcDecodeBinStream::decodebin_pad_added_callback(GstElement* src, GstPad* new_pad, gpointer user_data) {
   SrcDecodeBinStream* stream = reinterpret_cast<SrcDecodeBinStream*>(user_data);
+  if (stream->IsInputFailover()) {
+    stream->HandleFailoverPadAdded(src, new_pad);
+    return;
+  }
   stream->HandleDecodeBinPadAdded(src, new_pad);
 }
 
@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <vector>
+
 #include "stream/ibase_stream.h"
 
 #include "stream/elements/element.h"
@@ -34,7 +37,12 @@ class SrcDecodeBinStream : public IBaseStream {
 
   const char* ClassName() const override;
 
+  bool IsInputFailover() const;  // more than one input and failover window configured
+
+  GstPadProbeInfo* CheckProbeData(InputProbe* probe, GstPadProbeInfo* buff) override;
+
  protected:
+  bool NeedCheckInputData() const override;  // failover tracks last data time per input
   void OnInpudSrcPadCreated(pad::Pad* src_pad, element_id_t id, const common::uri::GURL& url) override;
   void OnOutputSinkPadCreated(pad::Pad* sink_pad,
                               element_id_t id,
@@ -60,7 +68,16 @@ class SrcDecodeBinStream : public IBaseStream {
   virtual void HandleDecodeBinElementAdded(GstBin* bin, GstElement* element) = 0;
   virtual void HandleDecodeBinElementRemoved(GstBin* bin, GstElement* element) = 0;
 
+  // links decodebin pads of every input into input-selectors instead of udb connections
+  void HandleFailoverPadAdded(GstElement* src, GstPad* new_pad);
+  virtual gboolean HandleFailoverTimerTick();
+
  private:
+  void SwitchInput(size_t input);
+
+  static gboolean failover_timer_callback(gpointer user_data);
+  static GstPadProbeReturn failover_keyframe_probe_callback(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+
   static void decodebin_pad_added_callback(GstElement* src, GstPad* new_pad, gpointer user_data);
   static gboolean decodebin_autoplugger_callback(GstElement* elem, GstPad* pad, GstCaps* caps, gpointer user_data);
 
@@ -78,6 +95,14 @@ class SrcDecodeBinStream : public IBaseStream {
 
   static void decodebin_element_added_callback(GstBin* bin, GstElement* element, gpointer user_data);
   static void decodebin_element_removed_callback(GstBin* bin, GstElement* element, gpointer user_data);
+
+  const fastotv::timestamp_t failover_window_msec_;  // 0 if failover disabled
+  std::vector<std::atomic<fastotv::timestamp_t>> input_last_data_;
+  std::atomic<size_t> active_input_;
+  std::atomic<size_t> pending_input_;
+  fastotv::timestamp_t pending_since_;
+  size_t reported_input_;
+  guint failover_timer_id_;
 };
 
 }  // namespace streams
@@ -14,6 +14,8 @@
 
 #include "stream/streams/timeshift/timeshift_recorder_stream.h"
 
+#include <sys/stat.h>
+
 #include <string>
 
 #include <common/file_system/string_path_utils.h>
@@ -54,7 +56,12 @@ TimeShiftRecorderStream::TimeShiftRecorderStream(const TimeshiftConfig* config,
                                                  const TimeShiftInfo& info,
                                                  IStreamClient* client,
                                                  StreamStruct* stats)
-    : base_class(config, info, client, stats), chunk_(), audio_pad_(nullptr), video_pad_(nullptr) {}
+    : base_class(config, info, client, stats),
+      chunk_(),
+      audio_pad_(nullptr),
+      video_pad_(nullptr),
+      chunks_index_(info.timshift_dir),
+      chunk_start_time_(0) {}
 
 const char* TimeShiftRecorderStream::ClassName() const {
   return "TimeShiftRecorderStream";
@@ -117,7 +124,14 @@ gboolean TimeShiftRecorderStream::HandleMainTimerTick() {
   time_t el = GetElipsedTime();
   if (el % no_data_panic_sec == 0) {
     const time_t max_life_time = common::time::current_utc_mstime() / 1000 - tinfo.timeshift_chunk_life_time;
-    RemoveOldFilesByTime(tinfo.timshift_dir, max_life_time, "*" CHUNK_EXT);
+    if (chunks_index_.IsExist()) {
+      common::ErrnoError err = chunks_index_.RemoveOlder(max_life_time);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+      }
+    } else {
+      RemoveOldFilesByTime(tinfo.timshift_dir, max_life_time, "*" CHUNK_EXT);
+    }
   }
   return base_class::HandleMainTimerTick();
 }
@@ -145,12 +159,34 @@ gchararray TimeShiftRecorderStream::OnPathSet(GstElement* splitmux, guint fragme
   UNUSED(fragment_id);
   UNUSED(sample);
 
+  const time_t cur_time = common::time::current_utc_mstime() / 1000;
+  IndexFinishedChunk(cur_time);
   chunk_index_t ind = CalcNextIndex();
   chunk_.index = ind;
+  chunk_start_time_ = cur_time;
   std::string new_path = common::MemSPrintf("%s%llu." TS_EXTENSION, chunk_.path, chunk_.index);
   return strdup(new_path.c_str());
 }
 
+void TimeShiftRecorderStream::IndexFinishedChunk(time_t finished_time) {
+  if (!chunk_start_time_ || chunk_.index == invalid_chunk_index) {
+    return;
+  }
+
+  const std::string path = common::MemSPrintf("%s%llu." TS_EXTENSION, chunk_.path, chunk_.index);
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return;
+  }
+
+  const TimeShiftIndex::Chunk chunk = {chunk_.index, chunk_start_time_, finished_time - chunk_start_time_,
+                                       static_cast<uint64_t>(st.st_size)};
+  common::ErrnoError err = chunks_index_.Append(chunk);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+  }
+}
+
 gchararray TimeShiftRecorderStream::path_setter_callback(GstElement* splitmux, guint fragment_id, gpointer user_data) {
   return path_setter_full_callback(splitmux, fragment_id, nullptr, user_data);
 }
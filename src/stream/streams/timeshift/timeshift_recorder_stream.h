@@ -15,6 +15,7 @@
 #pragma once
 
 #include "stream/streams/timeshift/itimeshift_recorder_stream.h"
+#include "stream/timeshift_index.h"
 
 #include "utils/chunk_info.h"
 
@@ -65,8 +66,13 @@ class TimeShiftRecorderStream : public ITimeShiftRecorderStream {
                                               GstSample* sample,
                                               gpointer user_data);
 
+  void IndexFinishedChunk(time_t finished_time);
+
   pad::Pad* audio_pad_;
   pad::Pad* video_pad_;
+
+  TimeShiftIndex chunks_index_;
+  time_t chunk_start_time_;  // of chunk_ if it written by this stream, otherwise 0
 };
 
 }  // namespace streams
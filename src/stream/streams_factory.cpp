@@ -28,6 +28,7 @@
 #include "stream/streams/mosaic_stream.h"
 #include "stream/streams/relay/playlist_relay_stream.h"
 #include "stream/streams/relay/rtsp_relay_stream.h"
+#include "stream/streams/relay/ts_passthrough_stream.h"
 #include "stream/streams/test/test_life_stream.h"
 #include "stream/streams/test/test_stream.h"
 #include "stream/streams/timeshift/catchup_stream.h"
@@ -39,6 +40,20 @@
 namespace fastocloud {
 namespace stream {
 
+namespace {
+// failover keeps every input connected, so all of them must be plain network live sources
+bool IsFailoverInput(const input_t& input) {
+  for (const InputUri& iuri : input) {
+    const common::uri::GURL input_uri = iuri.GetUrl();
+    if (input_uri.SchemeIsFile() || input_uri.SchemeIsRtsp() || input_uri.SchemeIsDev() || IsTestInputUrl(iuri) ||
+        IsDisplayInputUrl(iuri)) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
 IBaseStream* StreamsFactory::CreateStream(const Config* config,
                                           IBaseStream::IStreamClient* client,
                                           StreamStruct* stats,
@@ -62,6 +77,10 @@ IBaseStream* StreamsFactory::CreateStream(const Config* config,
         return new streams::PlaylistRelayStream(prconfig, client, stats);
       }
 
+      if (rconfig->GetInputFailover() && IsFailoverInput(input)) {  // hot-standby backup inputs
+        return new streams::RelayStream(rconfig, client, stats);
+      }
+
       NOTREACHED();
       return nullptr;  // not supported
       // return new streams::MosaicStream(rconfig, client, stats);
@@ -72,6 +91,17 @@ IBaseStream* StreamsFactory::CreateStream(const Config* config,
       return new streams::RtspRelayStream(rconfig, client, stats);
     }
 
+    if (rconfig->GetTsPassthrough()) {
+      bool passthrough = true;
+      for (const OutputUri& output : config->GetOutput()) {
+        passthrough &= streams::TsPassthroughStream::IsPassthroughOutput(output.GetUrl());
+      }
+      if (passthrough) {
+        return new streams::TsPassthroughStream(rconfig, client, stats);
+      }
+      WARNING_LOG() << "TS passthrough supported only for udp/tcp/srt/file outputs, fallback to remux relay";
+    }
+
     return new streams::RelayStream(rconfig, client, stats);
   } else if (type == fastotv::ENCODE || type == fastotv::COD_ENCODE) {
     const streams::EncodeConfig* econfig = static_cast<const streams::EncodeConfig*>(config);
@@ -85,6 +115,15 @@ IBaseStream* StreamsFactory::CreateStream(const Config* config,
         return new streams::PlaylistEncodingStream(econfig, client, stats);
       }
 
+      if (econfig->GetInputFailover() && IsFailoverInput(input)) {  // hot-standby backup inputs
+        if (econfig->GetRelayVideo()) {
+          return new streams::EncodingOnlyAudioStream(econfig, client, stats);
+        } else if (econfig->GetRelayAudio()) {
+          return new streams::EncodingOnlyVideoStream(econfig, client, stats);
+        }
+        return new streams::EncodingStream(econfig, client, stats);
+      }
+
       return new streams::MosaicStream(econfig, client, stats);
     }
 
@@ -28,10 +28,14 @@
 
 #define VIDEO_TEE_NAME_1U "video_tee_%lu"
 #define AUDIO_TEE_NAME_1U "audio_tee_%lu"
+#define VIDEO_RAW_TEE_NAME_1U "video_raw_tee_%lu"
 
 #define UDB_VIDEO_NAME_1U "udb_conn_video_%lu"
 #define UDB_AUDIO_NAME_1U "udb_conn_audio_%lu"
 
+#define VIDEO_INPUT_SELECTOR_NAME_1U "video_input_selector_%lu"
+#define AUDIO_INPUT_SELECTOR_NAME_1U "audio_input_selector_%lu"
+
 #define POST_PROC_NAME_1U "post_proc_%lu"
 #define VIDEO_LOGO_NAME_1U "videologo_%lu"
 #define RSVG_VIDEO_LOGO_NAME_1U "rsvg_videologo_%lu"
@@ -66,6 +70,11 @@
 #define VIDEO_RATE_CAPS_FILTER_NAME_1U "videorate_capsfilter_%lu"
 #define VIDEO_RATE_NAME_1U "videorate_%lu"
 
+#define ML_TEE_NAME_1U "ml_tee_%lu"
+#define ML_QUEUE_NAME_1U "ml_queue_%lu"
+#define ML_VIDEO_RATE_NAME_1U "ml_videorate_%lu"
+#define ML_SINK_NAME_1U "ml_sink_%lu"
+
 #define AUDIO_RESAMPLE_NAME_1U "audioresample_%lu"
 #define MPEG_AUDIO_PARSE_NAME_1U "mpegaudioparse_%lu"
 
@@ -90,7 +99,13 @@
 #define VIDEO_DEPAY_NAME_1U "video_depay_%lu"
 
 #define VIDEO_TEE_QUEUE_NAME_1U "video_tee_queue_%lu"
+#define TS_TEE_NAME_1U "ts_tee_%lu"
+#define TS_TEE_QUEUE_NAME_1U "ts_tee_queue_%lu"
 #define AUDIO_TEE_QUEUE_NAME_1U "audio_tee_queue_%lu"
+#define MUXER_TEE_NAME_1U "muxer_tee_%lu"
+#define MUXER_TEE_QUEUE_NAME_1U "muxer_tee_queue_%lu"
+#define TUNER_QUEUE_NAME_1U "tuner_queue_%lu"
+#define VIDEO_RENDITION_QUEUE_NAME_1U "video_rendition_queue_%lu"
 
 #define AUDIO_LEVEL_NAME_1U "level_%lu"
 
@@ -26,6 +26,7 @@
 
 #include "base/constants.h"
 #include "stream/stypes.h"
+#include "stream/timeshift_index.h"
 
 namespace fastocloud {
 namespace stream {
@@ -44,6 +45,40 @@ bool compare_files(const common::file_system::ascii_file_string_path& first,
   CHECK(ok) << "Must be index but: " << second_chunk;
   return first_index < second_index;
 }
+
+bool find_last_chunk_file(const common::file_system::ascii_directory_string_path& timshift_dir,
+                          chunk_index_t* index,
+                          time_t* file_created_time) {
+  const std::string absolute_path = timshift_dir.GetPath();
+  if (!common::file_system::is_directory_exist(absolute_path)) {
+    CRITICAL_LOG() << "Folder with chunks doesn't exist: " << absolute_path;
+  }
+
+  const std::function<bool(const common::file_system::ascii_file_string_path&)> filter =
+      [](const common::file_system::ascii_file_string_path& path) {
+        std::string file_name = path.GetBaseFileName();
+        chunk_index_t index;
+        return common::ConvertFromString(file_name, &index);
+      };
+
+  auto files = common::file_system::ScanFolder(timshift_dir, CHUNK_EXT, false, filter);
+  if (files.empty()) {
+    return false;
+  }
+
+  const common::file_system::ascii_file_string_path last_file =
+      *std::max_element(files.begin(), files.end(), compare_files);
+  common::ErrnoError err = common::file_system::get_file_time_last_modification(last_file.GetPath(), file_created_time);
+  if (err) {
+    return false;
+  }
+  chunk_index_t lindex;
+  if (!common::ConvertFromString(last_file.GetBaseFileName(), &lindex)) {
+    return false;
+  }
+  *index = lindex;
+  return true;
+}
 }  // namespace
 
 TimeShiftInfo::TimeShiftInfo()
@@ -58,6 +93,11 @@ bool TimeShiftInfo::FindChunkToPlay(time_t chunk_duration, chunk_index_t* index)
   }
 
   time_t desired_time = common::time::current_utc_mstime() / 1000 - timeshift_delay * 60;  // OK
+  const TimeShiftIndex chunks_index(timshift_dir);
+  if (chunks_index.IsExist()) {
+    return chunks_index.FindChunkToPlay(desired_time, chunk_duration, index);
+  }
+
   std::string absolute_path = timshift_dir.GetPath();
   if (!common::file_system::is_directory_exist(absolute_path)) {
     CRITICAL_LOG() << "Folder with chunks doesn't exist: " << absolute_path;
@@ -107,34 +147,26 @@ bool TimeShiftInfo::FindLastChunk(chunk_index_t* index, time_t* file_created_tim
     return false;
   }
 
-  const std::string absolute_path = timshift_dir.GetPath();
-  if (!common::file_system::is_directory_exist(absolute_path)) {
-    CRITICAL_LOG() << "Folder with chunks doesn't exist: " << absolute_path;
+  const TimeShiftIndex chunks_index(timshift_dir);
+  TimeShiftIndex::Chunk last_chunk;
+  const bool indexed = chunks_index.FindLastChunk(&last_chunk);
+
+  // chunk in progress is recorded to index only when closed, so disk may hold newer one after restart
+  chunk_index_t file_index;
+  time_t file_time;
+  const bool on_disk = find_last_chunk_file(timshift_dir, &file_index, &file_time);
+  if (indexed && (!on_disk || last_chunk.index >= file_index)) {
+    *index = last_chunk.index;
+    *file_created_time = last_chunk.start_time + last_chunk.duration;
+    return true;
   }
 
-  const std::function<bool(const common::file_system::ascii_file_string_path&)> filter =
-      [](const common::file_system::ascii_file_string_path& path) {
-        std::string file_name = path.GetBaseFileName();
-        chunk_index_t index;
-        return common::ConvertFromString(file_name, &index);
-      };
-
-  auto files = common::file_system::ScanFolder(timshift_dir, CHUNK_EXT, false, filter);
-  if (files.empty()) {
+  if (!on_disk) {
     return false;
   }
 
-  std::sort(files.begin(), files.end(), compare_files);
-  common::file_system::ascii_file_string_path last_file = files.back();
-  common::ErrnoError err = common::file_system::get_file_time_last_modification(last_file.GetPath(), file_created_time);
-  if (err) {
-    return false;
-  }
-  chunk_index_t lindex;
-  if (!common::ConvertFromString(last_file.GetBaseFileName(), &lindex)) {
-    return false;
-  }
-  *index = lindex;
+  *index = file_index;
+  *file_created_time = file_time;
   return true;
 }
 
@@ -32,6 +32,8 @@ struct TimeShiftInfo {
   TimeShiftInfo();
   explicit TimeShiftInfo(const std::string& path, chunk_life_time_t lth, time_shift_delay_t delay);
 
+  // both use chunks index of recorder if present, otherwise scan folder;
+  // last chunk is newest of index and folder, because chunk in progress is not indexed yet
   bool FindLastChunk(chunk_index_t* index, time_t* file_created_time) const WARN_UNUSED_RESULT;
   bool FindChunkToPlay(time_t chunk_duration, chunk_index_t* index) const WARN_UNUSED_RESULT;
 
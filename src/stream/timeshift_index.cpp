@@ -0,0 +1,269 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/timeshift_index.h"
+
+#if defined(OS_POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <common/file_system/string_path_utils.h>
+#include <common/sprintf.h>
+
+#include "base/types.h"
+
+#define TIMESHIFT_INDEX_FILE_NAME "chunks.idx"
+
+namespace fastocloud {
+namespace stream {
+
+namespace {
+// compaction rewrites whole file, so do it only when noticeable part of records expired
+enum { kCompactDivider = 4 };
+
+typedef TimeShiftIndex::Chunk Chunk;
+
+time_t GetEndTime(const Chunk& chunk) {
+  return chunk.start_time + chunk.duration;
+}
+
+class MappedIndex {
+ public:
+  explicit MappedIndex(const std::string& path) : data_(nullptr), size_(0) {
+#if defined(OS_POSIX)
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == INVALID_DESCRIPTOR) {
+      return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+      const size_t size = (static_cast<size_t>(st.st_size) / sizeof(Chunk)) * sizeof(Chunk);  // skip partial tail
+      if (size) {
+        void* mem = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mem != MAP_FAILED) {
+          data_ = static_cast<const Chunk*>(mem);
+          size_ = size;
+        }
+      }
+    }
+    close(fd);
+#else
+    UNUSED(path);
+#endif
+  }
+
+  ~MappedIndex() {
+#if defined(OS_POSIX)
+    if (data_) {
+      munmap(const_cast<Chunk*>(data_), size_);
+    }
+#endif
+  }
+
+  const Chunk* begin() const { return data_; }
+  const Chunk* end() const { return data_ + GetCount(); }
+  size_t GetCount() const { return size_ / sizeof(Chunk); }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MappedIndex);
+
+  const Chunk* data_;
+  size_t size_;
+};
+}  // namespace
+
+TimeShiftIndex::TimeShiftIndex(const common::file_system::ascii_directory_string_path& dir)
+    : dir_(dir.GetPath()),
+      path_(common::file_system::make_path(dir_, TIMESHIFT_INDEX_FILE_NAME)),
+      write_mutex_(),
+      write_fd_(INVALID_DESCRIPTOR),
+      last_removed_index_(invalid_chunk_index) {}
+
+TimeShiftIndex::~TimeShiftIndex() {
+  CloseWriter();
+}
+
+bool TimeShiftIndex::IsExist() const {
+  return common::file_system::is_file_exist(path_);
+}
+
+const std::string& TimeShiftIndex::GetPath() const {
+  return path_;
+}
+
+common::ErrnoError TimeShiftIndex::Append(const Chunk& chunk) {
+#if defined(OS_POSIX)
+  std::unique_lock<std::mutex> lock(write_mutex_);
+  if (write_fd_ == INVALID_DESCRIPTOR) {
+    write_fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (write_fd_ == INVALID_DESCRIPTOR) {
+      return common::make_errno_error(errno);
+    }
+  }
+
+  ssize_t written = write(write_fd_, &chunk, sizeof(chunk));
+  if (written == sizeof(chunk)) {
+    return common::ErrnoError();
+  }
+
+  common::ErrnoError err = common::make_errno_error(written == ERROR_RESULT_VALUE ? errno : EIO);
+  if (written > 0) {  // keep records aligned for readers
+    off_t end = lseek(write_fd_, 0, SEEK_END);
+    if (end != ERROR_RESULT_VALUE) {
+      ignore_result(ftruncate(write_fd_, end - written));
+    }
+  }
+  return err;
+#else
+  UNUSED(chunk);
+  return common::make_errno_error("Timeshift index not supported", ENOTSUP);
+#endif
+}
+
+common::ErrnoError TimeShiftIndex::RemoveOlder(time_t min_end_time) {
+#if defined(OS_POSIX)
+  std::unique_lock<std::mutex> lock(write_mutex_);
+  MappedIndex chunks(path_);
+  const size_t count = chunks.GetCount();
+  if (count == 0) {
+    return common::ErrnoError();
+  }
+
+  const Chunk* first_alive = std::lower_bound(
+      chunks.begin(), chunks.end(), min_end_time,
+      [](const Chunk& chunk, time_t min_end_time) { return GetEndTime(chunk) < min_end_time; });
+  const Chunk* first_not_removed = chunks.begin();
+  if (last_removed_index_ != invalid_chunk_index) {
+    first_not_removed = std::upper_bound(
+        chunks.begin(), first_alive, last_removed_index_,
+        [](chunk_index_t index, const Chunk& chunk) { return index < chunk.index; });
+  }
+  for (const Chunk* it = first_not_removed; it != first_alive; ++it) {
+    const std::string chunk_path = common::MemSPrintf("%s%llu." TS_EXTENSION, dir_, it->index);
+    if (unlink(chunk_path.c_str()) == ERROR_RESULT_VALUE && errno != ENOENT) {
+      WARNING_LOG() << "Can't remove file: " << chunk_path << ", error: " << strerror(errno);
+    }
+    last_removed_index_ = it->index;
+  }
+
+  const size_t stale = first_alive - chunks.begin();
+  if (stale == 0 || stale * kCompactDivider < count) {
+    return common::ErrnoError();
+  }
+
+  // readers keep old mapping, rename replaces index atomically for next lookups
+  const std::string tmp_path = path_ + ".tmp";
+  int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  const char* data = reinterpret_cast<const char*>(first_alive);
+  size_t left = (count - stale) * sizeof(Chunk);
+  while (left) {
+    ssize_t written = write(fd, data, left);
+    if (written == ERROR_RESULT_VALUE) {
+      if (errno == EINTR) {
+        continue;
+      }
+      common::ErrnoError err = common::make_errno_error(errno);
+      close(fd);
+      unlink(tmp_path.c_str());
+      return err;
+    }
+    data += written;
+    left -= written;
+  }
+  close(fd);
+
+  if (rename(tmp_path.c_str(), path_.c_str()) == ERROR_RESULT_VALUE) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    unlink(tmp_path.c_str());
+    return err;
+  }
+
+  CloseWriter();  // next append goes to new file
+  return common::ErrnoError();
+#else
+  UNUSED(min_end_time);
+  return common::ErrnoError();
+#endif
+}
+
+bool TimeShiftIndex::FindLastChunk(Chunk* chunk) const {
+  if (!chunk) {
+    return false;
+  }
+
+  MappedIndex chunks(path_);
+  if (chunks.GetCount() == 0) {
+    return false;
+  }
+
+  *chunk = *(chunks.end() - 1);
+  return true;
+}
+
+bool TimeShiftIndex::FindChunkToPlay(time_t desired_time, time_t chunk_duration, chunk_index_t* index) const {
+  if (!index) {
+    return false;
+  }
+
+  MappedIndex chunks(path_);
+  if (chunks.GetCount() == 0) {
+    return false;
+  }
+
+  // first chunk started less than chunk duration before desired time
+  const time_t min_start_time = desired_time - chunk_duration;
+  const Chunk* it = std::upper_bound(chunks.begin(), chunks.end(), min_start_time,
+                                     [](time_t start_time, const Chunk& chunk) { return start_time < chunk.start_time; });
+  if (it == chunks.end()) {
+    return false;
+  }
+
+  const time_t diff = desired_time - it->start_time;
+  if (diff <= -chunk_duration) {  // gap in recording
+    return false;
+  }
+
+  if (diff > 0 && it != chunks.begin()) {
+    *index = (it - 1)->index;
+  } else {
+    *index = it->index;
+  }
+
+  INFO_LOG() << "Select " << *index << " part, diff sec " << diff;
+  return true;
+}
+
+void TimeShiftIndex::CloseWriter() {
+#if defined(OS_POSIX)
+  if (write_fd_ != INVALID_DESCRIPTOR) {
+    close(write_fd_);
+    write_fd_ = INVALID_DESCRIPTOR;
+  }
+#endif
+}
+
+}  // namespace stream
+}  // namespace fastocloud
@@ -0,0 +1,70 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <mutex>
+#include <string>
+
+#include <common/error.h>
+#include <common/file_system/path.h>
+
+#include "stream/timeshift.h"
+
+namespace fastocloud {
+namespace stream {
+
+// Append-only file of fixed size records, one per finished chunk, stored next to timeshift chunks.
+// Recorder appends, players map it read only and binary search by time instead of scanning folder.
+class TimeShiftIndex {
+ public:
+  struct Chunk {
+    uint64_t index;
+    int64_t start_time;  // utc seconds
+    int64_t duration;    // seconds
+    uint64_t size;       // bytes
+  };
+
+  explicit TimeShiftIndex(const common::file_system::ascii_directory_string_path& dir);
+  ~TimeShiftIndex();
+
+  bool IsExist() const;
+  const std::string& GetPath() const;
+
+  // recorder side
+  common::ErrnoError Append(const Chunk& chunk) WARN_UNUSED_RESULT;
+  // removes chunk files ended before min_end_time, without folder scan,
+  // index itself rewritten only if enough expired records accumulated
+  common::ErrnoError RemoveOlder(time_t min_end_time) WARN_UNUSED_RESULT;
+
+  // players side, index mapped on every call so recorder appends are visible
+  bool FindLastChunk(Chunk* chunk) const WARN_UNUSED_RESULT;
+  bool FindChunkToPlay(time_t desired_time, time_t chunk_duration, chunk_index_t* index) const WARN_UNUSED_RESULT;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TimeShiftIndex);
+
+  void CloseWriter();
+
+  const std::string dir_;
+  const std::string path_;
+  std::mutex write_mutex_;  // splitmuxsink path callback appends, main loop compacts
+  int write_fd_;
+  chunk_index_t last_removed_index_;
+};
+
+}  // namespace stream
+}  // namespace fastocloud
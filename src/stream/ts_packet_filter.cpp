@@ -0,0 +1,331 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/ts_packet_filter.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+namespace fastocloud {
+namespace stream {
+
+namespace {
+const int8_t kInvalidCC = -1;
+const uint8_t kPatTableId = 0x00;
+const uint8_t kPmtTableId = 0x02;
+const size_t kCrcSize = 4;
+
+uint16_t GetPid(const uint8_t* packet) {
+  return static_cast<uint16_t>(((packet[1] & 0x1F) << 8) | packet[2]);
+}
+
+size_t GetSectionLength(const uint8_t* section) {
+  return ((section[1] & 0x0F) << 8) | section[2];
+}
+
+// offset of section start in packet with payload_unit_start, 0 if there is no section
+size_t FindSection(const uint8_t* packet) {
+  if (!(packet[1] & 0x40) || !(packet[3] & 0x10)) {
+    return 0;
+  }
+
+  size_t pos = 4;
+  if (packet[3] & 0x20) {
+    pos += 1 + packet[4];
+  }
+  if (pos >= TsPacketFilter::PACKET_SIZE) {
+    return 0;
+  }
+  pos += 1 + packet[pos];  // pointer field
+  return pos + 3 <= TsPacketFilter::PACKET_SIZE ? pos : 0;
+}
+
+// section must fit in packet, PSI tables larger than one packet are not parsed
+bool IsCompleteSection(const uint8_t* packet, size_t section, size_t min_length) {
+  const size_t section_length = GetSectionLength(packet + section);
+  return section_length >= min_length && section + 3 + section_length <= TsPacketFilter::PACKET_SIZE;
+}
+}  // namespace
+
+TsPacketFilter::TsPacketFilter(const pids_t& pids)
+    : pass_all_(pids.empty()),
+      requested_pids_(PIDS_COUNT, false),
+      passed_pids_(PIDS_COUNT, false),
+      last_cc_(PIDS_COUNT, kInvalidCC),
+      pending_(),
+      in_sync_(true),
+      programs_(),
+      selection_version_(0),
+      stats_() {
+  for (uint16_t pid : pids) {
+    if (pid < PIDS_COUNT) {
+      requested_pids_[pid] = true;
+    }
+  }
+  UpdatePassedPids();
+}
+
+bool TsPacketFilter::Process(const uint8_t* data, size_t size, std::vector<uint8_t>* out) {
+  if (pending_.empty() && pass_all_ && size % PACKET_SIZE == 0) {
+    bool aligned = true;
+    for (size_t pos = 0; pos < size; pos += PACKET_SIZE) {
+      if (data[pos] != SYNC_BYTE) {
+        aligned = false;
+        break;
+      }
+    }
+
+    if (aligned) {  // common case of udp input, nothing to copy
+      for (size_t pos = 0; pos < size; pos += PACKET_SIZE) {
+        Inspect(data + pos);
+      }
+      return true;
+    }
+  }
+
+  pending_.insert(pending_.end(), data, data + size);
+  size_t pos = 0;
+  while (pos + PACKET_SIZE <= pending_.size()) {
+    const uint8_t* packet = pending_.data() + pos;
+    // next packet sync byte confirms boundary if it is already received
+    const bool synced = packet[0] == SYNC_BYTE &&
+                        (pos + PACKET_SIZE >= pending_.size() || pending_[pos + PACKET_SIZE] == SYNC_BYTE);
+    if (!synced) {
+      if (in_sync_) {
+        stats_.sync_losses++;
+        in_sync_ = false;
+      }
+      pos++;
+      continue;
+    }
+
+    in_sync_ = true;
+    Inspect(packet);
+    const uint16_t pid = GetPid(packet);
+    if (!IsPassed(pid)) {
+      stats_.dropped_packets++;
+    } else if (!pass_all_ && pid == PAT_PID) {
+      uint8_t rewritten[PACKET_SIZE];
+      const uint8_t* pat = RewritePat(packet, rewritten) ? rewritten : packet;
+      out->insert(out->end(), pat, pat + PACKET_SIZE);
+    } else {
+      out->insert(out->end(), packet, packet + PACKET_SIZE);
+    }
+    pos += PACKET_SIZE;
+  }
+  pending_.erase(pending_.begin(), pending_.begin() + pos);
+  return false;
+}
+
+TsPacketFilter::Stats TsPacketFilter::GetStats() const {
+  return stats_;
+}
+
+uint32_t TsPacketFilter::Crc32(const uint8_t* data, size_t size) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= static_cast<uint32_t>(data[i]) << 24;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+bool TsPacketFilter::IsPassed(uint16_t pid) const {
+  return pass_all_ || passed_pids_[pid];
+}
+
+void TsPacketFilter::Inspect(const uint8_t* packet) {
+  stats_.packets++;
+  const uint16_t pid = GetPid(packet);
+  if (pid == NULL_PID) {
+    return;
+  }
+
+  const uint8_t adaptation_control = (packet[3] >> 4) & 0x3;
+  const int8_t cc = packet[3] & 0x0F;
+  bool discontinuity = false;
+  if ((adaptation_control & 0x2) && packet[4] > 0) {
+    discontinuity = packet[5] & 0x80;
+  }
+
+  if (!(adaptation_control & 0x1)) {  // counter increments only with payload
+    return;
+  }
+
+  int8_t& last_cc = last_cc_[pid];
+  if (last_cc != kInvalidCC && !discontinuity) {
+    const int8_t expected = (last_cc + 1) & 0x0F;
+    if (cc != expected && cc != last_cc) {  // one duplicate packet allowed
+      stats_.cc_errors++;
+    }
+  }
+  last_cc = cc;
+
+  if (pass_all_) {
+    return;
+  }
+
+  const size_t section = FindSection(packet);
+  if (!section) {
+    return;
+  }
+
+  if (pid == PAT_PID) {
+    ParsePat(packet, section);
+    return;
+  }
+
+  programs_t::iterator it = programs_.find(pid);
+  if (it != programs_.end()) {
+    ParsePmt(packet, section, &it->second);
+  }
+}
+
+void TsPacketFilter::ParsePat(const uint8_t* packet, size_t section) {
+  if (packet[section] != kPatTableId || !IsCompleteSection(packet, section, 5 + kCrcSize)) {
+    return;
+  }
+
+  const size_t section_end = section + 3 + GetSectionLength(packet + section) - kCrcSize;
+  programs_t programs;
+  for (size_t i = section + 8; i + 4 <= section_end; i += 4) {
+    const uint16_t program_number = static_cast<uint16_t>((packet[i] << 8) | packet[i + 1]);
+    const uint16_t pmt_pid = static_cast<uint16_t>(((packet[i + 2] & 0x1F) << 8) | packet[i + 3]);
+    if (program_number == 0) {  // network pid
+      continue;
+    }
+
+    programs_t::const_iterator known = programs_.find(pmt_pid);
+    if (known != programs_.end() && known->second.number == program_number) {
+      programs[pmt_pid] = known->second;
+    } else {
+      programs[pmt_pid] = {program_number, requested_pids_[pmt_pid], pids_t()};
+    }
+  }
+
+  if (programs.size() == programs_.size() &&
+      std::equal(programs.begin(), programs.end(), programs_.begin(),
+                 [](const programs_t::value_type& left, const programs_t::value_type& right) {
+                   return left.first == right.first && left.second.number == right.second.number;
+                 })) {
+    return;
+  }
+
+  programs_.swap(programs);
+  UpdatePassedPids();
+}
+
+void TsPacketFilter::ParsePmt(const uint8_t* packet, size_t section, Program* program) {
+  if (packet[section] != kPmtTableId || !IsCompleteSection(packet, section, 9 + kCrcSize)) {
+    return;
+  }
+
+  const uint16_t program_number = static_cast<uint16_t>((packet[section + 3] << 8) | packet[section + 4]);
+  if (program_number != program->number) {
+    return;
+  }
+
+  const size_t section_end = section + 3 + GetSectionLength(packet + section) - kCrcSize;
+  const uint16_t pcr_pid = static_cast<uint16_t>(((packet[section + 8] & 0x1F) << 8) | packet[section + 9]);
+  const size_t program_info_length = ((packet[section + 10] & 0x0F) << 8) | packet[section + 11];
+  pids_t pids;
+  if (pcr_pid != NULL_PID) {
+    pids.push_back(pcr_pid);
+  }
+  for (size_t i = section + 12 + program_info_length; i + 5 <= section_end;) {
+    const uint16_t es_pid = static_cast<uint16_t>(((packet[i + 1] & 0x1F) << 8) | packet[i + 2]);
+    const size_t es_info_length = ((packet[i + 3] & 0x0F) << 8) | packet[i + 4];
+    pids.push_back(es_pid);
+    i += 5 + es_info_length;
+  }
+  std::sort(pids.begin(), pids.end());
+  pids.erase(std::unique(pids.begin(), pids.end()), pids.end());
+  if (pids == program->pids) {
+    return;
+  }
+
+  program->pids.swap(pids);
+  UpdatePassedPids();
+}
+
+bool TsPacketFilter::RewritePat(const uint8_t* packet, uint8_t* rewritten) const {
+  const size_t section = FindSection(packet);
+  if (!section || packet[section] != kPatTableId || !IsCompleteSection(packet, section, 5 + kCrcSize)) {
+    return false;
+  }
+
+  const size_t section_end = section + 3 + GetSectionLength(packet + section) - kCrcSize;
+  memcpy(rewritten, packet, section + 8);
+  size_t pos = section + 8;
+  for (size_t i = section + 8; i + 4 <= section_end; i += 4) {
+    const uint16_t program_number = static_cast<uint16_t>((packet[i] << 8) | packet[i + 1]);
+    const uint16_t pmt_pid = static_cast<uint16_t>(((packet[i + 2] & 0x1F) << 8) | packet[i + 3]);
+    programs_t::const_iterator it = programs_.find(pmt_pid);
+    if (program_number == 0 || (it != programs_.end() && it->second.selected)) {
+      memcpy(rewritten + pos, packet + i, 4);
+      pos += 4;
+    }
+  }
+
+  const size_t section_length = pos + kCrcSize - section - 3;
+  rewritten[section + 1] = (packet[section + 1] & 0xF0) | ((section_length >> 8) & 0x0F);
+  rewritten[section + 2] = section_length & 0xFF;
+  const uint8_t version = ((packet[section + 5] >> 1) + selection_version_) & 0x1F;
+  rewritten[section + 5] = (packet[section + 5] & 0xC1) | (version << 1);
+  const uint32_t crc = Crc32(rewritten + section, pos - section);
+  rewritten[pos++] = (crc >> 24) & 0xFF;
+  rewritten[pos++] = (crc >> 16) & 0xFF;
+  rewritten[pos++] = (crc >> 8) & 0xFF;
+  rewritten[pos++] = crc & 0xFF;
+  memset(rewritten + pos, 0xFF, PACKET_SIZE - pos);
+  return true;
+}
+
+void TsPacketFilter::UpdatePassedPids() {
+  std::vector<bool> passed(requested_pids_);
+  for (uint16_t pid = 0; pid <= PSI_MAX_PID; ++pid) {
+    passed[pid] = true;
+  }
+
+  bool selection_changed = false;
+  for (programs_t::value_type& program : programs_) {
+    bool selected = requested_pids_[program.first];
+    for (uint16_t pid : program.second.pids) {
+      selected = selected || requested_pids_[pid];
+    }
+    if (selected != program.second.selected) {
+      program.second.selected = selected;
+      selection_changed = true;
+    }
+    if (!selected) {
+      continue;
+    }
+
+    passed[program.first] = true;
+    for (uint16_t pid : program.second.pids) {
+      passed[pid] = true;
+    }
+  }
+
+  passed_pids_.swap(passed);
+  if (selection_changed) {
+    selection_version_++;
+  }
+}
+
+}  // namespace stream
+}  // namespace fastocloud
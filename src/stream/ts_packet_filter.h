@@ -0,0 +1,90 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+namespace fastocloud {
+namespace stream {
+
+// Packet level MPEG-TS processing for passthrough relay, no demux:
+// resync on 188 byte packets, PID filter, continuity counter tracking.
+// With pid filter program is selected if its PMT pid or one of its elementary pids is listed,
+// then PMT, PCR and all elementary pids of program pass, PAT is rewritten to list only selected programs.
+// PSI pids (0 - 0x1F) always pass.
+class TsPacketFilter {
+ public:
+  enum {
+    PACKET_SIZE = 188,
+    SYNC_BYTE = 0x47,
+    PAT_PID = 0x00,
+    PSI_MAX_PID = 0x1F,
+    NULL_PID = 0x1FFF,
+    PIDS_COUNT = 0x2000
+  };
+  typedef std::vector<uint16_t> pids_t;
+
+  struct Stats {
+    uint64_t packets;
+    uint64_t dropped_packets;  // by pid filter
+    uint64_t cc_errors;
+    uint64_t sync_losses;
+  };
+
+  explicit TsPacketFilter(const pids_t& pids);  // empty pids - everything pass
+
+  // returns true if data can be forwarded as is (aligned and nothing filtered),
+  // otherwise passed packets appended to out, not complete tail kept till next call
+  bool Process(const uint8_t* data, size_t size, std::vector<uint8_t>* out);
+
+  Stats GetStats() const;
+
+  static uint32_t Crc32(const uint8_t* data, size_t size);  // MPEG-2 PSI crc
+
+ private:
+  struct Program {
+    uint16_t number;
+    bool selected;
+    pids_t pids;  // pcr and elementary
+  };
+  typedef std::map<uint16_t, Program> programs_t;  // by pmt pid
+
+  void Inspect(const uint8_t* packet);
+  void ParsePat(const uint8_t* packet, size_t section);
+  void ParsePmt(const uint8_t* packet, size_t section, Program* program);
+  // false if packet doesn't start single packet PAT section, then it is passed as is
+  bool RewritePat(const uint8_t* packet, uint8_t* rewritten) const;
+  void UpdatePassedPids();
+  bool IsPassed(uint16_t pid) const;
+
+  const bool pass_all_;
+  std::vector<bool> requested_pids_;
+  std::vector<bool> passed_pids_;
+  std::vector<int8_t> last_cc_;
+  std::vector<uint8_t> pending_;
+  bool in_sync_;
+
+  programs_t programs_;
+  uint8_t selection_version_;  // added to PAT version, so receivers notice changed program list
+
+  Stats stats_;
+};
+
+}  // namespace stream
+}  // namespace fastocloud
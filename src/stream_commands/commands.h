@@ -20,6 +20,8 @@
 #define CHANGED_SOURCES_STREAM "changed_source_stream"
 #define STATISTIC_STREAM "statistic_stream"
 
+#define RESOLVED_LINK_STREAM "resolved_link_stream"
+
 #if defined(MACHINE_LEARNING)
 #define ML_NOTIFICATION_STREAM "ml_notification_stream"
 #endif
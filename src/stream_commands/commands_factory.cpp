@@ -14,6 +14,8 @@
 
 #include "stream_commands/commands_factory.h"
 
+#include <string>
+
 #include "stream_commands/commands.h"
 
 namespace fastocloud {
@@ -42,4 +44,19 @@ fastotv::protocol::request_t StopStreamRequest(fastotv::protocol::sequance_id_t
   return req;
 }
 
+common::Error ResolvedLinkStreamNotification(const ResolvedLinkInfo& params, fastotv::protocol::request_t* req) {
+  if (!req) {
+    return common::make_error_inval();
+  }
+
+  std::string req_str;
+  common::Error err_ser = params.SerializeToString(&req_str);
+  if (err_ser) {
+    return err_ser;
+  }
+
+  *req = fastotv::protocol::request_t::MakeNotification(RESOLVED_LINK_STREAM, req_str);
+  return common::Error();
+}
+
 }  // namespace fastocloud
@@ -16,10 +16,13 @@
 
 #include <fastotv/protocol/types.h>
 
+#include "stream_commands/commands_info/resolved_link_info.h"
+
 namespace fastocloud {
 
 fastotv::protocol::request_t RestartStreamRequest(fastotv::protocol::sequance_id_t id);
 fastotv::protocol::request_t StopStreamRequest(fastotv::protocol::sequance_id_t id);
+common::Error ResolvedLinkStreamNotification(const ResolvedLinkInfo& params, fastotv::protocol::request_t* req);
 
 fastotv::protocol::response_t RestartStreamResponseSuccess(fastotv::protocol::sequance_id_t id);
 fastotv::protocol::response_t StopStreamResponseSuccess(fastotv::protocol::sequance_id_t id);
@@ -0,0 +1,94 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream_commands/commands_info/details/latency_stats_info.h"
+
+#include <string>
+
+#define FIELD_LATENCY_STAGE "stage"
+#define FIELD_LATENCY_SUM "sum"  // usec
+#define FIELD_LATENCY_MAX "max"  // usec
+#define FIELD_LATENCY_BUCKETS "buckets"
+
+namespace fastocloud {
+namespace details {
+
+LatencyStatsInfo::LatencyStatsInfo() : LatencyStatsInfo(LATENCY_STAGE_OUTPUT, LatencyStats()) {}
+
+LatencyStatsInfo::LatencyStatsInfo(LatencyStage stage, const LatencyStats& stats) : stage_(stage), stats_(stats) {}
+
+LatencyStage LatencyStatsInfo::GetStage() const {
+  return stage_;
+}
+
+LatencyStats LatencyStatsInfo::GetLatencyStats() const {
+  return stats_;
+}
+
+common::Error LatencyStatsInfo::SerializeFields(json_object* out) const {
+  ignore_result(SetStringField(out, FIELD_LATENCY_STAGE, LatencyStats::GetStageName(stage_)));
+  ignore_result(SetUInt64Field(out, FIELD_LATENCY_SUM, stats_.GetSumUsec()));
+  ignore_result(SetUInt64Field(out, FIELD_LATENCY_MAX, stats_.GetMaxUsec()));
+
+  json_object* jbuckets = json_object_new_array();
+  for (size_t i = 0; i < LatencyStats::BUCKETS_COUNT; ++i) {
+    json_object_array_add(jbuckets, json_object_new_int64(stats_.GetBucket(i)));
+  }
+  ignore_result(SetArrayField(out, FIELD_LATENCY_BUCKETS, jbuckets));
+  return common::Error();
+}
+
+common::Error LatencyStatsInfo::DoDeSerialize(json_object* serialized) {
+  std::string stage_str;
+  common::Error err = GetStringField(serialized, FIELD_LATENCY_STAGE, &stage_str);
+  if (err) {
+    return err;
+  }
+
+  LatencyStage stage = LATENCY_STAGES_COUNT;
+  for (int i = 0; i < LATENCY_STAGES_COUNT; ++i) {
+    if (stage_str == LatencyStats::GetStageName(static_cast<LatencyStage>(i))) {
+      stage = static_cast<LatencyStage>(i);
+      break;
+    }
+  }
+  if (stage == LATENCY_STAGES_COUNT) {
+    return common::make_error_inval();
+  }
+
+  LatencyStats stats;
+  uint64_t sum = 0;
+  ignore_result(GetUint64Field(serialized, FIELD_LATENCY_SUM, &sum));
+  stats.SetSumUsec(sum);
+
+  uint64_t max = 0;
+  ignore_result(GetUint64Field(serialized, FIELD_LATENCY_MAX, &max));
+  stats.SetMaxUsec(max);
+
+  json_object* jbuckets = nullptr;
+  size_t len = 0;
+  err = GetArrayField(serialized, FIELD_LATENCY_BUCKETS, &jbuckets, &len);
+  if (!err) {
+    for (size_t i = 0; i < len && i < LatencyStats::BUCKETS_COUNT; ++i) {
+      json_object* jbucket = json_object_array_get_idx(jbuckets, i);
+      stats.SetBucket(i, json_object_get_int64(jbucket));
+    }
+  }
+
+  *this = LatencyStatsInfo(stage, stats);
+  return common::Error();
+}
+
+}  // namespace details
+}  // namespace fastocloud
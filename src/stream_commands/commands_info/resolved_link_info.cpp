@@ -0,0 +1,74 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream_commands/commands_info/resolved_link_info.h"
+
+#include <string>
+
+#define RESOLVED_LINK_SOURCE_FIELD "source"
+#define RESOLVED_LINK_URL_FIELD "url"
+#define RESOLVED_LINK_EXPIRE_FIELD "expire"
+
+namespace fastocloud {
+
+ResolvedLinkInfo::ResolvedLinkInfo() : base_class(), source_(), url_(), expire_utc_msec_(0) {}
+
+ResolvedLinkInfo::ResolvedLinkInfo(const std::string& source,
+                                   const std::string& url,
+                                   fastotv::timestamp_t expire_utc_msec)
+    : base_class(), source_(source), url_(url), expire_utc_msec_(expire_utc_msec) {}
+
+std::string ResolvedLinkInfo::GetSource() const {
+  return source_;
+}
+
+std::string ResolvedLinkInfo::GetUrl() const {
+  return url_;
+}
+
+fastotv::timestamp_t ResolvedLinkInfo::GetExpireTime() const {
+  return expire_utc_msec_;
+}
+
+common::Error ResolvedLinkInfo::SerializeFields(json_object* out) const {
+  ignore_result(SetStringField(out, RESOLVED_LINK_SOURCE_FIELD, source_));
+  ignore_result(SetStringField(out, RESOLVED_LINK_URL_FIELD, url_));
+  ignore_result(SetInt64Field(out, RESOLVED_LINK_EXPIRE_FIELD, expire_utc_msec_));
+  return common::Error();
+}
+
+common::Error ResolvedLinkInfo::DoDeSerialize(json_object* serialized) {
+  std::string source;
+  common::Error err = GetStringField(serialized, RESOLVED_LINK_SOURCE_FIELD, &source);
+  if (err) {
+    return err;
+  }
+
+  std::string url;
+  err = GetStringField(serialized, RESOLVED_LINK_URL_FIELD, &url);
+  if (err) {
+    return err;
+  }
+
+  int64_t expire;
+  err = GetInt64Field(serialized, RESOLVED_LINK_EXPIRE_FIELD, &expire);
+  if (err) {
+    return err;
+  }
+
+  *this = ResolvedLinkInfo(source, url, expire);
+  return common::Error();
+}
+
+}  // namespace fastocloud
@@ -17,6 +17,7 @@
 #include <math.h>
 
 #include "stream_commands/commands_info/details/channel_stats_info.h"
+#include "stream_commands/commands_info/details/latency_stats_info.h"
 
 #define STREAM_ID_FIELD "id"
 #define STREAM_TYPE_FIELD "type"
@@ -31,6 +32,7 @@
 
 #define STREAM_INPUT_STREAMS_FIELD "input_streams"
 #define STREAM_OUTPUT_STREAMS_FIELD "output_streams"
+#define STREAM_LATENCY_FIELD "latency"
 
 namespace fastocloud {
 
@@ -93,6 +95,18 @@ common::Error StatisticInfo::SerializeFields(json_object* out) const {
   }
   ignore_result(SetArrayField(out, STREAM_OUTPUT_STREAMS_FIELD, joutput_streams));
 
+  json_object* jlatency = json_object_new_array();
+  for (size_t i = 0; i < stream_struct_.latency.size(); ++i) {
+    json_object* jinf = nullptr;
+    details::LatencyStatsInfo linf(static_cast<LatencyStage>(i), stream_struct_.latency[i]);
+    common::Error err = linf.Serialize(&jinf);
+    if (err) {
+      continue;
+    }
+    json_object_array_add(jlatency, jinf);
+  }
+  ignore_result(SetArrayField(out, STREAM_LATENCY_FIELD, jlatency));
+
   ignore_result(SetInt64Field(out, STREAM_LOOP_START_TIME_FIELD, stream_struct_.loop_start_time));
   ignore_result(SetUInt64Field(out, STREAM_RSS_FIELD, rss_bytes_));
   ignore_result(SetDoubleField(out, STREAM_CPU_FIELD, cpu_load_));
@@ -150,6 +164,22 @@ common::Error StatisticInfo::DoDeSerialize(json_object* serialized) {
     }
   }
 
+  latency_stats_t latency;
+  json_object* jlatency = nullptr;
+  err = GetArrayField(serialized, STREAM_LATENCY_FIELD, &jlatency, &len);
+  if (!err) {
+    for (size_t i = 0; i < len; ++i) {
+      json_object* jlat = json_object_array_get_idx(jlatency, i);
+      details::LatencyStatsInfo linf;
+      common::Error err = linf.DeSerialize(jlat);
+      if (err) {
+        continue;
+      }
+
+      latency[linf.GetStage()] = linf.GetLatencyStats();
+    }
+  }
+
   StreamStatus st = NEW;
   ignore_result(GetEnumField(serialized, STREAM_STATUS_FIELD, &st));
 
@@ -176,6 +206,7 @@ common::Error StatisticInfo::DoDeSerialize(json_object* serialized) {
 
   StreamStruct strct(cid, type, st, input, output, start_time, loop_start_time, restarts);
   strct.idle_time = idle_time;
+  strct.latency = latency;
   *this = StatisticInfo(strct, cpu_load, rss, time);
   return common::Error();
 }
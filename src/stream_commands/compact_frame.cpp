@@ -0,0 +1,339 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream_commands/compact_frame.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+
+#include <common/libev/io_client.h>
+
+#define STATISTIC_FRAME_VERSION 2
+#define COMPACT_FRAME_HEADER_SIZE 5
+
+namespace fastocloud {
+namespace {
+
+const int kCompactFrameWriteRetryMsec = 1;
+
+class FrameWriter {
+ public:
+  explicit FrameWriter(std::string* out) : out_(out) {}
+
+  void PutUInt8(uint8_t value) { out_->push_back(static_cast<char>(value)); }
+
+  void PutUInt32(uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      PutUInt8(static_cast<uint8_t>(value >> shift));
+    }
+  }
+
+  void PutUInt64(uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      PutUInt8(static_cast<uint8_t>(value >> shift));
+    }
+  }
+
+  void PutInt64(int64_t value) { PutUInt64(static_cast<uint64_t>(value)); }
+
+  void PutDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    PutUInt64(bits);
+  }
+
+  void PutString(const std::string& value) {
+    PutUInt32(static_cast<uint32_t>(value.size()));
+    out_->append(value);
+  }
+
+ private:
+  std::string* const out_;
+};
+
+class FrameReader {
+ public:
+  explicit FrameReader(const std::string& data) : data_(data), pos_(0), failed_(false) {}
+
+  bool IsFailed() const { return failed_; }
+
+  uint8_t GetUInt8() {
+    if (!Check(1)) {
+      return 0;
+    }
+    return static_cast<uint8_t>(data_[pos_++]);
+  }
+
+  uint32_t GetUInt32() {
+    if (!Check(4)) {
+      return 0;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+      value = (value << 8) | static_cast<uint8_t>(data_[pos_++]);
+    }
+    return value;
+  }
+
+  uint64_t GetUInt64() {
+    if (!Check(8)) {
+      return 0;
+    }
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+      value = (value << 8) | static_cast<uint8_t>(data_[pos_++]);
+    }
+    return value;
+  }
+
+  int64_t GetInt64() { return static_cast<int64_t>(GetUInt64()); }
+
+  double GetDouble() {
+    const uint64_t bits = GetUInt64();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  std::string GetString() {
+    const uint32_t size = GetUInt32();
+    if (!Check(size)) {
+      return std::string();
+    }
+    std::string value = data_.substr(pos_, size);
+    pos_ += size;
+    return value;
+  }
+
+ private:
+  bool Check(size_t size) {
+    if (failed_ || data_.size() - pos_ < size) {
+      failed_ = true;
+      return false;
+    }
+    return true;
+  }
+
+  const std::string& data_;
+  size_t pos_;
+  bool failed_;
+};
+
+void PutChannels(FrameWriter* writer, const input_channels_info_t& channels) {
+  writer->PutUInt32(static_cast<uint32_t>(channels.size()));
+  for (const ChannelStats& stat : channels) {
+    writer->PutUInt64(stat.GetID());
+    writer->PutInt64(stat.GetLastUpdateTime());
+    writer->PutUInt64(stat.GetTotalBytes());
+    writer->PutUInt64(stat.GetPrevTotalBytes());
+    writer->PutUInt64(stat.GetBps());
+    writer->PutString(common::ConvertToString(stat.GetDesireBytesPerSecond()));
+  }
+}
+
+input_channels_info_t GetChannels(FrameReader* reader) {
+  input_channels_info_t channels;
+  const uint32_t count = reader->GetUInt32();
+  for (uint32_t i = 0; i < count && !reader->IsFailed(); ++i) {
+    ChannelStats stat(static_cast<fastotv::channel_id_t>(reader->GetUInt64()));
+    stat.SetLastUpdateTime(reader->GetInt64());
+    stat.SetTotalBytes(reader->GetUInt64());
+    stat.SetPrevTotalBytes(reader->GetUInt64());
+    stat.SetBps(reader->GetUInt64());
+    common::media::DesireBytesPerSec dbps;
+    if (common::ConvertFromString(reader->GetString(), &dbps)) {
+      stat.SetDesireBytesPerSecond(dbps);
+    }
+    channels.push_back(stat);
+  }
+  return channels;
+}
+
+}  // namespace
+
+CompactFrame::CompactFrame() : type(COMPACT_FRAME_TYPES_COUNT), payload() {}
+
+common::Error EncodeStatisticFrame(const StatisticInfo& stat, std::string* payload) {
+  if (!payload) {
+    return common::make_error_inval();
+  }
+
+  const StreamStruct str = stat.GetStreamStruct();
+  if (!str.IsValid()) {
+    return common::make_error_inval();
+  }
+
+  payload->clear();
+  FrameWriter writer(payload);
+  writer.PutUInt8(STATISTIC_FRAME_VERSION);
+  writer.PutString(str.id);
+  writer.PutUInt32(str.type);
+  writer.PutUInt32(str.status);
+  writer.PutInt64(str.start_time);
+  writer.PutInt64(str.loop_start_time);
+  writer.PutInt64(str.idle_time);
+  writer.PutUInt64(str.restarts);
+  writer.PutDouble(stat.GetCpuLoad());
+  writer.PutUInt64(stat.GetRssBytes());
+  writer.PutInt64(stat.GetTimestamp());
+  PutChannels(&writer, str.input);
+  PutChannels(&writer, str.output);
+  writer.PutUInt32(LATENCY_STAGES_COUNT);
+  for (const LatencyStats& lat : str.latency) {
+    for (size_t i = 0; i < LatencyStats::BUCKETS_COUNT; ++i) {
+      writer.PutUInt64(lat.GetBucket(i));
+    }
+    writer.PutUInt64(lat.GetSumUsec());
+    writer.PutUInt64(lat.GetMaxUsec());
+  }
+  return common::Error();
+}
+
+common::Error DecodeStatisticFrame(const std::string& payload, StatisticInfo* stat) {
+  if (!stat) {
+    return common::make_error_inval();
+  }
+
+  FrameReader reader(payload);
+  if (reader.GetUInt8() != STATISTIC_FRAME_VERSION) {
+    return common::make_error("Unsupported statistic frame version");
+  }
+
+  StreamStruct str;
+  str.id = reader.GetString();
+  str.type = static_cast<fastotv::StreamType>(reader.GetUInt32());
+  str.status = static_cast<StreamStatus>(reader.GetUInt32());
+  str.start_time = reader.GetInt64();
+  str.loop_start_time = reader.GetInt64();
+  str.idle_time = reader.GetInt64();
+  str.restarts = reader.GetUInt64();
+  const StatisticInfo::cpu_load_t cpu_load = reader.GetDouble();
+  const StatisticInfo::rss_t rss = reader.GetUInt64();
+  const fastotv::timestamp_t timestamp = reader.GetInt64();
+  str.input = GetChannels(&reader);
+  str.output = GetChannels(&reader);
+  const uint32_t stages = reader.GetUInt32();
+  for (uint32_t stage = 0; stage < stages && !reader.IsFailed(); ++stage) {
+    LatencyStats lat;
+    for (size_t i = 0; i < LatencyStats::BUCKETS_COUNT; ++i) {
+      lat.SetBucket(i, reader.GetUInt64());
+    }
+    lat.SetSumUsec(reader.GetUInt64());
+    lat.SetMaxUsec(reader.GetUInt64());
+    if (stage < str.latency.size()) {  // stages added by newer stream are skipped
+      str.latency[stage] = lat;
+    }
+  }
+
+  if (reader.IsFailed() || !str.IsValid()) {
+    return common::make_error("Invalid statistic frame");
+  }
+
+  *stat = StatisticInfo(str, cpu_load, rss, timestamp);
+  return common::Error();
+}
+
+common::ErrnoError WriteCompactFrame(common::libev::IoClient* client,
+                                     CompactFrameType type,
+                                     const std::string& payload) {
+  if (!client || type >= COMPACT_FRAME_TYPES_COUNT || payload.size() > kMaxCompactFramePayload) {
+    return common::make_errno_error_inval();
+  }
+
+  std::string frame;
+  frame.reserve(payload.size() + COMPACT_FRAME_HEADER_SIZE);
+  FrameWriter writer(&frame);
+  writer.PutUInt32(static_cast<uint32_t>(payload.size()));
+  writer.PutUInt8(type);
+  frame.append(payload);
+
+  size_t total = 0;
+  while (total < frame.size()) {
+    size_t nwrite = 0;
+    common::ErrnoError err = client->Write(frame.data() + total, frame.size() - total, &nwrite);
+    if (err) {
+      const int code = err->GetErrorCode();
+      if (code != EAGAIN && code != EWOULDBLOCK && code != EINTR) {
+        return err;
+      }
+      if (code != EINTR) {  // part of frame may be already in pipe, can't give up until pipe drains
+        std::this_thread::sleep_for(std::chrono::milliseconds(kCompactFrameWriteRetryMsec));
+      }
+      continue;
+    }
+    total += nwrite;
+  }
+  return common::ErrnoError();
+}
+
+CompactFrameReader::CompactFrameReader() : buffer_() {}
+
+common::ErrnoError CompactFrameReader::ReadFrom(common::libev::IoClient* client) {
+  if (!client) {
+    return common::make_errno_error_inval();
+  }
+
+  char buff[READ_CHUNK_SIZE];
+  size_t nread = 0;
+  common::ErrnoError err = client->Read(buff, sizeof(buff), &nread);
+  if (err) {
+    return err;
+  }
+
+  if (nread == 0) {
+    return common::make_errno_error("Compact frame pipe closed", ECONNRESET);
+  }
+
+  Append(buff, nread);
+  return common::ErrnoError();
+}
+
+void CompactFrameReader::Append(const char* data, size_t size) {
+  buffer_.append(data, size);
+}
+
+common::ErrnoError CompactFrameReader::PopFrame(CompactFrame* frame, bool* ready) {
+  if (!frame || !ready) {
+    return common::make_errno_error_inval();
+  }
+
+  *ready = false;
+  if (buffer_.size() < COMPACT_FRAME_HEADER_SIZE) {
+    return common::ErrnoError();
+  }
+
+  const std::string header_data = buffer_.substr(0, COMPACT_FRAME_HEADER_SIZE);
+  FrameReader header(header_data);
+  const uint32_t size = header.GetUInt32();
+  const uint8_t type = header.GetUInt8();
+  if (size > kMaxCompactFramePayload || type >= COMPACT_FRAME_TYPES_COUNT) {
+    buffer_.clear();
+    return common::make_errno_error("Invalid compact frame header", EINVAL);
+  }
+
+  if (buffer_.size() - COMPACT_FRAME_HEADER_SIZE < size) {  // payload not fully received
+    return common::ErrnoError();
+  }
+
+  frame->type = static_cast<CompactFrameType>(type);
+  frame->payload = buffer_.substr(COMPACT_FRAME_HEADER_SIZE, size);
+  buffer_.erase(0, COMPACT_FRAME_HEADER_SIZE + size);
+  *ready = true;
+  return common::ErrnoError();
+}
+
+}  // namespace fastocloud
@@ -0,0 +1,82 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+#include <common/error.h>
+
+#include "stream_commands/commands_info/statistic_info.h"
+
+namespace common {
+namespace libev {
+class IoClient;
+}
+}  // namespace common
+
+namespace fastocloud {
+
+// Compact framing of daemon <-> stream pipes, enabled by daemon at spawn through PIPE_COMPACT_FRAMING_FIELD.
+// Frame: payload size (uint32, network order), type (uint8), payload; no compression.
+// Statistic has fixed binary schema, other frames carry small serialized infos as is.
+enum CompactFrameType : uint8_t {
+  COMPACT_FRAME_STOP = 0,              // daemon -> stream, empty
+  COMPACT_FRAME_RESTART = 1,           // daemon -> stream, empty
+  COMPACT_FRAME_RESOLVED_LINK = 2,     // daemon -> stream, ResolvedLinkInfo json
+  COMPACT_FRAME_STATISTIC = 3,         // stream -> daemon, EncodeStatisticFrame
+  COMPACT_FRAME_CHANGED_SOURCES = 4,   // stream -> daemon, ChangedSouresInfo json
+  COMPACT_FRAME_ML_NOTIFICATION = 5,   // stream -> daemon, NotificationInfo json
+  COMPACT_FRAME_TYPES_COUNT
+};
+
+struct CompactFrame {
+  CompactFrame();
+
+  CompactFrameType type;
+  std::string payload;
+};
+
+enum { kMaxCompactFramePayload = 1024 * 1024 };
+
+common::Error EncodeStatisticFrame(const StatisticInfo& stat, std::string* payload) WARN_UNUSED_RESULT;
+common::Error DecodeStatisticFrame(const std::string& payload, StatisticInfo* stat) WARN_UNUSED_RESULT;
+
+// keeps writing until whole frame is out, pipes split frames above PIPE_BUF,
+// callers serialize writes through loop thread
+common::ErrnoError WriteCompactFrame(common::libev::IoClient* client,
+                                     CompactFrameType type,
+                                     const std::string& payload) WARN_UNUSED_RESULT;
+
+// Per pipe read buffer: bytes are accumulated as they arrive, frame is parsed only when complete.
+class CompactFrameReader {
+ public:
+  enum { READ_CHUNK_SIZE = 64 * 1024 };
+
+  CompactFrameReader();
+
+  // reads whatever pipe has now
+  common::ErrnoError ReadFrom(common::libev::IoClient* client) WARN_UNUSED_RESULT;
+  void Append(const char* data, size_t size);
+
+  // ready is false until whole frame buffered, error on invalid header (stream is out of sync)
+  common::ErrnoError PopFrame(CompactFrame* frame, bool* ready) WARN_UNUSED_RESULT;
+
+ private:
+  std::string buffer_;
+};
+
+}  // namespace fastocloud
@@ -14,6 +14,8 @@
 
 #include "utils/m3u8_writer.h"
 
+#include <inttypes.h>
+
 #include "utils/chunk_info.h"
 
 namespace fastocloud {
@@ -45,6 +47,20 @@ common::ErrnoError M3u8Writer::WriteFooter() {
   return file_.WriteBuffer("#EXT-X-ENDLIST", &writed);
 }
 
+common::ErrnoError M3u8Writer::WriteMasterHeader() {
+  size_t writed;
+  return file_.WriteBuffer("#EXTM3U\n#EXT-X-VERSION:3\n", &writed);
+}
+
+common::ErrnoError M3u8Writer::WriteStreamInf(uint64_t bandwidth,
+                                              const common::draw::Size& resolution,
+                                              const std::string& uri) {
+  size_t writed;
+  return file_.WriteBuffer(common::MemSPrintf("#EXT-X-STREAM-INF:BANDWIDTH=%" PRIu64 ",RESOLUTION=%dx%d\n%s\n",
+                                              bandwidth, resolution.width(), resolution.height(), uri),
+                           &writed);
+}
+
 common::ErrnoError M3u8Writer::Close() {
   return file_.Close();
 }
@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <string>
+
+#include <common/draw/size.h>
 #include <common/file_system/file.h>
 
 namespace fastocloud {
@@ -31,6 +34,12 @@ class M3u8Writer {
   common::ErrnoError WriteHeader(uint64_t first_index, size_t target_duration) WARN_UNUSED_RESULT;
   common::ErrnoError WriteLine(const ChunkInfo& chunks) WARN_UNUSED_RESULT;
   common::ErrnoError WriteFooter() WARN_UNUSED_RESULT;
+
+  // master playlist
+  common::ErrnoError WriteMasterHeader() WARN_UNUSED_RESULT;
+  common::ErrnoError WriteStreamInf(uint64_t bandwidth,
+                                    const common::draw::Size& resolution,
+                                    const std::string& uri) WARN_UNUSED_RESULT;
   common::ErrnoError Close() WARN_UNUSED_RESULT;
 
  private:
@@ -14,11 +14,24 @@
 
 #include "gtest/gtest.h"
 
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include "base/config_fields.h"
 #include "base/constants.h"
+#include "base/latency_histogram.h"
 #include "base/stream_config_parse.h"
+#include "base/stream_link.h"
 
+#include "server/base/async_http_client.h"
+#include "server/base/http_file_reply.h"
+#if defined(OS_LINUX)
+#include "server/dvb_tuner_manager.h"
+#endif
 #include "server/options/options.h"
+#include "server/segments_cache.h"
+#include "server/statistic_aggregator.h"
 
 namespace {
 const char kTimeshiftRecorderConfig[] = R"({
@@ -53,3 +66,189 @@ TEST(Options, cfgs) {
   ASSERT_FALSE(err);
   ASSERT_EQ(args->GetSize(), 4);
 }
+
+TEST(AsyncHttpClient, nonblocking_send) {
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+  fastocloud::server::base::AsyncHttpClient client(nullptr, common::net::socket_info(fds[0]));
+  const size_t size = 16 * 1024 * 1024;  // far above socket buffer
+  fastocloud::server::base::AsyncHttpClient::data_t data = std::make_shared<const std::string>(size, 'x');
+  ASSERT_FALSE(client.StartSendData(data, 0, size));
+  ASSERT_TRUE(client.IsSending());
+
+  char buff[4096];
+  ASSERT_GT(read(fds[1], buff, sizeof(buff)), 0);
+  bool done = true;
+  ASSERT_FALSE(client.ContinueSend(&done));
+  ASSERT_FALSE(done);
+  ASSERT_TRUE(client.IsSending());
+
+  ::close(fds[1]);
+  ::close(fds[0]);
+}
+
+TEST(HttpFileReply, ranges) {
+  const fastocloud::server::base::FileVersion version = {100, 1, 0, 1};
+  common::http::HttpRequest req;
+  auto res = common::http::parse_http_request("GET /1.ts HTTP/1.1\r\nRange: bytes=10-19\r\n\r\n", &req);
+  ASSERT_FALSE(res.second);
+  fastocloud::server::base::HttpFileReply reply = fastocloud::server::base::MakeFileReply(req, "ts", version, false);
+  ASSERT_EQ(reply.status, fastocloud::server::base::HS_PARTIAL_CONTENT);
+  ASSERT_EQ(reply.offset, 10);
+  ASSERT_EQ(reply.length, 10);
+
+  res = common::http::parse_http_request("GET /1.ts HTTP/1.1\r\nRange: bytes=-30\r\n\r\n", &req);
+  ASSERT_FALSE(res.second);
+  reply = fastocloud::server::base::MakeFileReply(req, "ts", version, false);
+  ASSERT_EQ(reply.status, fastocloud::server::base::HS_PARTIAL_CONTENT);
+  ASSERT_EQ(reply.offset, 70);
+  ASSERT_EQ(reply.length, 30);
+
+  res = common::http::parse_http_request("GET /1.ts HTTP/1.1\r\nRange: bytes=100-\r\n\r\n", &req);
+  ASSERT_FALSE(res.second);
+  reply = fastocloud::server::base::MakeFileReply(req, "ts", version, false);
+  ASSERT_EQ(reply.status, fastocloud::server::base::HS_RANGE_NOT_SATISFIABLE);
+}
+
+TEST(HttpFileReply, not_modified) {
+  fastocloud::server::base::FileVersion version = {100, 1, 0, 1};
+  const std::string etag = fastocloud::server::base::MakeETag(version);
+  common::http::HttpRequest req;
+  auto res =
+      common::http::parse_http_request("GET /1.m3u8 HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n", &req);
+  ASSERT_FALSE(res.second);
+  fastocloud::server::base::HttpFileReply reply = fastocloud::server::base::MakeFileReply(req, "m3u8", version, false);
+  ASSERT_EQ(reply.status, fastocloud::server::base::HS_NOT_MODIFIED);
+
+  version.mtime_nsec = 500;  // rewritten within the same second
+  reply = fastocloud::server::base::MakeFileReply(req, "m3u8", version, false);
+  ASSERT_EQ(reply.status, common::http::HS_OK);
+  ASSERT_EQ(reply.length, 100);
+
+  version.mtime_nsec = 0;
+  version.inode = 2;  // replaced by rename
+  reply = fastocloud::server::base::MakeFileReply(req, "m3u8", version, false);
+  ASSERT_EQ(reply.status, common::http::HS_OK);
+}
+
+TEST(HttpFileReply, cache_control) {
+  ASSERT_STREQ(fastocloud::server::base::GetCacheControl("ts", true), "public, max-age=31536000, immutable");
+  ASSERT_STREQ(fastocloud::server::base::GetCacheControl("ts", false), "public, max-age=10");
+  ASSERT_STREQ(fastocloud::server::base::GetCacheControl("m3u8", true), "no-cache");
+}
+
+TEST(SegmentsCache, invalidate) {
+  const std::string path = "/tmp/segments_cache_test.m3u8";
+  const std::string replacement = path + ".tmp";
+  FILE* file = fopen(path.c_str(), "w");
+  ASSERT_TRUE(file);
+  fputs("first", file);
+  fclose(file);
+
+  // revalidate period never passes, playlist must be reloaded right after write anyway
+  fastocloud::server::SegmentsCache cache(1024, 1024, 60000);
+  fastocloud::server::SegmentsCache::segment_t segment = cache.Get(path, "application/vnd.apple.mpegurl");
+  ASSERT_TRUE(segment);
+  ASSERT_EQ(segment->data, "first");
+
+  // same size, same second, replaced by rename
+  file = fopen(replacement.c_str(), "w");
+  ASSERT_TRUE(file);
+  fputs("other", file);
+  fclose(file);
+  ASSERT_EQ(rename(replacement.c_str(), path.c_str()), 0);
+  segment = cache.Get(path, "application/vnd.apple.mpegurl");
+  ASSERT_TRUE(segment);
+  ASSERT_EQ(segment->data, "other");
+
+  unlink(path.c_str());
+  ASSERT_FALSE(cache.Get(path, "application/vnd.apple.mpegurl"));
+  ASSERT_FALSE(fastocloud::server::SegmentsCache::IsCacheable("/tmp/segments_cache_test.mp4"));
+}
+
+TEST(StreamLink, expire_time) {
+  const fastotv::timestamp_t now = 1600000000000;
+  const common::uri::GURL youtube(
+      "https://manifest.googlevideo.com/api/manifest/hls_variant/expire/1600021600/ei/abc/file/index.m3u8");
+  ASSERT_EQ(fastocloud::GetStreamLinkExpireTime(youtube, now), 1600021600000);
+  const common::uri::GURL signed_query("https://cdn.example.com/live.m3u8?token=abc&expire=1600003600");
+  ASSERT_EQ(fastocloud::GetStreamLinkExpireTime(signed_query, now), 1600003600000);
+  const common::uri::GURL not_signed("https://cdn.example.com/live.m3u8");
+  ASSERT_EQ(fastocloud::GetStreamLinkExpireTime(not_signed, now), now + STREAM_LINK_DEFAULT_TTL_SEC * 1000);
+}
+
+TEST(StatisticAggregator, coalesce) {
+  fastocloud::server::StatisticAggregator aggregator;
+  common::libev::IoClient* legacy = reinterpret_cast<common::libev::IoClient*>(0x1);
+  common::libev::IoClient* panel = reinterpret_cast<common::libev::IoClient*>(0x2);
+  aggregator.Subscribe(panel, {"2"});
+
+  aggregator.Update("1", "{\"id\":\"1\",\"v\":1}");
+  aggregator.Update("1", "{\"id\":\"1\",\"v\":2}");
+  aggregator.Update("2", "{\"id\":\"2\"}");
+  auto changes = aggregator.TakeChanges(legacy);
+  ASSERT_EQ(changes.size(), 2);
+  ASSERT_TRUE(aggregator.TakeChanges(legacy).empty());
+
+  std::string batch;
+  ASSERT_TRUE(aggregator.TakeBatch(panel, &batch));
+  ASSERT_EQ(batch, "[{\"id\":\"2\"}]");
+  aggregator.Update("1", "{\"id\":\"1\",\"v\":3}");
+  ASSERT_FALSE(aggregator.TakeBatch(panel, &batch));
+
+  changes = aggregator.TakeChanges(legacy);
+  ASSERT_EQ(changes.size(), 1);
+  ASSERT_EQ(changes[0], "{\"id\":\"1\",\"v\":3}");
+}
+
+TEST(LatencyHistogram, render) {
+  fastocloud::LatencyHistogram histogram;
+  histogram.Observe(100);
+  histogram.Observe(3000);
+  histogram.Observe(5000000);
+
+  std::string out;
+  histogram.Render("req", "endpoint=\"http\"", &out);
+  ASSERT_NE(out.find("req_bucket{endpoint=\"http\",le=\"0.0005\"} 1\n"), std::string::npos);
+  ASSERT_NE(out.find("req_bucket{endpoint=\"http\",le=\"0.005\"} 2\n"), std::string::npos);
+  ASSERT_NE(out.find("req_bucket{endpoint=\"http\",le=\"1\"} 2\n"), std::string::npos);
+  ASSERT_NE(out.find("req_bucket{endpoint=\"http\",le=\"+Inf\"} 3\n"), std::string::npos);
+  ASSERT_NE(out.find("req_count{endpoint=\"http\"} 3\n"), std::string::npos);
+}
+
+#if defined(OS_LINUX)
+TEST(DvbTunerManager, share) {
+  pid_t next_pid = 100;
+  std::vector<pid_t> stopped;
+  fastocloud::server::DvbTunerManager tuners(
+      [&next_pid](const common::uri::GURL& source, const common::uri::GURL& feed, pid_t* pid) {
+        UNUSED(source);
+        UNUSED(feed);
+        *pid = next_pid++;
+        return common::ErrnoError();
+      },
+      [&stopped](pid_t pid) { stopped.push_back(pid); });
+
+  const common::uri::GURL first("dvb://?frequency=514000000&modulation=3");
+  const common::uri::GURL same("dvb://?modulation=3&frequency=514000000");
+  const common::uri::GURL other("dvb://?frequency=522000000&modulation=3");
+  ASSERT_EQ(fastocloud::server::DvbTunerManager::MakeTunerKey(first),
+            fastocloud::server::DvbTunerManager::MakeTunerKey(same));
+
+  common::uri::GURL feed1, feed2, feed3;
+  ASSERT_FALSE(tuners.Acquire("1", first, &feed1));
+  ASSERT_FALSE(tuners.Acquire("2", same, &feed2));
+  ASSERT_FALSE(tuners.Acquire("3", other, &feed3));
+  ASSERT_EQ(feed1, feed2);
+  ASSERT_NE(feed1, feed3);
+  ASSERT_EQ(tuners.GetTunersCount(), 2u);
+
+  tuners.TunerExited(100);
+  tuners.CheckTuners();  // restarted as 102
+  tuners.Release("1");
+  ASSERT_TRUE(stopped.empty());
+  tuners.Release("2");
+  ASSERT_EQ(stopped, std::vector<pid_t>({102}));
+  ASSERT_EQ(tuners.GetTunersCount(), 1u);
+}
+#endif
@@ -0,0 +1,565 @@
+/*  Copyright (C) 2014-2020 FastoGT. All right reserved.
+    This file is part of fastocloud.
+    fastocloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    fastocloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with fastocloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Pipeline benchmark: every stream type created by StreamsFactory runs against synthetic local inputs,
+// live ts (videotestsrc/audiotestsrc) on loopback udp and canned ts files for playlists.
+// Like in production each stream runs in own process, so cpu and rss are per stream.
+// Timeshift player plays with delay of PLAYER_DELAY_MIN from recorder running next to it,
+// so that scenario takes additional PLAYER_RECORD_AHEAD_SEC.
+// usage: pipeline_benchmark [duration_sec] [streams_per_scenario] [work_dir]
+// report written into work_dir/pipeline_benchmark.json
+
+#include <signal.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glib-unix.h>
+#include <gst/gst.h>
+
+#include <json-c/json_object.h>
+#include <json-c/json_tokener.h>
+
+#include <common/file_system/file_system.h>
+#include <common/sprintf.h>
+#include <common/time.h>
+
+#include "base/config_fields.h"
+#include "base/constants.h"
+#include "base/gst_constants.h"
+#include "base/stream_config.h"
+#include "base/stream_config_parse.h"
+#include "base/stream_struct.h"
+
+#include "stream/configs_factory.h"
+#include "stream/gstreamer_init.h"
+#include "stream/streams_factory.h"
+
+#define DEFAULT_DURATION_SEC 30
+#define DEFAULT_STREAMS_COUNT 1
+#define DEFAULT_WORK_DIR "/tmp/fastocloud_benchmark"
+#define REPORT_FILE_NAME "pipeline_benchmark.json"
+#define CANNED_TS_FILE_NAME "canned_%lu.ts"
+
+#define FEED_BASE_PORT 25000
+#define OUTPUT_BASE_PORT 26000
+#define FEED_PORTS_PER_STREAM 2  // mosaic reads 2 inputs
+#define CANNED_TS_FILES 2
+#define CANNED_TS_FRAMES 250
+#define FEED_WARMUP_SEC 2
+#define BENCH_CHUNK_DURATION_SEC 5
+// player delay counts in minutes, recorder running next to player must cover it before player starts
+#define PLAYER_DELAY_MIN 1
+#define PLAYER_RECORD_AHEAD_SEC (PLAYER_DELAY_MIN * 60 + 2 * BENCH_CHUNK_DURATION_SEC)
+
+#define FEED_VIDEO                                                                     \
+  "videotestsrc is-live=true pattern=ball ! video/x-raw,width=1280,height=720,framerate=25/1 ! " X264_ENC \
+  " tune=zerolatency bitrate=3000 key-int-max=50 ! h264parse ! mux. "
+#define FEED_AUDIO "audiotestsrc is-live=true ! audioconvert ! " FAAC " ! aacparse ! mux. "
+
+namespace {
+
+struct Scenario {
+  const char* name;
+  fastotv::StreamType type;
+  bool have_audio;
+  size_t inputs;     // feed ports, 0 - canned files or test source
+  bool encode;
+  bool test_input;   // internal videotestsrc
+  bool timeshift;    // reads or writes timeshift dir of same stream index
+};
+
+const Scenario kTimeshiftRecordScenario = {"timeshift_record", fastotv::TIMESHIFT_RECORDER, true, 1,
+                                           false, false, true};
+
+const Scenario kScenarios[] = {
+    {"relay", fastotv::RELAY, true, 1, false, false, false},
+    {"encode", fastotv::ENCODE, true, 1, true, false, false},
+    {"encode_test_input", fastotv::ENCODE, false, 0, true, true, false},
+    {"mosaic", fastotv::ENCODE, true, 2, true, false, false},
+    kTimeshiftRecordScenario,
+    {"timeshift_play", fastotv::TIMESHIFT_PLAYER, true, 0, false, false, true},  // recorder runs meanwhile
+    {"playlist_relay", fastotv::RELAY, true, 0, false, false, false},
+};
+
+int64_t rusage_cpu_usec() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<int64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 + usage.ru_utime.tv_usec +
+         usage.ru_stime.tv_usec;
+}
+
+size_t proc_status_kb(const char* field) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  const size_t field_len = strlen(field);
+  while (std::getline(status, line)) {
+    if (line.compare(0, field_len, field) == 0) {
+      return strtoul(line.c_str() + field_len + 1, nullptr, 10);
+    }
+  }
+  return 0;
+}
+
+std::string canned_ts_path(const std::string& work_dir, size_t index) {
+  return work_dir + "/" + common::MemSPrintf(CANNED_TS_FILE_NAME, index);
+}
+
+// counts video frames on src pad of first video encoder, if stream doesn't encode - of first video parser
+class BenchClient : public fastocloud::stream::IBaseStream::IStreamClient {
+ public:
+  BenchClient() : frames_(0), first_frame_usec_(0), pipeline_(nullptr), encoder_found_(false), counted_(nullptr) {}
+
+  uint64_t GetFrames() const { return frames_; }
+  int64_t GetFirstFrameUsec() const { return first_frame_usec_; }
+
+  void OnStatusChanged(fastocloud::stream::IBaseStream* stream, fastocloud::StreamStatus status) override {
+    UNUSED(stream);
+    UNUSED(status);
+  }
+  void OnPipelineEOS(fastocloud::stream::IBaseStream* stream) override { UNUSED(stream); }
+  void OnTimeoutUpdated(fastocloud::stream::IBaseStream* stream) override { UNUSED(stream); }
+  void OnInputProbeEvent(fastocloud::stream::IBaseStream* stream,
+                         fastocloud::stream::InputProbe* probe,
+                         GstEvent* event) override {
+    UNUSED(stream);
+    UNUSED(probe);
+    UNUSED(event);
+  }
+  void OnOutputProbeEvent(fastocloud::stream::IBaseStream* stream,
+                          fastocloud::stream::OutputProbe* probe,
+                          GstEvent* event) override {
+    UNUSED(stream);
+    UNUSED(probe);
+    UNUSED(event);
+  }
+  void OnSyncMessageReceived(fastocloud::stream::IBaseStream* stream, GstMessage* message) override {
+    UNUSED(stream);
+    UNUSED(message);
+  }
+  void OnASyncMessageReceived(fastocloud::stream::IBaseStream* stream, GstMessage* message) override {
+    UNUSED(stream);
+    GstObject* pipeline = GST_MESSAGE_SRC(message);
+    while (pipeline && GST_OBJECT_PARENT(pipeline)) {
+      pipeline = GST_OBJECT_PARENT(pipeline);
+    }
+    if (!pipeline || !GST_IS_PIPELINE(pipeline) || GST_ELEMENT(pipeline) == pipeline_) {
+      return;
+    }
+
+    pipeline_ = GST_ELEMENT(pipeline);  // new or restarted pipeline
+    encoder_found_ = false;
+    GstIterator* it = gst_bin_iterate_recurse(GST_BIN(pipeline_));
+    GValue item = G_VALUE_INIT;
+    while (!encoder_found_ && gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+      Inspect(GST_ELEMENT(g_value_get_object(&item)));
+      g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    if (!encoder_found_) {  // parsers created by decodebin/demuxers later
+      g_signal_connect(pipeline_, "deep-element-added", G_CALLBACK(deep_element_added_callback), this);
+    }
+  }
+  GstPadProbeInfo* OnCheckReveivedOutputData(fastocloud::stream::IBaseStream* stream,
+                                             fastocloud::stream::OutputProbe* probe,
+                                             GstPadProbeInfo* info) override {
+    UNUSED(stream);
+    UNUSED(probe);
+    return info;
+  }
+  GstPadProbeInfo* OnCheckReveivedData(fastocloud::stream::IBaseStream* stream,
+                                       fastocloud::stream::InputProbe* probe,
+                                       GstPadProbeInfo* info) override {
+    UNUSED(stream);
+    UNUSED(probe);
+    return info;
+  }
+  void OnInputChanged(fastocloud::stream::IBaseStream* stream, const fastocloud::InputUri& uri) override {
+    UNUSED(stream);
+    UNUSED(uri);
+  }
+  void OnPipelineCreated(fastocloud::stream::IBaseStream* stream) override { UNUSED(stream); }
+#if defined(MACHINE_LEARNING)
+  void OnMlNotification(fastocloud::stream::IBaseStream* stream,
+                        const std::vector<fastotv::commands_info::ml::ImageBox>& images) override {
+    UNUSED(stream);
+    UNUSED(images);
+  }
+#endif
+
+ private:
+  void Inspect(GstElement* element) {
+    GstElementFactory* factory = gst_element_get_factory(element);
+    if (!factory) {
+      return;
+    }
+
+    const gchar* klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+    if (!klass || !strstr(klass, "Video")) {
+      return;
+    }
+
+    const bool encoder = strstr(klass, "Encoder");
+    if (!encoder && !strstr(klass, "Parser")) {
+      return;
+    }
+
+    GstElement* expected = nullptr;
+    if (encoder) {
+      encoder_found_ = true;
+      counted_.store(element);
+    } else if (!counted_.compare_exchange_strong(expected, element)) {
+      return;
+    }
+
+    GstPad* pad = gst_element_get_static_pad(element, "src");
+    if (pad) {
+      gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, frame_probe_callback, this, nullptr);
+      gst_object_unref(pad);
+    }
+  }
+
+  static void deep_element_added_callback(GstBin* bin, GstBin* sub_bin, GstElement* element, gpointer user_data) {
+    UNUSED(bin);
+    UNUSED(sub_bin);
+    BenchClient* client = reinterpret_cast<BenchClient*>(user_data);
+    client->Inspect(element);
+  }
+
+  static GstPadProbeReturn frame_probe_callback(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+    UNUSED(info);
+    BenchClient* client = reinterpret_cast<BenchClient*>(user_data);
+    if (client->counted_.load() != GST_PAD_PARENT(pad)) {  // encoder found after parser
+      return GST_PAD_PROBE_OK;
+    }
+    if (client->frames_++ == 0) {
+      client->first_frame_usec_ = g_get_monotonic_time();
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  std::atomic<uint64_t> frames_;
+  std::atomic<int64_t> first_frame_usec_;
+  GstElement* pipeline_;
+  bool encoder_found_;
+  std::atomic<GstElement*> counted_;
+};
+
+fastocloud::StreamConfig make_bench_config(const Scenario& scenario, size_t index, const std::string& work_dir) {
+  const size_t feed_port = FEED_BASE_PORT + index * FEED_PORTS_PER_STREAM;
+  std::string input;
+  if (scenario.test_input) {
+    input = R"([{"id": 0, "uri": ")" TEST_URL R"("}])";
+  } else if (scenario.inputs == 0 && !scenario.timeshift) {
+    input = "[";
+    for (size_t i = 0; i < CANNED_TS_FILES; ++i) {
+      input += common::MemSPrintf(R"(%s{"id": %lu, "uri": "file://%s"})", i ? ", " : "", i,
+                                  canned_ts_path(work_dir, i));
+    }
+    input += "]";
+  } else if (scenario.inputs == 0) {
+    input = common::MemSPrintf(R"([{"id": 0, "uri": "udp://127.0.0.1:%lu"}])", feed_port);  // player reads dir
+  } else {
+    input = "[";
+    for (size_t i = 0; i < scenario.inputs; ++i) {
+      input += common::MemSPrintf(R"(%s{"id": %lu, "uri": "udp://127.0.0.1:%lu"})", i ? ", " : "", i, feed_port + i);
+    }
+    input += "]";
+  }
+
+  const std::string sid = common::MemSPrintf("%s_%lu", scenario.name, index);
+  const std::string stream_dir = work_dir + "/" + sid;
+  const std::string timeshift_dir = common::MemSPrintf("%s/timeshift_%lu", work_dir, index);
+  std::string json = common::MemSPrintf(
+      R"({")" ID_FIELD R"(": "%s", ")" TYPE_FIELD R"(": %d, ")" FEEDBACK_DIR_FIELD R"(": "%s", ")" DATA_DIR_FIELD
+      R"(": "%s", ")" LOG_LEVEL_FIELD R"(": %d, ")" HAVE_AUDIO_FIELD R"(": %s, ")" INPUT_FIELD R"(": %s, ")"
+      OUTPUT_FIELD R"(": [{"id": 0, "uri": "udp://127.0.0.1:%lu"}])",
+      sid, scenario.type, stream_dir, stream_dir, common::logging::LOG_LEVEL_WARNING,
+      scenario.have_audio ? "true" : "false", input, OUTPUT_BASE_PORT + index);
+  if (scenario.encode) {
+    json += common::MemSPrintf(R"(, ")" VIDEO_CODEC_FIELD R"(": ")" X264_ENC R"(", ")" AUDIO_CODEC_FIELD
+                               R"(": ")" FAAC R"(", ")" SIZE_FIELD R"(": "1280x720")");
+  }
+  if (scenario.timeshift) {
+    json += common::MemSPrintf(R"(, ")" TIMESHIFT_DIR_FIELD R"(": "%s", ")" TIMESHIFT_CHUNK_DURATION_FIELD R"(": %d)",
+                               timeshift_dir, BENCH_CHUNK_DURATION_SEC);
+  }
+  json += "}";
+  return fastocloud::StreamConfig(fastocloud::MakeConfigFromJson(json).release());
+}
+
+json_object* run_stream(const Scenario& scenario, size_t index, const std::string& work_dir, uint32_t duration_sec) {
+  json_object* result = json_object_new_object();
+  json_object_object_add(result, "index", json_object_new_int64(index));
+  fastocloud::StreamConfig config_args = make_bench_config(scenario, index, work_dir);
+  fastocloud::StreamInfo sha;
+  std::string feedback_dir, data_dir;
+  common::logging::LOG_LEVEL logs_level;
+  common::ErrnoError errn = fastocloud::MakeStreamInfo(config_args, true, &sha, &feedback_dir, &data_dir, &logs_level);
+  if (errn) {
+    json_object_object_add(result, "error", json_object_new_string(errn->GetDescription().c_str()));
+    return result;
+  }
+
+  fastocloud::stream::Config* lconfig = nullptr;
+  common::Error err = fastocloud::stream::make_config(config_args, &lconfig);
+  if (err) {
+    json_object_object_add(result, "error", json_object_new_string(err->GetDescription().c_str()));
+    return result;
+  }
+  const std::unique_ptr<fastocloud::stream::Config> config(lconfig);
+
+  fastocloud::stream::TimeShiftInfo tinfo;
+  fastocloud::stream::chunk_index_t start_chunk_index = fastocloud::stream::invalid_chunk_index;
+  if (scenario.timeshift) {
+    std::string timeshift_dir;
+    config_args->Find(TIMESHIFT_DIR_FIELD)->GetAsBasicString(&timeshift_dir);
+    const fastocloud::stream::time_shift_delay_t delay =
+        scenario.type == fastotv::TIMESHIFT_PLAYER ? PLAYER_DELAY_MIN : 0;
+    tinfo = fastocloud::stream::TimeShiftInfo(timeshift_dir, DEFAULT_CHUNK_LIFE_TIME, delay);
+    if (scenario.type == fastotv::TIMESHIFT_PLAYER &&
+        !tinfo.FindChunkToPlay(BENCH_CHUNK_DURATION_SEC, &start_chunk_index)) {
+      json_object_object_add(result, "error", json_object_new_string("No recorded chunks"));
+      return result;
+    }
+  }
+
+  fastocloud::StreamStruct stats(sha);
+  BenchClient client;
+  const int64_t start_usec = g_get_monotonic_time();
+  fastocloud::stream::IBaseStream* stream =
+      fastocloud::stream::StreamsFactory::GetInstance().CreateStream(config.get(), &client, &stats, tinfo,
+                                                                      start_chunk_index);
+  if (!stream) {
+    json_object_object_add(result, "error", json_object_new_string("Can't create stream"));
+    return result;
+  }
+
+  // cpu of created stream only: gst init and config parsing are excluded, pipeline build in Exec is included
+  const int64_t cpu_start_usec = g_get_monotonic_time();
+  const int64_t start_cpu_usec = rusage_cpu_usec();
+
+  int64_t stop_usec = 0, stop_cpu_usec = 0;
+  size_t rss_kb = 0;
+  std::thread quit([&]() {
+    sleep(duration_sec);
+    stop_usec = g_get_monotonic_time();
+    stop_cpu_usec = rusage_cpu_usec();
+    rss_kb = proc_status_kb("VmRSS:");
+    stream->Quit(fastocloud::stream::EXIT_SELF);
+  });
+  stream->Exec();
+  quit.join();
+
+  size_t input_bytes = 0, output_bytes = 0;
+  for (const auto& input : stats.input) {
+    input_bytes += input.GetTotalBytes();
+  }
+  for (const auto& output : stats.output) {
+    output_bytes += output.GetTotalBytes();
+  }
+
+  const int64_t first_frame_usec = client.GetFirstFrameUsec();
+  const double flow_sec = first_frame_usec ? (stop_usec - first_frame_usec) / 1000000.0 : 0;
+  const double run_sec = (stop_usec - start_usec) / 1000000.0;
+  const double cpu_run_sec = (stop_usec - cpu_start_usec) / 1000000.0;
+  json_object_object_add(result, "class", json_object_new_string(stream->ClassName()));
+  json_object_object_add(result, "startup_msec",
+                         json_object_new_int64(first_frame_usec ? (first_frame_usec - start_usec) / 1000 : -1));
+  json_object_object_add(result, "frames", json_object_new_int64(client.GetFrames()));
+  json_object_object_add(result, "fps", json_object_new_double(flow_sec > 0 ? client.GetFrames() / flow_sec : 0));
+  json_object_object_add(result, "cpu_percent",
+                         json_object_new_double((stop_cpu_usec - start_cpu_usec) / (cpu_run_sec * 10000.0)));
+  json_object_object_add(result, "rss_kb", json_object_new_int64(rss_kb));
+  json_object_object_add(result, "rss_peak_kb", json_object_new_int64(proc_status_kb("VmHWM:")));
+  json_object_object_add(result, "input_kbps", json_object_new_double(input_bytes * 8 / 1000.0 / run_sec));
+  json_object_object_add(result, "output_kbps", json_object_new_double(output_bytes * 8 / 1000.0 / run_sec));
+  delete stream;
+  return result;
+}
+
+gboolean quit_loop_callback(gpointer user_data) {
+  g_main_loop_quit(static_cast<GMainLoop*>(user_data));
+  return G_SOURCE_REMOVE;
+}
+
+// runs gst launch line in new process, till eos or SIGTERM
+pid_t spawn_launch(const std::string& launch) {
+  const pid_t pid = fork();
+  if (pid != 0) {
+    return pid;
+  }
+
+  fastocloud::stream::GstInitializer::InitCore(0, nullptr);
+  GError* error = nullptr;
+  GstElement* pipeline = gst_parse_launch(launch.c_str(), &error);
+  if (!pipeline) {
+    ERROR_LOG() << "Can't launch: " << launch << ", error: " << (error ? error->message : "unknown");
+    _exit(EXIT_FAILURE);
+  }
+
+  GMainLoop* loop = g_main_loop_new(nullptr, FALSE);
+  GstBus* bus = gst_element_get_bus(pipeline);
+  gst_bus_add_signal_watch(bus);
+  g_signal_connect_swapped(bus, "message::eos", G_CALLBACK(g_main_loop_quit), loop);
+  g_signal_connect_swapped(bus, "message::error", G_CALLBACK(g_main_loop_quit), loop);
+  g_unix_signal_add(SIGTERM, quit_loop_callback, loop);
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+  g_main_loop_run(loop);
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  _exit(EXIT_SUCCESS);
+}
+
+// runs stream in own process, result json written into result_fd if valid
+pid_t spawn_stream(const Scenario& scenario,
+                   size_t index,
+                   const std::string& work_dir,
+                   uint32_t duration,
+                   int result_fd) {
+  const pid_t pid = fork();
+  if (pid != 0) {
+    return pid;
+  }
+
+  fastocloud::stream::GstInitializer init;
+  init.Init(0, nullptr, fastocloud::stream::CPU);
+  json_object* result = run_stream(scenario, index, work_dir, duration);
+  if (result_fd != INVALID_DESCRIPTOR) {
+    const char* result_str = json_object_to_json_string_ext(result, JSON_C_TO_STRING_PLAIN);
+    ignore_result(write(result_fd, result_str, strlen(result_str)));
+  }
+  _exit(EXIT_SUCCESS);
+}
+
+json_object* run_scenario(const Scenario& scenario, size_t streams, const std::string& work_dir, uint32_t duration) {
+  std::vector<pid_t> recorders;
+  if (scenario.type == fastotv::TIMESHIFT_PLAYER) {
+    for (size_t i = 0; i < streams; ++i) {
+      const uint32_t record_duration = PLAYER_RECORD_AHEAD_SEC + duration;
+      recorders.push_back(spawn_stream(kTimeshiftRecordScenario, i, work_dir, record_duration, INVALID_DESCRIPTOR));
+    }
+    sleep(PLAYER_RECORD_AHEAD_SEC);
+  }
+
+  std::vector<pid_t> workers;
+  std::vector<int> pipes;
+  for (size_t i = 0; i < streams; ++i) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+      break;
+    }
+
+    const pid_t pid = spawn_stream(scenario, i, work_dir, duration, fds[1]);
+    close(fds[1]);
+    workers.push_back(pid);
+    pipes.push_back(fds[0]);
+  }
+
+  json_object* jresults = json_object_new_array();
+  for (size_t i = 0; i < workers.size(); ++i) {
+    std::string result_str;
+    char buff[4096];
+    ssize_t nread;
+    while ((nread = read(pipes[i], buff, sizeof(buff))) > 0) {
+      result_str.append(buff, nread);
+    }
+    close(pipes[i]);
+    waitpid(workers[i], nullptr, 0);
+    json_object* result = json_tokener_parse(result_str.c_str());
+    if (!result) {
+      result = json_object_new_object();
+      json_object_object_add(result, "index", json_object_new_int64(i));
+      json_object_object_add(result, "error", json_object_new_string("Stream process crashed"));
+    }
+    json_object_array_add(jresults, result);
+  }
+
+  for (pid_t recorder : recorders) {
+    waitpid(recorder, nullptr, 0);
+  }
+
+  json_object* jscenario = json_object_new_object();
+  json_object_object_add(jscenario, "name", json_object_new_string(scenario.name));
+  json_object_object_add(jscenario, "results", jresults);
+  return jscenario;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const uint32_t duration = argc > 1 ? strtoul(argv[1], nullptr, 10) : DEFAULT_DURATION_SEC;
+  const size_t streams = argc > 2 ? strtoul(argv[2], nullptr, 10) : DEFAULT_STREAMS_COUNT;
+  const std::string work_dir = argc > 3 ? argv[3] : DEFAULT_WORK_DIR;
+  if (!duration || !streams) {
+    std::cerr << "Usage: " << argv[0] << " [duration_sec] [streams_per_scenario] [work_dir]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  common::ErrnoError errn = common::file_system::create_directory(work_dir, true);
+  if (errn) {
+    std::cerr << "Can't create " << work_dir << ": " << errn->GetDescription() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // gstreamer only in child processes, daemon like parent stays single threaded
+  for (size_t i = 0; i < CANNED_TS_FILES; ++i) {
+    const pid_t canned = spawn_launch(common::MemSPrintf(
+        "videotestsrc num-buffers=%d ! video/x-raw,width=1280,height=720,framerate=25/1 ! " X264_ENC
+        " key-int-max=50 ! h264parse ! mux. audiotestsrc num-buffers=%d ! audioconvert ! " FAAC
+        " ! aacparse ! mux. mpegtsmux name=mux ! filesink location=%s",
+        CANNED_TS_FRAMES, CANNED_TS_FRAMES * 2, canned_ts_path(work_dir, i)));
+    waitpid(canned, nullptr, 0);
+  }
+
+  std::string clients;
+  for (size_t i = 0; i < streams * FEED_PORTS_PER_STREAM; ++i) {
+    clients += common::MemSPrintf("%s127.0.0.1:%lu", i ? "," : "", FEED_BASE_PORT + i);
+  }
+  const pid_t feed = spawn_launch(common::MemSPrintf(
+      FEED_VIDEO FEED_AUDIO "mpegtsmux name=mux alignment=7 ! multiudpsink sync=false clients=%s", clients));
+  sleep(FEED_WARMUP_SEC);
+
+  json_object* jscenarios = json_object_new_array();
+  for (const Scenario& scenario : kScenarios) {
+    std::cout << "Running " << scenario.name << " x" << streams << " for " << duration << " sec" << std::endl;
+    json_object_array_add(jscenarios, run_scenario(scenario, streams, work_dir, duration));
+  }
+
+  kill(feed, SIGTERM);
+  waitpid(feed, nullptr, 0);
+
+  json_object* jreport = json_object_new_object();
+  json_object_object_add(jreport, "version", json_object_new_string(PROJECT_VERSION_HUMAN));
+  json_object_object_add(jreport, "timestamp", json_object_new_int64(common::time::current_utc_mstime()));
+  json_object_object_add(jreport, "duration_sec", json_object_new_int64(duration));
+  json_object_object_add(jreport, "streams_per_scenario", json_object_new_int64(streams));
+  json_object_object_add(jreport, "cpu_count", json_object_new_int64(std::thread::hardware_concurrency()));
+  json_object_object_add(jreport, "scenarios", jscenarios);
+
+  const std::string report_path = work_dir + "/" REPORT_FILE_NAME;
+  std::ofstream report(report_path);
+  report << json_object_to_json_string_ext(jreport, JSON_C_TO_STRING_PRETTY) << std::endl;
+  json_object_put(jreport);
+  std::cout << "Report: " << report_path << std::endl;
+  return report ? EXIT_SUCCESS : EXIT_FAILURE;
+}
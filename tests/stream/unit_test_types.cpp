@@ -14,7 +14,23 @@
 
 #include <gtest/gtest.h>
 
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "base/constants.h"
+#include "base/stream_stats_block.h"
+#include "base/types.h"
+
+#include "stream/detection_limiter.h"
+#include "stream/latency_tracer.h"
+#include "stream/playlist_reader.h"
 #include "stream/stypes.h"
+#include "stream/timeshift.h"
+#include "stream/timeshift_index.h"
+#include "stream/ts_packet_filter.h"
+
+#include "stream_commands/compact_frame.h"
 
 TEST(element_id_t, GetElementId) {
   fastocloud::stream::element_id_t id;
@@ -60,3 +76,330 @@ TEST(m3u8, GetIndexFromHttpTsTemplate) {
   uint64_t ind3;
   ASSERT_FALSE(fastocloud::stream::GetIndexFromHttpTsTemplate("123_g.ts", &ind3));
 }
+
+TEST(TimeShiftIndex, FindChunks) {
+  char dir_template[] = "/tmp/timeshift_index_XXXXXX";
+  const char* dir = mkdtemp(dir_template);
+  ASSERT_TRUE(dir);
+  fastocloud::stream::TimeShiftIndex index(common::file_system::ascii_directory_string_path(std::string(dir) + "/"));
+  ASSERT_FALSE(index.IsExist());
+
+  const time_t duration = 10;
+  for (uint64_t i = 0; i < 8; ++i) {
+    const fastocloud::stream::TimeShiftIndex::Chunk chunk = {i, static_cast<int64_t>(1000 + i * duration), duration,
+                                                             1024};
+    ASSERT_FALSE(index.Append(chunk));
+  }
+  ASSERT_TRUE(index.IsExist());
+
+  fastocloud::stream::TimeShiftIndex::Chunk last;
+  ASSERT_TRUE(index.FindLastChunk(&last));
+  ASSERT_EQ(last.index, 7);
+  ASSERT_EQ(last.start_time, 1070);
+
+  fastocloud::stream::chunk_index_t found;
+  ASSERT_TRUE(index.FindChunkToPlay(1020, duration, &found));
+  ASSERT_EQ(found, 2);
+  ASSERT_TRUE(index.FindChunkToPlay(1025, duration, &found));
+  ASSERT_EQ(found, 1);
+  ASSERT_FALSE(index.FindChunkToPlay(1200, duration, &found));
+
+  // three chunks ended before 1040
+  ASSERT_FALSE(index.RemoveOlder(1040));
+  ASSERT_FALSE(index.FindChunkToPlay(1020, duration, &found));
+  ASSERT_TRUE(index.FindChunkToPlay(1030, duration, &found));
+  ASSERT_EQ(found, 3);
+  ASSERT_TRUE(index.FindLastChunk(&last));
+  ASSERT_EQ(last.index, 7);
+
+  // chunk in progress is not indexed yet, but must not be reused after restart
+  const fastocloud::stream::TimeShiftInfo tinfo(std::string(dir) + "/", DEFAULT_CHUNK_LIFE_TIME, 0);
+  fastocloud::stream::chunk_index_t last_index;
+  time_t last_time;
+  ASSERT_TRUE(tinfo.FindLastChunk(&last_index, &last_time));
+  ASSERT_EQ(last_index, 7);
+  const std::string in_progress = std::string(dir) + "/8" CHUNK_EXT;
+  FILE* chunk_file = fopen(in_progress.c_str(), "w");
+  ASSERT_TRUE(chunk_file);
+  fclose(chunk_file);
+  ASSERT_TRUE(tinfo.FindLastChunk(&last_index, &last_time));
+  ASSERT_EQ(last_index, 8);
+
+  unlink(in_progress.c_str());
+  unlink(index.GetPath().c_str());
+  rmdir(dir);
+}
+
+namespace {
+void MakeTsPacket(uint8_t* packet, uint16_t pid, uint8_t cc) {
+  memset(packet, 0xFF, fastocloud::stream::TsPacketFilter::PACKET_SIZE);
+  packet[0] = fastocloud::stream::TsPacketFilter::SYNC_BYTE;
+  packet[1] = (pid >> 8) & 0x1F;
+  packet[2] = pid & 0xFF;
+  packet[3] = 0x10 | (cc & 0x0F);
+}
+}  // namespace
+
+TEST(TsPacketFilter, Process) {
+  const size_t psize = fastocloud::stream::TsPacketFilter::PACKET_SIZE;
+  uint8_t data[psize * 4];
+  MakeTsPacket(data, 0x100, 0);
+  MakeTsPacket(data + psize, 0x101, 0);
+  MakeTsPacket(data + psize * 2, 0x100, 1);
+  MakeTsPacket(data + psize * 3, 0x100, 3);
+
+  std::vector<uint8_t> out;
+  fastocloud::stream::TsPacketFilter all({});
+  ASSERT_TRUE(all.Process(data, sizeof(data), &out));
+  ASSERT_TRUE(out.empty());
+  ASSERT_EQ(all.GetStats().packets, 4u);
+  ASSERT_EQ(all.GetStats().cc_errors, 1u);
+
+  // split packet and pid filter
+  fastocloud::stream::TsPacketFilter filter({0x100});
+  ASSERT_FALSE(filter.Process(data, 100, &out));
+  ASSERT_TRUE(out.empty());
+  ASSERT_FALSE(filter.Process(data + 100, sizeof(data) - 100, &out));
+  ASSERT_EQ(out.size(), psize * 3);
+  ASSERT_EQ(filter.GetStats().dropped_packets, 1u);
+
+  // garbage before sync byte
+  out.clear();
+  const uint8_t garbage[] = {0x01, 0x02, 0x03};
+  fastocloud::stream::TsPacketFilter resync({});
+  ASSERT_FALSE(resync.Process(garbage, sizeof(garbage), &out));
+  ASSERT_FALSE(resync.Process(data, sizeof(data), &out));
+  ASSERT_EQ(out.size(), sizeof(data));
+  ASSERT_EQ(resync.GetStats().sync_losses, 1u);
+}
+
+namespace {
+// single packet PSI section, CRC filled
+void MakePsiPacket(uint8_t* packet, uint16_t pid, const std::vector<uint8_t>& section) {
+  MakeTsPacket(packet, pid, 0);
+  packet[1] |= 0x40;
+  packet[4] = 0;  // pointer field
+  memcpy(packet + 5, section.data(), section.size());
+  const uint32_t crc = fastocloud::stream::TsPacketFilter::Crc32(section.data(), section.size());
+  packet[5 + section.size()] = crc >> 24;
+  packet[6 + section.size()] = crc >> 16;
+  packet[7 + section.size()] = crc >> 8;
+  packet[8 + section.size()] = crc;
+}
+}  // namespace
+
+TEST(TsPacketFilter, SelectProgram) {
+  const size_t psize = fastocloud::stream::TsPacketFilter::PACKET_SIZE;
+  uint8_t data[psize * 7];
+  // programs 1 (pmt 0x1010: 0x100, 0x101) and 2 (pmt 0x1020: 0x200)
+  MakePsiPacket(data, 0, {0x00, 0xB0, 0x11, 0x00, 0x01, 0xC1, 0x00, 0x00, 0x00, 0x01, 0xF0, 0x10, 0x00, 0x02, 0xF0,
+                          0x20});
+  MakePsiPacket(data + psize, 0x1010, {0x02, 0xB0, 0x17, 0x00, 0x01, 0xC1, 0x00, 0x00, 0xE1, 0x00, 0xF0, 0x00, 0x1B,
+                                       0xE1, 0x00, 0xF0, 0x00, 0x0F, 0xE1, 0x01, 0xF0, 0x00});
+  MakePsiPacket(data + psize * 2, 0x1020,
+                {0x02, 0xB0, 0x12, 0x00, 0x02, 0xC1, 0x00, 0x00, 0xE2, 0x00, 0xF0, 0x00, 0x1B, 0xE2, 0x00, 0xF0, 0x00});
+  MakeTsPacket(data + psize * 3, 0x100, 0);
+  MakeTsPacket(data + psize * 4, 0x101, 0);
+  MakeTsPacket(data + psize * 5, 0x200, 0);
+  MakePsiPacket(data + psize * 6, 0, {0x00, 0xB0, 0x11, 0x00, 0x01, 0xC1, 0x00, 0x00, 0x00, 0x01, 0xF0, 0x10, 0x00,
+                                      0x02, 0xF0, 0x20});
+  data[psize * 6 + 3] |= 1;  // cc
+
+  std::vector<uint8_t> out;
+  fastocloud::stream::TsPacketFilter filter({0x100});
+  ASSERT_FALSE(filter.Process(data, sizeof(data), &out));
+  ASSERT_EQ(out.size(), psize * 5);
+  ASSERT_EQ(filter.GetStats().dropped_packets, 2u);
+  ASSERT_EQ(memcmp(out.data() + psize, data + psize, psize), 0);                  // pmt 0x1010
+  ASSERT_EQ(memcmp(out.data() + psize * 2, data + psize * 3, psize * 2), 0);  // 0x100, 0x101
+
+  // last PAT lists only program 1
+  const uint8_t* pat = out.data() + psize * 4 + 5;
+  ASSERT_EQ(((pat[1] & 0x0F) << 8) | pat[2], 13);
+  ASSERT_EQ((pat[8] << 8) | pat[9], 1);
+  ASSERT_EQ(((pat[10] & 0x1F) << 8) | pat[11], 0x1010);
+  ASSERT_EQ(fastocloud::stream::TsPacketFilter::Crc32(pat, 16), 0u);
+}
+
+namespace {
+fastocloud::InputUri MakePlaylistFile(const std::string& path, const char* data) {
+  if (data) {
+    FILE* file = fopen(path.c_str(), "w");
+    fputs(data, file);
+    fclose(file);
+  }
+  return fastocloud::InputUri(0, common::uri::GURL("file://" + path));
+}
+
+std::string ReadPlaylistBuffer(fastocloud::stream::PlaylistReader* reader) {
+  GstBuffer* buffer = reader->ReadBuffer();
+  if (!buffer) {
+    return std::string();
+  }
+
+  GstMapInfo map;
+  gst_buffer_map(buffer, &map, GST_MAP_READ);
+  const std::string data(reinterpret_cast<const char*>(map.data), map.size);
+  gst_buffer_unmap(buffer, &map);
+  gst_buffer_unref(buffer);
+  return data;
+}
+}  // namespace
+
+TEST(PlaylistReader, NextEntry) {
+  gst_init(nullptr, nullptr);
+  const fastocloud::input_t playlist = {MakePlaylistFile("/tmp/playlist_reader_1.ts", "first"),
+                                        MakePlaylistFile("/tmp/playlist_reader_missing.ts", nullptr),
+                                        MakePlaylistFile("/tmp/playlist_reader_2.ts", "second")};
+  std::vector<std::string> opened;
+  {
+    fastocloud::stream::PlaylistReader reader(playlist, false, [&opened](const fastocloud::InputUri& uri) {
+      opened.push_back(uri.GetUrl().path());
+    });
+    ASSERT_EQ(ReadPlaylistBuffer(&reader), "first");
+    ASSERT_EQ(ReadPlaylistBuffer(&reader), "second");  // missing entry skipped
+    ASSERT_EQ(ReadPlaylistBuffer(&reader), std::string());
+  }
+  ASSERT_EQ(opened, std::vector<std::string>({"/tmp/playlist_reader_1.ts", "/tmp/playlist_reader_2.ts"}));
+
+  fastocloud::stream::PlaylistReader loop(playlist, true, nullptr);
+  ASSERT_EQ(ReadPlaylistBuffer(&loop), "first");
+  ASSERT_EQ(ReadPlaylistBuffer(&loop), "second");
+  ASSERT_EQ(ReadPlaylistBuffer(&loop), "first");
+
+  unlink("/tmp/playlist_reader_1.ts");
+  unlink("/tmp/playlist_reader_2.ts");
+}
+
+TEST(PlaylistReader, AllEntriesFailed) {
+  gst_init(nullptr, nullptr);
+  const fastocloud::input_t playlist = {MakePlaylistFile("/tmp/playlist_reader_missing_1.ts", nullptr),
+                                        MakePlaylistFile("/tmp/playlist_reader_missing_2.ts", nullptr)};
+  fastocloud::stream::PlaylistReader loop(playlist, true, nullptr);
+  ASSERT_EQ(loop.ReadBuffer(), nullptr);  // loop doesn't spin forever
+}
+
+TEST(LatencyTracer, SampleAndSnapshot) {
+  fastocloud::stream::LatencyTracer tracer;
+  const int64_t now = fastocloud::stream::LatencyTracer::sample_interval_usec * 2;
+  ASSERT_TRUE(tracer.NeedSample(fastocloud::LATENCY_STAGE_OUTPUT, now));
+  ASSERT_FALSE(tracer.NeedSample(fastocloud::LATENCY_STAGE_OUTPUT, now + 1));
+  ASSERT_TRUE(tracer.NeedSample(fastocloud::LATENCY_STAGE_INPUT, now + 1));
+
+  tracer.Observe(fastocloud::LATENCY_STAGE_OUTPUT, 30000);     // 30 msec
+  tracer.Observe(fastocloud::LATENCY_STAGE_OUTPUT, 20000000);  // 20 sec
+  fastocloud::latency_stats_t stats;
+  tracer.Snapshot(&stats);
+  const fastocloud::LatencyStats& output = stats[fastocloud::LATENCY_STAGE_OUTPUT];
+  ASSERT_EQ(output.GetCount(), 2u);
+  ASSERT_EQ(output.GetBucket(6), 1u);  // le 50 msec
+  ASSERT_EQ(output.GetBucket(fastocloud::LatencyStats::BUCKETS_COUNT - 1), 1u);
+  ASSERT_EQ(output.GetSumUsec(), 20030000u);
+  ASSERT_EQ(output.GetMaxUsec(), 20000000u);
+  ASSERT_EQ(stats[fastocloud::LATENCY_STAGE_INPUT].GetCount(), 0u);
+}
+
+TEST(StreamStatsBlock, TruncatedChannels) {
+  fastocloud::StreamStatsBlock* block = fastocloud::StreamStatsBlock::Create(1, 2);
+  ASSERT_TRUE(block);
+  fastocloud::StreamStruct str("test", fastotv::ENCODE, fastocloud::PLAYING,
+                               {fastocloud::ChannelStats(0), fastocloud::ChannelStats(1)},
+                               {fastocloud::ChannelStats(2)}, 100, 200, 3);
+  block->Write(str, 0.5, 1024, 300);
+  ASSERT_TRUE(block->IsTruncated());
+
+  uint64_t sequence = 0;
+  fastocloud::StreamStruct stats;
+  double cpu_load = 0;
+  size_t rss_bytes = 0;
+  fastotv::timestamp_t utc_time = 0;
+  ASSERT_TRUE(block->Read("test", &sequence, &stats, &cpu_load, &rss_bytes, &utc_time));
+  ASSERT_EQ(stats.input.size(), 1u);
+  ASSERT_EQ(stats.output.size(), 1u);
+  ASSERT_EQ(stats.output[0].GetID(), fastotv::channel_id_t(2));
+  ASSERT_EQ(rss_bytes, 1024u);
+  ASSERT_FALSE(block->Read("test", &sequence, &stats, &cpu_load, &rss_bytes, &utc_time));  // nothing new
+  fastocloud::StreamStatsBlock::Destroy(block);
+}
+
+TEST(CompactFrame, StatisticRoundTrip) {
+  fastocloud::ChannelStats input(0);
+  input.SetTotalBytes(1024);
+  input.SetBps(128);
+  fastocloud::StreamStruct str("test", fastotv::ENCODE, fastocloud::PLAYING, {input}, {fastocloud::ChannelStats(1)}, 100,
+                               200, 3);
+  str.latency[fastocloud::LATENCY_STAGE_OUTPUT].SetBucket(2, 5);
+  str.latency[fastocloud::LATENCY_STAGE_OUTPUT].SetMaxUsec(7000);
+  const fastocloud::StatisticInfo stat(str, 12.5, 4096, 300);
+
+  std::string payload;
+  ASSERT_FALSE(fastocloud::EncodeStatisticFrame(stat, &payload));
+  fastocloud::StatisticInfo decoded;
+  ASSERT_FALSE(fastocloud::DecodeStatisticFrame(payload, &decoded));
+  const fastocloud::StreamStruct dstr = decoded.GetStreamStruct();
+  ASSERT_EQ(dstr.id, str.id);
+  ASSERT_EQ(dstr.status, fastocloud::PLAYING);
+  ASSERT_EQ(dstr.restarts, 3u);
+  ASSERT_EQ(dstr.input.size(), 1u);
+  ASSERT_EQ(dstr.input[0].GetTotalBytes(), 1024u);
+  ASSERT_EQ(dstr.input[0].GetBps(), 128u);
+  ASSERT_EQ(dstr.output.size(), 1u);
+  ASSERT_EQ(dstr.latency[fastocloud::LATENCY_STAGE_OUTPUT].GetBucket(2), 5u);
+  ASSERT_EQ(dstr.latency[fastocloud::LATENCY_STAGE_OUTPUT].GetMaxUsec(), 7000u);
+  ASSERT_EQ(decoded.GetCpuLoad(), 12.5);
+  ASSERT_EQ(decoded.GetRssBytes(), 4096u);
+  ASSERT_EQ(decoded.GetTimestamp(), 300);
+
+  payload.resize(payload.size() / 2);
+  ASSERT_TRUE(fastocloud::DecodeStatisticFrame(payload, &decoded));
+}
+
+TEST(CompactFrame, ReaderPieces) {
+  const std::string payload(10000, 'x');  // above PIPE_BUF, arrives in several reads
+  std::string data;
+  for (uint8_t type : {fastocloud::COMPACT_FRAME_ML_NOTIFICATION, fastocloud::COMPACT_FRAME_STOP}) {
+    const uint32_t size = type == fastocloud::COMPACT_FRAME_STOP ? 0 : payload.size();
+    data.push_back(static_cast<char>(size >> 24));
+    data.push_back(static_cast<char>(size >> 16));
+    data.push_back(static_cast<char>(size >> 8));
+    data.push_back(static_cast<char>(size));
+    data.push_back(static_cast<char>(type));
+    data.append(payload, 0, size);
+  }
+
+  fastocloud::CompactFrameReader reader;
+  fastocloud::CompactFrame frame;
+  bool ready = true;
+  reader.Append(data.data(), 3);  // part of header
+  ASSERT_FALSE(reader.PopFrame(&frame, &ready));
+  ASSERT_FALSE(ready);
+  reader.Append(data.data() + 3, 4096);
+  ASSERT_FALSE(reader.PopFrame(&frame, &ready));
+  ASSERT_FALSE(ready);
+  reader.Append(data.data() + 4099, data.size() - 4099);
+  ASSERT_FALSE(reader.PopFrame(&frame, &ready));
+  ASSERT_TRUE(ready);
+  ASSERT_EQ(frame.type, fastocloud::COMPACT_FRAME_ML_NOTIFICATION);
+  ASSERT_EQ(frame.payload, payload);
+  ASSERT_FALSE(reader.PopFrame(&frame, &ready));
+  ASSERT_TRUE(ready);
+  ASSERT_EQ(frame.type, fastocloud::COMPACT_FRAME_STOP);
+  ASSERT_TRUE(frame.payload.empty());
+  ASSERT_FALSE(reader.PopFrame(&frame, &ready));
+  ASSERT_FALSE(ready);
+
+  const char invalid[] = {0, 0, 0, 0, fastocloud::COMPACT_FRAME_TYPES_COUNT};
+  reader.Append(invalid, sizeof(invalid));
+  ASSERT_TRUE(reader.PopFrame(&frame, &ready));
+}
+
+TEST(DetectionLimiter, Accept) {
+  fastocloud::stream::DetectionLimiter limiter(1000);
+  ASSERT_FALSE(limiter.Accept({}, 0));
+  ASSERT_TRUE(limiter.Accept({1, 2}, 10));
+  ASSERT_FALSE(limiter.Accept({2, 1}, 20));
+  ASSERT_TRUE(limiter.Accept({2}, 30));
+  ASSERT_TRUE(limiter.Accept({2}, 1030));
+  ASSERT_TRUE(limiter.Accept({}, 1040));
+  ASSERT_FALSE(limiter.Accept({}, 5000));
+}
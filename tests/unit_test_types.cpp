@@ -16,6 +16,8 @@
 
 #include "stream_commands/commands_info/statistic_info.h"
 #include "base/constants.h"
+#include "base/rendition.h"
+#include "base/stream_config_parse.h"
 
 TEST(StreamStructInfo, SerializeDeSerialize) {
   fastocloud::StreamInfo sha;
@@ -53,3 +55,20 @@ TEST(StreamStructInfo, SerializeDeSerialize) {
 
   json_object_put(serialized);
 }
+
+TEST(Rendition, MakeRendition) {
+  auto hash = fastocloud::MakeConfigFromJson(R"({"name" : "720p", "size" : "1280x720", "video_bitrate" : 3000})");
+  ASSERT_TRUE(hash);
+  auto rendition = fastocloud::Rendition::MakeRendition(hash.get());
+  ASSERT_TRUE(rendition);
+  ASSERT_EQ(rendition->GetName(), "720p");
+  ASSERT_EQ(rendition->GetSize(), common::draw::Size(1280, 720));
+  ASSERT_EQ(*rendition->GetVideoBitrate(), 3000);
+
+  auto without_size = fastocloud::MakeConfigFromJson(R"({"name" : "720p", "video_bitrate" : 3000})");
+  ASSERT_TRUE(without_size);
+  ASSERT_FALSE(fastocloud::Rendition::MakeRendition(without_size.get()));
+
+  ASSERT_EQ(fastocloud::GetRenditionBandwidth(3000, 128), 3128000u);
+  ASSERT_EQ(fastocloud::GetRenditionBandwidth(3000, fastocloud::bit_rate_t()), 3000000u);
+}
@@ -14,9 +14,38 @@
 
 #include <gtest/gtest.h>
 
+#include <stdio.h>
+#include <unistd.h>
+
+#include <string>
+
 #include "utils/chunk_info.h"
+#include "utils/m3u8_writer.h"
 
 TEST(ChunkInfo, double) {
   fastocloud::utils::ChunkInfo ch("1497615343667_segment10012.ts", 11.43 * fastocloud::utils::ChunkInfo::SECOND, 10012);
   ASSERT_EQ(ch.GetDurationInSecconds(), 11.43);
 }
+
+TEST(M3u8Writer, master_playlist) {
+  const std::string path = "/tmp/m3u8_writer_master_test.m3u8";
+  unlink(path.c_str());
+  fastocloud::utils::M3u8Writer writer;
+  ASSERT_FALSE(writer.Open(common::file_system::ascii_file_string_path(path),
+                           common::file_system::File::FLAG_CREATE | common::file_system::File::FLAG_WRITE));
+  ASSERT_FALSE(writer.WriteMasterHeader());
+  ASSERT_FALSE(writer.WriteStreamInf(3128000, common::draw::Size(1280, 720), "720p/master.m3u8"));
+  ASSERT_FALSE(writer.WriteStreamInf(864000, common::draw::Size(640, 360), "360p/master.m3u8"));
+  ASSERT_FALSE(writer.Close());
+
+  FILE* file = fopen(path.c_str(), "r");
+  ASSERT_TRUE(file);
+  char buff[512] = {0};
+  const size_t nread = fread(buff, 1, sizeof(buff) - 1, file);
+  fclose(file);
+  unlink(path.c_str());
+  ASSERT_EQ(std::string(buff, nread),
+            "#EXTM3U\n#EXT-X-VERSION:3\n"
+            "#EXT-X-STREAM-INF:BANDWIDTH=3128000,RESOLUTION=1280x720\n720p/master.m3u8\n"
+            "#EXT-X-STREAM-INF:BANDWIDTH=864000,RESOLUTION=640x360\n360p/master.m3u8\n");
+}